@@ -0,0 +1,178 @@
+/**
+ * bench.c - codectk_bench: throughput and micro-op benchmarks
+ *
+ * Usage:
+ *   codectk_bench [options]
+ *     --json FILE      also write the results as JSON ("-" = stdout, which
+ *                      moves the text report to stderr)
+ *     --only SECTION   codecs, gf2m or poly
+ *     --ber LIST       comma-separated channel bit error rates of the noisy
+ *                      decodes (default 1e-4,1e-3,1e-2)
+ *     --bytes N        codec payload per call (default 1 MiB)
+ *     --time SEC       minimum time per measurement (default 0.2)
+ *     --threads N      threads of the shared executor (default: all CPUs)
+ *     --quick          small sizes and parameter sets, for a smoke run
+ *
+ * Sections:
+ *   codecs  Mbps of message bits for encode, clean decode and noisy decode
+ *           of every registered codec over a few parameter sets
+ *   gf2m    cost per op of gf2m_mul/inv/sqr and of the gf2m_mul_vec()
+ *           kernel for every backend the CPU supports, and of the
+ *           bitsliced multiply per lane
+ *   poly    cost of the GF(2) and GF(2^m) polynomial operations by degree
+ */
+
+#include "bench.h"
+#include "../include/executor.h"
+#include "../include/gf2m.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <x86intrin.h>
+#define BENCH_TICKS() ((double)__rdtsc())
+#else
+#define BENCH_TICKS() 0.0
+#endif
+
+#ifndef CODECTK_VERSION
+#define CODECTK_VERSION "unknown"
+#endif
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+bench_cost bench_run(const bench_opts *o, void (*fn)(void *arg), void *arg) {
+  /* One untimed call warms the caches and any lazily built tables */
+  fn(arg);
+
+  unsigned long calls = 0;
+  double t0 = now(), k0 = BENCH_TICKS(), t1;
+  do {
+    fn(arg);
+    calls++;
+    t1 = now();
+  } while (t1 - t0 < o->min_time);
+  double k1 = BENCH_TICKS();
+
+  bench_cost c = {(t1 - t0) / (double)calls, (k1 - k0) / (double)calls};
+  return c;
+}
+
+void bench_record(bench_opts *o, const char *fmt, ...) {
+  if (!o->json) return;
+  fprintf(o->json, "%s\n    {", o->records++ ? "," : "");
+  va_list ap;
+  va_start(ap, fmt);
+  vfprintf(o->json, fmt, ap);
+  va_end(ap);
+  fputc('}', o->json);
+}
+
+static int parse_ber(bench_opts *o, const char *list) {
+  o->nber = 0;
+  for (const char *p = list; *p;) {
+    char *end;
+    double v = strtod(p, &end);
+    if (end == p || v < 0 || v >= 0.5 || o->nber == BENCH_MAX_BER) return -1;
+    o->ber[o->nber++] = v;
+    p = (*end == ',') ? end + 1 : end;
+    if (*end && *end != ',') return -1;
+  }
+  return 0;
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [--json FILE] [--only codecs|gf2m|poly] [--ber LIST]\n"
+          "          [--bytes N] [--time SEC] [--threads N] [--quick]\n",
+          prog);
+}
+
+int main(int argc, char **argv) {
+  bench_opts o = {0};
+  o.min_time = 0.2;
+  o.bytes = (size_t)1 << 20;
+  o.text = stdout;
+  parse_ber(&o, "1e-4,1e-3,1e-2");
+
+  const char *json_path = NULL;
+  int have_bytes = 0, have_time = 0;
+  long threads = -1;
+
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i], *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+    if (!strcmp(a, "--quick")) {
+      o.quick = 1;
+      continue;
+    }
+    if (!v) {
+      usage(argv[0]);
+      return 2;
+    }
+    i++;
+    if (!strcmp(a, "--json")) {
+      json_path = v;
+    } else if (!strcmp(a, "--only") &&
+               (!strcmp(v, "codecs") || !strcmp(v, "gf2m") || !strcmp(v, "poly"))) {
+      o.only = v;
+    } else if (!strcmp(a, "--ber") && parse_ber(&o, v) == 0) {
+      /* parsed */
+    } else if (!strcmp(a, "--bytes") && atol(v) > 0) {
+      o.bytes = (size_t)atol(v);
+      have_bytes = 1;
+    } else if (!strcmp(a, "--time") && atof(v) >= 0) {
+      o.min_time = atof(v);
+      have_time = 1;
+    } else if (!strcmp(a, "--threads") && atol(v) >= 0) {
+      threads = atol(v);
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  if (o.quick) {
+    if (!have_bytes) o.bytes = 16384;
+    if (!have_time) o.min_time = 0.01;
+  }
+  if (threads >= 0 && codectk_executor_configure_shared((unsigned)threads) != CODECTK_OK) {
+    fprintf(stderr, "Error: at most %d threads\n", CODECTK_EXECUTOR_MAX_THREADS);
+    return 2;
+  }
+
+  if (json_path) {
+    if (!strcmp(json_path, "-")) {
+      o.json = stdout;
+      o.text = stderr;
+    } else if (!(o.json = fopen(json_path, "w"))) {
+      fprintf(stderr, "Error: cannot open '%s'\n", json_path);
+      return 1;
+    }
+  }
+
+  const char *backend = gf2m_backend.name;
+  unsigned nthreads = codectk_executor_threads(codectk_executor_shared());
+  fprintf(o.text, "codectk %s, gf2m backend %s, %u threads\n", CODECTK_VERSION, backend,
+          nthreads);
+  if (o.json) {
+    fprintf(o.json, "{\n  \"version\": \"%s\",\n  \"backend\": \"%s\",\n"
+            "  \"threads\": %u,\n  \"min_time\": %g,\n  \"results\": [",
+            CODECTK_VERSION, backend, nthreads, o.min_time);
+  }
+
+  if (!o.only || !strcmp(o.only, "codecs")) bench_codecs(&o);
+  if (!o.only || !strcmp(o.only, "gf2m")) bench_gf2m(&o);
+  if (!o.only || !strcmp(o.only, "poly")) bench_poly(&o);
+
+  if (o.json) {
+    fprintf(o.json, "\n  ]\n}\n");
+    if (o.json != stdout) fclose(o.json);
+  }
+  return 0;
+}
@@ -0,0 +1,54 @@
+/**
+ * bench.h - Shared harness of codectk_bench
+ *
+ * Every measurement repeats its body until the minimum time has passed and
+ * reports the mean cost of one call, both in seconds and, where the CPU
+ * has a cheap tick counter (the x86 TSC), in ticks. Results go to a text
+ * report and, with --json, to one flat JSON array of records, so that runs
+ * of different versions can be compared key by key.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define BENCH_MAX_BER 8
+
+typedef struct {
+  double min_time;              /* seconds per measurement */
+  size_t bytes;                 /* codec payload per call */
+  double ber[BENCH_MAX_BER];    /* channel bit error rates of the noisy decodes */
+  unsigned nber;
+  int quick;                    /* small sizes and parameter sets only */
+  const char *only;             /* "codecs", "gf2m" or "poly"; NULL = all */
+  FILE *text;                   /* human-readable report, or NULL */
+  FILE *json;                   /* JSON records, or NULL */
+  int records;                  /* JSON records written so far */
+} bench_opts;
+
+typedef struct {
+  double sec;                   /* per call */
+  double ticks;                 /* per call; 0 without a tick counter */
+} bench_cost;
+
+/* Mean cost of fn(arg) over at least o->min_time seconds and one call */
+bench_cost bench_run(const bench_opts *o, void (*fn)(void *arg), void *arg);
+
+/**
+ * Append one JSON record; fmt gives its members without the braces, e.g.
+ * "\"kind\":\"gf2m\",\"m\":%u". Does nothing without --json.
+ */
+void bench_record(bench_opts *o, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/* Deterministic 64-bit generator shared by the sections */
+static inline uint64_t bench_rand(uint64_t *s) {
+  *s = *s * 6364136223846793005ULL + 1442695040888963407ULL;
+  return *s >> 11;
+}
+
+/* Sections, in bench_codecs.c, micro_gf2m.c and bench_poly.c */
+void bench_codecs(bench_opts *o);
+void bench_gf2m(bench_opts *o);
+void bench_poly(bench_opts *o);
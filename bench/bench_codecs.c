@@ -0,0 +1,319 @@
+/**
+ * bench_codecs.c - Encode and decode throughput of the registered codecs
+ *
+ * The payload is skewed random bytes (mostly a few symbols, so that
+ * Huffman has something to compress). Stream codecs code it in one call;
+ * Goppa codes one message per codeword, so its payload is split into
+ * k-bit messages and run through the batch entry points. Noisy decodes
+ * flip each coded bit with the given probability beforehand, outside the
+ * timing, and also report the bit error rate left after decoding.
+ * Throughput counts message bits either way.
+ */
+
+#include "bench.h"
+#include "../include/bch.h"
+#include "../include/codectk.h"
+#include "../include/goppa.h"
+#include "../include/hamming.h"
+#include "../include/huffman.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  const char *codec;            /* registry name */
+  const char *label;            /* parameters, as reported */
+  const void *params;
+  size_t block_bits;            /* > 0: batches of messages of this size */
+  size_t coded_bits;            /* codeword size of a block */
+  int corrects;                 /* 0: no noisy decodes (Huffman) */
+} codec_case;
+
+typedef struct {
+  const codec_case *cc;
+  const codectk_codec *codec;
+  const uint8_t *in;
+  size_t in_bits;
+  uint8_t *out;
+  size_t out_cap;               /* bytes */
+  size_t out_bits;              /* result of the last call */
+  size_t corrected;
+  codectk_err err;
+  /* block mode: one item per message, slots of in_slot / out_slot bytes */
+  codectk_batch_item *items;
+  size_t count, in_slot, out_slot;
+} codec_call;
+
+static void run_encode(void *arg) {
+  codec_call *c = (codec_call*)arg;
+  if (c->cc->block_bits) {
+    for (size_t i = 0; i < c->count; i++) {
+      c->items[i] = (codectk_batch_item){c->in + i * c->in_slot, c->cc->block_bits,
+                                         c->out + i * c->out_slot, c->out_slot * 8, 0,
+                                         CODECTK_OK};
+    }
+    c->err = codectk_encode_batch(c->codec, c->cc->params, c->items, c->count);
+    c->out_bits = c->count * c->cc->coded_bits;
+    return;
+  }
+  c->out_bits = c->out_cap * 8;
+  c->err = c->codec->encode(c->cc->params, c->in, c->in_bits, c->out, &c->out_bits);
+}
+
+static void run_decode(void *arg) {
+  codec_call *c = (codec_call*)arg;
+  if (c->cc->block_bits) {
+    for (size_t i = 0; i < c->count; i++) {
+      c->items[i] = (codectk_batch_item){c->in + i * c->in_slot, c->cc->coded_bits,
+                                         c->out + i * c->out_slot, c->out_slot * 8, 0,
+                                         CODECTK_OK};
+    }
+    c->err = codectk_decode_batch(c->codec, c->cc->params, c->items, c->count);
+    c->corrected = 0;
+    for (size_t i = 0; i < c->count; i++) c->corrected += c->items[i].num_corrected;
+    c->out_bits = c->count * c->cc->block_bits;
+    return;
+  }
+  c->out_bits = c->out_cap * 8;
+  c->corrected = 0;
+  c->err = c->codec->decode(c->cc->params, c->in, c->in_bits, c->out, &c->out_bits,
+                            &c->corrected);
+}
+
+static const char *err_name(codectk_err e) {
+  switch (e) {
+    case CODECTK_OK: return "ok";
+    case CODECTK_EINVAL: return "einval";
+    case CODECTK_ENOMEM: return "enomem";
+    case CODECTK_EDECODE: return "edecode";
+    case CODECTK_ENOTSUP: return "enotsup";
+  }
+  return "unknown";
+}
+
+/* Flip each of the first bits bits of buf with probability ber: the gaps
+ * between flips are geometric */
+static size_t add_noise(uint8_t *buf, size_t bits, double ber, uint64_t *seed) {
+  if (ber <= 0) return 0;
+  double scale = 1.0 / log1p(-ber);
+  size_t flips = 0;
+  for (size_t pos = 0;; pos++) {
+    double u = ((double)bench_rand(seed) + 1.0) / 9007199254740993.0;
+    double gap = floor(log(u) * scale);
+    if (gap >= (double)(bits - pos)) break;
+    pos += (size_t)gap;
+    buf[pos / 8] ^= (uint8_t)(1u << (pos % 8));
+    flips++;
+  }
+  return flips;
+}
+
+/* Message bits of the decode d that differ from the payload */
+static size_t bit_errors(const codec_call *d, const uint8_t *payload, size_t payload_bits) {
+  size_t diff = 0;
+  if (d->cc->block_bits) {
+    size_t k = d->cc->block_bits;
+    for (size_t i = 0; i < d->count; i++) {
+      const uint8_t *a = payload + i * d->out_slot, *b = d->out + i * d->out_slot;
+      for (size_t j = 0; j < k; j++) diff += ((a[j / 8] ^ b[j / 8]) >> (j % 8)) & 1;
+    }
+    return diff;
+  }
+  size_t bits = d->out_bits < payload_bits ? d->out_bits : payload_bits;
+  for (size_t i = 0; i < bits / 8; i++) {
+    diff += (size_t)__builtin_popcount((unsigned)(payload[i] ^ d->out[i]));
+  }
+  for (size_t j = bits / 8 * 8; j < bits; j++) {
+    diff += ((payload[j / 8] ^ d->out[j / 8]) >> (j % 8)) & 1;
+  }
+  return diff + (payload_bits - bits);
+}
+
+static double mbps(size_t bits, bench_cost c) {
+  return c.sec > 0 ? (double)bits / c.sec / 1e6 : 0;
+}
+
+static void bench_case(bench_opts *o, const codec_case *cc) {
+  const codectk_codec *codec = codectk_get(cc->codec);
+  uint64_t seed = 0x5eed;
+
+  /* Payload: whole messages in block mode, each in its own byte slot */
+  size_t count = 0, in_slot = 0, out_slot = 0, payload_bits = o->bytes * 8;
+  if (cc->block_bits) {
+    count = payload_bits / cc->block_bits ? payload_bits / cc->block_bits : 1;
+    in_slot = (cc->block_bits + 7) / 8;
+    out_slot = (cc->coded_bits + 7) / 8;
+    payload_bits = count * cc->block_bits;
+  }
+  size_t payload_bytes = cc->block_bits ? count * in_slot : o->bytes;
+  size_t coded_cap = cc->block_bits ? count * out_slot : 4 * o->bytes + 65536;
+  size_t plain_cap = cc->block_bits ? count * in_slot : o->bytes + 65536;
+
+  uint8_t *payload = calloc(payload_bytes + 8, 1);
+  uint8_t *coded = malloc(coded_cap);
+  uint8_t *noisy = malloc(coded_cap);
+  uint8_t *plain = malloc(plain_cap);
+  codectk_batch_item *items = count ? malloc(count * sizeof(*items)) : NULL;
+  if (!payload || !coded || !noisy || !plain || (count && !items)) {
+    fprintf(stderr, "Error: out of memory for %s %s\n", cc->codec, cc->label);
+    goto done;
+  }
+  for (size_t i = 0; i < payload_bytes; i++) {
+    uint64_t r = bench_rand(&seed);
+    uint8_t common = (uint8_t)"etaoin "[(r >> 2) % 7];
+    payload[i] = (r & 3) ? common : (uint8_t)(r >> 8);
+  }
+  if (cc->block_bits) {
+    /* Clear the bits past k in each slot, which decode leaves zero */
+    for (size_t i = 0; i < count && cc->block_bits % 8; i++) {
+      payload[i * in_slot + in_slot - 1] &= (uint8_t)((1u << (cc->block_bits % 8)) - 1);
+    }
+  }
+
+  codec_call enc = {cc, codec, payload, payload_bits, coded, coded_cap, 0, 0, CODECTK_OK,
+                    items, count, in_slot, out_slot};
+  bench_cost ce = bench_run(o, run_encode, &enc);
+  if (enc.err != CODECTK_OK) {
+    fprintf(stderr, "Error: %s %s encode: %s\n", cc->codec, cc->label,
+            codectk_strerror(enc.err));
+    goto done;
+  }
+  size_t coded_bits = enc.out_bits;
+
+  codec_call dec = {cc, codec, coded, coded_bits, plain, plain_cap, 0, 0, CODECTK_OK,
+                    items, count, out_slot, in_slot};
+  bench_cost cd = bench_run(o, run_decode, &dec);
+  int exact = dec.err == CODECTK_OK && bit_errors(&dec, payload, payload_bits) == 0;
+
+  if (o->text) {
+    fprintf(o->text, "  %-8s %-22s encode %9.2f Mbps  decode %9.2f Mbps%s\n", cc->codec,
+            cc->label, mbps(payload_bits, ce), mbps(payload_bits, cd),
+            exact ? "" : "  (MISMATCH)");
+  }
+  bench_record(o,
+               "\"kind\":\"codec\",\"codec\":\"%s\",\"params\":\"%s\",\"payload_bits\":%zu,"
+               "\"coded_bits\":%zu,\"encode_mbps\":%.3f,\"decode_mbps\":%.3f,"
+               "\"roundtrip_ok\":%s",
+               cc->codec, cc->label, payload_bits, coded_bits, mbps(payload_bits, ce),
+               mbps(payload_bits, cd), exact ? "true" : "false");
+
+  for (unsigned b = 0; b < o->nber && cc->corrects; b++) {
+    memcpy(noisy, coded, (coded_bits + 7) / 8);
+    size_t flips = add_noise(noisy, coded_bits, o->ber[b], &seed);
+    dec.in = noisy;
+    bench_cost cn = bench_run(o, run_decode, &dec);
+    size_t residual = bit_errors(&dec, payload, payload_bits);
+    size_t failed = 0;
+    for (size_t i = 0; i < count; i++) failed += items[i].err != CODECTK_OK;
+
+    if (o->text) {
+      fprintf(o->text, "  %-8s %-22s   ber %-8g decode %9.2f Mbps  %zu flips, "
+              "%zu corrected, residual ber %.2e\n", cc->codec, cc->label, o->ber[b],
+              mbps(payload_bits, cn), flips, dec.corrected,
+              (double)residual / (double)payload_bits);
+    }
+    bench_record(o,
+                 "\"kind\":\"codec_noisy\",\"codec\":\"%s\",\"params\":\"%s\",\"ber\":%g,"
+                 "\"decode_mbps\":%.3f,\"flips\":%zu,\"corrected\":%zu,\"status\":\"%s\","
+                 "\"failed_blocks\":%zu,\"residual_ber\":%.3e",
+                 cc->codec, cc->label, o->ber[b], mbps(payload_bits, cn), flips,
+                 dec.corrected, err_name(dec.err), failed,
+                 (double)residual / (double)payload_bits);
+  }
+
+done:
+  free(payload);
+  free(coded);
+  free(noisy);
+  free(plain);
+  free(items);
+}
+
+/* A Goppa code with an irreducible g of degree t over a random support */
+static goppa_ctx *make_goppa(unsigned m, unsigned t, size_t n, unsigned flags, uint16_t *g,
+                             uint16_t *L) {
+  uint64_t seed = 1 + m * 1000 + t;
+  for (int tries = 0; tries < 1000; tries++) {
+    for (unsigned i = 0; i < t; i++) g[i] = (uint16_t)(bench_rand(&seed) & ((1u << m) - 1));
+    g[t] = 1;
+    for (uint32_t x = 0; x < (1u << m); x++) L[x] = (uint16_t)x;
+    for (size_t i = (1u << m) - 1; i > 0; i--) {
+      size_t j = bench_rand(&seed) % (i + 1);
+      uint16_t tmp = L[i];
+      L[i] = L[j];
+      L[j] = tmp;
+    }
+
+    /* Creation rejects roots of g in the support: an irreducible g has
+     * none, and it is the only kind that decodes */
+    goppa_params P = {.m = m, .t = t, .n = n, .L = L, .g = g, .flags = flags};
+    goppa_ctx *c = NULL;
+    if (goppa_ctx_create(&P, &c) != CODECTK_OK) continue;
+    if (c->sqrt_x) return c;
+    goppa_ctx_destroy(c);
+  }
+  return NULL;
+}
+
+typedef struct {
+  unsigned m, t;
+  size_t n;
+  unsigned flags;
+  int full_only;
+} goppa_set;
+
+void bench_codecs(bench_opts *o) {
+  static const hamming_params ham[] = {{3}, {6}};
+  static const bch_params bch[] = {
+    {.m = 8, .t = 4}, {.m = 10, .t = 8}, {.m = 13, .t = 8},
+    {.m = 8, .t = 4, .flags = BCH_FLAG_CT}
+  };
+  static const huffman_params huf[] = {{0, 0, 0}, {HUFFMAN_DEFAULT_BLOCK, 0, 4}};
+  static const goppa_set gop[] = {
+    {10, 20, 1000, 0, 0}, {12, 64, 3488, 0, 1}, {10, 20, 1000, GOPPA_FLAG_CT, 0}
+  };
+  char label[64];
+
+  if (o->text) fprintf(o->text, "codecs (%zu byte payload)\n", o->bytes);
+
+  for (size_t i = 0; i < sizeof(ham) / sizeof(ham[0]); i++) {
+    snprintf(label, sizeof(label), "m=%u", ham[i].m);
+    codec_case cc = {"hamming", label, &ham[i], 0, 0, 1};
+    bench_case(o, &cc);
+  }
+
+  for (size_t i = 0; i < sizeof(bch) / sizeof(bch[0]); i++) {
+    if (o->quick && bch[i].m > 10) continue;
+    snprintf(label, sizeof(label), "m=%u,t=%u%s", bch[i].m, bch[i].t,
+             (bch[i].flags & BCH_FLAG_CT) ? ",ct" : "");
+    codec_case cc = {"bch", label, &bch[i], 0, 0, 1};
+    bench_case(o, &cc);
+  }
+
+  for (size_t i = 0; i < sizeof(huf) / sizeof(huf[0]); i++) {
+    snprintf(label, sizeof(label), "block=%zu,streams=%u", huf[i].block_size,
+             huf[i].streams);
+    codec_case cc = {"huffman", label, &huf[i], 0, 0, 0};
+    bench_case(o, &cc);
+  }
+
+  for (size_t i = 0; i < sizeof(gop) / sizeof(gop[0]); i++) {
+    const goppa_set *s = &gop[i];
+    if (o->quick && s->full_only) continue;
+    uint16_t *g = malloc((s->t + 1) * sizeof(uint16_t));
+    uint16_t *L = malloc((size_t)(1u << s->m) * sizeof(uint16_t));
+    goppa_ctx *c = (g && L) ? make_goppa(s->m, s->t, s->n, s->flags, g, L) : NULL;
+    snprintf(label, sizeof(label), "m=%u,t=%u,n=%zu%s", s->m, s->t, s->n,
+             (s->flags & GOPPA_FLAG_CT) ? ",ct" : "");
+    if (c) {
+      goppa_params P = {.m = s->m, .t = s->t, .n = s->n, .L = c->L, .g = g, .ctx = c};
+      codec_case cc = {"goppa", label, &P, c->k, c->n, 1};
+      bench_case(o, &cc);
+    } else {
+      fprintf(stderr, "Error: no Goppa code for %s\n", label);
+    }
+    goppa_ctx_destroy(c);
+    free(g);
+    free(L);
+  }
+}
@@ -0,0 +1,141 @@
+/**
+ * bench_poly.c - Cost of the polynomial operations by degree
+ *
+ * Operands are random polynomials of exactly the given degree: products
+ * of two of them, remainders of a product by a third, gcds of two, and
+ * evaluation at a point. GF(2^m) polynomials are over GF(2^12), the field
+ * of the larger Goppa codes; GF(2) degrees cover the BCH generators and
+ * the word-level Karatsuba range.
+ */
+
+#include "bench.h"
+#include "../include/poly.h"
+#include <stdlib.h>
+
+typedef struct {
+  poly_gf2m_t a, b, m, prod, r;
+  poly_gf2_t ba, bb, bm, bprod, br, bq;
+  uint16_t x;
+  uint16_t sink;
+} poly_ctx;
+
+static void gf2m_mul_op(void *arg) {
+  poly_ctx *p = (poly_ctx*)arg;
+  poly_gf2m_mul(&p->prod, &p->a, &p->b);
+}
+
+static void gf2m_mod_op(void *arg) {
+  poly_ctx *p = (poly_ctx*)arg;
+  poly_gf2m_mod(&p->r, &p->prod, &p->m);
+}
+
+static void gf2m_gcd_op(void *arg) {
+  poly_ctx *p = (poly_ctx*)arg;
+  poly_gf2m_gcd(&p->r, &p->a, &p->b);
+}
+
+static void gf2m_eval_op(void *arg) {
+  poly_ctx *p = (poly_ctx*)arg;
+  p->sink ^= poly_gf2m_eval(&p->a, p->x);
+  p->x = (uint16_t)(p->x * 5 + 1) & 0xfff;
+}
+
+static void gf2_mul_op(void *arg) {
+  poly_ctx *p = (poly_ctx*)arg;
+  poly_gf2_mul(&p->bprod, &p->ba, &p->bb);
+}
+
+static void gf2_mod_op(void *arg) {
+  poly_ctx *p = (poly_ctx*)arg;
+  poly_gf2_div_rem(&p->bq, &p->br, &p->bprod, &p->bm);
+}
+
+static void gf2_gcd_op(void *arg) {
+  poly_ctx *p = (poly_ctx*)arg;
+  poly_gf2_gcd(&p->br, &p->ba, &p->bb);
+}
+
+static void random_gf2m(poly_gf2m_t *p, int deg, uint64_t *seed) {
+  poly_gf2m_zero(p);
+  for (int i = 0; i < deg; i++) poly_gf2m_set_coeff(p, i, (uint16_t)(bench_rand(seed) & 0xfff));
+  poly_gf2m_set_coeff(p, deg, (uint16_t)(1 + bench_rand(seed) % 0xfff));
+}
+
+static void random_gf2(poly_gf2_t *p, int deg, uint64_t *seed) {
+  poly_gf2_zero(p);
+  for (int i = 0; i < deg; i++) poly_gf2_set_coeff(p, i, (int)(bench_rand(seed) & 1));
+  poly_gf2_set_coeff(p, deg, 1);
+}
+
+static void report(bench_opts *o, const char *op, int deg, bench_cost c) {
+  if (o->text) fprintf(o->text, "  %-10s deg %-6d %12.2f ns\n", op, deg, c.sec * 1e9);
+  bench_record(o, "\"kind\":\"poly\",\"op\":\"%s\",\"degree\":%d,\"ns_per_op\":%.2f", op, deg,
+               c.sec * 1e9);
+}
+
+void bench_poly(bench_opts *o) {
+  static const int gf2m_degrees[] = {16, 64, 256, 1024};
+  static const int gf2_degrees[] = {64, 512, 4096, 32768};
+  const gf2m_ctx *f = gf2m_ctx_get(12, 0);
+  uint64_t seed = 12;
+  poly_ctx *p = calloc(1, sizeof(*p));
+  if (!f || !p) {
+    free(p);
+    return;
+  }
+
+  if (o->text) fprintf(o->text, "poly\n");
+
+  for (size_t i = 0; i < sizeof(gf2m_degrees) / sizeof(gf2m_degrees[0]); i++) {
+    int d = gf2m_degrees[i];
+    if (o->quick && i >= 2) break;
+    if (poly_gf2m_init(&p->a, f, d + 1) || poly_gf2m_init(&p->b, f, d + 1) ||
+        poly_gf2m_init(&p->m, f, d + 1) || poly_gf2m_init(&p->prod, f, 2 * d + 1) ||
+        poly_gf2m_init(&p->r, f, 2 * d + 1)) {
+      break;
+    }
+    random_gf2m(&p->a, d, &seed);
+    random_gf2m(&p->b, d, &seed);
+    random_gf2m(&p->m, d, &seed);
+    poly_gf2m_mul(&p->prod, &p->a, &p->b);
+    p->x = 3;
+
+    report(o, "gf2m_mul", d, bench_run(o, gf2m_mul_op, p));
+    report(o, "gf2m_mod", d, bench_run(o, gf2m_mod_op, p));
+    report(o, "gf2m_gcd", d, bench_run(o, gf2m_gcd_op, p));
+    report(o, "gf2m_eval", d, bench_run(o, gf2m_eval_op, p));
+
+    poly_gf2m_free(&p->a);
+    poly_gf2m_free(&p->b);
+    poly_gf2m_free(&p->m);
+    poly_gf2m_free(&p->prod);
+    poly_gf2m_free(&p->r);
+  }
+
+  for (size_t i = 0; i < sizeof(gf2_degrees) / sizeof(gf2_degrees[0]); i++) {
+    int d = gf2_degrees[i];
+    if (o->quick && i >= 2) break;
+    if (poly_gf2_init(&p->ba, d + 1) || poly_gf2_init(&p->bb, d + 1) ||
+        poly_gf2_init(&p->bm, d + 1) || poly_gf2_init(&p->bprod, 2 * d + 1) ||
+        poly_gf2_init(&p->br, 2 * d + 1) || poly_gf2_init(&p->bq, 2 * d + 1)) {
+      break;
+    }
+    random_gf2(&p->ba, d, &seed);
+    random_gf2(&p->bb, d, &seed);
+    random_gf2(&p->bm, d, &seed);
+    poly_gf2_mul(&p->bprod, &p->ba, &p->bb);
+
+    report(o, "gf2_mul", d, bench_run(o, gf2_mul_op, p));
+    report(o, "gf2_mod", d, bench_run(o, gf2_mod_op, p));
+    report(o, "gf2_gcd", d, bench_run(o, gf2_gcd_op, p));
+
+    poly_gf2_free(&p->ba);
+    poly_gf2_free(&p->bb);
+    poly_gf2_free(&p->bm);
+    poly_gf2_free(&p->bprod);
+    poly_gf2_free(&p->br);
+    poly_gf2_free(&p->bq);
+  }
+
+  free(p);
+}
@@ -0,0 +1,117 @@
+/**
+ * micro_gf2m.c - Cost per op of the GF(2^m) primitives
+ *
+ * gf2m_mul/inv/sqr go through the installed backend, so every backend the
+ * CPU supports is installed in turn and timed over the same operands: an
+ * array of random nonzero elements, each op's result folded into a sink
+ * so that the calls are independent but not dead. gf2m_mul_vec() is timed
+ * per element, and the bitsliced multiply per element of one lane.
+ */
+
+#include "bench.h"
+#include "../include/gf2m.h"
+#include "../include/gf2m_bs.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MICRO_OPS 4096
+
+typedef struct {
+  const gf2m_ctx *f;
+  uint16_t a[MICRO_OPS], b[MICRO_OPS], r[MICRO_OPS];
+  gf2m_bs x[GF2M_BS_LANES], y[GF2M_BS_LANES];
+  uint16_t sink;
+} micro_ctx;
+
+static void op_mul(void *arg) {
+  micro_ctx *c = (micro_ctx*)arg;
+  uint16_t s = 0;
+  for (size_t i = 0; i < MICRO_OPS; i++) s ^= gf2m_mul(c->f, c->a[i], c->b[i]);
+  c->sink ^= s;
+}
+
+static void op_inv(void *arg) {
+  micro_ctx *c = (micro_ctx*)arg;
+  uint16_t s = 0;
+  for (size_t i = 0; i < MICRO_OPS; i++) s ^= gf2m_inv(c->f, c->a[i]);
+  c->sink ^= s;
+}
+
+static void op_sqr(void *arg) {
+  micro_ctx *c = (micro_ctx*)arg;
+  uint16_t s = 0;
+  for (size_t i = 0; i < MICRO_OPS; i++) s ^= gf2m_sqr(c->f, c->a[i]);
+  c->sink ^= s;
+}
+
+static void op_mul_vec(void *arg) {
+  micro_ctx *c = (micro_ctx*)arg;
+  gf2m_mul_vec(c->f, c->r, c->a, c->b, MICRO_OPS);
+  c->sink ^= c->r[c->a[0] % MICRO_OPS];
+}
+
+/* 64 bitsliced products of 64 lanes: MICRO_OPS elements */
+static void op_bs_mul(void *arg) {
+  micro_ctx *c = (micro_ctx*)arg;
+  for (size_t i = 0; i < GF2M_BS_LANES; i++) gf2m_bs_mul(c->f, &c->x[i], &c->x[i], &c->y[i]);
+  c->sink ^= (uint16_t)c->x[0].p[0];
+}
+
+static void report(bench_opts *o, const char *backend, unsigned m, const char *op,
+                   bench_cost cost) {
+  double ns = cost.sec * 1e9 / MICRO_OPS, ticks = cost.ticks / MICRO_OPS;
+  if (o->text) {
+    fprintf(o->text, "  %-12s m=%-2u %-8s %8.2f ns/op", backend, m, op, ns);
+    if (ticks > 0) fprintf(o->text, "  %8.2f cycles/op", ticks);
+    fputc('\n', o->text);
+  }
+  if (ticks > 0) {
+    bench_record(o, "\"kind\":\"gf2m\",\"backend\":\"%s\",\"m\":%u,\"op\":\"%s\","
+                 "\"ns_per_op\":%.4f,\"cycles_per_op\":%.3f", backend, m, op, ns, ticks);
+  } else {
+    bench_record(o, "\"kind\":\"gf2m\",\"backend\":\"%s\",\"m\":%u,\"op\":\"%s\","
+                 "\"ns_per_op\":%.4f,\"cycles_per_op\":null", backend, m, op, ns);
+  }
+}
+
+void bench_gf2m(bench_opts *o) {
+  static const char *const backends[] = {"c", "ssse3", "avx2", "neon"};
+  static const unsigned fields[] = {8, 12, 16};
+  micro_ctx *c = malloc(sizeof(*c));
+  if (!c) return;
+  memset(c, 0, sizeof(*c));
+
+  if (o->text) fprintf(o->text, "gf2m (cycles are time stamp counter ticks)\n");
+
+  for (size_t fi = 0; fi < sizeof(fields) / sizeof(fields[0]); fi++) {
+    unsigned m = fields[fi];
+    if (o->quick && m > 8) break;
+    c->f = gf2m_ctx_get(m, 0);
+    if (!c->f) continue;
+
+    uint64_t seed = m;
+    uint16_t mask = (uint16_t)((1u << m) - 1);
+    for (size_t i = 0; i < MICRO_OPS; i++) {
+      do c->a[i] = (uint16_t)(bench_rand(&seed) & mask); while (!c->a[i]);
+      do c->b[i] = (uint16_t)(bench_rand(&seed) & mask); while (!c->b[i]);
+    }
+    for (size_t w = 0; w < GF2M_BS_LANES; w++) {
+      gf2m_bs_pack(&c->x[w], c->a + w * GF2M_BS_LANES);
+      gf2m_bs_pack(&c->y[w], c->b + w * GF2M_BS_LANES);
+    }
+
+    for (size_t bi = 0; bi < sizeof(backends) / sizeof(backends[0]); bi++) {
+      if (gf2m_backend_select(backends[bi]) != 0) continue;
+      const char *name = gf2m_backend.name;
+      report(o, name, m, "mul", bench_run(o, op_mul, c));
+      report(o, name, m, "inv", bench_run(o, op_inv, c));
+      report(o, name, m, "sqr", bench_run(o, op_sqr, c));
+      report(o, name, m, "mul_vec", bench_run(o, op_mul_vec, c));
+    }
+    gf2m_backend_select(NULL);
+
+    report(o, "bitsliced", m, "mul", bench_run(o, op_bs_mul, c));
+  }
+
+  free(c);
+}
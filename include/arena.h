@@ -0,0 +1,69 @@
+/**
+ * arena.h - Caller-owned scratch arena (header-only)
+ *
+ * A bump allocator over one caller buffer, which may live on the stack, in
+ * a per-thread pool or anywhere else. Allocation is a pointer bump and a
+ * whole group of temporaries is released at once by rewinding to a mark,
+ * so routines that take their scratch from an arena make no heap calls.
+ *
+ * Codecs report the worst case they need for a parameter set (e.g.
+ * goppa_workspace_size()); size queries count every allocation rounded
+ * with codectk_arena_round() plus CODECTK_ARENA_ALIGN for the alignment of
+ * the buffer itself.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Alignment of every allocation */
+#define CODECTK_ARENA_ALIGN 16
+
+typedef struct {
+  uint8_t *base;  /* first aligned byte of the buffer */
+  size_t size;    /* usable bytes from base */
+  size_t used;    /* bytes handed out */
+} codectk_arena;
+
+/* Bytes an allocation of n bytes takes from an arena */
+static inline size_t codectk_arena_round(size_t n) {
+  return (n + CODECTK_ARENA_ALIGN - 1) & ~(size_t)(CODECTK_ARENA_ALIGN - 1);
+}
+
+/* Use buf[0..size) as the arena; a NULL buffer gives an empty arena */
+static inline void codectk_arena_init(codectk_arena *a, void *buf, size_t size) {
+  size_t pad = buf ? (size_t)(-(uintptr_t)buf & (CODECTK_ARENA_ALIGN - 1)) : 0;
+  a->base = buf ? (uint8_t*)buf + pad : NULL;
+  a->size = (buf && size > pad) ? size - pad : 0;
+  a->used = 0;
+}
+
+/**
+ * n bytes, aligned to CODECTK_ARENA_ALIGN and not cleared. Returns NULL,
+ * taking nothing, if the arena is NULL or has too little room left.
+ */
+static inline void *codectk_arena_alloc(codectk_arena *a, size_t n) {
+  size_t need = codectk_arena_round(n);
+  if (!a || need < n || need > a->size - a->used) return NULL;
+  void *p = a->base + a->used;
+  a->used += need;
+  return p;
+}
+
+/* codectk_arena_alloc() with the bytes zeroed */
+static inline void *codectk_arena_calloc(codectk_arena *a, size_t n) {
+  void *p = codectk_arena_alloc(a, n);
+  if (p) memset(p, 0, n);
+  return p;
+}
+
+/* Current position, to hand back to codectk_arena_release() */
+static inline size_t codectk_arena_mark(const codectk_arena *a) {
+  return a ? a->used : 0;
+}
+
+/* Release everything allocated since mark was taken */
+static inline void codectk_arena_release(codectk_arena *a, size_t mark) {
+  if (a && mark <= a->used) a->used = mark;
+}
@@ -1,11 +1,204 @@
 #pragma once
 #include "codectk.h"
+#include "gf2m.h"
 #include <stddef.h>
+
+/**
+ * Upper bound on deg g(x). Keeps the parity register on the stack so the
+ * encode path never allocates.
+ */
+#define BCH_MAX_PARITY_BITS 4096
+
+/**
+ * Largest parity register (in 64-bit words) that gets slicing-by-8 tables.
+ * Larger registers fall back to one table lookup per byte.
+ */
+#define BCH_SLICE_MAX_WORDS 4
+
+/**
+ * Largest t that gets per-syndrome byte tables (t x 256 entries). Larger t
+ * evaluates the syndromes one remainder bit at a time.
+ */
+#define BCH_SYND_TABLE_MAX_T 64
+
+/**
+ * Largest deg Λ(x) handled by the SIMD Chien search. Larger error locators
+ * use the scalar incremental search.
+ */
+#define BCH_CHIEN_SIMD_MAX_T 64
+
+/**
+ * Dirty codewords of a stream whose Berlekamp-Massey runs go in lockstep.
+ * The schedule depends on t only, so they share every loop.
+ */
+#define BCH_BM_LANES 8
+
+/**
+ * Precomputed BCH state for one (m, t) pair.
+ *
+ * Holds the field tables and the generator polynomial in LFSR form so that
+ * encode/decode do no per-call setup. Built by bch_ctx_create(), read-only
+ * afterwards, and therefore safe to share between threads.
+ *
+ * Bit layout: a codeword of N bits (N = n, or less for a shortened code) is
+ * [message | parity] in stream order, and stream bit p is the coefficient of
+ * x^(N-1-p). The first message bit is the highest-degree term, which lets the
+ * encoder run a reflected LFSR over the input in natural bit order.
+ */
 typedef struct {
-  unsigned m;     // 2<=m<=12 (start with small m)
+  unsigned m;         /* field degree, 2 <= m <= 16 */
+  unsigned t;         /* correction capability */
+  unsigned n;         /* full code length, 2^m - 1 */
+  unsigned r;         /* parity bits = deg g(x) */
+  unsigned k;         /* message bits, n - r */
+  gf2m_ctx field;     /* shared GF(2^m) tables from gf2m_ctx_get() */
+  unsigned words;     /* 64-bit words in the parity register */
+  uint64_t *gen;      /* reflected g(x) without x^r: bit i = g_{r-1-i} */
+  unsigned slices;    /* LFSR tables: 8 (slicing-by-8) or 1 (byte-wise) */
+  uint64_t *tab;      /* slices x 256 entries of words each */
+  uint16_t *synd_tab; /* t x 256 byte tables for the odd syndromes, or NULL */
+  unsigned chien_lanes; /* positions per SIMD Chien step, 0 = scalar */
+  uint8_t *chien_tab; /* split-nibble step tables for the SIMD Chien search */
+} bch_ctx;
+
+/**
+ * Handling of a trailing partial block in multi-block streams.
+ *
+ * BCH_PAD_SHORTEN: the last message is encoded as a shortened codeword of
+ *   len + r bits, and decode treats a trailing partial codeword the same way.
+ * BCH_PAD_ZERO: the last message is zero-filled to a full n-bit codeword,
+ *   and decode ignores trailing bits shorter than n (e.g. byte padding).
+ */
+typedef enum {
+  BCH_PAD_SHORTEN = 0,
+  BCH_PAD_ZERO
+} bch_pad;
+
+/**
+ * bch_params.flags. BCH_FLAG_CT makes the codec's decode entry points use
+ * the constant-time decoder, bch_ctx_decode_ct().
+ */
+#define BCH_FLAG_CT 0x1u
+
+typedef struct {
+  unsigned m;     // 2<=m<=16
   unsigned t;     // capability
-  // precomputed tables (optional):
-  uint16_t *alog, *log;
+  // precomputed context (optional); when set, m and t are taken from it
+  const bch_ctx *ctx;
+  // trailing partial block policy
+  bch_pad pad;
+  // BCH_FLAG_*
+  unsigned flags;
 } bch_params;
 
+/**
+ * Build a BCH context for the given (m, t).
+ * Returns CODECTK_EINVAL for unsupported parameters (including codes with
+ * no message bits left), CODECTK_ENOMEM on allocation failure.
+ */
+codectk_err bch_ctx_create(unsigned m, unsigned t, bch_ctx **out);
+
+/**
+ * Free a context returned by bch_ctx_create(). NULL is ignored.
+ */
+void bch_ctx_destroy(bch_ctx *ctx);
+
+/**
+ * Fill the split-nibble step tables of the SIMD Chien search for a step of
+ * lanes positions: nt tables of 128 bytes, one per coefficient j = 1..nt
+ * (nt <= BCH_CHIEN_SIMD_MAX_T). Used by bch_ctx_create() and by the
+ * generator of the fixed codecs.
+ */
+void bch_chien_fill(const bch_ctx *ctx, unsigned lanes, unsigned nt, uint8_t *out);
+
+/**
+ * Encode an arbitrary-length bitstream. The input is split into k-bit
+ * messages, each emitted as an n-bit codeword [message | parity]; a final
+ * partial message is handled according to pad. *out_bits is the output
+ * capacity in bits on entry and the encoded length on return.
+ */
+codectk_err bch_ctx_encode(const bch_ctx *ctx, bch_pad pad,
+                           const uint8_t *in, size_t in_bits,
+                           uint8_t *out, size_t *out_bits);
+
+/**
+ * Decode a stream of back-to-back codewords and write k corrected message
+ * bits per codeword. Codewords with more than t errors are passed through
+ * uncorrected and the call returns CODECTK_EDECODE after decoding the rest;
+ * *num_corrected is the total over all codewords. Long streams are split
+ * into runs of codewords decoded on the shared executor (executor.h); the
+ * output does not depend on the thread count.
+ */
+codectk_err bch_ctx_decode(const bch_ctx *ctx, bch_pad pad,
+                           const uint8_t *in, size_t in_bits,
+                           uint8_t *out, size_t *out_bits, size_t *num_corrected);
+
+/**
+ * Bytes of decode scratch (error positions, Chien registers, and syndromes,
+ * error locator and Berlekamp-Massey registers for BCH_BM_LANES
+ * codewords) needed by bch_ctx_decode_ws(); depends only on t.
+ */
+size_t bch_ctx_workspace_size(const bch_ctx *ctx);
+
+/**
+ * bch_ctx_decode() using caller-provided scratch of at least
+ * bch_ctx_workspace_size() bytes, 4-byte aligned, so that decoding never
+ * allocates. The context itself stays read-only, so each thread sharing a
+ * context needs its own workspace. Caller scratch keeps the decode on the
+ * calling thread. With workspace == NULL the call is bch_ctx_decode().
+ */
+codectk_err bch_ctx_decode_ws(const bch_ctx *ctx, bch_pad pad,
+                              const uint8_t *in, size_t in_bits,
+                              uint8_t *out, size_t *out_bits, size_t *num_corrected,
+                              void *workspace, size_t workspace_size);
+
+/**
+ * Decode count independent streams with one context and one workspace
+ * (bch_ctx_workspace_size() bytes) on the calling thread. With workspace
+ * == NULL, runs of items are spread over the shared executor instead,
+ * with scratch allocated once per thread. Each item gets its own err,
+ * out_bits and num_corrected, as from bch_ctx_decode(). Returns
+ * CODECTK_OK if every item decoded, else the first item error.
+ */
+codectk_err bch_ctx_decode_batch(const bch_ctx *ctx, bch_pad pad,
+                                 codectk_batch_item *items, size_t count,
+                                 void *workspace, size_t workspace_size);
+
+/**
+ * Constant-time bch_ctx_decode(): same output, errors and counts, but
+ * codewords are decoded 64 at a time, one per lane of bitsliced GF(2^m)
+ * arithmetic (gf2m_bs.h), each pass on the same fixed schedule:
+ *
+ * 1. The t odd syndromes accumulated over every position, the received
+ *    bits as lane masks, and the even ones as squares
+ * 2. Inversion-free Berlekamp-Massey in its binary form, t steps over all
+ *    t + 1 coefficients with the length updates as masked selects
+ * 3. Chien search over every position of the codeword
+ * 4. The correction applied under a mask of the codewords whose root count
+ *    matches the locator length L <= t
+ *
+ * Clean codewords take the same path as dirty ones, and no branch, loop
+ * bound or memory address depends on the received bits, only on the code
+ * and the stream length. Scratch of about 16 n + 128 t m bytes is
+ * allocated per call, and the call stays on the calling thread.
+ */
+codectk_err bch_ctx_decode_ct(const bch_ctx *ctx, bch_pad pad,
+                              const uint8_t *in, size_t in_bits,
+                              uint8_t *out, size_t *out_bits, size_t *num_corrected);
+
 const codectk_codec* bch_codec(void);
+
+/**
+ * Codec of a parameter set compiled in with CODECTK_FIXED_CODECS, by its
+ * name "bch-M-T" (also found by codectk_get()), or NULL. Its context and
+ * tables are static, and its encoder and decoder are specialized for the
+ * set. params may be NULL; otherwise a bch_params whose pad and flags are
+ * used, with m and t 0 or equal to the set's and no ctx.
+ */
+const codectk_codec* bch_fixed_codec(const char *name);
+
+/**
+ * The static context of a fixed set, or NULL: for its code parameters and
+ * sizes, or for the bch_ctx_* functions, which run it unspecialized.
+ */
+const bch_ctx* bch_fixed_ctx(const char *name);
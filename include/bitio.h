@@ -1,28 +1,252 @@
+/**
+ * bitio.h - Bit-level stream I/O (header-only)
+ *
+ * Streams are LSB-first: the first bit of a stream is bit 0 of byte 0.
+ * Both directions keep a 64-bit accumulator so that multi-bit fields move
+ * with one shift/OR, and memory is touched one 64-bit word at a time.
+ *
+ * Single-bit bitw_put()/bitr_get() remain for simple callers; hot loops
+ * should use bitw_put_bits() and bitr_peek_bits()/bitr_skip_bits().
+ */
+
 #pragma once
-#include <stdio.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
+
+/* Largest field for bitr_peek_bits()/bitr_get_bits(); a refill guarantees it */
+#define BITIO_MAX_BITS 56
+
+static inline uint64_t bitio_load_le64(const uint8_t *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap64(v);
+#endif
+  return v;
+}
+
+static inline void bitio_store_le64(uint8_t *p, uint64_t v) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap64(v);
+#endif
+  memcpy(p, &v, sizeof(v));
+}
+
+static inline uint64_t bitio_mask(unsigned n) {
+  return n < 64 ? (1ULL << n) - 1 : ~0ULL;
+}
+
+/* Writer */
+
+/**
+ * acc holds nacc (< 64) pending bits; p is the next byte to store. Every
+ * put checks the remaining capacity up front, so the pending bits always
+ * fit and bitw_flush() cannot fail after a successful put.
+ */
+typedef struct {
+  uint64_t acc;
+  unsigned nacc;
+  uint8_t *p, *end, *start;
+} bitw_t;
+
+static inline void bitw_init(bitw_t *w, uint8_t *out, size_t out_bytes) {
+  w->acc = 0;
+  w->nacc = 0;
+  w->p = out;
+  w->end = out + out_bytes;
+  w->start = out;
+}
+
+/**
+ * Append the low n bits of v (n <= 64). Returns -1, writing nothing, if
+ * the output cannot hold them.
+ */
+static inline int bitw_put_bits(bitw_t *w, uint64_t v, unsigned n) {
+  if ((size_t)(w->end - w->p) * 8 < (size_t)w->nacc + n) return -1;
 
-typedef struct { uint8_t buf; int bitpos; uint8_t *p, *end; } bitw_t;
-typedef struct { int buf, bitpos; const uint8_t *p, *end; } bitr_t;
+  v &= bitio_mask(n);
+  w->acc |= v << w->nacc;
+  unsigned total = w->nacc + n;
+  if (total >= 64) {
+    /* The capacity check above leaves at least 8 bytes */
+    bitio_store_le64(w->p, w->acc);
+    w->p += 8;
+    w->acc = w->nacc ? v >> (64 - w->nacc) : 0;
+    total -= 64;
+  }
+  w->nacc = total;
+  return 0;
+}
 
-static inline void bitw_init(bitw_t *w, uint8_t *out, size_t out_bytes)
-{ w->buf=0; w->bitpos=0; w->p=out; w->end=out+out_bytes; }
+static inline int bitw_put(bitw_t *w, unsigned b) {
+  return bitw_put_bits(w, b & 1u, 1);
+}
 
-static inline int bitw_put(bitw_t *w, unsigned b){
-  if(w->p>=w->end) return -1;
-  w->buf |= (b & 1u) << w->bitpos;
-  if(++w->bitpos==8){ *w->p++ = w->buf; w->buf=0; w->bitpos=0; }
+/**
+ * Store the pending bits, zero-padding the last byte. The stream is byte
+ * aligned afterwards.
+ */
+static inline int bitw_flush(bitw_t *w) {
+  for (unsigned i = 0; i < w->nacc; i += 8) {
+    *w->p++ = (uint8_t)(w->acc >> i);
+  }
+  w->acc = 0;
+  w->nacc = 0;
   return 0;
 }
-static inline int bitw_flush(bitw_t *w){
-  if(w->bitpos){ if(w->p>=w->end) return -1; *w->p++ = w->buf; w->buf=0; w->bitpos=0; }
+
+/* Bits written so far, including pending ones */
+static inline size_t bitw_tell(const bitw_t *w) {
+  return (size_t)(w->p - w->start) * 8 + w->nacc;
+}
+
+/**
+ * Append len whole bytes. At a byte boundary this is a memcpy; otherwise
+ * the bytes are shifted in 56 bits at a time.
+ */
+static inline int bitw_put_bytes(bitw_t *w, const uint8_t *src, size_t len) {
+  if ((size_t)(w->end - w->p) < len || ((size_t)(w->end - w->p) - len) * 8 < w->nacc) {
+    return -1;
+  }
+
+  if ((w->nacc & 7) == 0) {
+    bitw_flush(w);
+    memcpy(w->p, src, len);
+    w->p += len;
+    return 0;
+  }
+
+  size_t i = 0;
+  for (; i + 8 <= len; i += 7) {
+    bitw_put_bits(w, bitio_load_le64(src + i), 56);
+  }
+  for (; i < len; i++) {
+    bitw_put_bits(w, src[i], 8);
+  }
   return 0;
 }
 
-static inline void bitr_init(bitr_t *r, const uint8_t *in, size_t in_bytes)
-{ r->buf=-1; r->bitpos=8; r->p=in; r->end=in+in_bytes; }
+/* Reader */
+
+/**
+ * acc holds nacc valid bits; bits above nacc, if any, are already the
+ * next stream bits (the refill overlaps them), so ORing them in again is
+ * harmless. p is the first byte not yet (fully) loaded.
+ */
+typedef struct {
+  uint64_t acc;
+  unsigned nacc;
+  const uint8_t *p, *end, *start;
+} bitr_t;
 
-static inline int bitr_get(bitr_t *r){
-  if(r->bitpos==8){ if(r->p>=r->end) return -1; r->buf=*r->p++; r->bitpos=0; }
-  int b = (r->buf >> r->bitpos) & 1; r->bitpos++; return b;
+static inline void bitr_init(bitr_t *r, const uint8_t *in, size_t in_bytes) {
+  r->acc = 0;
+  r->nacc = 0;
+  r->p = in;
+  r->end = in + in_bytes;
+  r->start = in;
+}
+
+/**
+ * Top the accumulator up to at least BITIO_MAX_BITS bits, or to the end
+ * of the input. Away from the end this is one unaligned load with no
+ * data-dependent branches.
+ */
+static inline void bitr_refill(bitr_t *r) {
+  if (r->end - r->p >= 8) {
+    r->acc |= bitio_load_le64(r->p) << r->nacc;
+    r->p += (63 - r->nacc) >> 3;
+    r->nacc |= 56;
+    return;
+  }
+  while (r->nacc <= 56 && r->p < r->end) {
+    r->acc |= (uint64_t)*r->p++ << r->nacc;
+    r->nacc += 8;
+  }
+}
+
+/* Bits left in the stream */
+static inline size_t bitr_bits_left(const bitr_t *r) {
+  return (size_t)(r->end - r->p) * 8 + r->nacc;
+}
+
+/* Bits consumed so far */
+static inline size_t bitr_tell(const bitr_t *r) {
+  return (size_t)(r->p - r->start) * 8 - r->nacc;
+}
+
+/**
+ * Next n bits (n <= BITIO_MAX_BITS) without consuming them. Bits past the
+ * end of the input read as zero.
+ */
+static inline uint64_t bitr_peek_bits(bitr_t *r, unsigned n) {
+  if (r->nacc < n) bitr_refill(r);
+  return r->acc & bitio_mask(n);
+}
+
+/**
+ * Consume n bits (n <= BITIO_MAX_BITS). Returns -1, consuming nothing, if
+ * fewer than n bits are left.
+ */
+static inline int bitr_skip_bits(bitr_t *r, unsigned n) {
+  if (r->nacc < n) {
+    bitr_refill(r);
+    if (r->nacc < n) return -1;
+  }
+  r->acc = n < 64 ? r->acc >> n : 0;
+  r->nacc -= n;
+  return 0;
+}
+
+/**
+ * Read n bits (n <= BITIO_MAX_BITS) into *v. Returns -1 if fewer than n
+ * bits are left.
+ */
+static inline int bitr_get_bits(bitr_t *r, unsigned n, uint64_t *v) {
+  uint64_t x = bitr_peek_bits(r, n);
+  if (bitr_skip_bits(r, n)) return -1;
+  *v = x;
+  return 0;
+}
+
+/* Next bit, or -1 at the end of the input */
+static inline int bitr_get(bitr_t *r) {
+  uint64_t b;
+  if (bitr_get_bits(r, 1, &b)) return -1;
+  return (int)b;
+}
+
+/**
+ * Read len whole bytes into dst. At a byte boundary the buffered bytes are
+ * drained and the rest is a memcpy. Returns -1, consuming nothing, if
+ * fewer than len bytes are left.
+ */
+static inline int bitr_get_bytes(bitr_t *r, uint8_t *dst, size_t len) {
+  if (bitr_bits_left(r) / 8 < len) return -1;
+
+  if ((r->nacc & 7) == 0) {
+    size_t buffered = r->nacc / 8;
+    size_t i = 0;
+    for (; i < buffered && i < len; i++) {
+      dst[i] = (uint8_t)(r->acc >> (8 * i));
+    }
+    if (i < buffered) {
+      /* Request ended inside the accumulator */
+      r->acc >>= 8 * i;
+      r->nacc -= (unsigned)(8 * i);
+      return 0;
+    }
+    memcpy(dst + i, r->p, len - i);
+    r->p += len - i;
+    r->acc = 0;
+    r->nacc = 0;
+    return 0;
+  }
+
+  for (size_t i = 0; i < len; i++) {
+    dst[i] = (uint8_t)bitr_peek_bits(r, 8);
+    bitr_skip_bits(r, 8);
+  }
+  return 0;
 }
@@ -10,6 +10,20 @@ typedef enum {
   CODECTK_ENOTSUP
 } codectk_err;
 
+/**
+ * One independent buffer of a batch call. in/in_bits and out/out_bits are
+ * as for encode/decode: out_bits is the capacity on entry and the coded
+ * length on return. err and num_corrected are set for every item.
+ */
+typedef struct {
+  const uint8_t *in;
+  size_t in_bits;
+  uint8_t *out;
+  size_t out_bits;
+  size_t num_corrected;
+  codectk_err err;
+} codectk_batch_item;
+
 typedef struct {
   const char *name;
   // encode: in bits -> out bits (stream-safe)
@@ -22,6 +36,12 @@ typedef struct {
                         const uint8_t *in, size_t in_bits,
                         uint8_t *out, size_t *out_bits,
                         size_t *num_corrected);
+  // optional: encode/decode count independent items with the parameters
+  //  validated and any per-call state built once; NULL = not provided
+  codectk_err (*encode_batch)(const void *params,
+                              codectk_batch_item *items, size_t count);
+  codectk_err (*decode_batch)(const void *params,
+                              codectk_batch_item *items, size_t count);
 } codectk_codec;
 
 /**
@@ -31,6 +51,18 @@ typedef struct {
  */
 const codectk_codec* codectk_get(const char *name);
 
+/**
+ * Encode or decode count independent items with one set of parameters,
+ * through the codec's batch entry point when it has one and one call per
+ * item otherwise. Each item gets its own err, out_bits and (for decode)
+ * num_corrected; an item that fails does not stop the others.
+ * Returns CODECTK_OK if every item succeeded, else the first item error.
+ */
+codectk_err codectk_encode_batch(const codectk_codec *codec, const void *params,
+                                 codectk_batch_item *items, size_t count);
+codectk_err codectk_decode_batch(const codectk_codec *codec, const void *params,
+                                 codectk_batch_item *items, size_t count);
+
 /**
  * Convert error code to human-readable string.
  * Returns string description of error (never NULL).
@@ -0,0 +1,66 @@
+#pragma once
+#include "codectk.h"
+#include <stddef.h>
+
+/* Most threads an executor runs, the calling thread included */
+#define CODECTK_EXECUTOR_MAX_THREADS 64
+
+/**
+ * Task body: run task i on behalf of worker (0 <= worker < the executor's
+ * thread count). A worker runs one task at a time, so per-worker scratch
+ * indexed by worker needs no locking. Tasks must write disjoint outputs;
+ * the result is then independent of which worker ran what.
+ */
+typedef codectk_err (*codectk_task_fn)(void *ctx, size_t i, unsigned worker);
+
+typedef struct codectk_executor codectk_executor;
+
+/**
+ * Start an executor of threads threads (0 = one per online CPU), the
+ * thread calling codectk_executor_run() being one of them. The workers
+ * persist and sleep between runs.
+ *
+ * Returns CODECTK_EINVAL for more than CODECTK_EXECUTOR_MAX_THREADS,
+ * CODECTK_ENOMEM if the executor or its threads cannot be created.
+ */
+codectk_err codectk_executor_create(unsigned threads, codectk_executor **out);
+
+/**
+ * Stop the workers and free the executor. It must be idle. NULL is ignored.
+ */
+void codectk_executor_destroy(codectk_executor *ex);
+
+/* Threads of ex (1 for NULL): an upper bound for the worker argument */
+unsigned codectk_executor_threads(const codectk_executor *ex);
+
+/**
+ * Run fn(ctx, i, worker) for every i < n on up to max_threads threads of
+ * ex (0 = all of them) and return when all have finished.
+ *
+ * The tasks start out split into one contiguous range per participating
+ * thread. A thread takes tasks from the front of its own range; one that
+ * runs dry steals the back half of another's, so a few expensive tasks do
+ * not hold up the rest.
+ *
+ * Every task runs even if some fail. Returns the error of the lowest
+ * failing i, or CODECTK_OK. With ex == NULL, from inside a task, or while
+ * another thread is running ex, the tasks run in order on the calling
+ * thread as worker 0.
+ */
+codectk_err codectk_executor_run(codectk_executor *ex, size_t n, unsigned max_threads,
+                                 codectk_task_fn fn, void *ctx);
+
+/**
+ * Process-wide executor used by the codecs, created on first use with
+ * the configured thread count. NULL if it could not be created, in which
+ * case the codecs run serially.
+ */
+codectk_executor *codectk_executor_shared(void);
+
+/**
+ * Thread count of the shared executor (0 = one per online CPU, the
+ * default; 1 = codecs stay on the calling thread). Only effective before
+ * the shared executor is first used; returns CODECTK_EINVAL afterwards or
+ * for more than CODECTK_EXECUTOR_MAX_THREADS.
+ */
+codectk_err codectk_executor_configure_shared(unsigned threads);
@@ -22,14 +22,20 @@ typedef struct {
   size_t n_bytes;  /* allocated bytes (at least ceil(n_bits/8)) */
 } gf2_vec;
 
+/* Matrix rows are padded to a multiple of this many 64-bit words (one cache line) */
+#define GF2_MAT_ROW_ALIGN 8
+
 /**
- * Matrix over GF(2) stored in row-major order.
- * Each row is a gf2_vec of length n_cols.
+ * Matrix over GF(2) stored in row-major order in one contiguous,
+ * 64-byte-aligned block. Row r is the stride words from data + r * stride,
+ * bit c of the row being bit c % 64 of word c / 64. Bits at and above
+ * n_cols are zero.
  */
 typedef struct {
-  gf2_vec *rows;
+  uint64_t *data;
   size_t n_rows;
   size_t n_cols;
+  size_t stride;  /* words per row: ceil(n_cols / 64) rounded up to GF2_MAT_ROW_ALIGN */
 } gf2_mat;
 
 /* Vector operations */
@@ -112,13 +118,32 @@ void gf2_mat_free(gf2_mat *m);
 
 /**
  * Perform Gaussian elimination to row-reduce a matrix.
- * Operates in-place, returns rank.
+ * Operates in-place, returns rank; the result is in reduced row echelon
+ * form (each pivot is the only 1 in its column).
  *
- * This is a simple but correct implementation. For large matrices,
- * consider block-wise algorithms or Strassen-like methods.
+ * Uses the Method of Four Russians (M4RI): pivots are gathered a strip of
+ * columns at a time, and every other row is then cleared of the whole
+ * strip with one lookup into tables of pivot-row combinations, in passes
+ * tiled so that the tables stay in cache.
  */
 size_t gf2_mat_row_reduce(gf2_mat *m);
 
+/**
+ * gf2_mat_row_reduce() that also stores the pivot column of row i in
+ * pivot_cols[i] for i < rank. pivot_cols needs min(n_rows, n_cols) entries
+ * and may be NULL.
+ */
+size_t gf2_mat_row_reduce_pivots(gf2_mat *m, size_t *pivot_cols);
+
+/**
+ * Multiply matrices: c = a * b, with c initialized to a->n_rows x
+ * b->n_cols (and not aliasing a or b). Method of Four Russians: every
+ * 8 rows of b get a table of their 256 combinations, so each row of c
+ * takes one table row per 8 columns of a.
+ * Returns 0 on success, -1 on a dimension mismatch.
+ */
+int gf2_mat_mul(gf2_mat *c, const gf2_mat *a, const gf2_mat *b);
+
 /**
  * Multiply matrix by vector: result = m * v.
  * result must be initialized to n_rows bits.
@@ -126,19 +151,31 @@ size_t gf2_mat_row_reduce(gf2_mat *m);
  */
 void gf2_mat_mul_vec(gf2_vec *result, const gf2_mat *m, const gf2_vec *v);
 
+/**
+ * Words of row (no bounds check).
+ */
+static inline uint64_t *gf2_mat_row(const gf2_mat *m, size_t row) {
+  return m->data + row * m->stride;
+}
+
 /**
  * Get element at (row, col).
  * Returns 0 or 1.
  */
 static inline int gf2_mat_get(const gf2_mat *m, size_t row, size_t col) {
-  if (row >= m->n_rows) return 0;
-  return gf2_vec_get(&m->rows[row], col);
+  if (row >= m->n_rows || col >= m->n_cols) return 0;
+  return (int)((gf2_mat_row(m, row)[col / 64] >> (col % 64)) & 1);
 }
 
 /**
  * Set element at (row, col) to b (0 or 1).
  */
 static inline void gf2_mat_set(gf2_mat *m, size_t row, size_t col, int b) {
-  if (row >= m->n_rows) return;
-  gf2_vec_set(&m->rows[row], col, b);
+  if (row >= m->n_rows || col >= m->n_cols) return;
+  uint64_t *w = gf2_mat_row(m, row) + col / 64;
+  if (b) {
+    *w |= 1ULL << (col % 64);
+  } else {
+    *w &= ~(1ULL << (col % 64));
+  }
 }
@@ -6,24 +6,34 @@
  */
 
 #pragma once
+#include <stddef.h>
 #include <stdint.h>
 
 /**
  * GF(2^m) field context.
  * Contains precomputed log/antilog tables for efficient multiplication.
  *
- * The tables satisfy: alog[log[x]] = x for all nonzero x.
- * log[0] is undefined and must be guarded in all operations.
+ * The tables satisfy: alog[log[x]] = x for all nonzero x. alog is doubled
+ * (2 * (2^m - 1) entries), so alog[log[a] + log[b]] needs no reduction
+ * modulo the group order. log[0] is not a logarithm; it is 0 only so that
+ * unguarded reads such as gf2m_mul_fast() stay inside the tables.
  */
 typedef struct {
   unsigned m;           /* field extension degree (2 <= m <= 16) */
-  uint16_t *alog;       /* antilog table, size 2^m */
+  uint16_t *alog;       /* antilog table, size 2 * (2^m - 1) */
   uint16_t *log;        /* log table, size 2^m */
+  uint16_t *sqr;        /* squaring table, size 2^m (NULL without GF2M_TABLE_SQR) */
+  uint8_t *mul;         /* product table mul[(a << m) | b], m <= 8 only (or NULL) */
+  unsigned flags;       /* GF2M_TABLE_* tables that were built */
   uint16_t prim;        /* primitive element (generator) */
   uint16_t mod_poly;    /* irreducible polynomial for field construction */
   int owns_tables;      /* 1 if tables were allocated by init, 0 if static */
 } gf2m_ctx;
 
+/* Optional tables for gf2m_ctx_init_ex() */
+#define GF2M_TABLE_SQR 0x1u   /* squaring (Frobenius) table, 2^m entries */
+#define GF2M_TABLE_MUL 0x2u   /* full product table, 2^2m bytes; ignored for m > 8 */
+
 /**
  * Addition in GF(2^m) is just XOR (commutative and associative).
  */
@@ -37,6 +47,7 @@ static inline uint16_t gf2m_add(uint16_t a, uint16_t b) {
  * @param ctx        Context to initialize
  * @param m          Field extension degree (2 <= m <= 16)
  * @param mod_poly   Irreducible polynomial (e.g., 0x11b for AES field GF(2^8))
+ *                   The x^m term may be omitted; it is implicit for m = 16
  *                   Must be primitive for correct operation
  * @return 0 on success, -1 on failure (invalid params or allocation failure)
  *
@@ -44,12 +55,62 @@ static inline uint16_t gf2m_add(uint16_t a, uint16_t b) {
  */
 int gf2m_ctx_init(gf2m_ctx *ctx, unsigned m, uint16_t mod_poly);
 
+/**
+ * gf2m_ctx_init() with a choice of optional tables (GF2M_TABLE_* flags).
+ * gf2m_ctx_init() is gf2m_ctx_init_ex(ctx, m, mod_poly, GF2M_TABLE_SQR).
+ */
+int gf2m_ctx_init_ex(gf2m_ctx *ctx, unsigned m, uint16_t mod_poly, unsigned flags);
+
 /**
  * Free resources associated with a field context.
  * Safe to call multiple times or on uninitialized contexts.
  */
 void gf2m_ctx_free(gf2m_ctx *ctx);
 
+/**
+ * Default primitive polynomial for GF(2^m), without the x^m term, or 0 if
+ * m is out of range. This is the field the BCH codec works in.
+ */
+uint16_t gf2m_default_poly(unsigned m);
+
+/**
+ * Process-wide shared context for (m, mod_poly); mod_poly == 0 selects
+ * gf2m_default_poly(m). Built on first use (with GF2M_TABLE_SQR) and kept
+ * until exit, so repeated calls return the same pointer and all threads
+ * read one copy of the tables. Thread-safe. When the library is built with
+ * CODECTK_STATIC_GF_TABLES, default-polynomial fields come from tables
+ * compiled into the library and need no setup at all.
+ *
+ * Returns NULL for invalid parameters, a non-primitive mod_poly, or
+ * allocation failure. The context is read-only: never pass it to
+ * gf2m_ctx_free(). A struct copy with owns_tables = 0 shares the tables.
+ */
+const gf2m_ctx *gf2m_ctx_get(unsigned m, uint16_t mod_poly);
+
+/**
+ * Branch-free multiply: no division and no zero test, safe to inline in
+ * inner loops. The product of the doubled antilog lookup is masked to 0
+ * when either operand is 0.
+ */
+static inline uint16_t gf2m_mul_fast(const gf2m_ctx *ctx, uint16_t a, uint16_t b) {
+  uint16_t r = ctx->alog[(unsigned)ctx->log[a] + ctx->log[b]];
+  return (uint16_t)(r & (0u - (unsigned)((a != 0) & (b != 0))));
+}
+
+/**
+ * Multiply via the product table; requires GF2M_TABLE_MUL (m <= 8).
+ */
+static inline uint16_t gf2m_mul_tab(const gf2m_ctx *ctx, uint16_t a, uint16_t b) {
+  return ctx->mul[((unsigned)a << ctx->m) | b];
+}
+
+/**
+ * Square via the Frobenius table; requires GF2M_TABLE_SQR.
+ */
+static inline uint16_t gf2m_sqr_tab(const gf2m_ctx *ctx, uint16_t a) {
+  return ctx->sqr[a];
+}
+
 /* Core field operations (C fallback; can be swapped by ASM backend) */
 
 /**
@@ -68,8 +129,8 @@ uint16_t gf2m_inv(const gf2m_ctx *ctx, uint16_t a);
  * Square a field element.
  * Equivalent to gf2m_mul(ctx, a, a) but can be optimized.
  *
- * Optimization note: In characteristic 2, squaring is a linear operation
- * (Frobenius endomorphism). Can be implemented as table lookup for speed.
+ * In characteristic 2, squaring is a linear operation (Frobenius
+ * endomorphism); it is a table lookup when the context has GF2M_TABLE_SQR.
  */
 uint16_t gf2m_sqr(const gf2m_ctx *ctx, uint16_t a);
 
@@ -79,12 +140,90 @@ uint16_t gf2m_sqr(const gf2m_ctx *ctx, uint16_t a);
  */
 uint16_t gf2m_pow(const gf2m_ctx *ctx, uint16_t a, unsigned exp);
 
+/* Batch operations (dispatched through gf2m_backend) */
+
+/**
+ * dst[i] = c * src[i] for i < len. dst may alias src.
+ */
+void gf2m_mul_scalar(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *src,
+                     uint16_t c, size_t len);
+
+/**
+ * dst[i] ^= c * src[i] for i < len (multiply-accumulate).
+ */
+void gf2m_mac_scalar(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *src,
+                     uint16_t c, size_t len);
+
+/**
+ * dst[i] = a[i] * b[i] for i < len. dst may alias a or b.
+ */
+void gf2m_mul_vec(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *a,
+                  const uint16_t *b, size_t len);
+
+/**
+ * y[i] = p(x[i]) for i < npts, where p has coefficients coeff[0..deg]
+ * (coeff[0] is the constant term). deg < 0 gives the zero polynomial.
+ */
+void gf2m_poly_eval_multi(const gf2m_ctx *ctx, const uint16_t *coeff, int deg,
+                          const uint16_t *x, uint16_t *y, size_t npts);
+
+/**
+ * Carry-less product of two GF(2)[x] polynomials stored 64 coefficients
+ * per word, least significant first: dst[0..na+nb) = a[0..na) * b[0..nb).
+ * dst must not overlap a or b. This is the base case under poly_gf2_mul().
+ */
+void gf2m_clmul_words(uint64_t *dst, const uint64_t *a, size_t na,
+                      const uint64_t *b, size_t nb);
+
+/* C fallbacks, also used for the tails of the SIMD kernels */
+uint16_t gf2m_mul_c(const gf2m_ctx *ctx, uint16_t a, uint16_t b);
+uint16_t gf2m_inv_c(const gf2m_ctx *ctx, uint16_t a);
+uint16_t gf2m_sqr_c(const gf2m_ctx *ctx, uint16_t a);
+void gf2m_mul_scalar_c(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *src,
+                       uint16_t c, size_t len);
+void gf2m_mac_scalar_c(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *src,
+                       uint16_t c, size_t len);
+void gf2m_mul_vec_c(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *a,
+                    const uint16_t *b, size_t len);
+void gf2m_poly_eval_multi_c(const gf2m_ctx *ctx, const uint16_t *coeff, int deg,
+                            const uint16_t *x, uint16_t *y, size_t npts);
+void gf2m_clmul_words_c(uint64_t *dst, const uint64_t *a, size_t na,
+                        const uint64_t *b, size_t nb);
+
 /* Backend vtable for ASM acceleration */
 
 typedef struct {
   uint16_t (*mul)(const gf2m_ctx*, uint16_t, uint16_t);
   uint16_t (*inv)(const gf2m_ctx*, uint16_t);
   uint16_t (*sqr)(const gf2m_ctx*, uint16_t);
+  void (*mul_scalar)(const gf2m_ctx*, uint16_t*, const uint16_t*, uint16_t, size_t);
+  void (*mac_scalar)(const gf2m_ctx*, uint16_t*, const uint16_t*, uint16_t, size_t);
+  void (*mul_vec)(const gf2m_ctx*, uint16_t*, const uint16_t*, const uint16_t*, size_t);
+  void (*poly_eval_multi)(const gf2m_ctx*, const uint16_t*, int, const uint16_t*,
+                          uint16_t*, size_t);
+  void (*clmul_words)(uint64_t*, const uint64_t*, size_t, const uint64_t*, size_t);
+  const char *name;     /* e.g. "c", "avx2+pclmul" */
 } gf2m_vtbl;
 
 extern gf2m_vtbl gf2m_backend;
+
+/**
+ * Install a backend by name, or the best one the CPU supports when name is
+ * NULL (this is what happens at library load).
+ *
+ * Names: "c" (portable), "ssse3", "avx2" (x86 split-nibble pshufb kernels),
+ * "neon" (ARM64 split-nibble tbl kernels). The x86 and ARM64 backends also
+ * use PCLMULQDQ / PMULL for the elementwise kernels and gf2m_clmul_words()
+ * when available.
+ * Returns 0 on success, -1 if the backend is not supported on this CPU.
+ * Not thread-safe: call before other threads use the field operations.
+ */
+int gf2m_backend_select(const char *name);
+
+/*
+ * Per-architecture installers (src/gf2m_x86.c, src/gf2m_arm.c). Each fills
+ * the vectorized entries of vt for the named ISA, or the best supported one
+ * when name is NULL, and returns -1 if that ISA is unavailable.
+ */
+int gf2m_backend_x86(gf2m_vtbl *vt, const char *name);
+int gf2m_backend_arm(gf2m_vtbl *vt, const char *name);
@@ -0,0 +1,92 @@
+/**
+ * gf2m_bs.h - Bitsliced GF(2^m) arithmetic over 64 lanes
+ *
+ * A gf2m_bs holds one field element for each of 64 independent lanes as
+ * bit planes: bit w of p[i] is bit i of lane w's element. Operations are
+ * fixed sequences of AND and XOR over the planes, with no table lookups
+ * and no branches on the lane values, so their timing does not depend on
+ * the data. They are the arithmetic of the constant-time decoders
+ * (bch_ctx_decode_ct(), goppa_ctx_decode_ct_batch()), which decode one
+ * word per lane and so 64 words per pass.
+ *
+ * Planes m..15 are zero in every result and must be zero in the operands.
+ * Branches depend only on m and the field polynomial, and in
+ * gf2m_bs_mul_pub() on its explicitly public constant.
+ */
+
+#pragma once
+#include "gf2m.h"
+#include <stdint.h>
+
+#define GF2M_BS_LANES 64
+
+typedef struct {
+  uint64_t p[16];
+} gf2m_bs;
+
+/* c in every lane, without branching on c */
+static inline void gf2m_bs_set1(gf2m_bs *r, uint16_t c) {
+  for (unsigned i = 0; i < 16; i++) r->p[i] = 0 - (uint64_t)(((unsigned)c >> i) & 1u);
+}
+
+static inline void gf2m_bs_add(gf2m_bs *r, const gf2m_bs *a, const gf2m_bs *b) {
+  for (unsigned i = 0; i < 16; i++) r->p[i] = a->p[i] ^ b->p[i];
+}
+
+/* Lanes set in mask from a, the others from b */
+static inline void gf2m_bs_select(gf2m_bs *r, uint64_t mask, const gf2m_bs *a,
+                                  const gf2m_bs *b) {
+  for (unsigned i = 0; i < 16; i++) r->p[i] = (a->p[i] & mask) | (b->p[i] & ~mask);
+}
+
+/* Mask of the lanes whose element is nonzero */
+static inline uint64_t gf2m_bs_nonzero(const gf2m_bs *a) {
+  uint64_t any = 0;
+  for (unsigned i = 0; i < 16; i++) any |= a->p[i];
+  return any;
+}
+
+/* Set bits of x without the table __builtin_popcountll() may use */
+static inline uint32_t gf2m_bs_popcount64(uint64_t x) {
+  x -= (x >> 1) & 0x5555555555555555ULL;
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return (uint32_t)((x * 0x0101010101010101ULL) >> 56);
+}
+
+/**
+ * r = a * b lanewise. Schoolbook product of the planes, then reduction by
+ * the field polynomial. r may alias a or b.
+ */
+void gf2m_bs_mul(const gf2m_ctx *f, gf2m_bs *r, const gf2m_bs *a, const gf2m_bs *b);
+
+/**
+ * r = sum of a[k] * b[k] over k < count, lanewise. The products are added
+ * before the reduction, which is done once, so a dot product costs less
+ * than count calls of gf2m_bs_mul(). r may alias the inputs.
+ */
+void gf2m_bs_dot(const gf2m_ctx *f, gf2m_bs *r, const gf2m_bs *a, const gf2m_bs *b,
+                 size_t count);
+
+/* r = a^2 lanewise: spreading the planes is free, only the reduction costs */
+void gf2m_bs_sqr(const gf2m_ctx *f, gf2m_bs *r, const gf2m_bs *a);
+
+/**
+ * r = c * a lanewise for a constant c that is not secret: adds a * x^i for
+ * the set bits i of c, branching on them, so no product planes are kept
+ * and the cost follows the weight of c. For constants derived from secrets (e.g. a
+ * Goppa support element), broadcast with gf2m_bs_set1() and use
+ * gf2m_bs_mul() instead. r may alias a.
+ */
+void gf2m_bs_mul_pub(const gf2m_ctx *f, gf2m_bs *r, const gf2m_bs *a, uint16_t c);
+
+/**
+ * Transpose the 64 x 64 bit matrix a in place: bit j of a[i] swaps with
+ * bit i of a[j]. Turns one word per lane into one mask per bit position
+ * and back.
+ */
+void gf2m_bs_transpose64(uint64_t a[64]);
+
+/* Bitslice v[0..64) (lane w = v[w]), and back */
+void gf2m_bs_pack(gf2m_bs *r, const uint16_t v[GF2M_BS_LANES]);
+void gf2m_bs_unpack(const gf2m_bs *a, uint16_t v[GF2M_BS_LANES]);
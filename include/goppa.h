@@ -1,6 +1,55 @@
 #pragma once
 #include "codectk.h"
+#include "gf2.h"
+#include "gf2m.h"
 #include <stddef.h>
+
+/* Longest supported code: a support set can hold at most every field element */
+#define GOPPA_MAX_N 65536
+
+/**
+ * goppa_params.flags. GOPPA_FLAG_CT builds the tables of the constant-time
+ * decoder (goppa_ctx_decode_ct_batch(), mnt / 4 bytes more), and makes the
+ * codec's decode entry points use it.
+ */
+#define GOPPA_FLAG_CT 0x1u
+
+/**
+ * Precomputed Goppa state for one parameter set.
+ *
+ * Holds H in systematic form: the parity-check matrix is row reduced once
+ * at creation, and what encoding needs is the parity part of the
+ * generator. Decoding uses the syndrome column 1/(x - L_i) mod g and the
+ * powers of every support element (2nt bytes each) and the square root
+ * map mod g, which only exists for irreducible g. Read-only after
+ * goppa_ctx_create(), so safe to share between threads.
+ *
+ * Bit layout: a codeword is n bits, bit i belonging to support element
+ * L[i]. The reduction prefers the last r positions as parity, so a codeword
+ * is normally [message | parity] with k = n - r message bits. When those
+ * columns of H are dependent, pos lists the positions instead.
+ */
+typedef struct {
+  unsigned m;             /* field degree */
+  unsigned t;             /* deg g(x) */
+  size_t n;               /* code length |L| */
+  size_t r;               /* parity bits: rank of H, at most m*t */
+  size_t k;               /* message bits, n - r */
+  const gf2m_ctx *field;  /* shared GF(2^m) tables from gf2m_ctx_get() */
+  uint16_t *g;            /* copy of g(x), t + 1 coefficients */
+  uint16_t *L;            /* copy of the support set */
+  uint32_t *pos;          /* position of message bit i (i < k), parity bit
+                             i - k (i >= k); NULL for [message | parity] */
+  gf2_mat gen;            /* k x r: parity = message * gen */
+  uint16_t *syn;          /* n x t: row i is 1/(x - L_i) mod g */
+  uint16_t *pow;          /* t x n: row j - 1 is L_i^j over i, for root search */
+  uint16_t *sqrt_x;       /* (t + 1) / 2 x t: row i is x^i sqrt(x) mod g;
+                             NULL if g is reducible (no decoding) */
+  unsigned flags;         /* GOPPA_FLAG_* it was created with */
+  gf2_mat ct_h;           /* 2mt x n parity-check matrix of g^2: row jm + b
+                             is bit b of L_i^j / g(L_i)^2; GOPPA_FLAG_CT only */
+} goppa_ctx;
+
 typedef struct {
   unsigned m;           // GF(2^m)
   unsigned t;           // deg g
@@ -11,5 +60,120 @@ typedef struct {
   // field tables:
   const uint16_t *alog; // size 2^m
   const uint16_t *log;  // size 2^m
+  // field polynomial without x^m; 0 = gf2m_default_poly(m)
+  uint16_t mod_poly;
+  // precomputed context (optional); when set, encode and decode use it
+  // and the fields above must describe the same code
+  const goppa_ctx *ctx;
+  // GOPPA_FLAG_* options
+  unsigned flags;
 } goppa_params;
+
+/**
+ * Build a Goppa context: check P (deg g = t, distinct support elements
+ * that are not roots of g, n > m*t), build H and reduce it to systematic
+ * form. Returns CODECTK_EINVAL for unsupported or inconsistent
+ * parameters, CODECTK_ENOMEM on allocation failure.
+ */
+codectk_err goppa_ctx_create(const goppa_params *P, goppa_ctx **out);
+
+/**
+ * Free a context returned by goppa_ctx_create(). NULL is ignored.
+ */
+void goppa_ctx_destroy(goppa_ctx *ctx);
+
+/**
+ * Encode one message of at most k bits (zero-filled to k) into an n-bit
+ * codeword. *out_bits is the output capacity in bits on entry and n on
+ * return. Never allocates.
+ */
+codectk_err goppa_ctx_encode(const goppa_ctx *ctx, const uint8_t *in, size_t in_bits,
+                             uint8_t *out, size_t *out_bits);
+
+/**
+ * Encode count messages. Runs of messages are stacked into a matrix and
+ * multiplied by the generator at once (gf2_mat_mul()), which shares each
+ * generator table among the whole run. Each item gets its own err and
+ * out_bits, as from goppa_ctx_encode(); returns CODECTK_OK if every item
+ * encoded, else the first item error.
+ */
+codectk_err goppa_ctx_encode_batch(const goppa_ctx *ctx, codectk_batch_item *items,
+                                   size_t count);
+
+/**
+ * Decode one n-bit word (bit i belongs to L[i]) into its k message bits
+ * with Patterson's algorithm:
+ *
+ * 1. S(x) = sum of 1/(x - L_i) over the set bits, from ctx->syn
+ * 2. T = S^-1 mod g and tau = sqrt(T + x) mod g, from ctx->sqrt_x
+ * 3. Lattice step: Euclid on (g, tau) stopped halfway gives a = b tau
+ *    mod g with deg a <= t/2, deg b <= (t-1)/2
+ * 4. Error locator sigma = a^2 + x b^2, evaluated over the support in
+ *    blocks from ctx->pow until its deg sigma roots are found
+ *
+ * Up to t errors are corrected. A word with more is passed through
+ * uncorrected and the call returns CODECTK_EDECODE. *out_bits is the
+ * output capacity in bits on entry and k on return. Returns
+ * CODECTK_ENOTSUP if g is reducible.
+ */
+codectk_err goppa_ctx_decode(const goppa_ctx *ctx, const uint8_t *in, size_t in_bits,
+                             uint8_t *out, size_t *out_bits, size_t *num_corrected);
+
+/**
+ * Bytes of decode scratch needed by goppa_ctx_decode_ws(); depends only
+ * on t and n.
+ */
+size_t goppa_ctx_workspace_size(const goppa_ctx *ctx);
+
+/**
+ * goppa_ctx_decode() using caller-provided scratch of at least
+ * goppa_ctx_workspace_size() bytes (any alignment), so that decoding
+ * never allocates; each thread needs its own workspace. With workspace ==
+ * NULL the scratch is allocated once for the call.
+ */
+codectk_err goppa_ctx_decode_ws(const goppa_ctx *ctx, const uint8_t *in, size_t in_bits,
+                                uint8_t *out, size_t *out_bits, size_t *num_corrected,
+                                void *workspace, size_t workspace_size);
+
+/**
+ * Bytes of decode scratch needed by goppa_decode_ws() for P, the same as
+ * goppa_ctx_workspace_size() of its context. Returns 0 for invalid
+ * parameters.
+ */
+size_t goppa_workspace_size(const goppa_params *P);
+
+/**
+ * goppa_ctx_decode_ws() on P->ctx. Without a context one is built for the
+ * call, which allocates; set P->ctx to decode many words.
+ */
+codectk_err goppa_decode_ws(const goppa_params *P, const uint8_t *in, size_t in_bits,
+                            uint8_t *out, size_t *out_bits, size_t *num_corrected,
+                            void *workspace, size_t workspace_size);
+
+/**
+ * Constant-time decode of count n-bit words, each into its k message bits
+ * as from goppa_ctx_decode(). Requires a context created with
+ * GOPPA_FLAG_CT (else CODECTK_ENOTSUP).
+ *
+ * Words are decoded 64 at a time, one per lane of bitsliced GF(2^m)
+ * arithmetic (gf2m_bs.h), and every pass runs the same fixed schedule:
+ *
+ * 1. 2t syndromes of the code as defined by g^2, which for squarefree g is
+ *    the same code: s_j = sum of r_i L_i^j / g(L_i)^2, as parities of the
+ *    received words against the rows of ct_h
+ * 2. Inversion-free Berlekamp-Massey, 2t steps over all t + 1
+ *    coefficients with the length updates as masked selects
+ * 3. The reversed locator evaluated at every support element
+ * 4. The correction applied under a mask of the lanes whose error count
+ *    matches the locator length and whose errors give back the syndromes
+ *
+ * No branch, loop bound or memory address depends on the received words
+ * or on g and L, only on the parameters. Creating the context is not
+ * constant time. Passes run on the shared executor. Each item gets its own
+ * err, out_bits and num_corrected; returns CODECTK_OK if every item
+ * decoded, else the first item error.
+ */
+codectk_err goppa_ctx_decode_ct_batch(const goppa_ctx *ctx, codectk_batch_item *items,
+                                      size_t count);
+
 const codectk_codec* goppa_codec(void);
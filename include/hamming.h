@@ -5,5 +5,9 @@
 
 #pragma once
 #include "codectk.h"
-typedef struct { unsigned m; } hamming_params;
+
+// largest m: a codeword (2^m - 1 bits) must fit in a 64-bit word
+#define HAMMING_MAX_M 6
+
+typedef struct { unsigned m; } hamming_params; // 2 <= m <= HAMMING_MAX_M
 const codectk_codec* hamming_codec(void);
@@ -0,0 +1,80 @@
+/**
+ * handle.h - Codec instances that keep their state between calls
+ *
+ * codectk_open() looks a codec up by name, checks its parameters once and
+ * builds what the codec would otherwise build on every call: the BCH or
+ * Goppa context with its tables, and the decode workspace. The handle
+ * then codes one stream of any length, fed in chunks of any size with
+ * codectk_process(), and the CODECTK_FLUSH call ends the stream.
+ *
+ * The block codecs code whole units of 8 codewords as they arrive, a whole
+ * number of bytes on both sides, and hold back a partial unit for the next
+ * call. The output is the same as one encode or decode call over the
+ * whole stream:
+ *
+ *   hamming  hamming_params  k-bit blocks to n-bit codewords
+ *   bch      bch_params      codewords of bch_ctx_encode(), pad as given;
+ *                            params.ctx, when set, is borrowed
+ *   bch-M-T  bch_params      a fixed codec (bch_fixed_codec()); params may
+ *                            be NULL
+ *   goppa    goppa_params    back-to-back n-bit codewords, the last message
+ *                            zero-filled to k bits; decode ignores a
+ *                            trailing partial codeword. params.ctx, when
+ *                            set, is borrowed, otherwise L and g are only
+ *                            read by codectk_open()
+ *
+ * Huffman codes the stream as a whole, so its handle buffers the input
+ * and produces all of the output on the flush.
+ *
+ * A handle is used by one thread at a time; handles do not share state.
+ */
+
+#pragma once
+#include "codectk.h"
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+  CODECTK_ENCODE = 0,
+  CODECTK_DECODE
+} codectk_direction;
+
+/* codectk_process() flags: the chunk is the last of the stream */
+#define CODECTK_FLUSH 0x1u
+
+typedef struct codectk_handle codectk_handle;
+
+/**
+ * Open an encoder or decoder for the codec called name (see codectk_get()).
+ * params point to the codec's parameter struct and are copied; Huffman
+ * takes NULL for one HUF2 stream.
+ *
+ * Returns CODECTK_EINVAL for an unknown codec or invalid parameters,
+ * CODECTK_ENOTSUP for a Goppa decoder whose g(x) is reducible,
+ * CODECTK_ENOMEM on allocation failure.
+ */
+codectk_err codectk_open(const char *name, const void *params, codectk_direction dir,
+                         codectk_handle **out);
+
+/**
+ * Feed in_bits bits of the stream. Without CODECTK_FLUSH in_bits must be a
+ * multiple of 8; the final chunk may end anywhere. *out and *out_bits get
+ * the output this call produced, in a buffer of the handle that stays valid
+ * until its next call. After CODECTK_FLUSH the handle starts a new stream.
+ *
+ * A codeword that cannot be corrected is passed through as the codec does,
+ * and the call returns CODECTK_EDECODE after coding the rest of the chunk.
+ * CODECTK_ENOMEM leaves the stream where it was, so the call can be
+ * repeated; any other error ends the stream.
+ */
+codectk_err codectk_process(codectk_handle *h, const uint8_t *in, size_t in_bits,
+                            unsigned flags, const uint8_t **out, size_t *out_bits);
+
+/* Errors corrected by a decoder since it was opened */
+size_t codectk_corrected(const codectk_handle *h);
+
+/**
+ * Free a handle from codectk_open(), its contexts and buffers. NULL is
+ * ignored.
+ */
+void codectk_close(codectk_handle *h);
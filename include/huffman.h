@@ -1,4 +1,40 @@
 #pragma once
 #include "codectk.h"
-typedef struct { int dummy; } huffman_params;
+#include <stddef.h>
+
+/* Suggested HUFB block size: large enough that the tables are noise */
+#define HUFFMAN_DEFAULT_BLOCK (256u * 1024u)
+
+/* Smallest HUFB block size the encoder takes */
+#define HUFFMAN_MIN_BLOCK 1024u
+
+typedef struct {
+  // 0: one HUF2 stream; otherwise split the input into independent HUFB
+  // blocks of this many bytes (HUFFMAN_MIN_BLOCK to 4 GiB), coded and
+  // decoded in parallel
+  size_t block_size;
+  // most threads of the shared executor (executor.h) used for HUFB
+  //  encode/decode, 0 = all of them
+  unsigned threads;
+  // bitstreams per HUFB block: 0 or 1, or 4 to split each block into
+  // quarters whose decoders run interleaved (implies HUFB; the default
+  // block size applies when block_size is 0)
+  unsigned streams;
+} huffman_params;
+
 const codectk_codec* huffman_codec(void);
+
+/**
+ * Number of blocks in a HUFB stream, and the decoded bytes per block (the
+ * last block may be shorter). block_size may be NULL.
+ */
+codectk_err huffman_block_info(const uint8_t *in, size_t in_bits,
+                               size_t *nblocks, size_t *block_size);
+
+/**
+ * Decode block index of a HUFB stream on its own, e.g. to start reading in
+ * the middle of a large file. *out_bits is the capacity on entry and the
+ * decoded length on return.
+ */
+codectk_err huffman_decode_block(const uint8_t *in, size_t in_bits, size_t index,
+                                 uint8_t *out, size_t *out_bits);
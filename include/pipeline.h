@@ -0,0 +1,69 @@
+#pragma once
+#include "codectk.h"
+#include <stddef.h>
+
+/* Longest chain accepted by codectk_pipeline_create() */
+#define CODECTK_PIPELINE_MAX_STAGES 8
+
+/* Default tile: small enough that a tile and its intermediates stay in L2 */
+#define CODECTK_PIPELINE_DEFAULT_TILE (64u * 1024u)
+
+/**
+ * Execution mode.
+ *
+ * CODECTK_PIPELINE_FUSED: one thread runs every stage over a tile before
+ *   starting the next, so intermediates never leave the cache.
+ * CODECTK_PIPELINE_THREADED: one thread per stage, handing tiles on through
+ *   single-producer/single-consumer rings, so the stages overlap.
+ */
+typedef enum {
+  CODECTK_PIPELINE_FUSED = 0,
+  CODECTK_PIPELINE_THREADED
+} codectk_pipeline_mode;
+
+/* One stage: a codec and its parameters (borrowed, must outlive the pipeline) */
+typedef struct {
+  const codectk_codec *codec;
+  const void *params;
+} codectk_stage;
+
+typedef struct codectk_pipeline codectk_pipeline;
+
+/**
+ * Build a pipeline that encodes through stages[0], stages[1], ... in turn
+ * and decodes in the reverse order. The input is cut into tiles of
+ * tile_bytes (0 = CODECTK_PIPELINE_DEFAULT_TILE) that are coded
+ * independently; the tile buffers are allocated here, grow only when a
+ * stage needs more room, and are reused by every call.
+ *
+ * Returns CODECTK_EINVAL for an empty or too long chain, CODECTK_ENOMEM on
+ * allocation failure. A pipeline may be used by one thread at a time.
+ */
+codectk_err codectk_pipeline_create(const codectk_stage *stages, size_t nstages,
+                                    size_t tile_bytes, codectk_pipeline_mode mode,
+                                    codectk_pipeline **out);
+
+/**
+ * Free a pipeline returned by codectk_pipeline_create(). NULL is ignored.
+ */
+void codectk_pipeline_destroy(codectk_pipeline *p);
+
+/**
+ * Run the chain over in. Each tile is written as (nstages + 1) LE32 bit
+ * counts, the input of every stage and the final output, followed by the
+ * coded bits; tiles are byte aligned. *out_bits is the capacity on entry
+ * and the encoded length on return.
+ */
+codectk_err codectk_pipeline_encode(codectk_pipeline *p,
+                                    const uint8_t *in, size_t in_bits,
+                                    uint8_t *out, size_t *out_bits);
+
+/**
+ * Undo codectk_pipeline_encode(). A tile that fails to decode is
+ * zero-filled and the call returns its error after decoding the rest;
+ * *num_corrected (optional) is the total over all stages and tiles.
+ */
+codectk_err codectk_pipeline_decode(codectk_pipeline *p,
+                                    const uint8_t *in, size_t in_bits,
+                                    uint8_t *out, size_t *out_bits,
+                                    size_t *num_corrected);
@@ -6,9 +6,18 @@
  * - poly_gf2m_t: Polynomials with GF(2^m) coefficients
  *
  * Used in BCH and Goppa code construction and decoding.
+ *
+ * Storage and scratch can come from a codectk_arena: the *_init_ws()
+ * functions place the coefficients in the arena, and the *_ws() variants
+ * of gcd, mod and inv_mod draw their temporaries from it and release them
+ * before returning. poly_*_scratch_size() gives the arena bytes for a
+ * number of polynomials; each *_ws() function documents how many it needs.
+ * Whatever does not fit falls back to the heap, so a short arena costs
+ * speed, never correctness.
  */
 
 #pragma once
+#include "arena.h"
 #include "gf2m.h"
 #include <stdint.h>
 #include <stddef.h>
@@ -28,6 +37,7 @@ typedef struct {
   uint64_t *coeff;  /* bit-packed coefficients: each uint64_t holds 64 coeffs */
   int deg;          /* degree (-1 for zero polynomial) */
   int capacity;     /* allocated capacity in bits */
+  int borrowed;     /* coeff is arena or caller storage: free only detaches */
 } poly_gf2_t;
 
 /**
@@ -37,7 +47,17 @@ typedef struct {
 int poly_gf2_init(poly_gf2_t *p, int capacity);
 
 /**
- * Free resources associated with polynomial.
+ * poly_gf2_init() with the coefficients taken from ws when it has room
+ * (ws may be NULL). Returns 0 on success, -1 on failure.
+ */
+int poly_gf2_init_ws(poly_gf2_t *p, int capacity, codectk_arena *ws);
+
+/* Arena bytes for count polynomials of the given capacity */
+size_t poly_gf2_scratch_size(int count, int capacity);
+
+/**
+ * Free resources associated with polynomial. Arena storage is not
+ * returned; it goes back with the arena mark it was allocated under.
  */
 void poly_gf2_free(poly_gf2_t *p);
 
@@ -63,16 +83,28 @@ int poly_gf2_get_coeff(const poly_gf2_t *p, int i);
 void poly_gf2_copy(poly_gf2_t *dst, const poly_gf2_t *src);
 
 /**
- * Add (XOR) two polynomials: result = a + b.
+ * Add (XOR) two polynomials: result = a + b. result may alias a or b.
  */
 void poly_gf2_add(poly_gf2_t *result, const poly_gf2_t *a, const poly_gf2_t *b);
 
 /**
- * Multiply two polynomials: result = a * b.
- * Simple schoolbook multiplication. For large degrees, consider Karatsuba or FFT.
+ * Multiply two polynomials: result = a * b, truncated to result's
+ * capacity; result must not alias a or b. Karatsuba over a word-level
+ * carry-less multiply (gf2m_clmul_words()). Temporaries come from the heap.
  */
 void poly_gf2_mul(poly_gf2_t *result, const poly_gf2_t *a, const poly_gf2_t *b);
 
+/**
+ * poly_gf2_mul() with its temporaries from ws: poly_gf2_mul_scratch_size()
+ * of the operands' capacities. Returns 0 on success, -1 if the temporaries
+ * could not be allocated (result is then zero).
+ */
+int poly_gf2_mul_ws(poly_gf2_t *result, const poly_gf2_t *a, const poly_gf2_t *b,
+                    codectk_arena *ws);
+
+/* Arena bytes poly_gf2_mul_ws() takes for operands of these capacities */
+size_t poly_gf2_mul_scratch_size(int a_capacity, int b_capacity);
+
 /**
  * Divide polynomials with remainder: a = q * b + r.
  * Returns 0 on success, -1 if b is zero.
@@ -80,10 +112,44 @@ void poly_gf2_mul(poly_gf2_t *result, const poly_gf2_t *a, const poly_gf2_t *b);
 int poly_gf2_div_rem(poly_gf2_t *q, poly_gf2_t *r, const poly_gf2_t *a, const poly_gf2_t *b);
 
 /**
- * Compute GCD of two polynomials using Euclidean algorithm.
+ * Compute GCD of two polynomials using Euclidean algorithm. When a is much
+ * longer than b, the first step reduces a mod b with Barrett.
  */
 void poly_gf2_gcd(poly_gf2_t *result, const poly_gf2_t *a, const poly_gf2_t *b);
 
+/*
+ * poly_gf2_gcd() with scratch for 4 polynomials of the larger capacity
+ * from ws (plus the Barrett scratch when that step runs)
+ */
+void poly_gf2_gcd_ws(poly_gf2_t *result, const poly_gf2_t *a, const poly_gf2_t *b,
+                     codectk_arena *ws);
+
+/**
+ * Precomputed reduction by a fixed modulus m for inputs of degree at most
+ * max_deg: mu = floor(x^max_deg / m) turns each reduction into two
+ * multiplications. Pays off when many polynomials are reduced by the same
+ * m, or one much longer than m.
+ */
+typedef struct {
+  poly_gf2_t m;   /* copy of the modulus */
+  poly_gf2_t mu;  /* floor(x^max_deg / m) */
+  int max_deg;    /* largest input degree */
+} poly_gf2_barrett;
+
+/* Returns 0 on success, -1 if m is zero or allocation fails */
+int poly_gf2_barrett_init(poly_gf2_barrett *br, const poly_gf2_t *m, int max_deg);
+void poly_gf2_barrett_free(poly_gf2_barrett *br);
+
+/* Arena bytes poly_gf2_mod_barrett() takes */
+size_t poly_gf2_barrett_scratch_size(const poly_gf2_barrett *br);
+
+/**
+ * result = a mod br->m, temporaries from ws (may be NULL). Returns 0 on
+ * success, -1 if deg a exceeds br->max_deg or allocation fails.
+ */
+int poly_gf2_mod_barrett(poly_gf2_t *result, const poly_gf2_t *a,
+                         const poly_gf2_barrett *br, codectk_arena *ws);
+
 /*
  * ============================================================================
  * Polynomials over GF(2^m) - Field element coefficients
@@ -99,6 +165,7 @@ typedef struct {
   int deg;            /* degree (-1 for zero polynomial) */
   int capacity;       /* allocated capacity */
   const gf2m_ctx *ctx; /* field context (borrowed reference) */
+  int borrowed;       /* coeff is arena or caller storage: free only detaches */
 } poly_gf2m_t;
 
 /**
@@ -109,7 +176,18 @@ typedef struct {
 int poly_gf2m_init(poly_gf2m_t *p, const gf2m_ctx *ctx, int capacity);
 
 /**
- * Free resources associated with polynomial.
+ * poly_gf2m_init() with the coefficients taken from ws when it has room
+ * (ws may be NULL). Returns 0 on success, -1 on failure.
+ */
+int poly_gf2m_init_ws(poly_gf2m_t *p, const gf2m_ctx *ctx, int capacity,
+                      codectk_arena *ws);
+
+/* Arena bytes for count polynomials of the given capacity */
+size_t poly_gf2m_scratch_size(int count, int capacity);
+
+/**
+ * Free resources associated with polynomial. Arena storage is not
+ * returned; it goes back with the arena mark it was allocated under.
  */
 void poly_gf2m_free(poly_gf2m_t *p);
 
@@ -157,11 +235,22 @@ int poly_gf2m_div_rem(poly_gf2m_t *q, poly_gf2m_t *r,
  */
 int poly_gf2m_mod(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m_t *m);
 
+/* poly_gf2m_mod() with scratch for 2 polynomials of a->capacity from ws */
+int poly_gf2m_mod_ws(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m_t *m,
+                     codectk_arena *ws);
+
 /**
  * Compute GCD of two polynomials using Euclidean algorithm.
  */
 void poly_gf2m_gcd(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m_t *b);
 
+/**
+ * poly_gf2m_gcd() with scratch for 4 polynomials of the larger of
+ * a->capacity and b->capacity from ws.
+ */
+void poly_gf2m_gcd_ws(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m_t *b,
+                      codectk_arena *ws);
+
 /**
  * Evaluate polynomial at a point x in the field.
  * Uses Horner's method for efficiency.
@@ -180,3 +269,10 @@ void poly_gf2m_deriv(poly_gf2m_t *result, const poly_gf2m_t *p);
  * Returns 0 on success, -1 if a and m are not coprime.
  */
 int poly_gf2m_inv_mod(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m_t *m);
+
+/**
+ * poly_gf2m_inv_mod() with scratch from ws: 8 polynomials of capacity
+ * max(a->capacity, 2 * m->capacity).
+ */
+int poly_gf2m_inv_mod_ws(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m_t *m,
+                         codectk_arena *ws);
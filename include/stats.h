@@ -0,0 +1,111 @@
+/**
+ * stats.h - Optional decode counters and per-stage timers
+ *
+ * With -DCODECTK_STATS=ON the decoders count codewords, corrections and
+ * failures and time their stages (field and table setup, syndromes, the
+ * key equation, root search, bit I/O) with the x86 time stamp counter, or
+ * the monotonic clock in nanoseconds elsewhere. Every thread, the
+ * executor's workers included, records into its own block, so recording
+ * takes no lock and shares no cache line; the getters read the blocks
+ * while they are being written, so a snapshot is consistent per counter
+ * but not across counters. Without the option the hooks compile to
+ * nothing and the getters return CODECTK_ENOTSUP.
+ *
+ * Recording branches on and indexes by the number of errors, so a build
+ * with the option is not constant time even with BCH_FLAG_CT or
+ * GOPPA_FLAG_CT; keep it to builds used for measurement.
+ *
+ * Codewords are the decoders' units: Hamming, BCH and Goppa codewords, and
+ * Huffman payloads (one per HUF2 stream or HUFB block). calls counts the
+ * decode and decode_batch entry points of the codec interface.
+ */
+
+#pragma once
+#include "codectk.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef enum {
+  CODECTK_STATS_HAMMING = 0,
+  CODECTK_STATS_BCH,
+  CODECTK_STATS_GOPPA,
+  CODECTK_STATS_HUFFMAN,
+  CODECTK_STATS_CODECS
+} codectk_stats_codec;
+
+typedef enum {
+  CODECTK_STAGE_SETUP = 0,     /* field, context and decode table construction */
+  CODECTK_STAGE_SYNDROME,      /* syndromes (Hamming: the whole lookup/correct loop) */
+  CODECTK_STAGE_KEY_EQUATION,  /* Berlekamp-Massey, Patterson */
+  CODECTK_STAGE_ROOTS,         /* Chien search, Goppa root search */
+  CODECTK_STAGE_BITIO,         /* word loads and stores, Huffman symbol decoding */
+  CODECTK_STAGES
+} codectk_stats_stage;
+
+/* Histogram buckets: 0 .. CODECTK_STATS_HIST - 2 corrections, then "more" */
+#define CODECTK_STATS_HIST 33
+
+typedef struct {
+  uint64_t calls;
+  uint64_t codewords;                     /* decoded, failures included */
+  uint64_t failures;                      /* beyond correction, or undecodable */
+  uint64_t corrections[CODECTK_STATS_HIST]; /* successful codewords by errors fixed */
+  uint64_t ticks[CODECTK_STAGES];         /* time in each stage */
+  uint64_t spans[CODECTK_STAGES];         /* timed spans of each stage */
+} codectk_codec_stats;
+
+typedef struct {
+  codectk_codec_stats codec[CODECTK_STATS_CODECS];
+  double ns_per_tick;                     /* calibrated against the monotonic clock */
+} codectk_stats;
+
+/* 1 if the library was built with CODECTK_STATS, else 0 */
+int codectk_stats_enabled(void);
+
+/* Counters of the calling thread only */
+codectk_err codectk_stats_thread(codectk_stats *out);
+
+/* Sum over every thread, including threads that have exited */
+codectk_err codectk_stats_total(codectk_stats *out);
+
+/**
+ * Zero the counters of every thread. Updates racing with the reset may
+ * survive it, so reset between decodes for exact figures.
+ */
+void codectk_stats_reset(void);
+
+/* Human-readable report of the codecs that decoded anything */
+void codectk_stats_print(FILE *f, const codectk_stats *s);
+
+/* Stage and codec names, as used by codectk_stats_print() */
+const char *codectk_stats_codec_name(codectk_stats_codec c);
+const char *codectk_stats_stage_name(codectk_stats_stage s);
+
+/*
+ * Hooks for the decoders. CODECTK_STATS_T0 declares a start time,
+ * CODECTK_STATS_STAGE adds the time since it to a stage and RESTART sets
+ * it to the current time again; WORDS records n codewords with corr
+ * corrections each, FAILURES n that failed.
+ */
+#ifdef CODECTK_STATS
+uint64_t codectk_stats_ticks(void);
+void codectk_stats_time(codectk_stats_codec c, codectk_stats_stage s, uint64_t t0);
+void codectk_stats_words(codectk_stats_codec c, size_t corr, size_t n);
+void codectk_stats_failures(codectk_stats_codec c, size_t n);
+void codectk_stats_call(codectk_stats_codec c);
+
+#define CODECTK_STATS_T0(v) uint64_t v = codectk_stats_ticks()
+#define CODECTK_STATS_STAGE(c, s, t0) codectk_stats_time(CODECTK_STATS_##c, CODECTK_STAGE_##s, t0)
+#define CODECTK_STATS_RESTART(v) ((v) = codectk_stats_ticks())
+#define CODECTK_STATS_WORDS(c, corr, n) codectk_stats_words(CODECTK_STATS_##c, corr, n)
+#define CODECTK_STATS_FAILURES(c, n) codectk_stats_failures(CODECTK_STATS_##c, n)
+#define CODECTK_STATS_CALL(c) codectk_stats_call(CODECTK_STATS_##c)
+#else
+#define CODECTK_STATS_T0(v) ((void)0)
+#define CODECTK_STATS_STAGE(c, s, t0) ((void)0)
+#define CODECTK_STATS_RESTART(v) ((void)0)
+#define CODECTK_STATS_WORDS(c, corr, n) ((void)0)
+#define CODECTK_STATS_FAILURES(c, n) ((void)0)
+#define CODECTK_STATS_CALL(c) ((void)0)
+#endif
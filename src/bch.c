@@ -4,18 +4,33 @@
  * Implements BCH codes over GF(2) with t-error correction capability.
  * Uses:
  * - Generator polynomial from minimal polynomials
- * - Systematic encoding via polynomial division
+ * - Systematic encoding via a table-driven (slicing-by-8) LFSR
  * - Berlekamp-Massey algorithm for decoding
- * - Chien search for error location
+ * - Incremental, SIMD-evaluated Chien search for error location
  */
 
 #include "../include/bch.h"
+#include "../include/executor.h"
 #include "../include/gf2m.h"
+#include "../include/gf2m_bs.h"
 #include "../include/poly.h"
+#include "../include/stats.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define BCH_CHIEN_X86 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BCH_CHIEN_NEON 1
+#endif
+
+#if defined(BCH_CHIEN_X86) || defined(BCH_CHIEN_NEON)
+#define BCH_CHIEN_SIMD 1
+#endif
+
 /**
  * Compute the minimal polynomial of α^i over GF(2).
  * The minimal polynomial is the smallest monic polynomial m(x) such that m(α^i) = 0.
@@ -24,84 +39,103 @@
  * where k is the smallest integer such that β^(2^(k+1)) = β.
  *
  * This is the polynomial: m(x) = (x - β)(x - β^2)(x - β^4)...(x - β^(2^k))
+ * The conjugates form the cyclotomic coset of i, so the walk stops when
+ * the exponent comes back to i; each factor is multiplied in in place.
  */
 static void compute_minimal_poly(poly_gf2m_t *result, const gf2m_ctx *ctx, int i) {
-  unsigned m = ctx->m;
-  unsigned order = (1U << m) - 1;
-
-  /* Track which conjugates we've seen */
-  uint8_t *seen = (uint8_t*)calloc(order + 1, sizeof(uint8_t));
-  if (!seen) return;
+  unsigned order = (1U << ctx->m) - 1;
 
   /* Start with m(x) = 1 */
   poly_gf2m_zero(result);
   poly_gf2m_set_coeff(result, 0, 1);
 
-  /* Current element to process */
-  unsigned current = (unsigned)i % order;
-
-  while (!seen[current]) {
-    seen[current] = 1;
+  unsigned start = (unsigned)i % order;
+  unsigned current = start;
 
-    /* Multiply m(x) by (x - α^current) */
-    /* We need to multiply: result(x) * (x - β) where β = α^current */
-    poly_gf2m_t factor, temp;
-    poly_gf2m_init(&factor, ctx, 2);
-    poly_gf2m_init(&temp, ctx, result->deg + 2);
+  do {
+    /* m(x) = m(x) * (x - β) with β = α^current, from the top down */
+    int d = result->deg;
+    if (d + 1 >= result->capacity) return;
 
-    /* factor = x - β = x + β (in GF(2^m), - is +) */
     uint16_t beta = ctx->alog[current];
-    poly_gf2m_set_coeff(&factor, 0, beta);  /* constant term */
-    poly_gf2m_set_coeff(&factor, 1, 1);     /* x term */
-
-    /* temp = result * factor */
-    poly_gf2m_mul(&temp, result, &factor);
-    poly_gf2m_copy(result, &temp);
-
-    poly_gf2m_free(&factor);
-    poly_gf2m_free(&temp);
+    uint16_t *c = result->coeff;
+    c[d + 1] = c[d];
+    for (int j = d; j > 0; j--) {
+      c[j] = gf2m_add(c[j - 1], gf2m_mul(ctx, c[j], beta));
+    }
+    c[0] = gf2m_mul(ctx, c[0], beta);
+    result->deg = d + 1;
 
     /* Next conjugate is current * 2 (mod order) */
     current = (current * 2) % order;
-    if (current == 0) current = order;  /* Avoid 0, wrap to order */
-  }
-
-  free(seen);
+  } while (current != start);
 }
 
 /**
  * Compute LCM of two polynomials: lcm(a, b) = (a * b) / gcd(a, b)
+ * The minimal polynomials and g(x) are binary, so this runs on word-packed
+ * GF(2) polynomials. Temporaries come from ws.
  */
-static void poly_gf2m_lcm(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m_t *b) {
+static void poly_gf2_lcm(poly_gf2_t *result, const poly_gf2_t *a, const poly_gf2_t *b,
+                         codectk_arena *ws) {
   if (a->deg < 0 || b->deg < 0) {
-    poly_gf2m_zero(result);
+    poly_gf2_zero(result);
     return;
   }
 
   /* Compute gcd(a, b) */
-  poly_gf2m_t gcd_poly, product, quotient, remainder;
-  poly_gf2m_init(&gcd_poly, a->ctx, a->deg + b->deg + 1);
-  poly_gf2m_init(&product, a->ctx, a->deg + b->deg + 1);
-  poly_gf2m_init(&quotient, a->ctx, a->deg + b->deg + 1);
-  poly_gf2m_init(&remainder, a->ctx, a->deg + b->deg + 1);
+  size_t mark = codectk_arena_mark(ws);
+  int cap = a->deg + b->deg + 1;
+  poly_gf2_t gcd_poly, product, quotient, remainder;
+  poly_gf2_init_ws(&gcd_poly, cap, ws);
+  poly_gf2_init_ws(&product, cap, ws);
+  poly_gf2_init_ws(&quotient, cap, ws);
+  poly_gf2_init_ws(&remainder, cap, ws);
 
-  poly_gf2m_gcd(&gcd_poly, a, b);
+  poly_gf2_gcd_ws(&gcd_poly, a, b, ws);
 
   /* Compute a * b */
-  poly_gf2m_mul(&product, a, b);
+  poly_gf2_mul_ws(&product, a, b, ws);
 
   /* Divide by gcd */
   if (gcd_poly.deg >= 0) {
-    poly_gf2m_div_rem(&quotient, &remainder, &product, &gcd_poly);
-    poly_gf2m_copy(result, &quotient);
+    poly_gf2_div_rem(&quotient, &remainder, &product, &gcd_poly);
+    poly_gf2_copy(result, &quotient);
   } else {
-    poly_gf2m_zero(result);
+    poly_gf2_zero(result);
+  }
+
+  poly_gf2_free(&gcd_poly);
+  poly_gf2_free(&product);
+  poly_gf2_free(&quotient);
+  poly_gf2_free(&remainder);
+  codectk_arena_release(ws, mark);
+}
+
+/* Arena bytes build_generator() uses, for polynomials up to deg g = m*t */
+static size_t generator_scratch_size(unsigned m, unsigned t) {
+  /* The GF(2^m) minimal poly, then m_i and new_g; the lcm's 4 temporaries,
+   * the gcd's 4 below them and the product's scratch */
+  int cap = (int)(m * t + m) + 1;
+  return poly_gf2m_scratch_size(1, (int)m + 1) + poly_gf2_scratch_size(10, cap) +
+         poly_gf2_mul_scratch_size(cap, (int)m + 1) + CODECTK_ARENA_ALIGN;
+}
+
+/* m_i(x) over GF(2^m) has coefficients in {0, 1}: pack it into a GF(2) poly */
+static void minimal_poly_gf2(poly_gf2_t *result, const gf2m_ctx *ctx, int i,
+                             codectk_arena *ws) {
+  size_t mark = codectk_arena_mark(ws);
+  poly_gf2m_t mp;
+  poly_gf2m_init_ws(&mp, ctx, (int)ctx->m + 1, ws);
+  compute_minimal_poly(&mp, ctx, i);
+
+  poly_gf2_zero(result);
+  for (int j = 0; j <= mp.deg; j++) {
+    if (mp.coeff[j]) poly_gf2_set_coeff(result, j, 1);
   }
 
-  poly_gf2m_free(&gcd_poly);
-  poly_gf2m_free(&product);
-  poly_gf2m_free(&quotient);
-  poly_gf2m_free(&remainder);
+  poly_gf2m_free(&mp);
+  codectk_arena_release(ws, mark);
 }
 
 /**
@@ -109,461 +143,1772 @@ static void poly_gf2m_lcm(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_
  * g(x) = lcm(m_1(x), m_3(x), ..., m_{2t-1}(x))
  * where m_i(x) is the minimal polynomial of α^i.
  */
-static int build_generator(poly_gf2m_t *g, const gf2m_ctx *ctx, unsigned t) {
+static int build_generator(poly_gf2_t *g, const gf2m_ctx *ctx, unsigned t,
+                           codectk_arena *ws) {
   /* Start with g(x) = m_1(x) */
-  compute_minimal_poly(g, ctx, 1);
+  minimal_poly_gf2(g, ctx, 1, ws);
 
-  /* LCM with m_3, m_5, ..., m_{2t-1} */
+  /* LCM with m_3, m_5, ..., m_{2t-1}; a minimal poly has degree <= m */
   for (unsigned i = 3; i < 2 * t; i += 2) {
-    poly_gf2m_t m_i, new_g;
-    poly_gf2m_init(&m_i, ctx, 20);  /* Minimal polys are typically small */
-    poly_gf2m_init(&new_g, ctx, g->deg + 20);
+    size_t mark = codectk_arena_mark(ws);
+    poly_gf2_t m_i, new_g;
+    poly_gf2_init_ws(&m_i, (int)ctx->m + 1, ws);
+    poly_gf2_init_ws(&new_g, g->deg + (int)ctx->m + 1, ws);
+
+    minimal_poly_gf2(&m_i, ctx, (int)i, ws);
+    poly_gf2_lcm(&new_g, g, &m_i, ws);
+    poly_gf2_copy(g, &new_g);
+
+    poly_gf2_free(&m_i);
+    poly_gf2_free(&new_g);
+    codectk_arena_release(ws, mark);
+  }
+
+  return 0;
+}
+
+static inline unsigned get_bit(const uint8_t *buf, size_t i) {
+  return ((unsigned)buf[i >> 3] >> (i & 7)) & 1u;
+}
 
-    compute_minimal_poly(&m_i, ctx, (int)i);
-    poly_gf2m_lcm(&new_g, g, &m_i);
-    poly_gf2m_copy(g, &new_g);
 
-    poly_gf2m_free(&m_i);
-    poly_gf2m_free(&new_g);
+static inline uint64_t load_le64(const uint8_t *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap64(v);
+#endif
+  return v;
+}
+
+static inline void store_le64(uint8_t *p, uint64_t v) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap64(v);
+#endif
+  memcpy(p, &v, sizeof(v));
+}
+
+/* Read nbits (<= 64) stream bits starting at bit offset off */
+static inline uint64_t load_bits(const uint8_t *buf, size_t off, unsigned nbits) {
+  const uint8_t *p = buf + (off >> 3);
+  unsigned shift = (unsigned)(off & 7);
+  unsigned nbytes = (shift + nbits + 7) >> 3;
+  uint64_t v = 0;
+
+  if (nbits == 64) {
+    /* At least 8 whole bytes are in range */
+    v = load_le64(p) >> shift;
+    if (shift) v |= (uint64_t)p[8] << (64 - shift);
+    return v;
   }
 
-  return 0;
+  for (unsigned i = 0; i < nbytes && i < 8; i++) {
+    v |= (uint64_t)p[i] << (8 * i);
+  }
+  v >>= shift;
+  if (nbytes > 8) v |= (uint64_t)p[8] << (64 - shift);
+
+  return nbits < 64 ? v & ((1ULL << nbits) - 1) : v;
 }
 
+/* OR nbits (<= 64) bits of v into a zeroed stream at bit offset off */
+static inline void store_bits(uint8_t *buf, size_t off, uint64_t v, unsigned nbits) {
+  uint8_t *p = buf + (off >> 3);
+  unsigned shift = (unsigned)(off & 7);
+  unsigned nbytes = (shift + nbits + 7) >> 3;
+
+  if (nbits == 64) {
+    store_le64(p, load_le64(p) | (v << shift));
+    if (shift) p[8] |= (uint8_t)(v >> (64 - shift));
+    return;
+  }
+
+  v &= (1ULL << nbits) - 1;
+  for (unsigned i = 0; i < nbytes && i < 8; i++) {
+    p[i] |= (uint8_t)((v << shift) >> (8 * i));
+  }
+  if (nbytes > 8) p[8] |= (uint8_t)(v >> (64 - shift));
+}
 
 /**
- * BCH Encoder
+ * Clock one message bit into the parity LFSR.
  *
- * Systematic encoding: codeword = [message | parity]
- * 1. Compute g(x) = generator polynomial
- * 2. Compute parity = remainder of (x^r * m(x)) / g(x), where r = deg(g)
- * 3. Output: message || parity
+ * The register is reflected: bit 0 holds the x^(r-1) coefficient, so the
+ * feedback tap is bit 0 and the register shifts right.
  */
-static codectk_err bch_encode(const void *pp, const uint8_t *in, size_t in_bits,
-                              uint8_t *out, size_t *out_bits) {
-  const bch_params *P = (const bch_params*)pp;
+static inline void lfsr_clock(const bch_ctx *c, uint64_t *reg, unsigned b) {
+  uint64_t fb = 0 - (uint64_t)((b ^ (unsigned)reg[0]) & 1u);
 
-  if (!P || !in || !out || !out_bits) return CODECTK_EINVAL;
-  if (P->m < 2 || P->m > 16 || P->t == 0) return CODECTK_EINVAL;
+  for (unsigned w = 0; w + 1 < c->words; w++) {
+    reg[w] = (reg[w] >> 1) | (reg[w + 1] << 63);
+  }
+  reg[c->words - 1] >>= 1;
 
-  /* Initialize field context */
-  gf2m_ctx ctx;
+  for (unsigned w = 0; w < c->words; w++) {
+    reg[w] ^= c->gen[w] & fb;
+  }
+}
 
-  /* Use standard primitive polynomials for common field sizes */
-  uint16_t prim_polys[] = {
-    0, 0, 0x7, 0xB, 0x13, 0x25, 0x43, 0x89,
-    0x11D, 0x211, 0x409, 0x805, 0x1053, 0x201B, 0x4443, 0x8003, 0x100B
-  };
+/**
+ * Build the byte-at-a-time LFSR tables.
+ *
+ * T_0[v] is the register after clocking 8 zero bits from a register holding
+ * v in its low byte, so one input byte costs a shift and a table XOR:
+ * reg = (reg >> 8) ^ T_0[(reg ^ byte) & 0xff]. For slicing-by-8,
+ * T_j[v] = (T_{j-1}[v] >> 8) ^ T_0[T_{j-1}[v] & 0xff] is the effect of byte v
+ * after a further 8j clocks, so one 64-bit word costs 8 lookups.
+ */
+static int build_lfsr_tables(bch_ctx *c) {
+  unsigned words = c->words;
+
+  c->slices = (words <= BCH_SLICE_MAX_WORDS) ? 8 : 1;
+  c->tab = (uint64_t*)calloc((size_t)c->slices * 256 * words, sizeof(uint64_t));
+  if (!c->tab) return -1;
+
+  for (unsigned v = 0; v < 256; v++) {
+    uint64_t *e = &c->tab[(size_t)v * words];
+    e[0] = v;
+    for (unsigned i = 0; i < 8; i++) {
+      lfsr_clock(c, e, 0);
+    }
+  }
 
-  if (P->m >= sizeof(prim_polys) / sizeof(prim_polys[0])) {
-    return CODECTK_EINVAL;
+  for (unsigned j = 1; j < c->slices; j++) {
+    for (unsigned v = 0; v < 256; v++) {
+      const uint64_t *prev = &c->tab[((size_t)(j - 1) * 256 + v) * words];
+      uint64_t *e = &c->tab[((size_t)j * 256 + v) * words];
+      const uint64_t *t0 = &c->tab[(size_t)(prev[0] & 0xff) * words];
+
+      for (unsigned w = 0; w < words; w++) {
+        uint64_t hi = (w + 1 < words) ? prev[w + 1] << 56 : 0;
+        e[w] = ((prev[w] >> 8) | hi) ^ t0[w];
+      }
+    }
   }
 
-  if (gf2m_ctx_init(&ctx, P->m, prim_polys[P->m]) != 0) {
-    return CODECTK_ENOMEM;
+  return 0;
+}
+
+/* Feed one input byte (stream order, LSB first) */
+static inline void lfsr_byte(const bch_ctx *c, uint64_t *reg, unsigned byte) {
+  unsigned words = c->words;
+  const uint64_t *t0 = &c->tab[(size_t)((reg[0] ^ byte) & 0xff) * words];
+
+  for (unsigned w = 0; w + 1 < words; w++) {
+    reg[w] = ((reg[w] >> 8) | (reg[w + 1] << 56)) ^ t0[w];
   }
+  reg[words - 1] = (reg[words - 1] >> 8) ^ t0[words - 1];
+}
 
-  /* Build generator polynomial g(x) */
-  poly_gf2m_t g;
-  poly_gf2m_init(&g, &ctx, 100);  /* Conservative capacity */
-  build_generator(&g, &ctx, P->t);
+/* Feed 64 input bits into a single-word register (slicing-by-8) */
+static inline uint64_t lfsr_word1(const uint64_t *tab, uint64_t reg, uint64_t v) {
+  uint64_t x = reg ^ v;
+
+  return tab[(7 * 256) + (x & 0xff)] ^
+         tab[(6 * 256) + ((x >> 8) & 0xff)] ^
+         tab[(5 * 256) + ((x >> 16) & 0xff)] ^
+         tab[(4 * 256) + ((x >> 24) & 0xff)] ^
+         tab[(3 * 256) + ((x >> 32) & 0xff)] ^
+         tab[(2 * 256) + ((x >> 40) & 0xff)] ^
+         tab[(1 * 256) + ((x >> 48) & 0xff)] ^
+         tab[x >> 56];
+}
 
-  int r = g.deg;  /* Degree of generator = number of parity bits */
-  unsigned n = (1U << P->m) - 1;  /* Code length */
-  unsigned k = n - (unsigned)r;   /* Message length */
+/* Feed 64 input bits into a multi-word register (slicing-by-8) */
+static inline void lfsr_word(const uint64_t *tab, unsigned words,
+                             uint64_t *reg, uint64_t v) {
+  uint64_t x = reg[0] ^ v;
 
-#ifdef DEBUG_BCH_ENCODER
-  fprintf(stderr, "Generator deg=%d, n=%u, k=%u, r=%d\n", g.deg, n, k, r);
-  fprintf(stderr, "Generator coeffs (GF2m): ");
-  for (int i = 0; i <= g.deg; i++) {
-    fprintf(stderr, "%u ", poly_gf2m_get_coeff(&g, i));
+  /* The bits above the first word only shift down during 64 clocks */
+  for (unsigned w = 0; w + 1 < words; w++) {
+    reg[w] = reg[w + 1];
   }
-  fprintf(stderr, "\n");
-#endif
+  reg[words - 1] = 0;
 
-  /* Check input size */
-  if (in_bits > k) {
-    poly_gf2m_free(&g);
-    gf2m_ctx_free(&ctx);
-    return CODECTK_EINVAL;
+  for (unsigned j = 0; j < 8; j++) {
+    const uint64_t *e = &tab[((size_t)(7 - j) * 256 + ((x >> (8 * j)) & 0xff)) * words];
+    for (unsigned w = 0; w < words; w++) {
+      reg[w] ^= e[w];
+    }
   }
+}
 
-  /* Convert generator to GF(2) polynomial */
-  poly_gf2_t g_gf2;
-  poly_gf2_init(&g_gf2, r + 1);
+/* Slicing-by-8 over whole words; words is a constant at each call site */
+static inline size_t lfsr_run_words(const bch_ctx *c, unsigned words, uint64_t *reg,
+                                    const uint8_t *in, size_t off, size_t nbits,
+                                    uint8_t *copy, size_t copy_off) {
+  size_t done = 0;
+
+  for (; nbits - done >= 64; done += 64) {
+    uint64_t v = in ? load_bits(in, off + done, 64) : 0;
+    if (copy) store_bits(copy, copy_off + done, v, 64);
+    if (words == 1) {
+      reg[0] = lfsr_word1(c->tab, reg[0], v);
+    } else {
+      lfsr_word(c->tab, words, reg, v);
+    }
+  }
 
-  /* For binary BCH, g(x) has coefficients in {0, 1} */
-  /* Extract just the GF(2) representation */
-  for (int i = 0; i <= g.deg; i++) {
-    uint16_t c = poly_gf2m_get_coeff(&g, i);
-    poly_gf2_set_coeff(&g_gf2, i, c != 0 ? 1 : 0);
+  return done;
+}
+
+/**
+ * Clock nbits stream bits starting at bit offset off through the LFSR.
+ * A NULL input clocks zeros. When copy is set, the input bits are also
+ * copied to it (zeroed) at copy_off.
+ */
+static void lfsr_run(const bch_ctx *c, uint64_t *reg,
+                     const uint8_t *in, size_t off, size_t nbits,
+                     uint8_t *copy, size_t copy_off) {
+  size_t done = 0;
+
+  if (c->slices == 8) {
+    switch (c->words) {
+      case 1: done = lfsr_run_words(c, 1, reg, in, off, nbits, copy, copy_off); break;
+      case 2: done = lfsr_run_words(c, 2, reg, in, off, nbits, copy, copy_off); break;
+      case 3: done = lfsr_run_words(c, 3, reg, in, off, nbits, copy, copy_off); break;
+      case 4: done = lfsr_run_words(c, 4, reg, in, off, nbits, copy, copy_off); break;
+      default: done = lfsr_run_words(c, c->words, reg, in, off, nbits, copy, copy_off); break;
+    }
   }
 
-#ifdef DEBUG_BCH_ENCODER
-  fprintf(stderr, "Generator coeffs (GF2): ");
-  for (int i = 0; i <= g_gf2.deg; i++) {
-    fprintf(stderr, "%d ", poly_gf2_get_coeff(&g_gf2, i));
+  for (; nbits - done >= 8; done += 8) {
+    unsigned byte = in ? (unsigned)load_bits(in, off + done, 8) : 0;
+    if (copy) store_bits(copy, copy_off + done, byte, 8);
+    lfsr_byte(c, reg, byte);
   }
-  fprintf(stderr, "\n");
+  for (; done < nbits; done++) {
+    unsigned bit = in ? get_bit(in, off + done) : 0;
+    if (copy) store_bits(copy, copy_off + done, bit, 1);
+    lfsr_clock(c, reg, bit);
+  }
+}
+
+/**
+ * Build the per-syndrome byte tables for the odd syndromes S_j, j = 2i + 1:
+ * synd_tab[i * 256 + b] = sum over set bits u of b of α^(j(7-u)), i.e. the
+ * byte b evaluated at α^j with its first bit as the highest-degree term.
+ */
+static int build_syndrome_tables(bch_ctx *c) {
+  const gf2m_ctx *ctx = &c->field;
+  unsigned n = c->n;
+
+  if (c->t > BCH_SYND_TABLE_MAX_T) return 0;  /* evaluate bit by bit */
+
+  c->synd_tab = (uint16_t*)calloc((size_t)c->t * 256, sizeof(uint16_t));
+  if (!c->synd_tab) return -1;
+
+  for (unsigned i = 0; i < c->t; i++) {
+    unsigned j = 2 * i + 1;
+    uint16_t *tab = &c->synd_tab[(size_t)i * 256];
+
+    for (unsigned u = 0; u < 8; u++) {
+      uint16_t term = ctx->alog[(j * (7 - u)) % n];
+      unsigned bit = 1u << u;
+      /* Every byte with bit u set gets the term: fill by doubling */
+      for (unsigned b = 0; b < bit; b++) {
+        tab[b | bit] = tab[b] ^ term;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Step tables kept for the SIMD Chien search: one per coefficient up to
+ * BCH_CHIEN_SIMD_MAX_T. BCH_CHIEN_CPU in chien_lanes (the built-in fixed
+ * contexts) means the tables for 32 lanes are followed by those for 16 and
+ * the width is picked when the search runs.
+ */
+#define BCH_CHIEN_SIMD_T(t) ((t) < BCH_CHIEN_SIMD_MAX_T ? (t) : BCH_CHIEN_SIMD_MAX_T)
+#define BCH_CHIEN_CPU (~0u)
+
+/* Pick the widest Chien search the CPU supports: lanes per step, 0 = scalar */
+static unsigned chien_select_lanes(void) {
+#ifdef BCH_CHIEN_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return 32;
+  if (__builtin_cpu_supports("ssse3")) return 16;
+  return 0;
+#elif defined(BCH_CHIEN_NEON)
+  return 16;
+#else
+  return 0;
 #endif
+}
+
+/**
+ * The split-nibble step tables for the SIMD Chien search: for each
+ * j = 1..nt, the products of α^{-j * lanes} with every nibble value in each
+ * of the four nibble positions of a 16-bit element, split into low and high
+ * output bytes.
+ */
+void bch_chien_fill(const bch_ctx *c, unsigned lanes, unsigned nt, uint8_t *out) {
+  const uint16_t *alog = c->field.alog;
+  const uint16_t *log = c->field.log;
+  unsigned n = c->n;
+
+  for (unsigned j = 1; j <= nt; j++) {
+    unsigned step = n - (unsigned)(((uint64_t)j * lanes) % n);
+    uint8_t *tab = &out[(size_t)(j - 1) * 128];
+
+    for (unsigned q = 0; q < 4; q++) {
+      for (unsigned v = 1; v < 16; v++) {
+        unsigned x = v << (4 * q);
+        if (x > n) continue;  /* not a field element for this m */
+        unsigned e = log[x] + step;
+        uint16_t prod = alog[e >= n ? e - n : e];
+        tab[(2 * q) * 16 + v] = (uint8_t)prod;
+        tab[(2 * q + 1) * 16 + v] = (uint8_t)(prod >> 8);
+      }
+    }
+  }
+}
+
+static int build_chien_tables(bch_ctx *c) {
+  c->chien_lanes = chien_select_lanes();
+  if (!c->chien_lanes) return 0;
 
-  /* Build message polynomial m(x) from input bits */
-  poly_gf2_t m;
-  poly_gf2_init(&m, (int)k);
+  unsigned nt = BCH_CHIEN_SIMD_T(c->t);
+  c->chien_tab = (uint8_t*)calloc((size_t)nt * 128, 1);
+  if (!c->chien_tab) return -1;
+  bch_chien_fill(c, c->chien_lanes, nt, c->chien_tab);
+  return 0;
+}
 
-  for (size_t i = 0; i < in_bits; i++) {
-    int byte_idx = (int)(i / 8);
-    int bit_idx = (int)(i % 8);
-    int bit = (in[byte_idx] >> bit_idx) & 1;
-    poly_gf2_set_coeff(&m, (int)i, bit);
+codectk_err bch_ctx_create(unsigned m, unsigned t, bch_ctx **out) {
+  if (!out) return CODECTK_EINVAL;
+  *out = NULL;
+  if (m < 2 || m > 16 || t == 0) {
+    return CODECTK_EINVAL;
   }
 
-  /* Compute x^r * m(x) */
-  poly_gf2_t shifted;
-  poly_gf2_init(&shifted, (int)(k + (unsigned)r));
+  unsigned n = (1U << m) - 1;
+  if (2 * t >= n) return CODECTK_EINVAL;
 
-#ifdef DEBUG_BCH_ENCODER
-  fprintf(stderr, "Message m deg=%d: ", m.deg);
-  for (int i = 0; i <= m.deg; i++) {
-    fprintf(stderr, "%d", poly_gf2_get_coeff(&m, i));
+  bch_ctx *c = (bch_ctx*)calloc(1, sizeof(bch_ctx));
+  if (!c) return CODECTK_ENOMEM;
+
+  /* Borrow the shared field tables; destroy leaves them alone */
+  const gf2m_ctx *field = gf2m_ctx_get(m, 0);
+  if (!field) {
+    free(c);
+    return CODECTK_ENOMEM;
+  }
+  c->field = *field;
+  c->field.owns_tables = 0;
+
+  /* Build generator polynomial g(x); deg g <= m*t. All temporaries come
+   * from one scratch block. */
+  size_t scratch_size = generator_scratch_size(m, t);
+  void *scratch = malloc(scratch_size);
+  codectk_arena ws;
+  codectk_arena_init(&ws, scratch, scratch_size);
+
+  poly_gf2_t g;
+  if (!scratch || poly_gf2_init(&g, (int)(m * t) + 1) != 0) {
+    free(scratch);
+    bch_ctx_destroy(c);
+    return CODECTK_ENOMEM;
+  }
+  build_generator(&g, &c->field, t, &ws);
+  free(scratch);
+
+  if (g.deg <= 0 || (unsigned)g.deg >= n || g.deg > BCH_MAX_PARITY_BITS) {
+    poly_gf2_free(&g);
+    bch_ctx_destroy(c);
+    return CODECTK_EINVAL;
+  }
+
+  c->m = m;
+  c->t = t;
+  c->n = n;
+  c->r = (unsigned)g.deg;
+  c->k = n - c->r;
+  c->words = (c->r + 63) / 64;
+
+  c->gen = (uint64_t*)calloc(c->words, sizeof(uint64_t));
+  if (!c->gen) {
+    poly_gf2_free(&g);
+    bch_ctx_destroy(c);
+    return CODECTK_ENOMEM;
   }
-  fprintf(stderr, "\n");
-#endif
 
-  for (int i = 0; i <= m.deg; i++) {
-    if (poly_gf2_get_coeff(&m, i)) {
-      poly_gf2_set_coeff(&shifted, i + r, 1);
+  /* Store g(x) reflected (bit i holds g_{r-1-i}) for the right-shifting LFSR. */
+  for (unsigned i = 0; i < c->r; i++) {
+    if (poly_gf2_get_coeff(&g, (int)(c->r - 1 - i))) {
+      c->gen[i / 64] |= 1ULL << (i % 64);
     }
   }
 
-  /* Compute remainder: parity = (x^r * m(x)) mod g(x) */
-  poly_gf2_t quotient, parity;
-  poly_gf2_init(&quotient, (int)k);
-  poly_gf2_init(&parity, (int)(k + (unsigned)r));  /* Need capacity for full shifted poly */
+  if (build_lfsr_tables(c) != 0 || build_syndrome_tables(c) != 0 ||
+      build_chien_tables(c) != 0) {
+    poly_gf2_free(&g);
+    bch_ctx_destroy(c);
+    return CODECTK_ENOMEM;
+  }
 
 #ifdef DEBUG_BCH_ENCODER
-  fprintf(stderr, "Shifted deg=%d, g_gf2 deg=%d\n", shifted.deg, g_gf2.deg);
-  fprintf(stderr, "Shifted: ");
-  for (int i = 0; i <= shifted.deg && i < 20; i++) {
-    fprintf(stderr, "%d", poly_gf2_get_coeff(&shifted, i));
+  fprintf(stderr, "Generator deg=%u, n=%u, k=%u\n", c->r, c->n, c->k);
+  fprintf(stderr, "Generator coeffs: ");
+  for (int i = 0; i <= g.deg; i++) {
+    fprintf(stderr, "%d", poly_gf2_get_coeff(&g, i));
   }
   fprintf(stderr, "\n");
 #endif
 
-  poly_gf2_div_rem(&quotient, &parity, &shifted, &g_gf2);
+  poly_gf2_free(&g);
+  *out = c;
+  return CODECTK_OK;
+}
 
-#ifdef DEBUG_BCH_ENCODER
-  fprintf(stderr, "Parity deg=%d: ", parity.deg);
-  for (int i = 0; i <= parity.deg; i++) {
-    fprintf(stderr, "%d", poly_gf2_get_coeff(&parity, i));
+void bch_ctx_destroy(bch_ctx *ctx) {
+  if (!ctx) return;
+  free(ctx->gen);
+  free(ctx->tab);
+  free(ctx->synd_tab);
+  free(ctx->chien_tab);
+  gf2m_ctx_free(&ctx->field);
+  free(ctx);
+}
+
+/**
+ * Encode one codeword at bit offset in_off/out_off.
+ *
+ * avail message bits are read from the input; the remaining msg_len - avail
+ * bits are zero fill. Writes msg_len + r bits; the output must be zeroed.
+ */
+static void encode_block(const bch_ctx *c, const uint8_t *in, size_t in_off,
+                         size_t avail, size_t msg_len, uint8_t *out, size_t out_off) {
+  uint64_t reg[BCH_MAX_PARITY_BITS / 64] = {0};
+
+  /* Clock message bits (then zero fill) through the LFSR */
+  lfsr_run(c, reg, in, in_off, avail, out, out_off);
+  lfsr_run(c, reg, NULL, 0, msg_len - avail, NULL, 0);
+
+  /* Register bit i is the parity coefficient of x^(r-1-i) */
+  for (unsigned i = 0; i < c->r; i += 64) {
+    unsigned nbits = (c->r - i < 64) ? c->r - i : 64;
+    store_bits(out, out_off + msg_len + i, reg[i / 64], nbits);
   }
-  fprintf(stderr, "\n");
-#endif
+}
+
+/**
+ * BCH Encoder
+ *
+ * Systematic encoding: codeword = [message | parity]
+ * parity = remainder of (x^r * m(x)) / g(x), where r = deg(g), computed by
+ * clocking the message through an LFSR built from g(x).
+ *
+ * The input is split into k-bit messages emitted as back-to-back n-bit
+ * codewords. A final partial message is handled according to pad.
+ */
+codectk_err bch_ctx_encode(const bch_ctx *c, bch_pad pad,
+                           const uint8_t *in, size_t in_bits,
+                           uint8_t *out, size_t *out_bits) {
+  if (!c || !out_bits || (in_bits && (!in || !out))) return CODECTK_EINVAL;
+
+  size_t blocks = in_bits / c->k;
+  size_t tail = in_bits % c->k;
+  size_t tail_len = 0;  /* message bits of the final partial codeword */
 
-  /* Write output: message bits followed by parity bits */
-  size_t total_bits = in_bits + (size_t)r;
+  if (tail) tail_len = (pad == BCH_PAD_ZERO) ? c->k : tail;
+
+  size_t total_bits = blocks * c->n + (tail ? tail_len + c->r : 0);
   size_t total_bytes = (total_bits + 7) / 8;
+  if (total_bytes > (*out_bits) / 8) return CODECTK_ENOMEM;
 
-  if (total_bytes > (*out_bits) / 8) {
-    poly_gf2_free(&g_gf2);
-    poly_gf2_free(&m);
-    poly_gf2_free(&shifted);
-    poly_gf2_free(&quotient);
-    poly_gf2_free(&parity);
-    poly_gf2m_free(&g);
-    gf2m_ctx_free(&ctx);
-    return CODECTK_ENOMEM;
+  if (total_bytes) memset(out, 0, total_bytes);
+
+  size_t in_off = 0, out_off = 0;
+  for (size_t b = 0; b < blocks; b++) {
+    encode_block(c, in, in_off, c->k, c->k, out, out_off);
+    in_off += c->k;
+    out_off += c->n;
+  }
+  if (tail) {
+    encode_block(c, in, in_off, tail, tail_len, out, out_off);
   }
 
-  memset(out, 0, total_bytes);
+  *out_bits = total_bits;
+  return CODECTK_OK;
+}
 
-  /* Copy message bits */
-  for (size_t i = 0; i < in_bits; i++) {
-    int byte_idx = (int)(i / 8);
-    int bit_idx = (int)(i % 8);
-    int bit = (in[byte_idx] >> bit_idx) & 1;
-    if (bit) {
-      out[byte_idx] |= (uint8_t)(1 << bit_idx);
+/**
+ * Syndromes of a received word from its LFSR remainder.
+ *
+ * rem holds R(x) = x^r * c(x) mod g(x), bit i being the coefficient of
+ * x^(r-1-i). Since g(α^j) = 0 for j = 1..2t, S_j = c(α^j) = R(α^j) α^(-jr),
+ * so only r bits are evaluated instead of the whole codeword. Only the odd
+ * syndromes are evaluated; for binary codes S_2j = S_j^2.
+ */
+static void compute_syndromes(const bch_ctx *c, const uint64_t *rem,
+                              uint16_t *syndromes) {
+  const uint16_t *alog = c->field.alog;
+  unsigned n = c->n;
+  unsigned t = c->t;
+  unsigned nbytes = (c->r + 7) / 8;
+
+  for (unsigned i = 0; i < t; i++) {
+    unsigned j = 2 * i + 1;
+    uint16_t val = 0;
+    unsigned shift;  /* R(α^j) was evaluated as R(α^j) α^(j shift) */
+
+    if (c->synd_tab) {
+      /* Byte-wise Horner over the remainder padded to whole bytes */
+      const uint16_t *tab = &c->synd_tab[(size_t)i * 256];
+      uint16_t step = alog[(8 * j) % n];  /* α^(8j) */
+
+      for (unsigned q = 0; q < nbytes; q++) {
+        val = gf2m_mul_fast(&c->field, val, step);
+        val ^= tab[(rem[q / 8] >> (8 * (q % 8))) & 0xff];
+      }
+      shift = 8 * nbytes - c->r;
+    } else {
+      for (unsigned w = 0; w < c->words; w++) {
+        uint64_t bits = rem[w];
+        while (bits) {
+          unsigned b = 64 * w + (unsigned)__builtin_ctzll(bits);
+          val ^= alog[(unsigned)(((uint64_t)j * (c->r - 1 - b)) % n)];
+          bits &= bits - 1;
+        }
+      }
+      shift = 0;
     }
+
+    /* S_j = val * α^(-j(r + shift)) */
+    unsigned e = (unsigned)(((uint64_t)j * (c->r + shift)) % n);
+    syndromes[j - 1] = gf2m_mul_fast(&c->field, val, alog[n - e]);
   }
 
-  /* Copy parity bits */
-  for (int i = 0; i < r; i++) {
-    size_t bit_pos = in_bits + (size_t)i;
-    int byte_idx = (int)(bit_pos / 8);
-    int bit_idx = (int)(bit_pos % 8);
+  /* S_2j = S_j^2 (Frobenius) */
+  for (unsigned j = 2; j <= 2 * t; j += 2) {
+    uint16_t sj = syndromes[j / 2 - 1];
+    syndromes[j - 1] = gf2m_sqr_tab(&c->field, sj);
+  }
+}
 
-    if (poly_gf2_get_coeff(&parity, i)) {
-      out[byte_idx] |= (uint8_t)(1 << bit_idx);
-    }
+/**
+ * Inversion-free Berlekamp-Massey (iBM) for binary codes, run on lanes
+ * codewords in lockstep.
+ *
+ * Lane w has syndromes S_1..S_2t at syndromes[w * 2t], and gets Λ(x) in
+ * lambda[w * (t + 1)] and its length L (the number of errors it claims)
+ * in len[w]. Instead of Λ -= (d/b) x^m B, each step forms
+ * Λ' = γΛ + δ x B with the previous nonzero discrepancy γ, which scales Λ
+ * by a nonzero constant and leaves its roots alone.
+ *
+ * For binary codes S_2j = S_j^2 makes every second discrepancy zero, so
+ * only the t odd steps are run, each followed by the shift of the skipped
+ * even step (B <- x^2 B instead of x B). Coefficients past x^t are
+ * dropped: they can only matter once L > t, which is uncorrectable.
+ *
+ * The schedule depends on t only: every step touches all t + 1
+ * coefficients and the update of B is a masked select, so neither the
+ * iteration count nor the branches depend on the syndromes. scratch holds
+ * lanes * (t + 1) coefficients for B(x).
+ */
+static void berlekamp_massey(const gf2m_ctx *ctx, unsigned t, unsigned lanes,
+                             const uint16_t *syndromes, uint16_t *lambda,
+                             unsigned *len, uint16_t *scratch) {
+  uint16_t gamma[BCH_BM_LANES];
+
+  for (unsigned w = 0; w < lanes; w++) {
+    uint16_t *lam = lambda + (size_t)w * (t + 1), *B = scratch + (size_t)w * (t + 1);
+    memset(lam, 0, (t + 1) * sizeof(uint16_t));
+    memset(B, 0, (t + 1) * sizeof(uint16_t));
+    lam[0] = B[0] = 1;
+    gamma[w] = 1;
+    len[w] = 0;
   }
 
-  *out_bits = total_bits;
+  for (unsigned r = 0; r < t; r++) {
+    unsigned top = (2 * r < t) ? 2 * r : t;
 
-  /* Cleanup */
-  poly_gf2_free(&g_gf2);
-  poly_gf2_free(&m);
-  poly_gf2_free(&shifted);
-  poly_gf2_free(&quotient);
-  poly_gf2_free(&parity);
-  poly_gf2m_free(&g);
-  gf2m_ctx_free(&ctx);
+    for (unsigned w = 0; w < lanes; w++) {
+      const uint16_t *S = syndromes + (size_t)w * 2 * t;
+      uint16_t *lam = lambda + (size_t)w * (t + 1), *B = scratch + (size_t)w * (t + 1);
 
-  return CODECTK_OK;
+      /* δ = Σ Λ_i S_(2r+1-i) */
+      uint16_t delta = 0;
+      for (unsigned i = 0; i <= top; i++) delta ^= gf2m_mul_fast(ctx, lam[i], S[2 * r - i]);
+
+      /* Length change: B <- x Λ, else B <- x^2 B */
+      unsigned change = (unsigned)(delta != 0) & (unsigned)(len[w] <= r);
+      uint16_t mask = (uint16_t)(0u - change);
+
+      /* From the top down, so that the lower old coefficients survive */
+      for (unsigned i = t + 1; i-- > 0;) {
+        uint16_t old = lam[i];
+        uint16_t b1 = i >= 1 ? B[i - 1] : 0, b2 = i >= 2 ? B[i - 2] : 0;
+        uint16_t l1 = i >= 1 ? lam[i - 1] : 0;
+        lam[i] = gf2m_mul_fast(ctx, gamma[w], old) ^ gf2m_mul_fast(ctx, delta, b1);
+        B[i] = (uint16_t)((l1 & mask) | (b2 & ~mask));
+      }
+
+      gamma[w] = (uint16_t)((delta & mask) | (gamma[w] & ~mask));
+      len[w] = change ? 2 * r + 1 - len[w] : len[w];
+    }
+  }
 }
 
 /**
- * Berlekamp-Massey algorithm for finding error locator polynomial.
- * Given syndromes S_1, S_3, ..., S_{2t-1}, finds Λ(x) such that:
- * Λ(α^{-i}) = 0 for each error location i.
+ * Chien search: find roots of error locator polynomial.
+ * For binary BCH, we check if Λ(α^{-i}) = 0 for i = 0, 1, ..., len-1.
+ * If yes, then the coefficient of x^i is in error, which is stream
+ * position len-1-i. Only the len positions of a shortened codeword are
+ * scanned, and the scan stops once deg Λ roots have been found.
  *
- * Returns the error locator polynomial in lambda.
+ * Incremental form: register j holds λ_j α^{-ij} and is multiplied by the
+ * fixed α^{-j} per step. The scalar path keeps the registers as logs, so a
+ * step is one add and one antilog lookup per coefficient. The SIMD paths
+ * evaluate chien_lanes positions per step, with each 16-bit register lane
+ * multiplied by the fixed α^{-j * lanes} through split-nibble tables.
+ */
+
+/* Incremental Chien search in the log domain; scratch holds 2 * deg entries */
+static int chien_scalar(const bch_ctx *c, const uint16_t *lambda, unsigned deg,
+                        unsigned len, uint32_t *scratch, uint32_t *error_positions) {
+  const uint16_t *alog = c->field.alog;
+  const uint16_t *log = c->field.log;
+  unsigned n = c->n;
+  unsigned terms = 0;
+  int found = 0;
+
+  /* Nonzero coefficients j >= 1 as (log λ_j α^{-ij}, n - j) pairs */
+  for (unsigned j = 1; j <= deg; j++) {
+    if (lambda[j]) {
+      scratch[2 * terms] = log[lambda[j]];
+      scratch[2 * terms + 1] = n - j % n;
+      terms++;
+    }
+  }
+
+  for (unsigned i = 0; i < len; i++) {
+    uint16_t sum = lambda[0];
+
+    for (unsigned k = 0; k < terms; k++) {
+      unsigned e = scratch[2 * k];
+      sum ^= alog[e];
+      e += scratch[2 * k + 1];
+      scratch[2 * k] = (e >= n) ? e - n : e;
+    }
+
+    if (sum == 0) {
+      error_positions[found++] = len - 1 - i;
+      if ((unsigned)found == deg) break;
+    }
+  }
+
+  return found;
+}
+
+#ifdef BCH_CHIEN_SIMD
+/*
+ * Split-nibble tables for the SIMD paths. For each j, 8 tables of 16 bytes:
+ * table 2q + h maps nibble q of a 16-bit element x to byte h of
+ * x_q * α^{-j * lanes}, where x_q is x with all but nibble q cleared.
  */
-static void berlekamp_massey(poly_gf2m_t *lambda, const uint16_t *syndromes,
-                              unsigned t, const gf2m_ctx *ctx) {
-  /* Initialize Λ(x) = 1 */
-  poly_gf2m_zero(lambda);
-  poly_gf2m_set_coeff(lambda, 0, 1);
-
-  /* B(x) = 1 (previous Λ) */
-  poly_gf2m_t B;
-  poly_gf2m_init(&B, ctx, (int)(2 * t));
-  poly_gf2m_set_coeff(&B, 0, 1);
-
-  int L = 0;  /* Current error count */
-  int m = 1;  /* Shift amount */
-  uint16_t b = 1;  /* Previous discrepancy */
-
-  for (unsigned n = 0; n < 2 * t; n++) {
-    /* Compute discrepancy d_n = S_n + Σ Λ_i * S_{n-i} */
-    uint16_t d = syndromes[n];
-
-    for (int i = 1; i <= L; i++) {
-      uint16_t lambda_i = poly_gf2m_get_coeff(lambda, i);
-      if (lambda_i != 0 && n >= (unsigned)i) {
-        unsigned idx = n - (unsigned)i;
-        uint16_t prod = gf2m_mul(ctx, lambda_i, syndromes[idx]);
-        d = gf2m_add(d, prod);
+#define CHIEN_TAB(tab, j, q, h) (&(tab)[(size_t)((j) - 1) * 128 + (2 * (q) + (h)) * 16])
+
+/* Starting lane values λ_j α^{-jp}, p = 0..lanes-1, as low and high byte planes */
+static void chien_simd_init(const bch_ctx *c, const uint16_t *lambda, unsigned deg,
+                            unsigned lanes, uint8_t (*planes)[2][32]) {
+  const uint16_t *alog = c->field.alog;
+  const uint16_t *log = c->field.log;
+  unsigned n = c->n;
+
+  for (unsigned j = 1; j <= deg; j++) {
+    for (unsigned p = 0; p < lanes; p++) {
+      uint16_t v = 0;
+      if (lambda[j]) {
+        unsigned e = log[lambda[j]] + n - (unsigned)(((uint64_t)j * p) % n);
+        v = alog[e >= n ? e - n : e];
       }
+      planes[j - 1][0][p] = (uint8_t)v;
+      planes[j - 1][1][p] = (uint8_t)(v >> 8);
     }
+  }
+}
 
-    if (d == 0) {
-      /* No correction needed */
-      m++;
-    } else {
-      poly_gf2m_t T;
-      poly_gf2m_init(&T, ctx, lambda->deg + 1);
-      poly_gf2m_copy(&T, lambda);
-
-      /* Λ(x) = Λ(x) - (d/b) * x^m * B(x) */
-      uint16_t factor = gf2m_mul(ctx, d, gf2m_inv(ctx, b));
-
-      for (int i = 0; i <= B.deg; i++) {
-        uint16_t B_i = poly_gf2m_get_coeff(&B, i);
-        if (B_i != 0) {
-          uint16_t term = gf2m_mul(ctx, factor, B_i);
-          uint16_t current = poly_gf2m_get_coeff(lambda, i + m);
-          poly_gf2m_set_coeff(lambda, i + m, gf2m_add(current, term));
-        }
+/* Record roots from a bitmask of zero lanes; returns 1 once deg are found */
+static inline int chien_collect(uint32_t zero, unsigned i0, unsigned len,
+                                unsigned deg, uint32_t *error_positions, int *found) {
+  while (zero) {
+    unsigned i = i0 + (unsigned)__builtin_ctz(zero);
+    zero &= zero - 1;
+    if (i >= len) break;
+    error_positions[(*found)++] = len - 1 - i;
+    if ((unsigned)*found == deg) return 1;
+  }
+  return 0;
+}
+#endif
+
+#ifdef BCH_CHIEN_X86
+__attribute__((target("ssse3")))
+static int chien_ssse3(const bch_ctx *c, const uint8_t *tab, const uint16_t *lambda,
+                       unsigned deg, unsigned len, uint32_t *error_positions) {
+  _Alignas(32) uint8_t planes[BCH_CHIEN_SIMD_MAX_T][2][32];
+  const __m128i nib = _mm_set1_epi8(0x0f);
+  const int wide = c->m > 8;
+  int found = 0;
+
+  chien_simd_init(c, lambda, deg, 16, planes);
+
+  for (unsigned i0 = 0; i0 < len; i0 += 16) {
+    __m128i sum_lo = _mm_set1_epi8((char)(lambda[0] & 0xff));
+    __m128i sum_hi = _mm_set1_epi8((char)(lambda[0] >> 8));
+
+    for (unsigned j = 1; j <= deg; j++) {
+      __m128i lo = _mm_load_si128((const __m128i*)planes[j - 1][0]);
+      __m128i hi = _mm_load_si128((const __m128i*)planes[j - 1][1]);
+      sum_lo = _mm_xor_si128(sum_lo, lo);
+      sum_hi = _mm_xor_si128(sum_hi, hi);
+
+      /* Step all lanes to the next 16 positions */
+      __m128i n0 = _mm_and_si128(lo, nib);
+      __m128i n1 = _mm_and_si128(_mm_srli_epi16(lo, 4), nib);
+      __m128i nlo = _mm_xor_si128(
+          _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)CHIEN_TAB(tab, j, 0, 0)), n0),
+          _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)CHIEN_TAB(tab, j, 1, 0)), n1));
+      __m128i nhi = _mm_xor_si128(
+          _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)CHIEN_TAB(tab, j, 0, 1)), n0),
+          _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)CHIEN_TAB(tab, j, 1, 1)), n1));
+      if (wide) {
+        __m128i n2 = _mm_and_si128(hi, nib);
+        __m128i n3 = _mm_and_si128(_mm_srli_epi16(hi, 4), nib);
+        nlo = _mm_xor_si128(nlo, _mm_xor_si128(
+            _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)CHIEN_TAB(tab, j, 2, 0)), n2),
+            _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)CHIEN_TAB(tab, j, 3, 0)), n3)));
+        nhi = _mm_xor_si128(nhi, _mm_xor_si128(
+            _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)CHIEN_TAB(tab, j, 2, 1)), n2),
+            _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)CHIEN_TAB(tab, j, 3, 1)), n3)));
+      }
+      _mm_store_si128((__m128i*)planes[j - 1][0], nlo);
+      _mm_store_si128((__m128i*)planes[j - 1][1], nhi);
+    }
+
+    __m128i zero = _mm_cmpeq_epi8(_mm_or_si128(sum_lo, sum_hi), _mm_setzero_si128());
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(zero);
+    if (chien_collect(mask, i0, len, deg, error_positions, &found)) break;
+  }
+
+  return found;
+}
+
+__attribute__((target("avx2")))
+static int chien_avx2(const bch_ctx *c, const uint8_t *tab, const uint16_t *lambda,
+                      unsigned deg, unsigned len, uint32_t *error_positions) {
+  _Alignas(32) uint8_t planes[BCH_CHIEN_SIMD_MAX_T][2][32];
+  const __m256i nib = _mm256_set1_epi8(0x0f);
+  const int wide = c->m > 8;
+  int found = 0;
+
+  chien_simd_init(c, lambda, deg, 32, planes);
+
+#define TAB256(j, q, h) \
+  _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)CHIEN_TAB(tab, j, q, h)))
+
+  for (unsigned i0 = 0; i0 < len; i0 += 32) {
+    __m256i sum_lo = _mm256_set1_epi8((char)(lambda[0] & 0xff));
+    __m256i sum_hi = _mm256_set1_epi8((char)(lambda[0] >> 8));
+
+    for (unsigned j = 1; j <= deg; j++) {
+      __m256i lo = _mm256_load_si256((const __m256i*)planes[j - 1][0]);
+      __m256i hi = _mm256_load_si256((const __m256i*)planes[j - 1][1]);
+      sum_lo = _mm256_xor_si256(sum_lo, lo);
+      sum_hi = _mm256_xor_si256(sum_hi, hi);
+
+      /* Step all lanes to the next 32 positions */
+      __m256i n0 = _mm256_and_si256(lo, nib);
+      __m256i n1 = _mm256_and_si256(_mm256_srli_epi16(lo, 4), nib);
+      __m256i nlo = _mm256_xor_si256(_mm256_shuffle_epi8(TAB256(j, 0, 0), n0),
+                                     _mm256_shuffle_epi8(TAB256(j, 1, 0), n1));
+      __m256i nhi = _mm256_xor_si256(_mm256_shuffle_epi8(TAB256(j, 0, 1), n0),
+                                     _mm256_shuffle_epi8(TAB256(j, 1, 1), n1));
+      if (wide) {
+        __m256i n2 = _mm256_and_si256(hi, nib);
+        __m256i n3 = _mm256_and_si256(_mm256_srli_epi16(hi, 4), nib);
+        nlo = _mm256_xor_si256(nlo, _mm256_xor_si256(_mm256_shuffle_epi8(TAB256(j, 2, 0), n2),
+                                                     _mm256_shuffle_epi8(TAB256(j, 3, 0), n3)));
+        nhi = _mm256_xor_si256(nhi, _mm256_xor_si256(_mm256_shuffle_epi8(TAB256(j, 2, 1), n2),
+                                                     _mm256_shuffle_epi8(TAB256(j, 3, 1), n3)));
       }
+      _mm256_store_si256((__m256i*)planes[j - 1][0], nlo);
+      _mm256_store_si256((__m256i*)planes[j - 1][1], nhi);
+    }
+
+    __m256i zero = _mm256_cmpeq_epi8(_mm256_or_si256(sum_lo, sum_hi), _mm256_setzero_si256());
+    uint32_t mask = (uint32_t)_mm256_movemask_epi8(zero);
+    if (chien_collect(mask, i0, len, deg, error_positions, &found)) break;
+  }
 
-      if (2 * L <= (int)n) {
-        /* Update B(x) and L */
-        L = (int)n + 1 - L;
-        poly_gf2m_copy(&B, &T);
-        b = d;
-        m = 1;
-      } else {
-        m++;
+#undef TAB256
+  return found;
+}
+#endif
+
+#ifdef BCH_CHIEN_NEON
+static int chien_neon(const bch_ctx *c, const uint8_t *tab, const uint16_t *lambda,
+                      unsigned deg, unsigned len, uint32_t *error_positions) {
+  _Alignas(32) uint8_t planes[BCH_CHIEN_SIMD_MAX_T][2][32];
+  const uint8x16_t nib = vdupq_n_u8(0x0f);
+  const int wide = c->m > 8;
+  int found = 0;
+
+  chien_simd_init(c, lambda, deg, 16, planes);
+
+  for (unsigned i0 = 0; i0 < len; i0 += 16) {
+    uint8x16_t sum_lo = vdupq_n_u8((uint8_t)(lambda[0] & 0xff));
+    uint8x16_t sum_hi = vdupq_n_u8((uint8_t)(lambda[0] >> 8));
+
+    for (unsigned j = 1; j <= deg; j++) {
+      uint8x16_t lo = vld1q_u8(planes[j - 1][0]);
+      uint8x16_t hi = vld1q_u8(planes[j - 1][1]);
+      sum_lo = veorq_u8(sum_lo, lo);
+      sum_hi = veorq_u8(sum_hi, hi);
+
+      /* Step all lanes to the next 16 positions */
+      uint8x16_t n0 = vandq_u8(lo, nib);
+      uint8x16_t n1 = vshrq_n_u8(lo, 4);
+      uint8x16_t nlo = veorq_u8(vqtbl1q_u8(vld1q_u8(CHIEN_TAB(tab, j, 0, 0)), n0),
+                                vqtbl1q_u8(vld1q_u8(CHIEN_TAB(tab, j, 1, 0)), n1));
+      uint8x16_t nhi = veorq_u8(vqtbl1q_u8(vld1q_u8(CHIEN_TAB(tab, j, 0, 1)), n0),
+                                vqtbl1q_u8(vld1q_u8(CHIEN_TAB(tab, j, 1, 1)), n1));
+      if (wide) {
+        uint8x16_t n2 = vandq_u8(hi, nib);
+        uint8x16_t n3 = vshrq_n_u8(hi, 4);
+        nlo = veorq_u8(nlo, veorq_u8(vqtbl1q_u8(vld1q_u8(CHIEN_TAB(tab, j, 2, 0)), n2),
+                                     vqtbl1q_u8(vld1q_u8(CHIEN_TAB(tab, j, 3, 0)), n3)));
+        nhi = veorq_u8(nhi, veorq_u8(vqtbl1q_u8(vld1q_u8(CHIEN_TAB(tab, j, 2, 1)), n2),
+                                     vqtbl1q_u8(vld1q_u8(CHIEN_TAB(tab, j, 3, 1)), n3)));
       }
+      vst1q_u8(planes[j - 1][0], nlo);
+      vst1q_u8(planes[j - 1][1], nhi);
+    }
 
-      poly_gf2m_free(&T);
+    /* One nibble per lane: 0xf where the lane is zero */
+    uint8x16_t zero = vceqq_u8(vorrq_u8(sum_lo, sum_hi), vdupq_n_u8(0));
+    uint64_t nibbles = vget_lane_u64(vreinterpret_u64_u8(
+        vshrn_n_u16(vreinterpretq_u16_u8(zero), 4)), 0);
+    uint32_t mask = 0;
+    for (unsigned p = 0; p < 16; p++) {
+      mask |= (uint32_t)((nibbles >> (4 * p)) & 1u) << p;
     }
+    if (chien_collect(mask, i0, len, deg, error_positions, &found)) break;
+  }
+
+  return found;
+}
+#endif
+
+static int chien_search(const bch_ctx *c, const uint16_t *lambda, unsigned deg,
+                        unsigned len, uint32_t *scratch, uint32_t *error_positions) {
+#ifdef BCH_CHIEN_SIMD
+  unsigned lanes = c->chien_lanes;
+  const uint8_t *tab = c->chien_tab;
+  if (lanes == BCH_CHIEN_CPU) {
+    lanes = chien_select_lanes();
+    if (lanes == 16) tab += (size_t)BCH_CHIEN_SIMD_T(c->t) * 128;
+  }
+#endif
+#ifdef BCH_CHIEN_X86
+  if (lanes == 32 && deg <= BCH_CHIEN_SIMD_MAX_T) {
+    return chien_avx2(c, tab, lambda, deg, len, error_positions);
+  }
+  if (lanes == 16 && deg <= BCH_CHIEN_SIMD_MAX_T) {
+    return chien_ssse3(c, tab, lambda, deg, len, error_positions);
   }
+#elif defined(BCH_CHIEN_NEON)
+  if (lanes == 16 && deg <= BCH_CHIEN_SIMD_MAX_T) {
+    return chien_neon(c, tab, lambda, deg, len, error_positions);
+  }
+#endif
+
+  return chien_scalar(c, lambda, deg, len, scratch, error_positions);
+}
+
+/* Decode scratch carved out of one workspace buffer, see bch_ctx_workspace_size() */
+typedef struct {
+  void *buf;            /* caller workspace, or allocated on the first dirty block */
+  size_t size;
+  int owned;
+  uint32_t *positions;  /* t error positions */
+  uint32_t *chien;      /* 2t scalar Chien registers */
+  uint16_t *syndromes;  /* 2t syndromes per lane */
+  uint16_t *lambda;     /* t + 1 error locator coefficients per lane */
+  uint16_t *bm;         /* t + 1 Berlekamp-Massey B(x) coefficients per lane */
+} decode_ws;
+
+size_t bch_ctx_workspace_size(const bch_ctx *c) {
+  if (!c) return 0;
+  size_t t = c->t;
+  return 3 * t * sizeof(uint32_t) + BCH_BM_LANES * (4 * t + 2) * sizeof(uint16_t);
+}
 
-  poly_gf2m_free(&B);
+static codectk_err ws_acquire(const bch_ctx *c, decode_ws *ws) {
+  if (ws->positions) return CODECTK_OK;
+
+  size_t need = bch_ctx_workspace_size(c);
+  if (!ws->buf) {
+    ws->buf = malloc(need);
+    if (!ws->buf) return CODECTK_ENOMEM;
+    ws->size = need;
+    ws->owned = 1;
+  }
+
+  uint32_t *w32 = (uint32_t*)ws->buf;
+  ws->positions = w32;
+  ws->chien = w32 + c->t;
+  ws->syndromes = (uint16_t*)(w32 + 3 * c->t);
+  ws->lambda = ws->syndromes + BCH_BM_LANES * 2 * c->t;
+  ws->bm = ws->lambda + BCH_BM_LANES * (c->t + 1);
+  return CODECTK_OK;
 }
 
 /**
- * Chien search: find roots of error locator polynomial.
- * For binary BCH, we check if Λ(α^{-i}) = 0 for i = 0, 1, ..., n-1.
- * If yes, then position i has an error.
+ * Copy the message bits of one codeword of len bits at bit offset in_off
+ * to out_off (the output must be zeroed) and leave x^r * c(x) mod g(x) in
+ * rem. Returns nonzero if the remainder, and so the syndrome, is nonzero.
  */
-static void chien_search(uint8_t *error_positions, int *num_errors,
-                         const poly_gf2m_t *lambda, unsigned n, const gf2m_ctx *ctx) {
-  *num_errors = 0;
-
-  /* For each possible position i in [0, n-1] */
-  for (unsigned i = 0; i < n; i++) {
-    /* Evaluate Λ(α^{-i}) = Λ(α^{n-i}) since α^n = 1 */
-    unsigned exponent = (n - i) % n;
-    uint16_t alpha_inv = (exponent == 0) ? 1 : ctx->alog[exponent];
-
-    uint16_t eval = poly_gf2m_eval(lambda, alpha_inv);
-
-    if (eval == 0) {
-      /* Error at position i */
-      if (*num_errors < 256) {
-        error_positions[*num_errors] = (uint8_t)i;
-        (*num_errors)++;
+static uint64_t block_remainder(const bch_ctx *c, const uint8_t *in, size_t in_off,
+                                unsigned len, uint8_t *out, size_t out_off, uint64_t *rem) {
+  unsigned msg_len = len - c->r;
+
+  /* The message bits are copied through in the same pass; errors are
+   * flipped in place once located */
+  lfsr_run(c, rem, in, in_off, msg_len, out, out_off);
+  lfsr_run(c, rem, in, in_off + msg_len, c->r, NULL, 0);
+
+  uint64_t any = 0;
+  for (unsigned w = 0; w < c->words; w++) any |= rem[w];
+  return any;
+}
+
+/* A dirty codeword waiting for its lane of Berlekamp-Massey */
+typedef struct {
+  unsigned len;
+  size_t out_off;
+} pending_block;
+
+/**
+ * Correct the count codewords in pend, whose syndromes fill the first
+ * count lanes of ws:
+ *
+ * 1. Berlekamp-Massey on all lanes at once gives each error locator Λ(x)
+ * 2. Chien search finds each codeword's error positions
+ * 3. For binary BCH, all errors have value 1, so just flip the bits
+ *
+ * Returns CODECTK_EDECODE if any codeword had more than t errors; its
+ * message bits stay uncorrected.
+ */
+static codectk_err correct_blocks(const bch_ctx *c, decode_ws *ws, const pending_block *pend,
+                                  unsigned count, uint8_t *out, size_t *corrected) {
+  unsigned t = c->t;
+  unsigned len[BCH_BM_LANES];
+  codectk_err result = CODECTK_OK;
+
+  CODECTK_STATS_T0(t0);
+  berlekamp_massey(&c->field, t, count, ws->syndromes, ws->lambda, len, ws->bm);
+  CODECTK_STATS_STAGE(BCH, KEY_EQUATION, t0);
+
+  for (unsigned w = 0; w < count; w++) {
+    const uint16_t *lambda = ws->lambda + (size_t)w * (t + 1);
+    int deg = (int)t;
+    while (deg >= 0 && lambda[deg] == 0) deg--;
+
+    /* deg Λ must be the length L <= t found by Berlekamp-Massey, and
+     * every root must lie inside the codeword, otherwise there were more
+     * than t errors */
+    int num_errors = 0;
+    if (deg > 0 && (unsigned)deg == len[w]) {
+      CODECTK_STATS_RESTART(t0);
+      num_errors = chien_search(c, lambda, (unsigned)deg, pend[w].len, ws->chien,
+                                ws->positions);
+      CODECTK_STATS_STAGE(BCH, ROOTS, t0);
+    }
+    if (deg <= 0 || (unsigned)deg != len[w] || num_errors != deg) {
+      CODECTK_STATS_FAILURES(BCH, 1);
+      result = CODECTK_EDECODE;
+      continue;
+    }
+    CODECTK_STATS_WORDS(BCH, (size_t)num_errors, 1);
+
+    /* Flip error bits; errors in the parity part are counted but not
+     * output */
+    unsigned msg_len = pend[w].len - c->r;
+    for (int i = 0; i < num_errors; i++) {
+      uint32_t pos = ws->positions[i];
+      if (pos < msg_len) {
+        size_t bit = pend[w].out_off + pos;
+        out[bit / 8] ^= (uint8_t)(1u << (bit % 8));
       }
     }
+    *corrected += (size_t)num_errors;
+  }
+  return result;
+}
+
+/*
+ * Parallel decode on the shared executor. A task covers a run of whole
+ * codewords, a multiple of 8 of them so that every task starts on a byte
+ * both in the input and in the output, and decodes it with its worker's
+ * slice of one scratch block. Batches are split into runs of items the
+ * same way. Clean codewords cost far less than dirty ones, which is what
+ * the executor's stealing evens out.
+ */
+#define BCH_TASK_BITS 65536  /* least input bits per parallel task */
+
+/* bch_ctx_decode_ws(), or the specialized decoder of a fixed context */
+typedef codectk_err (*bch_decode_fn)(const bch_ctx *c, bch_pad pad, const uint8_t *in,
+                                     size_t in_bits, uint8_t *out, size_t *out_bits,
+                                     size_t *num_corrected, void *workspace,
+                                     size_t workspace_size);
+
+typedef struct {
+  const bch_ctx *c;
+  bch_decode_fn decode;  /* runs each task serially */
+  bch_pad pad;
+  const uint8_t *in;
+  size_t in_bits;
+  uint8_t *out;
+  codectk_batch_item *items;
+  size_t count;
+  size_t per_task;     /* codewords (stream) or items (batch) per task */
+  size_t tasks;
+  uint8_t *ws;         /* one slice of ws_stride bytes per worker */
+  size_t ws_stride;
+  size_t *corrected;   /* per task (stream) */
+} bch_par;
+
+static size_t ws_stride(const bch_ctx *c) {
+  return (bch_ctx_workspace_size(c) + 7) & ~(size_t)7;
+}
+
+/* Scratch for every worker of ex, or NULL if parallel decode is not worth it */
+static uint8_t *par_workspace(const bch_ctx *c, codectk_executor *ex, size_t tasks,
+                              size_t extra) {
+  if (tasks < 2 || codectk_executor_threads(ex) < 2) return NULL;
+  return (uint8_t*)malloc(codectk_executor_threads(ex) * ws_stride(c) + extra);
+}
+
+static codectk_err stream_task(void *ctx, size_t i, unsigned worker) {
+  bch_par *p = (bch_par*)ctx;
+  const bch_ctx *c = p->c;
+  size_t start = i * p->per_task * c->n;
+  /* The last task also takes the trailing partial codeword */
+  size_t bits = (i + 1 == p->tasks) ? p->in_bits - start : p->per_task * c->n;
+  size_t out_bits = SIZE_MAX;
+  return p->decode(c, p->pad, p->in + start / 8, bits,
+                           p->out + i * p->per_task * c->k / 8, &out_bits,
+                           &p->corrected[i], p->ws + worker * p->ws_stride, p->ws_stride);
+}
+
+static codectk_err batch_task(void *ctx, size_t i, unsigned worker) {
+  bch_par *p = (bch_par*)ctx;
+  size_t end = (i + 1) * p->per_task < p->count ? (i + 1) * p->per_task : p->count;
+  for (size_t j = i * p->per_task; j < end; j++) {
+    codectk_batch_item *it = &p->items[j];
+    it->num_corrected = 0;
+    it->err = p->decode(p->c, p->pad, it->in, it->in_bits, it->out, &it->out_bits,
+                        &it->num_corrected, p->ws + worker * p->ws_stride, p->ws_stride);
   }
+  return CODECTK_OK;
 }
 
 /**
  * BCH Decoder
  *
- * 1. Compute syndromes S_1, S_3, ..., S_{2t-1}
- * 2. Use Berlekamp-Massey to find error locator polynomial Λ(x)
- * 3. Use Chien search to find error positions
- * 4. For binary BCH, all errors have value 1, so just flip the bits
+ * Splits the input into n-bit codewords and writes k message bits for each.
+ * With BCH_PAD_SHORTEN a trailing partial codeword longer than r bits is
+ * decoded as a shortened codeword; with BCH_PAD_ZERO a trailing partial
+ * codeword (e.g. byte padding) is ignored.
+ *
+ * Uncorrectable codewords are passed through uncorrected and the remaining
+ * codewords are still decoded; the call then returns CODECTK_EDECODE.
+ * num_corrected is the total over all codewords. Parallel tasks decode
+ * their runs with self.
  */
-static codectk_err bch_decode(const void *pp, const uint8_t *in, size_t in_bits,
-                              uint8_t *out, size_t *out_bits, size_t *corr) {
-  const bch_params *P = (const bch_params*)pp;
+static inline codectk_err decode_stream(const bch_ctx *c, bch_decode_fn self, bch_pad pad,
+                                        const uint8_t *in, size_t in_bits,
+                                        uint8_t *out, size_t *out_bits,
+                                        size_t *num_corrected,
+                                        void *workspace, size_t workspace_size) {
+  if (!c || !out_bits || (in_bits && (!in || !out))) return CODECTK_EINVAL;
+  if (workspace && workspace_size < bch_ctx_workspace_size(c)) return CODECTK_EINVAL;
+
+  size_t blocks = in_bits / c->n;
+  size_t tail = in_bits % c->n;
+
+  if (pad == BCH_PAD_ZERO) {
+    tail = 0;
+  } else if (tail && tail <= c->r) {
+    return CODECTK_EINVAL;  /* too short to be a codeword */
+  }
 
-  if (!P || !in || !out || !out_bits) return CODECTK_EINVAL;
-  if (P->m < 2 || P->m > 16 || P->t == 0) return CODECTK_EINVAL;
+  size_t total_bits = blocks * c->k + (tail ? tail - c->r : 0);
+  size_t total_bytes = (total_bits + 7) / 8;
+  if (total_bytes > (*out_bits) / 8) return CODECTK_ENOMEM;
+
+  /* Without caller scratch, long streams are decoded in parallel */
+  if (!workspace) {
+    codectk_executor *ex = codectk_executor_shared();
+    size_t per = (BCH_TASK_BITS / c->n + 7) & ~(size_t)7;
+    if (per == 0) per = 8;
+    size_t tasks = (blocks + per - 1) / per;
+    unsigned threads = codectk_executor_threads(ex);
+    uint8_t *buf = par_workspace(c, ex, tasks, tasks * sizeof(size_t));
+    if (buf) {
+      bch_par p = {c, self, pad, in, in_bits, out, NULL, 0, per, tasks, buf, ws_stride(c),
+                   (size_t*)(buf + threads * ws_stride(c))};
+      codectk_err err = codectk_executor_run(ex, tasks, 0, stream_task, &p);
+      size_t corrected = 0;
+      for (size_t i = 0; i < tasks; i++) corrected += p.corrected[i];
+      free(buf);
+
+      *out_bits = total_bits;
+      if (num_corrected) *num_corrected = corrected;
+      return err;
+    }
+  }
+
+  if (total_bytes) memset(out, 0, total_bytes);
+
+  decode_ws ws = {workspace, workspace_size, 0, NULL, NULL, NULL, NULL, NULL};
+  pending_block pend[BCH_BM_LANES];
+  unsigned npend = 0;
+  size_t corrected = 0;
+  codectk_err result = CODECTK_OK;
+  size_t in_off = 0, out_off = 0;
+
+  /* Dirty codewords are queued, syndromes computed, until a full set of
+   * lanes goes through Berlekamp-Massey together. The syndrome stage is
+   * timed once per set of lanes. */
+  CODECTK_STATS_T0(t0);
+  for (size_t b = 0; b <= blocks; b++) {
+    unsigned len = (b < blocks) ? c->n : (unsigned)tail;
+    if (len == 0) break;
+
+    uint64_t rem[BCH_MAX_PARITY_BITS / 64] = {0};
+    if (block_remainder(c, in, in_off, len, out, out_off, rem)) {
+      if (ws_acquire(c, &ws) != CODECTK_OK) return CODECTK_ENOMEM;
+      compute_syndromes(c, rem, ws.syndromes + (size_t)npend * 2 * c->t);
+      pend[npend].len = len;
+      pend[npend].out_off = out_off;
+      if (++npend == BCH_BM_LANES) {
+        CODECTK_STATS_STAGE(BCH, SYNDROME, t0);
+        if (correct_blocks(c, &ws, pend, npend, out, &corrected) != CODECTK_OK) {
+          result = CODECTK_EDECODE;
+        }
+        npend = 0;
+        CODECTK_STATS_RESTART(t0);
+      }
+    } else {
+      CODECTK_STATS_WORDS(BCH, 0, 1);
+    }
 
-  /* Initialize field context */
-  gf2m_ctx ctx;
+    in_off += len;
+    out_off += len - c->r;
+  }
+  CODECTK_STATS_STAGE(BCH, SYNDROME, t0);
+  if (npend && correct_blocks(c, &ws, pend, npend, out, &corrected) != CODECTK_OK) {
+    result = CODECTK_EDECODE;
+  }
 
-  uint16_t prim_polys[] = {
-    0, 0, 0x7, 0xB, 0x13, 0x25, 0x43, 0x89,
-    0x11D, 0x211, 0x409, 0x805, 0x1053, 0x201B, 0x4443, 0x8003, 0x100B
-  };
+  if (ws.owned) free(ws.buf);
 
-  if (P->m >= sizeof(prim_polys) / sizeof(prim_polys[0])) {
-    return CODECTK_EINVAL;
+  *out_bits = total_bits;
+  if (num_corrected) *num_corrected = corrected;
+  return result;
+}
+
+codectk_err bch_ctx_decode_ws(const bch_ctx *c, bch_pad pad,
+                              const uint8_t *in, size_t in_bits,
+                              uint8_t *out, size_t *out_bits, size_t *num_corrected,
+                              void *workspace, size_t workspace_size) {
+  return decode_stream(c, bch_ctx_decode_ws, pad, in, in_bits, out, out_bits, num_corrected,
+                       workspace, workspace_size);
+}
+
+codectk_err bch_ctx_decode(const bch_ctx *c, bch_pad pad,
+                           const uint8_t *in, size_t in_bits,
+                           uint8_t *out, size_t *out_bits, size_t *num_corrected) {
+  return bch_ctx_decode_ws(c, pad, in, in_bits, out, out_bits, num_corrected, NULL, 0);
+}
+
+/* bch_ctx_decode_batch() with each item, or run of items, decoded by self */
+static codectk_err decode_items(const bch_ctx *c, bch_decode_fn self, bch_pad pad,
+                                codectk_batch_item *items, size_t count,
+                                void *workspace, size_t workspace_size) {
+  if (!c || (count && !items)) return CODECTK_EINVAL;
+  if (workspace && workspace_size < bch_ctx_workspace_size(c)) return CODECTK_EINVAL;
+
+  /* Without caller scratch, runs of items are decoded in parallel */
+  if (!workspace && count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) total += items[i].in_bits;
+    size_t per = BCH_TASK_BITS / (total / count + 1);
+    if (per == 0) per = 1;
+    size_t tasks = (count + per - 1) / per;
+    codectk_executor *ex = codectk_executor_shared();
+    uint8_t *buf = par_workspace(c, ex, tasks, 0);
+    if (buf) {
+      bch_par p = {c, self, pad, NULL, 0, NULL, items, count, per, tasks, buf, ws_stride(c),
+                   NULL};
+      codectk_executor_run(ex, tasks, 0, batch_task, &p);
+      free(buf);
+
+      codectk_err first = CODECTK_OK;
+      for (size_t i = 0; i < count && first == CODECTK_OK; i++) first = items[i].err;
+      return first;
+    }
   }
 
-  if (gf2m_ctx_init(&ctx, P->m, prim_polys[P->m]) != 0) {
-    return CODECTK_ENOMEM;
+  void *owned = NULL;
+  if (!workspace && count) {
+    workspace_size = bch_ctx_workspace_size(c);
+    owned = workspace = malloc(workspace_size);
   }
 
-  unsigned n = (1U << P->m) - 1;
+  codectk_err first = CODECTK_OK;
+  for (size_t i = 0; i < count; i++) {
+    codectk_batch_item *it = &items[i];
+    it->num_corrected = 0;
+    it->err = workspace ? self(c, pad, it->in, it->in_bits, it->out, &it->out_bits,
+                               &it->num_corrected, workspace, workspace_size)
+                        : CODECTK_ENOMEM;
+    if (first == CODECTK_OK) first = it->err;
+  }
 
-  if (in_bits < n) {
-    gf2m_ctx_free(&ctx);
-    return CODECTK_EINVAL;
+  free(owned);
+  return first;
+}
+
+codectk_err bch_ctx_decode_batch(const bch_ctx *c, bch_pad pad,
+                                 codectk_batch_item *items, size_t count,
+                                 void *workspace, size_t workspace_size) {
+  return decode_items(c, bch_ctx_decode_ws, pad, items, count, workspace, workspace_size);
+}
+
+/*
+ * Constant-time decode: 64 codewords of one length N per pass, one per
+ * lane of gf2m_bs arithmetic. Lane w's codeword is kept as words at
+ * R + w * nw (bit p = stream bit p) and its errors at E + w * nw; 64 x 64
+ * transposes turn a block of 64 positions into position masks (bit w =
+ * lane w) and back. Stream position p is the coefficient of x^(N-1-p), so
+ * the field constants of a position are public and only the lane masks
+ * are secret.
+ */
+
+typedef struct {
+  gf2m_bs *S;      /* 2t syndromes, reversed: S[2t - j] = S_j */
+  gf2m_bs *C;      /* t + 1 error locator coefficients */
+  gf2m_bs *B;      /* t + 1 Berlekamp-Massey B(x) coefficients */
+  gf2m_bs *CX;     /* t m Chien products, see ct_chien() */
+  uint64_t *R, *E; /* 64 lanes of nw words */
+  size_t nw;
+} ct_ws;
+
+static void ct_syndromes(const bch_ctx *c, unsigned N, const ct_ws *ws) {
+  const gf2m_ctx *f = &c->field;
+  unsigned t = c->t;
+  uint64_t blk[GF2M_BS_LANES];
+
+  /* Blocks of the codeword only: their count depends on N alone, not the data */
+  memset(ws->S, 0, 2 * t * sizeof(gf2m_bs));
+  for (size_t b = 0; b < (N + 63) / 64; b++) {
+    for (unsigned w = 0; w < GF2M_BS_LANES; w++) blk[w] = ws->R[w * ws->nw + b];
+    gf2m_bs_transpose64(blk);
+
+    unsigned cnt = (N - 64 * b < 64) ? (unsigned)(N - 64 * b) : 64;
+    for (unsigned p = 0; p < cnt; p++) {
+      unsigned d = N - 1 - (unsigned)(64 * b + p);
+      uint64_t mask = blk[p];
+      for (unsigned j = 1; j < 2 * t; j += 2) {
+        uint16_t a = f->alog[(j * d) % c->n];
+        gf2m_bs *s = &ws->S[2 * t - j];
+        for (unsigned q = 0; q < c->m; q++) s->p[q] ^= mask & (0 - (uint64_t)((a >> q) & 1));
+      }
+    }
   }
 
-  /* Build received polynomial r(x) */
-  poly_gf2m_t r;
-  poly_gf2m_init(&r, &ctx, (int)n);
+  /* S_2j = S_j^2 */
+  for (unsigned j = 1; j <= t; j++) gf2m_bs_sqr(f, &ws->S[2 * t - 2 * j], &ws->S[2 * t - j]);
+}
 
-  for (size_t i = 0; i < n; i++) {
-    int byte_idx = (int)(i / 8);
-    int bit_idx = (int)(i % 8);
-    int bit = (in[byte_idx] >> bit_idx) & 1;
+/* berlekamp_massey() on 64 lanes, with gf2m_bs arithmetic and masks */
+static void ct_berlekamp_massey(const bch_ctx *c, const ct_ws *ws, uint32_t *len) {
+  const gf2m_ctx *f = &c->field;
+  unsigned t = c->t;
+  gf2m_bs *C = ws->C, *B = ws->B, gamma, delta, x[2], y[2];
+
+  memset(C, 0, (t + 1) * sizeof(gf2m_bs));
+  memset(B, 0, (t + 1) * sizeof(gf2m_bs));
+  gf2m_bs_set1(&C[0], 1);
+  gf2m_bs_set1(&B[0], 1);
+  gf2m_bs_set1(&gamma, 1);
+  memset(len, 0, GF2M_BS_LANES * sizeof(uint32_t));
+
+  for (uint32_t r = 0; r < t; r++) {
+    /* δ = Σ Λ_i S_(2r+1-i) */
+    unsigned top = (2 * r < t) ? 2 * r : t;
+    gf2m_bs_dot(f, &delta, C, ws->S + 2 * t - 1 - 2 * r, top + 1);
+
+    uint64_t change = 0;
+    for (unsigned w = 0; w < GF2M_BS_LANES; w++) {
+      change |= (uint64_t)((len[w] - r - 1) >> 31) << w;
+    }
+    change &= gf2m_bs_nonzero(&delta);
+
+    /* Λ_i <- γ Λ_i + δ B_(i-1), and B <- x Λ or x^2 B, from the top down */
+    x[0] = gamma;
+    x[1] = delta;
+    for (unsigned i = t; i > 0; i--) {
+      gf2m_bs zero = {{0}};
+      y[0] = C[i];
+      y[1] = B[i - 1];
+      gf2m_bs_select(&B[i], change, &C[i - 1], i >= 2 ? &B[i - 2] : &zero);
+      gf2m_bs_dot(f, &C[i], x, y, 2);
+    }
+    memset(&B[0], 0, sizeof(gf2m_bs));
+    gf2m_bs_mul(f, &C[0], &gamma, &C[0]);
 
-    if (bit) {
-      poly_gf2m_set_coeff(&r, (int)i, 1);
+    gf2m_bs_select(&gamma, change, &delta, &gamma);
+    for (unsigned w = 0; w < GF2M_BS_LANES; w++) {
+      uint32_t mw = 0u - (uint32_t)((change >> w) & 1);
+      len[w] = (len[w] & ~mw) | ((2 * r + 1 - len[w]) & mw);
     }
   }
+}
 
-  /* Compute syndromes S_1, S_3, ..., S_{2t-1} */
-  uint16_t *syndromes = (uint16_t*)calloc(2 * P->t, sizeof(uint16_t));
-  if (!syndromes) {
-    poly_gf2m_free(&r);
-    gf2m_ctx_free(&ctx);
-    return CODECTK_ENOMEM;
+/**
+ * Chien search over all N positions into E. Λ(α^-d) = sum of Λ_j α^(-jd),
+ * and the constants α^(-jd) are public, so with the products Λ_j x^b laid
+ * out beforehand an evaluation is only the XOR of those selected by the
+ * set bits of the constants.
+ */
+static void ct_chien(const bch_ctx *c, unsigned N, const ct_ws *ws) {
+  const gf2m_ctx *f = &c->field;
+  unsigned t = c->t, m = c->m;
+  uint64_t blk[GF2M_BS_LANES];
+
+  /* CX[(j - 1) m + b] = Λ_j x^b */
+  for (unsigned j = 1; j <= t; j++) {
+    gf2m_bs *cx = ws->CX + (size_t)(j - 1) * m;
+    cx[0] = ws->C[j];
+    for (unsigned b = 1; b < m; b++) gf2m_bs_mul_pub(f, &cx[b], &cx[b - 1], 2);
   }
 
-  for (unsigned i = 0; i < 2 * P->t; i++) {
-    /* S_{2i+1} = r(α^{2i+1}) */
-    unsigned exp = 2 * i + 1;
-    uint16_t alpha_power = ctx.alog[exp % n];
-    syndromes[i] = poly_gf2m_eval(&r, alpha_power);
+  /* A shortened codeword has no positions past N: no roots there either */
+  size_t nb = (N + 63) / 64;
+  for (unsigned w = 0; w < GF2M_BS_LANES; w++) {
+    memset(ws->E + w * ws->nw + nb, 0, (ws->nw - nb) * sizeof(uint64_t));
+  }
+  for (size_t b = 0; b < nb; b++) {
+    unsigned cnt = (N - 64 * b < 64) ? (unsigned)(N - 64 * b) : 64;
+    memset(blk, 0, sizeof(blk));
+    for (unsigned p = 0; p < cnt; p++) {
+      unsigned d = N - 1 - (unsigned)(64 * b + p);
+      gf2m_bs sum = ws->C[0];
+      for (unsigned j = 1; j <= t; j++) {
+        const gf2m_bs *cx = ws->CX + (size_t)(j - 1) * m;
+        for (unsigned a = f->alog[(j * (c->n - d)) % c->n]; a; a &= a - 1) {
+          gf2m_bs_add(&sum, &sum, &cx[__builtin_ctz(a)]);
+        }
+      }
+      blk[p] = ~gf2m_bs_nonzero(&sum);
+    }
+    gf2m_bs_transpose64(blk);
+    for (unsigned w = 0; w < GF2M_BS_LANES; w++) ws->E[w * ws->nw + b] = blk[w];
   }
+}
 
-  /* Check if all syndromes are zero (no errors) */
-  int has_errors = 0;
-  for (unsigned i = 0; i < 2 * P->t; i++) {
-    if (syndromes[i] != 0) {
-      has_errors = 1;
-      break;
+/**
+ * Decode count <= 64 codewords of N bits, lane w's at in_off + w N, into
+ * N - r message bits each at out_off + w (N - r) of the zeroed output.
+ * Returns CODECTK_EDECODE if any had more than t errors.
+ */
+static codectk_err ct_pass(const bch_ctx *c, unsigned N, unsigned count, const uint8_t *in,
+                           size_t in_off, uint8_t *out, size_t out_off, const ct_ws *ws,
+                           size_t *corrected) {
+  unsigned t = c->t, msg_len = N - c->r;
+  size_t nw = ws->nw;
+  uint32_t len[GF2M_BS_LANES];
+
+  CODECTK_STATS_T0(t0);
+  memset(ws->R, 0, GF2M_BS_LANES * nw * sizeof(uint64_t));
+  for (unsigned w = 0; w < count; w++) {
+    for (size_t i = 0; 64 * i < N; i++) {
+      unsigned bits = (N - 64 * i < 64) ? (unsigned)(N - 64 * i) : 64;
+      ws->R[w * nw + i] = load_bits(in, in_off + (size_t)w * N + 64 * i, bits);
+    }
+  }
+  CODECTK_STATS_STAGE(BCH, BITIO, t0);
+
+  CODECTK_STATS_RESTART(t0);
+  ct_syndromes(c, N, ws);
+  CODECTK_STATS_STAGE(BCH, SYNDROME, t0);
+  CODECTK_STATS_RESTART(t0);
+  ct_berlekamp_massey(c, ws, len);
+  CODECTK_STATS_STAGE(BCH, KEY_EQUATION, t0);
+  CODECTK_STATS_RESTART(t0);
+  ct_chien(c, N, ws);
+  CODECTK_STATS_STAGE(BCH, ROOTS, t0);
+
+  /* A codeword is corrected iff Λ has L <= t roots among its positions */
+  uint64_t failed = 0;
+  for (unsigned w = 0; w < count; w++) {
+    uint64_t *rw = ws->R + w * nw;
+    const uint64_t *ew = ws->E + w * nw;
+    uint32_t roots = 0;
+    for (size_t i = 0; i < nw; i++) roots += gf2m_bs_popcount64(ew[i]);
+    uint64_t ok = 0 - (uint64_t)((((roots ^ len[w]) - 1) & (len[w] - t - 1)) >> 31);
+
+    for (size_t i = 0; 64 * i < msg_len; i++) {
+      unsigned bits = (msg_len - 64 * i < 64) ? (unsigned)(msg_len - 64 * i) : 64;
+      store_bits(out, out_off + (size_t)w * msg_len + 64 * i, rw[i] ^ (ew[i] & ok), bits);
     }
+    *corrected += len[w] & (uint32_t)ok;
+    failed |= ~ok;
+    if (ok) CODECTK_STATS_WORDS(BCH, len[w], 1);
+    else CODECTK_STATS_FAILURES(BCH, 1);
   }
+  return failed ? CODECTK_EDECODE : CODECTK_OK;
+}
+
+codectk_err bch_ctx_decode_ct(const bch_ctx *c, bch_pad pad,
+                              const uint8_t *in, size_t in_bits,
+                              uint8_t *out, size_t *out_bits, size_t *num_corrected) {
+  if (!c || !out_bits || (in_bits && (!in || !out))) return CODECTK_EINVAL;
+
+  size_t blocks = in_bits / c->n;
+  size_t tail = in_bits % c->n;
 
-  if (!has_errors) {
-    /* No errors, copy input to output */
-    size_t out_bytes = (in_bits + 7) / 8;
-    if (out_bytes > (*out_bits) / 8) {
-      free(syndromes);
-      poly_gf2m_free(&r);
-      gf2m_ctx_free(&ctx);
-      return CODECTK_ENOMEM;
+  if (pad == BCH_PAD_ZERO) {
+    tail = 0;
+  } else if (tail && tail <= c->r) {
+    return CODECTK_EINVAL;  /* too short to be a codeword */
+  }
+
+  size_t total_bits = blocks * c->k + (tail ? tail - c->r : 0);
+  size_t total_bytes = (total_bits + 7) / 8;
+  if (total_bytes > (*out_bits) / 8) return CODECTK_ENOMEM;
+  if (total_bytes) memset(out, 0, total_bytes);
+
+  ct_ws ws;
+  size_t t = c->t;
+  ws.nw = (c->n + 63) / 64;
+  size_t planes = 2 * t + 2 * (t + 1) + t * c->m;
+  void *buf = malloc(planes * sizeof(gf2m_bs) + 2 * GF2M_BS_LANES * ws.nw * sizeof(uint64_t));
+  if (!buf) return CODECTK_ENOMEM;
+  ws.S = (gf2m_bs*)buf;
+  ws.C = ws.S + 2 * t;
+  ws.B = ws.C + t + 1;
+  ws.CX = ws.B + t + 1;
+  ws.R = (uint64_t*)(ws.CX + t * c->m);
+  ws.E = ws.R + GF2M_BS_LANES * ws.nw;
+
+  size_t corrected = 0;
+  codectk_err result = CODECTK_OK;
+  for (size_t b = 0; b < blocks; b += GF2M_BS_LANES) {
+    unsigned count = (blocks - b < GF2M_BS_LANES) ? (unsigned)(blocks - b) : GF2M_BS_LANES;
+    if (ct_pass(c, c->n, count, in, b * c->n, out, b * c->k, &ws, &corrected) != CODECTK_OK) {
+      result = CODECTK_EDECODE;
     }
+  }
+  if (tail && ct_pass(c, (unsigned)tail, 1, in, blocks * c->n, out, blocks * c->k, &ws,
+                      &corrected) != CODECTK_OK) {
+    result = CODECTK_EDECODE;
+  }
+  free(buf);
+
+  *out_bits = total_bits;
+  if (num_corrected) *num_corrected = corrected;
+  return result;
+}
 
-    memcpy(out, in, out_bytes);
-    *out_bits = in_bits;
-    if (corr) *corr = 0;
+/* Codec vtable adapters: use the caller's context, or build one per call */
 
-    free(syndromes);
-    poly_gf2m_free(&r);
-    gf2m_ctx_free(&ctx);
+static codectk_err get_ctx(const bch_params *P, const bch_ctx **c, bch_ctx **owned) {
+  *owned = NULL;
+  if (!P || (P->flags & ~BCH_FLAG_CT)) return CODECTK_EINVAL;
+  if (P->ctx) {
+    *c = P->ctx;
     return CODECTK_OK;
   }
+  CODECTK_STATS_T0(t0);
+  codectk_err err = bch_ctx_create(P->m, P->t, owned);
+  CODECTK_STATS_STAGE(BCH, SETUP, t0);
+  *c = *owned;
+  return err;
+}
 
-  /* Use Berlekamp-Massey to find error locator polynomial */
-  poly_gf2m_t lambda;
-  poly_gf2m_init(&lambda, &ctx, (int)(2 * P->t));
-  berlekamp_massey(&lambda, syndromes, P->t, &ctx);
-
-  /* Use Chien search to find error positions */
-  uint8_t error_positions[256];
-  int num_errors = 0;
-  chien_search(error_positions, &num_errors, &lambda, n, &ctx);
-
-  /* Check if we found too many errors */
-  if (num_errors > (int)P->t) {
-    free(syndromes);
-    poly_gf2m_free(&lambda);
-    poly_gf2m_free(&r);
-    gf2m_ctx_free(&ctx);
-    return CODECTK_EDECODE;
-  }
-
-  /* Copy input to output and flip error bits */
-  size_t out_bytes = (in_bits + 7) / 8;
-  if (out_bytes > (*out_bits) / 8) {
-    free(syndromes);
-    poly_gf2m_free(&lambda);
-    poly_gf2m_free(&r);
-    gf2m_ctx_free(&ctx);
-    return CODECTK_ENOMEM;
-  }
+static codectk_err bch_encode(const void *pp, const uint8_t *in, size_t in_bits,
+                              uint8_t *out, size_t *out_bits) {
+  const bch_ctx *c;
+  bch_ctx *owned;
+  codectk_err err = get_ctx((const bch_params*)pp, &c, &owned);
+  if (err != CODECTK_OK) return err;
+
+  err = bch_ctx_encode(c, ((const bch_params*)pp)->pad, in, in_bits, out, out_bits);
+  bch_ctx_destroy(owned);
+  return err;
+}
+
+static codectk_err bch_decode(const void *pp, const uint8_t *in, size_t in_bits,
+                              uint8_t *out, size_t *out_bits, size_t *corr) {
+  CODECTK_STATS_CALL(BCH);
+  const bch_ctx *c;
+  bch_ctx *owned;
+  codectk_err err = get_ctx((const bch_params*)pp, &c, &owned);
+  if (err != CODECTK_OK) return err;
+
+  const bch_params *P = (const bch_params*)pp;
+  err = (P->flags & BCH_FLAG_CT)
+            ? bch_ctx_decode_ct(c, P->pad, in, in_bits, out, out_bits, corr)
+            : bch_ctx_decode(c, P->pad, in, in_bits, out, out_bits, corr);
+  bch_ctx_destroy(owned);
+  return err;
+}
 
-  memcpy(out, in, out_bytes);
+/* Batch adapters: one context (and one workspace) for the whole batch */
 
-  /* Flip error bits (binary BCH: all errors have value 1) */
-  for (int i = 0; i < num_errors; i++) {
-    unsigned pos = error_positions[i];
-    int byte_idx = (int)(pos / 8);
-    int bit_idx = (int)(pos % 8);
-    out[byte_idx] ^= (uint8_t)(1 << bit_idx);
+static codectk_err fail_batch(codectk_batch_item *items, size_t count, codectk_err err) {
+  for (size_t i = 0; i < count; i++) {
+    items[i].num_corrected = 0;
+    items[i].err = err;
+  }
+  return count ? err : CODECTK_OK;
+}
+
+static codectk_err bch_encode_batch(const void *pp, codectk_batch_item *items,
+                                    size_t count) {
+  const bch_ctx *c;
+  bch_ctx *owned;
+  codectk_err err = get_ctx((const bch_params*)pp, &c, &owned);
+  if (err != CODECTK_OK) return fail_batch(items, count, err);
+
+  codectk_err first = CODECTK_OK;
+  for (size_t i = 0; i < count; i++) {
+    codectk_batch_item *it = &items[i];
+    it->num_corrected = 0;
+    it->err = bch_ctx_encode(c, ((const bch_params*)pp)->pad, it->in, it->in_bits,
+                             it->out, &it->out_bits);
+    if (first == CODECTK_OK) first = it->err;
   }
 
-  *out_bits = in_bits;
-  if (corr) *corr = (size_t)num_errors;
+  bch_ctx_destroy(owned);
+  return first;
+}
 
-  /* Cleanup */
-  free(syndromes);
-  poly_gf2m_free(&lambda);
-  poly_gf2m_free(&r);
-  gf2m_ctx_free(&ctx);
+static codectk_err bch_decode_batch(const void *pp, codectk_batch_item *items,
+                                    size_t count) {
+  CODECTK_STATS_CALL(BCH);
+  const bch_ctx *c;
+  bch_ctx *owned;
+  codectk_err err = get_ctx((const bch_params*)pp, &c, &owned);
+  if (err != CODECTK_OK) return fail_batch(items, count, err);
 
-  return CODECTK_OK;
+  const bch_params *P = (const bch_params*)pp;
+  if (P->flags & BCH_FLAG_CT) {
+    err = CODECTK_OK;
+    for (size_t i = 0; i < count; i++) {
+      codectk_batch_item *it = &items[i];
+      it->num_corrected = 0;
+      it->err = bch_ctx_decode_ct(c, P->pad, it->in, it->in_bits, it->out, &it->out_bits,
+                                  &it->num_corrected);
+      if (err == CODECTK_OK) err = it->err;
+    }
+  } else {
+    err = bch_ctx_decode_batch(c, P->pad, items, count, NULL, 0);
+  }
+  bch_ctx_destroy(owned);
+  return err;
 }
 
 static const codectk_codec BCH = {
   .name = "bch",
   .encode = bch_encode,
-  .decode = bch_decode
+  .decode = bch_decode,
+  .encode_batch = bch_encode_batch,
+  .decode_batch = bch_decode_batch
 };
 
 const codectk_codec* bch_codec(void) {
   return &BCH;
 }
+
+#ifdef CODECTK_FIXED_CODECS
+#include "codectk_fixed.h"
+
+/*
+ * Built-in fixed parameter sets (CODECTK_FIXED_CODECS). Each context is a
+ * static const object generated by tools/gen_fixed_codecs.c, so nothing is
+ * built at run time, and each set's encoder and serial decoder are
+ * flattened over it: t, r, n, words and the table pointers become
+ * constants, the LFSR, syndrome and Berlekamp-Massey loops are unrolled
+ * and the reductions mod n are by a constant. Constant-time decode uses
+ * the fixed context with the generic bitsliced decoder.
+ */
+
+typedef codectk_err (*bch_encode_fn)(const bch_ctx *c, bch_pad pad, const uint8_t *in,
+                                     size_t in_bits, uint8_t *out, size_t *out_bits);
+
+typedef struct {
+  const bch_ctx *c;
+  bch_encode_fn encode;
+  bch_decode_fn decode;
+} fixed_bch;
+
+/* params are optional; pad and flags are read, m and t must be 0 or the set's */
+static codectk_err fixed_params(const fixed_bch *f, const void *pp, bch_params *P) {
+  bch_params none = {0, 0, NULL, BCH_PAD_SHORTEN, 0};
+  *P = pp ? *(const bch_params*)pp : none;
+  if ((P->flags & ~BCH_FLAG_CT) || P->ctx || (P->m && P->m != f->c->m) ||
+      (P->t && P->t != f->c->t)) {
+    return CODECTK_EINVAL;
+  }
+  return CODECTK_OK;
+}
+
+static codectk_err fixed_encode(const fixed_bch *f, const void *pp, const uint8_t *in,
+                                size_t in_bits, uint8_t *out, size_t *out_bits) {
+  bch_params P;
+  codectk_err err = fixed_params(f, pp, &P);
+  if (err != CODECTK_OK) return err;
+  return f->encode(f->c, P.pad, in, in_bits, out, out_bits);
+}
+
+static codectk_err fixed_decode(const fixed_bch *f, const void *pp, const uint8_t *in,
+                                size_t in_bits, uint8_t *out, size_t *out_bits, size_t *corr) {
+  CODECTK_STATS_CALL(BCH);
+  bch_params P;
+  codectk_err err = fixed_params(f, pp, &P);
+  if (err != CODECTK_OK) return err;
+  if (P.flags & BCH_FLAG_CT) {
+    return bch_ctx_decode_ct(f->c, P.pad, in, in_bits, out, out_bits, corr);
+  }
+  return f->decode(f->c, P.pad, in, in_bits, out, out_bits, corr, NULL, 0);
+}
+
+static codectk_err fixed_encode_batch(const fixed_bch *f, const void *pp,
+                                      codectk_batch_item *items, size_t count) {
+  bch_params P;
+  codectk_err err = fixed_params(f, pp, &P);
+  if (err != CODECTK_OK) return fail_batch(items, count, err);
+
+  codectk_err first = CODECTK_OK;
+  for (size_t i = 0; i < count; i++) {
+    codectk_batch_item *it = &items[i];
+    it->num_corrected = 0;
+    it->err = f->encode(f->c, P.pad, it->in, it->in_bits, it->out, &it->out_bits);
+    if (first == CODECTK_OK) first = it->err;
+  }
+  return first;
+}
+
+static codectk_err fixed_decode_batch(const fixed_bch *f, const void *pp,
+                                      codectk_batch_item *items, size_t count) {
+  CODECTK_STATS_CALL(BCH);
+  bch_params P;
+  codectk_err err = fixed_params(f, pp, &P);
+  if (err != CODECTK_OK) return fail_batch(items, count, err);
+  if (!(P.flags & BCH_FLAG_CT)) {
+    return decode_items(f->c, f->decode, P.pad, items, count, NULL, 0);
+  }
+
+  codectk_err first = CODECTK_OK;
+  for (size_t i = 0; i < count; i++) {
+    codectk_batch_item *it = &items[i];
+    it->num_corrected = 0;
+    it->err = bch_ctx_decode_ct(f->c, P.pad, it->in, it->in_bits, it->out, &it->out_bits,
+                                &it->num_corrected);
+    if (first == CODECTK_OK) first = it->err;
+  }
+  return first;
+}
+
+/* One set: its context, the flattened entry points and the vtable */
+#define FIXED_BCH_SET(M, T, CTX)                                                          \
+  static const bch_ctx fixed_ctx_##M##_##T = CTX;                                         \
+  __attribute__((flatten)) static codectk_err fixed_encode_##M##_##T(                     \
+      const bch_ctx *c, bch_pad pad, const uint8_t *in, size_t in_bits, uint8_t *out,     \
+      size_t *out_bits) {                                                                 \
+    (void)c;                                                                              \
+    return bch_ctx_encode(&fixed_ctx_##M##_##T, pad, in, in_bits, out, out_bits);         \
+  }                                                                                       \
+  __attribute__((flatten)) static codectk_err fixed_decode_##M##_##T(                     \
+      const bch_ctx *c, bch_pad pad, const uint8_t *in, size_t in_bits, uint8_t *out,     \
+      size_t *out_bits, size_t *corr, void *ws, size_t ws_size) {                         \
+    (void)c;                                                                              \
+    return decode_stream(&fixed_ctx_##M##_##T, fixed_decode_##M##_##T, pad, in, in_bits,  \
+                         out, out_bits, corr, ws, ws_size);                               \
+  }                                                                                       \
+  static const fixed_bch fixed_##M##_##T = {&fixed_ctx_##M##_##T, fixed_encode_##M##_##T, \
+                                            fixed_decode_##M##_##T};                      \
+  static codectk_err fixed_enc_##M##_##T(const void *pp, const uint8_t *in,               \
+                                         size_t in_bits, uint8_t *out, size_t *out_bits) { \
+    return fixed_encode(&fixed_##M##_##T, pp, in, in_bits, out, out_bits);                \
+  }                                                                                       \
+  static codectk_err fixed_dec_##M##_##T(const void *pp, const uint8_t *in,               \
+                                         size_t in_bits, uint8_t *out, size_t *out_bits,  \
+                                         size_t *corr) {                                  \
+    return fixed_decode(&fixed_##M##_##T, pp, in, in_bits, out, out_bits, corr);          \
+  }                                                                                       \
+  static codectk_err fixed_enc_batch_##M##_##T(const void *pp, codectk_batch_item *items, \
+                                               size_t count) {                            \
+    return fixed_encode_batch(&fixed_##M##_##T, pp, items, count);                        \
+  }                                                                                       \
+  static codectk_err fixed_dec_batch_##M##_##T(const void *pp, codectk_batch_item *items, \
+                                               size_t count) {                            \
+    return fixed_decode_batch(&fixed_##M##_##T, pp, items, count);                        \
+  }                                                                                       \
+  static const codectk_codec fixed_codec_##M##_##T = {                                    \
+    .name = "bch-" #M "-" #T,                                                             \
+    .encode = fixed_enc_##M##_##T,                                                        \
+    .decode = fixed_dec_##M##_##T,                                                        \
+    .encode_batch = fixed_enc_batch_##M##_##T,                                            \
+    .decode_batch = fixed_dec_batch_##M##_##T                                             \
+  };
+
+CODECTK_FIXED_BCH(FIXED_BCH_SET)
+
+#define FIXED_BCH_ENTRY(M, T, CTX) &fixed_##M##_##T,
+#define FIXED_BCH_CODEC(M, T, CTX) &fixed_codec_##M##_##T,
+static const fixed_bch *const fixed_sets[] = {CODECTK_FIXED_BCH(FIXED_BCH_ENTRY)};
+static const codectk_codec *const fixed_codecs[] = {CODECTK_FIXED_BCH(FIXED_BCH_CODEC)};
+
+/* Index of the set called name, or -1 */
+static int fixed_find(const char *name) {
+  if (!name) return -1;
+  for (size_t i = 0; i < sizeof(fixed_codecs) / sizeof(fixed_codecs[0]); i++) {
+    if (!strcmp(name, fixed_codecs[i]->name)) return (int)i;
+  }
+  return -1;
+}
+
+const codectk_codec* bch_fixed_codec(const char *name) {
+  int i = fixed_find(name);
+  return i < 0 ? NULL : fixed_codecs[i];
+}
+
+const bch_ctx* bch_fixed_ctx(const char *name) {
+  int i = fixed_find(name);
+  return i < 0 ? NULL : fixed_sets[i]->c;
+}
+
+#else /* !CODECTK_FIXED_CODECS */
+
+const codectk_codec* bch_fixed_codec(const char *name) {
+  (void)name;
+  return NULL;
+}
+
+const bch_ctx* bch_fixed_ctx(const char *name) {
+  (void)name;
+  return NULL;
+}
+
+#endif
@@ -0,0 +1,285 @@
+/**
+ * executor.c - Work-stealing task executor
+ *
+ * Each participating thread owns a range of task indices packed into one
+ * 64-bit word (low half: next task, high half: end). The owner pops from
+ * the front and thieves cut the back half off with a compare-and-swap on
+ * the same word, so neither side takes a lock. The word fully describes
+ * the tasks not yet taken, which makes a stale compare-and-swap that
+ * happens to see an equal value still correct.
+ */
+
+#include "../include/executor.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Largest run handled in one pass of packed 32-bit ranges */
+#define EX_SLICE ((size_t)UINT32_MAX)
+
+typedef struct {
+  _Alignas(64) _Atomic uint64_t range;
+} ex_deque;
+
+typedef struct {
+  codectk_executor *ex;
+  unsigned id;
+} ex_worker;
+
+struct codectk_executor {
+  ex_deque deque[CODECTK_EXECUTOR_MAX_THREADS];
+  unsigned threads;
+  unsigned started;  /* worker threads, excluding the caller */
+  pthread_t tid[CODECTK_EXECUTOR_MAX_THREADS];
+  ex_worker worker[CODECTK_EXECUTOR_MAX_THREADS];
+
+  pthread_mutex_t run_lock;  /* one run at a time */
+  pthread_mutex_t lock;      /* guards the fields below */
+  pthread_cond_t wake, done;
+  unsigned long generation;
+  unsigned participants, active;
+  int quit;
+
+  /* Current run */
+  codectk_task_fn fn;
+  void *ctx;
+  size_t base;
+  atomic_size_t remaining;
+  size_t err_task;
+  codectk_err err;
+};
+
+/* Set while a thread runs tasks, so that nested runs stay inline */
+static _Thread_local int tl_in_task;
+
+static inline uint64_t pack(uint32_t lo, uint32_t hi) {
+  return (uint64_t)lo | ((uint64_t)hi << 32);
+}
+
+static int pop_own(ex_deque *d, size_t *i) {
+  uint64_t v = atomic_load(&d->range);
+  for (;;) {
+    uint32_t lo = (uint32_t)v, hi = (uint32_t)(v >> 32);
+    if (lo >= hi) return 0;
+    if (atomic_compare_exchange_weak(&d->range, &v, pack(lo + 1, hi))) {
+      *i = lo;
+      return 1;
+    }
+  }
+}
+
+/* Move the back half of some other deque into self's (empty) one */
+static int steal(codectk_executor *ex, unsigned self) {
+  unsigned n = ex->participants;
+  for (unsigned k = 1; k < n; k++) {
+    ex_deque *victim = &ex->deque[(self + k) % n];
+    uint64_t v = atomic_load(&victim->range);
+    for (;;) {
+      uint32_t lo = (uint32_t)v, hi = (uint32_t)(v >> 32);
+      if (lo >= hi) break;
+      uint32_t mid = hi - (hi - lo + 1) / 2;
+      if (atomic_compare_exchange_weak(&victim->range, &v, pack(lo, mid))) {
+        atomic_store(&ex->deque[self].range, pack(mid, hi));
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+static void record(codectk_executor *ex, size_t i, codectk_err e) {
+  pthread_mutex_lock(&ex->lock);
+  if (ex->err == CODECTK_OK || i < ex->err_task) {
+    ex->err = e;
+    ex->err_task = i;
+  }
+  pthread_mutex_unlock(&ex->lock);
+}
+
+static void participate(codectk_executor *ex, unsigned self) {
+  tl_in_task = 1;
+  for (;;) {
+    size_t i;
+    if (pop_own(&ex->deque[self], &i)) {
+      codectk_err e = ex->fn(ex->ctx, ex->base + i, self);
+      if (e != CODECTK_OK) record(ex, ex->base + i, e);
+      atomic_fetch_sub(&ex->remaining, 1);
+      continue;
+    }
+    if (atomic_load(&ex->remaining) == 0) break;
+    if (!steal(ex, self)) sched_yield();
+  }
+  tl_in_task = 0;
+}
+
+static void *worker_loop(void *arg) {
+  ex_worker w = *(ex_worker*)arg;
+  codectk_executor *ex = w.ex;
+  unsigned long seen = 0;
+
+  pthread_mutex_lock(&ex->lock);
+  for (;;) {
+    while (ex->generation == seen && !ex->quit) {
+      pthread_cond_wait(&ex->wake, &ex->lock);
+    }
+    if (ex->quit) break;
+    seen = ex->generation;
+    if (w.id >= ex->participants) continue;
+
+    pthread_mutex_unlock(&ex->lock);
+    participate(ex, w.id);
+    pthread_mutex_lock(&ex->lock);
+    if (--ex->active == 0) pthread_cond_signal(&ex->done);
+  }
+  pthread_mutex_unlock(&ex->lock);
+  return NULL;
+}
+
+codectk_err codectk_executor_create(unsigned threads, codectk_executor **out) {
+  if (!out) return CODECTK_EINVAL;
+  *out = NULL;
+  if (threads == 0) {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = ncpu > 0 ? (unsigned)ncpu : 1;
+    if (threads > CODECTK_EXECUTOR_MAX_THREADS) threads = CODECTK_EXECUTOR_MAX_THREADS;
+  }
+  if (threads > CODECTK_EXECUTOR_MAX_THREADS) return CODECTK_EINVAL;
+
+  codectk_executor *ex = (codectk_executor*)aligned_alloc(64, sizeof(*ex));
+  if (!ex) return CODECTK_ENOMEM;
+  memset(ex, 0, sizeof(*ex));
+  ex->threads = threads;
+  pthread_mutex_init(&ex->run_lock, NULL);
+  pthread_mutex_init(&ex->lock, NULL);
+  pthread_cond_init(&ex->wake, NULL);
+  pthread_cond_init(&ex->done, NULL);
+
+  for (unsigned t = 1; t < threads; t++) {
+    ex->worker[t].ex = ex;
+    ex->worker[t].id = t;
+    if (pthread_create(&ex->tid[ex->started], NULL, worker_loop, &ex->worker[t]) != 0) {
+      codectk_executor_destroy(ex);
+      return CODECTK_ENOMEM;
+    }
+    ex->started++;
+  }
+
+  *out = ex;
+  return CODECTK_OK;
+}
+
+void codectk_executor_destroy(codectk_executor *ex) {
+  if (!ex) return;
+  pthread_mutex_lock(&ex->lock);
+  ex->quit = 1;
+  pthread_cond_broadcast(&ex->wake);
+  pthread_mutex_unlock(&ex->lock);
+  for (unsigned t = 0; t < ex->started; t++) {
+    pthread_join(ex->tid[t], NULL);
+  }
+  pthread_cond_destroy(&ex->wake);
+  pthread_cond_destroy(&ex->done);
+  pthread_mutex_destroy(&ex->lock);
+  pthread_mutex_destroy(&ex->run_lock);
+  free(ex);
+}
+
+unsigned codectk_executor_threads(const codectk_executor *ex) {
+  return ex ? ex->threads : 1;
+}
+
+static codectk_err run_inline(size_t n, codectk_task_fn fn, void *ctx) {
+  codectk_err first = CODECTK_OK;
+  for (size_t i = 0; i < n; i++) {
+    codectk_err e = fn(ctx, i, 0);
+    if (first == CODECTK_OK) first = e;
+  }
+  return first;
+}
+
+/* Tasks [base, base + n), n <= EX_SLICE, on the first participants threads */
+static void run_slice(codectk_executor *ex, size_t base, size_t n, unsigned participants) {
+  ex->base = base;
+  for (unsigned p = 0; p < participants; p++) {
+    uint32_t lo = (uint32_t)(n * p / participants);
+    uint32_t hi = (uint32_t)(n * (p + 1) / participants);
+    atomic_store(&ex->deque[p].range, pack(lo, hi));
+  }
+  atomic_store(&ex->remaining, n);
+
+  pthread_mutex_lock(&ex->lock);
+  ex->participants = participants;
+  ex->active = participants - 1;
+  ex->generation++;
+  pthread_cond_broadcast(&ex->wake);
+  pthread_mutex_unlock(&ex->lock);
+
+  participate(ex, 0);
+
+  /* Workers may still be between their last task and checking in */
+  pthread_mutex_lock(&ex->lock);
+  while (ex->active > 0) pthread_cond_wait(&ex->done, &ex->lock);
+  pthread_mutex_unlock(&ex->lock);
+}
+
+codectk_err codectk_executor_run(codectk_executor *ex, size_t n, unsigned max_threads,
+                                 codectk_task_fn fn, void *ctx) {
+  if (!fn) return CODECTK_EINVAL;
+  if (n == 0) return CODECTK_OK;
+
+  unsigned participants = ex ? ex->threads : 1;
+  if (max_threads && max_threads < participants) participants = max_threads;
+  if (participants > n) participants = (unsigned)n;
+  if (participants <= 1 || tl_in_task || pthread_mutex_trylock(&ex->run_lock) != 0) {
+    return run_inline(n, fn, ctx);
+  }
+
+  ex->fn = fn;
+  ex->ctx = ctx;
+  ex->err = CODECTK_OK;
+  ex->err_task = 0;
+  for (size_t base = 0; base < n; base += EX_SLICE) {
+    size_t len = (n - base < EX_SLICE) ? n - base : EX_SLICE;
+    run_slice(ex, base, len, participants);
+  }
+  codectk_err err = ex->err;
+
+  pthread_mutex_unlock(&ex->run_lock);
+  return err;
+}
+
+/* Shared executor */
+
+static pthread_once_t shared_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t shared_lock = PTHREAD_MUTEX_INITIALIZER;
+static codectk_executor *shared;
+static unsigned shared_threads;
+static int shared_started;
+
+static void shared_init(void) {
+  pthread_mutex_lock(&shared_lock);
+  shared_started = 1;
+  unsigned threads = shared_threads;
+  pthread_mutex_unlock(&shared_lock);
+
+  /* Never destroyed: the workers sleep until the process exits */
+  if (codectk_executor_create(threads, &shared) != CODECTK_OK) shared = NULL;
+}
+
+codectk_executor *codectk_executor_shared(void) {
+  pthread_once(&shared_once, shared_init);
+  return shared;
+}
+
+codectk_err codectk_executor_configure_shared(unsigned threads) {
+  if (threads > CODECTK_EXECUTOR_MAX_THREADS) return CODECTK_EINVAL;
+  pthread_mutex_lock(&shared_lock);
+  codectk_err err = shared_started ? CODECTK_EINVAL : CODECTK_OK;
+  if (err == CODECTK_OK) shared_threads = threads;
+  pthread_mutex_unlock(&shared_lock);
+  return err;
+}
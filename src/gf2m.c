@@ -6,31 +6,49 @@
  */
 
 #include "../include/gf2m.h"
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
 
 gf2m_vtbl gf2m_backend;
 
+/* Standard primitive polynomials for common field sizes (x^m implicit) */
+static const uint16_t prim_polys[] = {
+  0, 0, 0x7, 0xB, 0x13, 0x25, 0x43, 0x89,
+  0x11D, 0x211, 0x409, 0x805, 0x1053, 0x201B, 0x4443, 0x8003, 0x100B
+};
+
+#ifdef CODECTK_STATIC_GF_TABLES
+/* Generated by tools/gen_gf2m_tables.c; entries with m == 0 are absent */
+extern const gf2m_ctx gf2m_static_ctx[17];
+#endif
+
 /**
  * Multiply two polynomials in GF(2) modulo an irreducible polynomial.
  * Used during table generation.
+ *
+ * Works in 32 bits so the x^m overflow is visible for m = 16, where the
+ * x^16 term of mod_poly does not fit in 16 bits and is implicit.
  */
 static uint16_t poly_mul_mod(uint16_t a, uint16_t b, uint16_t mod_poly, unsigned m) {
-  uint16_t result = 0;
-  uint16_t mask = (uint16_t)((1u << m) - 1u);
+  uint32_t result = 0;
+  uint32_t x = a;
+  uint32_t mask = (1u << m) - 1u;
+  uint32_t reduce = (uint32_t)mod_poly | (1u << m);
 
   while (b) {
     if (b & 1) {
-      result ^= a;
+      result ^= x;
     }
     b >>= 1;
-    a <<= 1;
-    if (a & (1u << m)) {
-      a ^= mod_poly;
+    x <<= 1;
+    if (x & (1u << m)) {
+      x ^= reduce;
     }
   }
 
-  return result & mask;
+  return (uint16_t)(result & mask);
 }
 
 /**
@@ -39,13 +57,14 @@ static uint16_t poly_mul_mod(uint16_t a, uint16_t b, uint16_t mod_poly, unsigned
  * The algorithm:
  * 1. Start with primitive element (usually 0x02)
  * 2. Compute successive powers: α^0, α^1, α^2, ..., α^(2^m-2)
- * 3. Build antilog table: alog[i] = α^i
+ * 3. Build antilog table: alog[i] = α^i, repeated once so that
+ *    alog[i + order] = alog[i]
  * 4. Build log table: log[alog[i]] = i
  *
  * This gives us: alog[log[x]] = x for all nonzero x
- * And: x * y = alog[(log[x] + log[y]) mod (2^m - 1)]
+ * And: x * y = alog[log[x] + log[y]] with no reduction mod (2^m - 1)
  */
-int gf2m_ctx_init(gf2m_ctx *ctx, unsigned m, uint16_t mod_poly) {
+int gf2m_ctx_init_ex(gf2m_ctx *ctx, unsigned m, uint16_t mod_poly, unsigned flags) {
   if (!ctx) return -1;
   if (m < 2 || m > 16) return -1;
 
@@ -53,12 +72,13 @@ int gf2m_ctx_init(gf2m_ctx *ctx, unsigned m, uint16_t mod_poly) {
   size_t order = field_size - 1; /* multiplicative group order */
 
   /* Allocate tables */
+  memset(ctx, 0, sizeof(*ctx));
   ctx->m = m;
   ctx->mod_poly = mod_poly;
   ctx->prim = 2; /* standard primitive element */
   ctx->owns_tables = 1;
 
-  ctx->alog = (uint16_t*)malloc(field_size * sizeof(uint16_t));
+  ctx->alog = (uint16_t*)malloc(2 * order * sizeof(uint16_t));
   ctx->log = (uint16_t*)malloc(field_size * sizeof(uint16_t));
 
   if (!ctx->alog || !ctx->log) {
@@ -66,57 +86,145 @@ int gf2m_ctx_init(gf2m_ctx *ctx, unsigned m, uint16_t mod_poly) {
     return -1;
   }
 
-  /* Initialize log table to sentinel values */
-  memset(ctx->log, 0xff, field_size * sizeof(uint16_t));
+  /* log[0] stays 0 so unguarded lookups remain in range */
+  memset(ctx->log, 0, field_size * sizeof(uint16_t));
 
   /* Generate antilog table by computing successive powers of primitive element */
   uint16_t x = 1;
-  for (size_t i = 0; i < order; i++) {
-    ctx->alog[i] = x;
-    ctx->log[x] = (uint16_t)i;
+  size_t cycle = 0;
+  while (cycle < order) {
+    ctx->alog[cycle] = x;
+    ctx->log[x] = (uint16_t)cycle;
     x = poly_mul_mod(x, ctx->prim, mod_poly, m);
-  }
-
-  /* Extend antilog table for wraparound (simplifies modulo operations) */
-  for (size_t i = order; i < field_size; i++) {
-    ctx->alog[i] = ctx->alog[i - order];
+    cycle++;
+    if (x == 1) break;
   }
 
   /* Verify we got a full cycle (primitive polynomial check) */
-  if (x != 1) {
+  if (x != 1 || cycle != order) {
     gf2m_ctx_free(ctx);
     return -1; /* mod_poly is not primitive */
   }
 
+  /* Second copy of the cycle: log sums index directly */
+  memcpy(ctx->alog + order, ctx->alog, order * sizeof(uint16_t));
+
+  if (flags & GF2M_TABLE_SQR) {
+    ctx->sqr = (uint16_t*)malloc(field_size * sizeof(uint16_t));
+    if (!ctx->sqr) {
+      gf2m_ctx_free(ctx);
+      return -1;
+    }
+    ctx->sqr[0] = 0;
+    for (size_t a = 1; a < field_size; a++) {
+      ctx->sqr[a] = ctx->alog[2u * ctx->log[a]];
+    }
+    ctx->flags |= GF2M_TABLE_SQR;
+  }
+
+  if ((flags & GF2M_TABLE_MUL) && m <= 8) {
+    ctx->mul = (uint8_t*)malloc(field_size * field_size);
+    if (!ctx->mul) {
+      gf2m_ctx_free(ctx);
+      return -1;
+    }
+    for (size_t a = 0; a < field_size; a++) {
+      for (size_t b = 0; b < field_size; b++) {
+        ctx->mul[(a << m) | b] = (uint8_t)gf2m_mul_fast(ctx, (uint16_t)a, (uint16_t)b);
+      }
+    }
+    ctx->flags |= GF2M_TABLE_MUL;
+  }
+
   return 0;
 }
 
+int gf2m_ctx_init(gf2m_ctx *ctx, unsigned m, uint16_t mod_poly) {
+  return gf2m_ctx_init_ex(ctx, m, mod_poly, GF2M_TABLE_SQR);
+}
+
 void gf2m_ctx_free(gf2m_ctx *ctx) {
   if (!ctx) return;
 
   if (ctx->owns_tables) {
-    if (ctx->alog) {
-      free(ctx->alog);
-      ctx->alog = NULL;
-    }
-    if (ctx->log) {
-      free(ctx->log);
-      ctx->log = NULL;
-    }
+    free(ctx->alog);
+    free(ctx->log);
+    free(ctx->sqr);
+    free(ctx->mul);
+    ctx->alog = NULL;
+    ctx->log = NULL;
+    ctx->sqr = NULL;
+    ctx->mul = NULL;
   }
 
   ctx->m = 0;
+  ctx->flags = 0;
   ctx->owns_tables = 0;
 }
 
+uint16_t gf2m_default_poly(unsigned m) {
+  if (m >= sizeof(prim_polys) / sizeof(prim_polys[0])) return 0;
+  return prim_polys[m];
+}
+
+/**
+ * Shared contexts, one per (m, mod_poly). Entries are immutable once
+ * published and never freed, so readers walk the list without locking;
+ * the mutex only serializes construction of new entries.
+ */
+typedef struct gf2m_cache_entry {
+  gf2m_ctx ctx;
+  struct gf2m_cache_entry *next;
+} gf2m_cache_entry;
+
+static _Atomic(gf2m_cache_entry*) cache_head;
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const gf2m_ctx *cache_find(gf2m_cache_entry *e, unsigned m, uint16_t mod_poly) {
+  for (; e; e = e->next) {
+    if (e->ctx.m == m && e->ctx.mod_poly == mod_poly) return &e->ctx;
+  }
+  return NULL;
+}
+
+const gf2m_ctx *gf2m_ctx_get(unsigned m, uint16_t mod_poly) {
+  if (m < 2 || m > 16) return NULL;
+  if (!mod_poly) mod_poly = prim_polys[m];
+
+#ifdef CODECTK_STATIC_GF_TABLES
+  if (mod_poly == prim_polys[m] && gf2m_static_ctx[m].m == m) {
+    return &gf2m_static_ctx[m];
+  }
+#endif
+
+  const gf2m_ctx *found = cache_find(
+      atomic_load_explicit(&cache_head, memory_order_acquire), m, mod_poly);
+  if (found) return found;
+
+  pthread_mutex_lock(&cache_lock);
+
+  /* Another thread may have built it while we waited */
+  gf2m_cache_entry *head = atomic_load_explicit(&cache_head, memory_order_relaxed);
+  found = cache_find(head, m, mod_poly);
+  if (!found) {
+    gf2m_cache_entry *e = (gf2m_cache_entry*)malloc(sizeof(gf2m_cache_entry));
+    if (e && gf2m_ctx_init(&e->ctx, m, mod_poly) == 0) {
+      e->next = head;
+      atomic_store_explicit(&cache_head, e, memory_order_release);
+      found = &e->ctx;
+    } else {
+      free(e);
+    }
+  }
+
+  pthread_mutex_unlock(&cache_lock);
+  return found;
+}
+
 /* Core field operations */
 
 uint16_t gf2m_mul_c(const gf2m_ctx *ctx, uint16_t a, uint16_t b) {
-  if (!a || !b) return 0;
-  unsigned la = ctx->log[a];
-  unsigned lb = ctx->log[b];
-  unsigned order = (1u << ctx->m) - 1u;
-  return ctx->alog[(la + lb) % order];
+  return gf2m_mul_fast(ctx, a, b);
 }
 
 uint16_t gf2m_inv_c(const gf2m_ctx *ctx, uint16_t a) {
@@ -127,9 +235,81 @@ uint16_t gf2m_inv_c(const gf2m_ctx *ctx, uint16_t a) {
 }
 
 uint16_t gf2m_sqr_c(const gf2m_ctx *ctx, uint16_t a) {
-  /* Optimization note: squaring in characteristic 2 is linear (Frobenius map).
-   * Could precompute a squaring table for O(1) performance. */
-  return gf2m_mul_c(ctx, a, a);
+  if (ctx->sqr) return ctx->sqr[a];
+  return gf2m_mul_fast(ctx, a, a);
+}
+
+void gf2m_mul_scalar_c(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *src,
+                       uint16_t c, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    dst[i] = gf2m_mul_fast(ctx, src[i], c);
+  }
+}
+
+void gf2m_mac_scalar_c(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *src,
+                       uint16_t c, size_t len) {
+  if (!c) return;
+  for (size_t i = 0; i < len; i++) {
+    dst[i] ^= gf2m_mul_fast(ctx, src[i], c);
+  }
+}
+
+void gf2m_mul_vec_c(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *a,
+                    const uint16_t *b, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    dst[i] = gf2m_mul_c(ctx, a[i], b[i]);
+  }
+}
+
+void gf2m_poly_eval_multi_c(const gf2m_ctx *ctx, const uint16_t *coeff, int deg,
+                            const uint16_t *x, uint16_t *y, size_t npts) {
+  for (size_t i = 0; i < npts; i++) {
+    /* Horner's method */
+    uint16_t acc = (deg >= 0) ? coeff[deg] : 0;
+    for (int d = deg - 1; d >= 0; d--) {
+      acc = gf2m_mul_c(ctx, acc, x[i]) ^ coeff[d];
+    }
+    y[i] = acc;
+  }
+}
+
+/*
+ * Portable carry-less multiply: a 4-bit window over b with a table of
+ * a * j for j < 16. a * j needs up to 67 bits, so each entry keeps its top
+ * three bits in a second word.
+ */
+void gf2m_clmul_words_c(uint64_t *dst, const uint64_t *a, size_t na,
+                        const uint64_t *b, size_t nb) {
+  memset(dst, 0, (na + nb) * sizeof(uint64_t));
+  for (size_t i = 0; i < na; i++) {
+    uint64_t lo[16], hi[16];
+    lo[0] = hi[0] = 0;
+    lo[1] = a[i];
+    hi[1] = 0;
+    for (unsigned j = 2; j < 16; j += 2) {
+      lo[j] = lo[j / 2] << 1;
+      hi[j] = (hi[j / 2] << 1) | (lo[j / 2] >> 63);
+      lo[j + 1] = lo[j] ^ a[i];
+      hi[j + 1] = hi[j];
+    }
+
+    for (size_t j = 0; j < nb; j++) {
+      uint64_t w = b[j];
+      uint64_t l = lo[w & 15], h = hi[w & 15];
+      for (unsigned s = 4; s < 64; s += 4) {
+        unsigned nib = (unsigned)(w >> s) & 15;
+        l ^= lo[nib] << s;
+        h ^= (lo[nib] >> (64 - s)) ^ (hi[nib] << s);
+      }
+      dst[i + j] ^= l;
+      dst[i + j + 1] ^= h;
+    }
+  }
+}
+
+void gf2m_clmul_words(uint64_t *dst, const uint64_t *a, size_t na,
+                      const uint64_t *b, size_t nb) {
+  gf2m_backend.clmul_words(dst, a, na, b, nb);
 }
 
 uint16_t gf2m_mul(const gf2m_ctx *ctx, uint16_t a, uint16_t b) {
@@ -163,10 +343,60 @@ uint16_t gf2m_pow(const gf2m_ctx *ctx, uint16_t a, unsigned exp) {
   return result;
 }
 
-/* Initialize backend to C fallback on library load */
+void gf2m_mul_scalar(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *src,
+                     uint16_t c, size_t len) {
+  gf2m_backend.mul_scalar(ctx, dst, src, c, len);
+}
+
+void gf2m_mac_scalar(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *src,
+                     uint16_t c, size_t len) {
+  gf2m_backend.mac_scalar(ctx, dst, src, c, len);
+}
+
+void gf2m_mul_vec(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *a,
+                  const uint16_t *b, size_t len) {
+  gf2m_backend.mul_vec(ctx, dst, a, b, len);
+}
+
+void gf2m_poly_eval_multi(const gf2m_ctx *ctx, const uint16_t *coeff, int deg,
+                          const uint16_t *x, uint16_t *y, size_t npts) {
+  gf2m_backend.poly_eval_multi(ctx, coeff, deg, x, y, npts);
+}
+
+/* Backend selection */
+
+static void backend_c(gf2m_vtbl *vt) {
+  vt->mul = gf2m_mul_c;
+  vt->inv = gf2m_inv_c;
+  vt->sqr = gf2m_sqr_c;
+  vt->mul_scalar = gf2m_mul_scalar_c;
+  vt->mac_scalar = gf2m_mac_scalar_c;
+  vt->mul_vec = gf2m_mul_vec_c;
+  vt->poly_eval_multi = gf2m_poly_eval_multi_c;
+  vt->clmul_words = gf2m_clmul_words_c;
+  vt->name = "c";
+}
+
+int gf2m_backend_select(const char *name) {
+  gf2m_vtbl vt;
+  backend_c(&vt);
+
+  if (name && strcmp(name, "c") == 0) {
+    gf2m_backend = vt;
+    return 0;
+  }
+
+  /* At most one of these is implemented for the build target */
+  int x86 = gf2m_backend_x86(&vt, name);
+  int arm = gf2m_backend_arm(&vt, name);
+  if (name && x86 != 0 && arm != 0) return -1;
+
+  gf2m_backend = vt;
+  return 0;
+}
+
+/* Pick the best backend for this CPU on library load */
 __attribute__((constructor))
 static void init_backend(void) {
-  gf2m_backend.mul = gf2m_mul_c;
-  gf2m_backend.inv = gf2m_inv_c;
-  gf2m_backend.sqr = gf2m_sqr_c;
+  gf2m_backend_select(NULL);
 }
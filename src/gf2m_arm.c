@@ -0,0 +1,224 @@
+/**
+ * gf2m_arm.c - ARM64 NEON kernels for the GF(2^m) batch operations
+ *
+ * Same structure as gf2m_x86.c: scalar-times-vector kernels use
+ * split-nibble tables looked up with tbl (vld2/vst2 split the 16-bit
+ * elements into byte planes for free), and the elementwise kernels use
+ * PMULL carry-less multiplication with a Barrett reduction when the CPU
+ * has the crypto extension.
+ */
+
+#include "../include/gf2m.h"
+
+#if defined(__aarch64__) && defined(__ARM_NEON) && defined(__GNUC__)
+
+#include <arm_neon.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <sys/auxv.h>
+#ifndef HWCAP_PMULL
+#define HWCAP_PMULL (1 << 4)
+#endif
+#endif
+
+#if defined(__clang__)
+#define PMULL_TARGET __attribute__((target("aes")))
+#else
+#define PMULL_TARGET __attribute__((target("+crypto")))
+#endif
+
+/* Below this length, building the nibble tables costs more than it saves */
+#define SPLIT_MIN_LEN 32
+
+/* Table 2q + h maps nibble q of x to byte h of c * (x restricted to nibble q) */
+static void nibble_tables(const gf2m_ctx *ctx, uint16_t c, uint8_t tab[8][16]) {
+  unsigned size = 1u << ctx->m;
+
+  memset(tab, 0, 8 * 16);
+  for (unsigned q = 0; q < 4; q++) {
+    for (unsigned v = 1; v < 16; v++) {
+      unsigned x = v << (4 * q);
+      if (x >= size) break;
+      uint16_t p = gf2m_mul_c(ctx, c, (uint16_t)x);
+      tab[2 * q][v] = (uint8_t)p;
+      tab[2 * q + 1][v] = (uint8_t)(p >> 8);
+    }
+  }
+}
+
+static void scalar_neon(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *src,
+                        uint16_t c, size_t len, int acc) {
+  uint8_t tab[8][16];
+  nibble_tables(ctx, c, tab);
+
+  uint8x16_t t[8];
+  for (unsigned i = 0; i < 8; i++) {
+    t[i] = vld1q_u8(tab[i]);
+  }
+  const uint8x16_t nib = vdupq_n_u8(0x0f);
+
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    /* val[0] = low bytes, val[1] = high bytes of 16 elements */
+    uint8x16x2_t x = vld2q_u8((const uint8_t*)(src + i));
+
+    uint8x16_t n0 = vandq_u8(x.val[0], nib);
+    uint8x16_t n1 = vshrq_n_u8(x.val[0], 4);
+    uint8x16_t n2 = vandq_u8(x.val[1], nib);
+    uint8x16_t n3 = vshrq_n_u8(x.val[1], 4);
+
+    uint8x16x2_t r;
+    r.val[0] = veorq_u8(veorq_u8(vqtbl1q_u8(t[0], n0), vqtbl1q_u8(t[2], n1)),
+                        veorq_u8(vqtbl1q_u8(t[4], n2), vqtbl1q_u8(t[6], n3)));
+    r.val[1] = veorq_u8(veorq_u8(vqtbl1q_u8(t[1], n0), vqtbl1q_u8(t[3], n1)),
+                        veorq_u8(vqtbl1q_u8(t[5], n2), vqtbl1q_u8(t[7], n3)));
+    if (acc) {
+      uint8x16x2_t d = vld2q_u8((const uint8_t*)(dst + i));
+      r.val[0] = veorq_u8(r.val[0], d.val[0]);
+      r.val[1] = veorq_u8(r.val[1], d.val[1]);
+    }
+    vst2q_u8((uint8_t*)(dst + i), r);
+  }
+
+  if (acc) {
+    gf2m_mac_scalar_c(ctx, dst + i, src + i, c, len - i);
+  } else {
+    gf2m_mul_scalar_c(ctx, dst + i, src + i, c, len - i);
+  }
+}
+
+static void mul_scalar_neon(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *src,
+                            uint16_t c, size_t len) {
+  if (len < SPLIT_MIN_LEN) {
+    gf2m_mul_scalar_c(ctx, dst, src, c, len);
+  } else {
+    scalar_neon(ctx, dst, src, c, len, 0);
+  }
+}
+
+static void mac_scalar_neon(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *src,
+                            uint16_t c, size_t len) {
+  if (!c) return;
+  if (len < SPLIT_MIN_LEN) {
+    gf2m_mac_scalar_c(ctx, dst, src, c, len);
+  } else {
+    scalar_neon(ctx, dst, src, c, len, 1);
+  }
+}
+
+#if defined(__linux__)
+/* Barrett reduction constants, see gf2m_x86.c */
+typedef struct {
+  uint64_t poly;
+  uint64_t mu;
+  unsigned m;
+  uint64_t mask;
+} barrett;
+
+static barrett barrett_init(const gf2m_ctx *ctx) {
+  unsigned m = ctx->m;
+  uint64_t poly = (uint64_t)ctx->mod_poly | (1ULL << m);
+  uint64_t rem = 1ULL << (2 * m);
+  uint64_t mu = 0;
+
+  for (int bit = (int)(2 * m); bit >= (int)m; bit--) {
+    if (rem & (1ULL << bit)) {
+      mu |= 1ULL << (bit - (int)m);
+      rem ^= poly << (bit - (int)m);
+    }
+  }
+
+  barrett br = {poly, mu, m, (1ULL << m) - 1};
+  return br;
+}
+
+PMULL_TARGET
+static inline uint64_t pmull64(uint64_t a, uint64_t b) {
+  poly128_t p = vmull_p64((poly64_t)a, (poly64_t)b);
+  return vgetq_lane_u64(vreinterpretq_u64_p128(p), 0);
+}
+
+PMULL_TARGET
+static inline uint16_t pmull_mul(uint64_t a, uint64_t b, const barrett *br) {
+  uint64_t p = pmull64(a, b);
+  uint64_t q = pmull64(p >> br->m, br->mu) >> br->m;
+  return (uint16_t)((p ^ pmull64(q, br->poly)) & br->mask);
+}
+
+PMULL_TARGET
+static void mul_vec_pmull(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *a,
+                          const uint16_t *b, size_t len) {
+  barrett br = barrett_init(ctx);
+  for (size_t i = 0; i < len; i++) {
+    dst[i] = pmull_mul(a[i], b[i], &br);
+  }
+}
+
+PMULL_TARGET
+static void poly_eval_multi_pmull(const gf2m_ctx *ctx, const uint16_t *coeff, int deg,
+                                  const uint16_t *x, uint16_t *y, size_t npts) {
+  barrett br = barrett_init(ctx);
+  for (size_t i = 0; i < npts; i++) {
+    /* Horner's method */
+    uint16_t acc = (deg >= 0) ? coeff[deg] : 0;
+    for (int d = deg - 1; d >= 0; d--) {
+      acc = pmull_mul(acc, x[i], &br) ^ coeff[d];
+    }
+    y[i] = acc;
+  }
+}
+
+/* Product scanning as in clmul_words_pclmul() */
+PMULL_TARGET
+static void clmul_words_pmull(uint64_t *dst, const uint64_t *a, size_t na,
+                              const uint64_t *b, size_t nb) {
+  if (na == 0 || nb == 0) {
+    memset(dst, 0, (na + nb) * sizeof(uint64_t));
+    return;
+  }
+
+  uint64_t carry = 0;
+  for (size_t k = 0; k + 1 < na + nb; k++) {
+    size_t lo = (k >= nb) ? k - nb + 1 : 0;
+    size_t hi = (k < na) ? k : na - 1;
+    uint64x2_t acc = vcombine_u64(vcreate_u64(carry), vcreate_u64(0));
+    for (size_t i = lo; i <= hi; i++) {
+      poly128_t p = vmull_p64((poly64_t)a[i], (poly64_t)b[k - i]);
+      acc = veorq_u64(acc, vreinterpretq_u64_p128(p));
+    }
+    dst[k] = vgetq_lane_u64(acc, 0);
+    carry = vgetq_lane_u64(acc, 1);
+  }
+  dst[na + nb - 1] = carry;
+}
+#endif
+
+int gf2m_backend_arm(gf2m_vtbl *vt, const char *name) {
+  if (name && strcmp(name, "neon") != 0) return -1;
+
+  vt->mul_scalar = mul_scalar_neon;
+  vt->mac_scalar = mac_scalar_neon;
+  vt->name = "neon";
+
+#if defined(__linux__)
+  if (getauxval(AT_HWCAP) & HWCAP_PMULL) {
+    vt->mul_vec = mul_vec_pmull;
+    vt->poly_eval_multi = poly_eval_multi_pmull;
+    vt->clmul_words = clmul_words_pmull;
+    vt->name = "neon+pmull";
+  }
+#endif
+
+  return 0;
+}
+
+#else
+
+int gf2m_backend_arm(gf2m_vtbl *vt, const char *name) {
+  (void)vt;
+  (void)name;
+  return -1;
+}
+
+#endif
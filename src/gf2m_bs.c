@@ -0,0 +1,135 @@
+/**
+ * gf2m_bs.c - Bitsliced GF(2^m) arithmetic over 64 lanes
+ *
+ * The multiply is specialised per m so that the plane loops are fully
+ * unrolled: an m x m schoolbook product of AND/XOR over whole words, 64
+ * lanes at a time, and a reduction that folds the top m - 1 planes back
+ * through the (public) terms of the field polynomial.
+ */
+
+#include "../include/gf2m_bs.h"
+#include <string.h>
+
+#if defined(__GNUC__)
+#define BS_INLINE static inline __attribute__((always_inline))
+#define BS_UNROLL _Pragma("GCC unroll 16")
+#else
+#define BS_INLINE static inline
+#define BS_UNROLL
+#endif
+
+/* The field polynomial without x^m: x^m = low(x) */
+static inline unsigned low_terms(const gf2m_ctx *f) {
+  return f->mod_poly & ((1u << f->m) - 1);
+}
+
+/* Fold product planes 2m-2 .. m into r, highest first */
+BS_INLINE void reduce(uint64_t *prod, const unsigned m, unsigned low, gf2m_bs *r) {
+  BS_UNROLL
+  for (unsigned d = 2 * m - 2; d >= m; d--) {
+    uint64_t top = prod[d];
+    BS_UNROLL
+    for (unsigned k = 0; k < m; k++) {
+      if ((low >> k) & 1) prod[d - m + k] ^= top;
+    }
+  }
+  for (unsigned i = 0; i < m; i++) r->p[i] = prod[i];
+  for (unsigned i = m; i < 16; i++) r->p[i] = 0;
+}
+
+/* r = sum of a[k] * b[k]: the products are summed unreduced, so one
+ * reduction serves the whole sum */
+BS_INLINE void dot_m(gf2m_bs *r, const gf2m_bs *a, const gf2m_bs *b, size_t count,
+                     const unsigned m, unsigned low) {
+  uint64_t prod[31] = {0};
+  for (size_t k = 0; k < count; k++) {
+    BS_UNROLL
+    for (unsigned i = 0; i < m; i++) {
+      uint64_t ai = a[k].p[i];
+      BS_UNROLL
+      for (unsigned j = 0; j < m; j++) prod[i + j] ^= ai & b[k].p[j];
+    }
+  }
+  reduce(prod, m, low, r);
+}
+
+#define BS_CASES(X) X(2) X(3) X(4) X(5) X(6) X(7) X(8) X(9) X(10) X(11) X(12) \
+                    X(13) X(14) X(15) X(16)
+
+void gf2m_bs_mul(const gf2m_ctx *f, gf2m_bs *r, const gf2m_bs *a, const gf2m_bs *b) {
+  unsigned low = low_terms(f);
+  switch (f->m) {
+#define BS_MUL(M) case M: dot_m(r, a, b, 1, M, low); break;
+    BS_CASES(BS_MUL)
+#undef BS_MUL
+    default: break;
+  }
+}
+
+void gf2m_bs_dot(const gf2m_ctx *f, gf2m_bs *r, const gf2m_bs *a, const gf2m_bs *b,
+                 size_t count) {
+  unsigned low = low_terms(f);
+  switch (f->m) {
+#define BS_DOT(M) case M: dot_m(r, a, b, count, M, low); break;
+    BS_CASES(BS_DOT)
+#undef BS_DOT
+    default: break;
+  }
+}
+
+void gf2m_bs_sqr(const gf2m_ctx *f, gf2m_bs *r, const gf2m_bs *a) {
+  unsigned m = f->m;
+  uint64_t prod[31] = {0};
+  for (unsigned i = 0; i < m; i++) prod[2 * i] = a->p[i];
+  reduce(prod, m, low_terms(f), r);
+}
+
+void gf2m_bs_mul_pub(const gf2m_ctx *f, gf2m_bs *r, const gf2m_bs *a, uint16_t c) {
+  unsigned m = f->m, low = low_terms(f);
+  uint64_t t[16], acc[16] = {0};
+  memcpy(t, a->p, sizeof(t));
+
+  for (unsigned i = 0; i < m && (c >> i); i++) {
+    if ((c >> i) & 1) {
+      for (unsigned q = 0; q < m; q++) acc[q] ^= t[q];
+    }
+    /* t *= x */
+    uint64_t top = t[m - 1];
+    memmove(t + 1, t, (m - 1) * sizeof(uint64_t));
+    t[0] = 0;
+    for (unsigned bits = low; bits; bits &= bits - 1) t[__builtin_ctz(bits)] ^= top;
+  }
+  memcpy(r->p, acc, sizeof(acc));
+}
+
+void gf2m_bs_transpose64(uint64_t a[64]) {
+  static const uint64_t masks[6] = {
+    0x00000000ffffffffULL, 0x0000ffff0000ffffULL, 0x00ff00ff00ff00ffULL,
+    0x0f0f0f0f0f0f0f0fULL, 0x3333333333333333ULL, 0x5555555555555555ULL
+  };
+
+  /* Swap the off-diagonal s x s blocks of every 2s x 2s block */
+  for (unsigned level = 0, s = 32; s; level++, s >>= 1) {
+    uint64_t mask = masks[level];
+    for (unsigned i = 0; i < 64; i++) {
+      if (i & s) continue;
+      uint64_t x = ((a[i] >> s) ^ a[i + s]) & mask;
+      a[i] ^= x << s;
+      a[i + s] ^= x;
+    }
+  }
+}
+
+void gf2m_bs_pack(gf2m_bs *r, const uint16_t v[GF2M_BS_LANES]) {
+  uint64_t a[64];
+  for (unsigned w = 0; w < 64; w++) a[w] = v[w];
+  gf2m_bs_transpose64(a);
+  memcpy(r->p, a, sizeof(r->p));
+}
+
+void gf2m_bs_unpack(const gf2m_bs *a, uint16_t v[GF2M_BS_LANES]) {
+  uint64_t b[64] = {0};
+  memcpy(b, a->p, sizeof(a->p));
+  gf2m_bs_transpose64(b);
+  for (unsigned w = 0; w < 64; w++) v[w] = (uint16_t)b[w];
+}
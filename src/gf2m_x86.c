@@ -0,0 +1,346 @@
+/**
+ * gf2m_x86.c - x86 SIMD kernels for the GF(2^m) batch operations
+ *
+ * Scalar-times-vector kernels (mul_scalar, mac_scalar) use split-nibble
+ * tables: x -> c * x is linear over GF(2), so c * x is the XOR of
+ * c * (nibble q of x) over the four nibbles of a 16-bit element, and each
+ * nibble product is a 16-entry table looked up with pshufb. Elements are
+ * split into low and high byte planes for the lookups.
+ *
+ * Elementwise kernels (mul_vec, poly_eval_multi) have no fixed operand to
+ * build tables for, so they use PCLMULQDQ carry-less multiplication with a
+ * Barrett reduction by the field polynomial: no tables and no branches on
+ * the operands. The same instruction gives the word-level GF(2)[x]
+ * multiply under poly_gf2_mul().
+ */
+
+#include "../include/gf2m.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+
+#include <immintrin.h>
+#include <string.h>
+
+/* Below this length, building the nibble tables costs more than it saves */
+#define SPLIT_MIN_LEN 32
+
+/* Table 2q + h maps nibble q of x to byte h of c * (x restricted to nibble q) */
+static void nibble_tables(const gf2m_ctx *ctx, uint16_t c, uint8_t tab[8][16]) {
+  unsigned size = 1u << ctx->m;
+
+  memset(tab, 0, 8 * 16);
+  for (unsigned q = 0; q < 4; q++) {
+    for (unsigned v = 1; v < 16; v++) {
+      unsigned x = v << (4 * q);
+      if (x >= size) break;
+      uint16_t p = gf2m_mul_c(ctx, c, (uint16_t)x);
+      tab[2 * q][v] = (uint8_t)p;
+      tab[2 * q + 1][v] = (uint8_t)(p >> 8);
+    }
+  }
+}
+
+__attribute__((target("ssse3")))
+static void scalar_ssse3(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *src,
+                         uint16_t c, size_t len, int acc) {
+  uint8_t tab[8][16];
+  nibble_tables(ctx, c, tab);
+
+  __m128i t[8];
+  for (unsigned i = 0; i < 8; i++) {
+    t[i] = _mm_loadu_si128((const __m128i*)tab[i]);
+  }
+  const __m128i nib = _mm_set1_epi8(0x0f);
+  const __m128i low = _mm_set1_epi16(0x00ff);
+
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+    __m128i b = _mm_loadu_si128((const __m128i*)(src + i + 8));
+    __m128i lo = _mm_packus_epi16(_mm_and_si128(a, low), _mm_and_si128(b, low));
+    __m128i hi = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+
+    __m128i n0 = _mm_and_si128(lo, nib);
+    __m128i n1 = _mm_and_si128(_mm_srli_epi16(lo, 4), nib);
+    __m128i n2 = _mm_and_si128(hi, nib);
+    __m128i n3 = _mm_and_si128(_mm_srli_epi16(hi, 4), nib);
+
+    __m128i rlo = _mm_xor_si128(
+        _mm_xor_si128(_mm_shuffle_epi8(t[0], n0), _mm_shuffle_epi8(t[2], n1)),
+        _mm_xor_si128(_mm_shuffle_epi8(t[4], n2), _mm_shuffle_epi8(t[6], n3)));
+    __m128i rhi = _mm_xor_si128(
+        _mm_xor_si128(_mm_shuffle_epi8(t[1], n0), _mm_shuffle_epi8(t[3], n1)),
+        _mm_xor_si128(_mm_shuffle_epi8(t[5], n2), _mm_shuffle_epi8(t[7], n3)));
+
+    __m128i r0 = _mm_unpacklo_epi8(rlo, rhi);
+    __m128i r1 = _mm_unpackhi_epi8(rlo, rhi);
+    if (acc) {
+      r0 = _mm_xor_si128(r0, _mm_loadu_si128((const __m128i*)(dst + i)));
+      r1 = _mm_xor_si128(r1, _mm_loadu_si128((const __m128i*)(dst + i + 8)));
+    }
+    _mm_storeu_si128((__m128i*)(dst + i), r0);
+    _mm_storeu_si128((__m128i*)(dst + i + 8), r1);
+  }
+
+  if (acc) {
+    gf2m_mac_scalar_c(ctx, dst + i, src + i, c, len - i);
+  } else {
+    gf2m_mul_scalar_c(ctx, dst + i, src + i, c, len - i);
+  }
+}
+
+__attribute__((target("avx2")))
+static void scalar_avx2(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *src,
+                        uint16_t c, size_t len, int acc) {
+  uint8_t tab[8][16];
+  nibble_tables(ctx, c, tab);
+
+  __m256i t[8];
+  for (unsigned i = 0; i < 8; i++) {
+    t[i] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)tab[i]));
+  }
+  const __m256i nib = _mm256_set1_epi8(0x0f);
+  const __m256i low = _mm256_set1_epi16(0x00ff);
+
+  /* pack/unpack work within 128-bit lanes, so the element order is kept */
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32) {
+    __m256i a = _mm256_loadu_si256((const __m256i*)(src + i));
+    __m256i b = _mm256_loadu_si256((const __m256i*)(src + i + 16));
+    __m256i lo = _mm256_packus_epi16(_mm256_and_si256(a, low), _mm256_and_si256(b, low));
+    __m256i hi = _mm256_packus_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8));
+
+    __m256i n0 = _mm256_and_si256(lo, nib);
+    __m256i n1 = _mm256_and_si256(_mm256_srli_epi16(lo, 4), nib);
+    __m256i n2 = _mm256_and_si256(hi, nib);
+    __m256i n3 = _mm256_and_si256(_mm256_srli_epi16(hi, 4), nib);
+
+    __m256i rlo = _mm256_xor_si256(
+        _mm256_xor_si256(_mm256_shuffle_epi8(t[0], n0), _mm256_shuffle_epi8(t[2], n1)),
+        _mm256_xor_si256(_mm256_shuffle_epi8(t[4], n2), _mm256_shuffle_epi8(t[6], n3)));
+    __m256i rhi = _mm256_xor_si256(
+        _mm256_xor_si256(_mm256_shuffle_epi8(t[1], n0), _mm256_shuffle_epi8(t[3], n1)),
+        _mm256_xor_si256(_mm256_shuffle_epi8(t[5], n2), _mm256_shuffle_epi8(t[7], n3)));
+
+    __m256i r0 = _mm256_unpacklo_epi8(rlo, rhi);
+    __m256i r1 = _mm256_unpackhi_epi8(rlo, rhi);
+    if (acc) {
+      r0 = _mm256_xor_si256(r0, _mm256_loadu_si256((const __m256i*)(dst + i)));
+      r1 = _mm256_xor_si256(r1, _mm256_loadu_si256((const __m256i*)(dst + i + 16)));
+    }
+    _mm256_storeu_si256((__m256i*)(dst + i), r0);
+    _mm256_storeu_si256((__m256i*)(dst + i + 16), r1);
+  }
+
+  if (acc) {
+    gf2m_mac_scalar_c(ctx, dst + i, src + i, c, len - i);
+  } else {
+    gf2m_mul_scalar_c(ctx, dst + i, src + i, c, len - i);
+  }
+}
+
+static void mul_scalar_ssse3(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *src,
+                             uint16_t c, size_t len) {
+  if (len < SPLIT_MIN_LEN) {
+    gf2m_mul_scalar_c(ctx, dst, src, c, len);
+  } else {
+    scalar_ssse3(ctx, dst, src, c, len, 0);
+  }
+}
+
+static void mac_scalar_ssse3(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *src,
+                             uint16_t c, size_t len) {
+  if (!c) return;
+  if (len < SPLIT_MIN_LEN) {
+    gf2m_mac_scalar_c(ctx, dst, src, c, len);
+  } else {
+    scalar_ssse3(ctx, dst, src, c, len, 1);
+  }
+}
+
+static void mul_scalar_avx2(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *src,
+                            uint16_t c, size_t len) {
+  if (len < SPLIT_MIN_LEN) {
+    gf2m_mul_scalar_c(ctx, dst, src, c, len);
+  } else {
+    scalar_avx2(ctx, dst, src, c, len, 0);
+  }
+}
+
+static void mac_scalar_avx2(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *src,
+                            uint16_t c, size_t len) {
+  if (!c) return;
+  if (len < SPLIT_MIN_LEN) {
+    gf2m_mac_scalar_c(ctx, dst, src, c, len);
+  } else {
+    scalar_avx2(ctx, dst, src, c, len, 1);
+  }
+}
+
+/*
+ * Barrett reduction constants: P(x) is the field polynomial including x^m
+ * and mu(x) = floor(x^2m / P(x)). For a product p of degree < 2m,
+ * q = ((p >> m) * mu) >> m is floor(p / P) and p mod P = p ^ q * P.
+ */
+typedef struct {
+  __m128i poly;
+  __m128i mu;
+  __m128i shift;
+  __m128i mask;
+} barrett;
+
+static barrett barrett_init(const gf2m_ctx *ctx) {
+  unsigned m = ctx->m;
+  uint64_t poly = (uint64_t)ctx->mod_poly | (1ULL << m);
+  uint64_t rem = 1ULL << (2 * m);
+  uint64_t mu = 0;
+
+  for (int bit = (int)(2 * m); bit >= (int)m; bit--) {
+    if (rem & (1ULL << bit)) {
+      mu |= 1ULL << (bit - (int)m);
+      rem ^= poly << (bit - (int)m);
+    }
+  }
+
+  barrett br;
+  br.poly = _mm_set_epi64x(0, (long long)poly);
+  br.mu = _mm_set_epi64x(0, (long long)mu);
+  br.shift = _mm_set_epi64x(0, (long long)m);
+  br.mask = _mm_set1_epi64x((long long)((1ULL << m) - 1));
+  return br;
+}
+
+/* Two products at once: lanes are the two 64-bit halves of a and b */
+__attribute__((target("pclmul,sse4.1")))
+static inline __m128i clmul_mul2(__m128i a, __m128i b, const barrett *br) {
+  __m128i p = _mm_unpacklo_epi64(_mm_clmulepi64_si128(a, b, 0x00),
+                                 _mm_clmulepi64_si128(a, b, 0x11));
+  __m128i h = _mm_srl_epi64(p, br->shift);
+  __m128i q = _mm_unpacklo_epi64(_mm_clmulepi64_si128(h, br->mu, 0x00),
+                                 _mm_clmulepi64_si128(h, br->mu, 0x01));
+  q = _mm_srl_epi64(q, br->shift);
+  __m128i qp = _mm_unpacklo_epi64(_mm_clmulepi64_si128(q, br->poly, 0x00),
+                                  _mm_clmulepi64_si128(q, br->poly, 0x01));
+  return _mm_and_si128(_mm_xor_si128(p, qp), br->mask);
+}
+
+__attribute__((target("pclmul,sse4.1")))
+static void mul_vec_pclmul(const gf2m_ctx *ctx, uint16_t *dst, const uint16_t *a,
+                           const uint16_t *b, size_t len) {
+  barrett br = barrett_init(ctx);
+
+  size_t i = 0;
+  for (; i + 2 <= len; i += 2) {
+    __m128i va = _mm_set_epi64x(a[i + 1], a[i]);
+    __m128i vb = _mm_set_epi64x(b[i + 1], b[i]);
+    __m128i r = clmul_mul2(va, vb, &br);
+    dst[i] = (uint16_t)_mm_extract_epi16(r, 0);
+    dst[i + 1] = (uint16_t)_mm_extract_epi16(r, 4);
+  }
+  if (i < len) {
+    dst[i] = gf2m_mul_c(ctx, a[i], b[i]);
+  }
+}
+
+__attribute__((target("pclmul,sse4.1")))
+static void poly_eval_multi_pclmul(const gf2m_ctx *ctx, const uint16_t *coeff, int deg,
+                                   const uint16_t *x, uint16_t *y, size_t npts) {
+  if (deg < 0) {
+    memset(y, 0, npts * sizeof(uint16_t));
+    return;
+  }
+
+  barrett br = barrett_init(ctx);
+
+  /* Horner's method, two points per lane pair */
+  size_t i = 0;
+  for (; i + 2 <= npts; i += 2) {
+    __m128i vx = _mm_set_epi64x(x[i + 1], x[i]);
+    __m128i acc = _mm_set1_epi64x(coeff[deg]);
+    for (int d = deg - 1; d >= 0; d--) {
+      acc = _mm_xor_si128(clmul_mul2(acc, vx, &br), _mm_set1_epi64x(coeff[d]));
+    }
+    y[i] = (uint16_t)_mm_extract_epi16(acc, 0);
+    y[i + 1] = (uint16_t)_mm_extract_epi16(acc, 4);
+  }
+  if (i < npts) {
+    gf2m_poly_eval_multi_c(ctx, coeff, deg, x + i, y + i, npts - i);
+  }
+}
+
+/*
+ * Product scanning: output word k is the low half of the XOR of all
+ * a_i * b_(k-i), plus the high half carried over from word k - 1.
+ */
+__attribute__((target("pclmul,sse4.1")))
+static void clmul_words_pclmul(uint64_t *dst, const uint64_t *a, size_t na,
+                               const uint64_t *b, size_t nb) {
+  if (na == 0 || nb == 0) {
+    memset(dst, 0, (na + nb) * sizeof(uint64_t));
+    return;
+  }
+
+  __m128i carry = _mm_setzero_si128();
+  for (size_t k = 0; k + 1 < na + nb; k++) {
+    size_t lo = (k >= nb) ? k - nb + 1 : 0;
+    size_t hi = (k < na) ? k : na - 1;
+    __m128i acc = carry;
+    for (size_t i = lo; i <= hi; i++) {
+      __m128i x = _mm_loadl_epi64((const __m128i*)(a + i));
+      __m128i y = _mm_loadl_epi64((const __m128i*)(b + k - i));
+      acc = _mm_xor_si128(acc, _mm_clmulepi64_si128(x, y, 0x00));
+    }
+    _mm_storel_epi64((__m128i*)(dst + k), acc);
+    carry = _mm_srli_si128(acc, 8);
+  }
+  _mm_storel_epi64((__m128i*)(dst + na + nb - 1), carry);
+}
+
+int gf2m_backend_x86(gf2m_vtbl *vt, const char *name) {
+  __builtin_cpu_init();
+  int has_avx2 = __builtin_cpu_supports("avx2");
+  int has_ssse3 = __builtin_cpu_supports("ssse3");
+  int has_pclmul = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+  int use_avx2;
+
+  if (!name) {
+    if (!has_ssse3) return 0;
+    use_avx2 = has_avx2;
+  } else if (strcmp(name, "avx2") == 0) {
+    if (!has_avx2) return -1;
+    use_avx2 = 1;
+  } else if (strcmp(name, "ssse3") == 0) {
+    if (!has_ssse3) return -1;
+    use_avx2 = 0;
+  } else {
+    return -1;
+  }
+
+  if (use_avx2) {
+    vt->mul_scalar = mul_scalar_avx2;
+    vt->mac_scalar = mac_scalar_avx2;
+    vt->name = has_pclmul ? "avx2+pclmul" : "avx2";
+  } else {
+    vt->mul_scalar = mul_scalar_ssse3;
+    vt->mac_scalar = mac_scalar_ssse3;
+    vt->name = has_pclmul ? "ssse3+pclmul" : "ssse3";
+  }
+
+  if (has_pclmul) {
+    vt->mul_vec = mul_vec_pclmul;
+    vt->poly_eval_multi = poly_eval_multi_pclmul;
+    vt->clmul_words = clmul_words_pclmul;
+  }
+
+  return 0;
+}
+
+#else
+
+int gf2m_backend_x86(gf2m_vtbl *vt, const char *name) {
+  (void)vt;
+  (void)name;
+  return -1;
+}
+
+#endif
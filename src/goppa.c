@@ -3,72 +3,63 @@
  *
  * Implements binary Goppa codes over GF(2^m) with:
  * - Parity-check matrix H from support set L and polynomial g(x)
- * - Systematic encoding
- * - Patterson algorithm for decoding (syndrome, inverse, quadratic split)
+ * - Systematic encoding with the generator cached in a goppa_ctx
+ * - Patterson decoding: syndrome from precomputed columns, S^-1 and the
+ *   square root map, the lattice step and a root search over the support
  */
 
 #include "../include/goppa.h"
+#include "../include/bitio.h"
+#include "../include/executor.h"
 #include "../include/gf2m.h"
+#include "../include/gf2m_bs.h"
 #include "../include/poly.h"
+#include "../include/stats.h"
 #include "../include/gf2.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+static codectk_err fail_batch(codectk_batch_item *items, size_t count, codectk_err err) {
+  for (size_t i = 0; i < count; i++) {
+    items[i].num_corrected = 0;
+    items[i].err = err;
+  }
+  return count ? err : CODECTK_OK;
+}
+
+/* Column of H for codeword position pos: the last mt positions come first,
+ * so that the reduction picks them as pivots */
+static size_t h_col(size_t pos, size_t n, size_t mt) {
+  return (pos >= n - mt) ? pos - (n - mt) : pos + mt;
+}
+
+static size_t h_pos(size_t col, size_t n, size_t mt) {
+  return (col < mt) ? n - mt + col : col - mt;
+}
+
 /**
  * Build parity-check matrix H for binary Goppa code.
- * H is mt x n where each column i is:
+ * H is mt x n where the column of position i is:
  *   [L_i^0/g(L_i), L_i^1/g(L_i), ..., L_i^(t-1)/g(L_i)]
- * expanded to binary form (m bits per element).
+ * expanded to binary form (m bits per element), placed at h_col(i).
  *
- * Returns binary matrix of size (mt) x n.
+ * g_at_L holds g(L_i), all nonzero.
  */
-static gf2_mat* build_parity_check_matrix(const goppa_params *P, const gf2m_ctx *ctx) {
+static int build_parity_check_matrix(gf2_mat *H, const goppa_params *P, const gf2m_ctx *ctx,
+                                     const uint16_t *g_at_L) {
   unsigned t = P->t;
   unsigned m = P->m;
   size_t n = P->n;
+  size_t mt = (size_t)t * m;
 
   /* H has mt rows and n columns */
-  size_t n_rows = (size_t)t * m;
-  gf2_mat *H = (gf2_mat*)malloc(sizeof(gf2_mat));
-  if (!H) return NULL;
-
-  if (gf2_mat_init(H, n_rows, n) != 0) {
-    free(H);
-    return NULL;
-  }
-
-  /* Precompute g(L_i) for all i */
-  uint16_t *g_at_L = (uint16_t*)malloc(n * sizeof(uint16_t));
-  if (!g_at_L) {
-    gf2_mat_free(H);
-    free(H);
-    return NULL;
-  }
-
-  poly_gf2m_t g_poly;
-  poly_gf2m_init(&g_poly, ctx, (int)t + 1);
-  for (unsigned i = 0; i <= t; i++) {
-    poly_gf2m_set_coeff(&g_poly, (int)i, P->g[i]);
-  }
+  if (gf2_mat_init(H, mt, n) != 0) return -1;
 
   for (size_t i = 0; i < n; i++) {
-    g_at_L[i] = poly_gf2m_eval(&g_poly, P->L[i]);
-    if (g_at_L[i] == 0) {
-      /* L[i] is a root of g(x), invalid support set */
-      poly_gf2m_free(&g_poly);
-      free(g_at_L);
-      gf2_mat_free(H);
-      free(H);
-      return NULL;
-    }
-  }
-
-  /* Build H column by column */
-  for (size_t col = 0; col < n; col++) {
-    uint16_t L_i = P->L[col];
-    uint16_t g_L_i = g_at_L[col];
-    uint16_t g_L_i_inv = gf2m_inv(ctx, g_L_i);
+    size_t col = h_col(i, n, mt);
+    uint16_t L_i = P->L[i];
+    uint16_t g_L_i_inv = gf2m_inv(ctx, g_at_L[i]);
 
     uint16_t L_power = 1;  /* L_i^j */
 
@@ -78,11 +69,7 @@ static gf2_mat* build_parity_check_matrix(const goppa_params *P, const gf2m_ctx
 
       /* Expand to m binary bits and set in H */
       for (unsigned bit = 0; bit < m; bit++) {
-        size_t row = j * m + bit;
-        int bit_val = (val >> bit) & 1;
-        if (bit_val) {
-          gf2_vec_set(&H->rows[row], col, 1);
-        }
+        if ((val >> bit) & 1) gf2_mat_set(H, j * m + bit, col, 1);
       }
 
       /* Next power: L_i^(j+1) */
@@ -90,259 +77,1049 @@ static gf2_mat* build_parity_check_matrix(const goppa_params *P, const gf2m_ctx
     }
   }
 
-  poly_gf2m_free(&g_poly);
-  free(g_at_L);
-  return H;
+  return 0;
+}
+
+/* Column of the syndrome map for support element a:
+ * 1/(x - a) = (g(x) - g(a)) / (x - a) * g(a)^-1 mod g, by synthetic division */
+static void syndrome_column(const gf2m_ctx *f, const uint16_t *g, unsigned t, uint16_t a,
+                            uint16_t g_a, uint16_t *col) {
+  col[t - 1] = g[t];
+  for (unsigned j = t - 1; j > 0; j--) col[j - 1] = g[j] ^ gf2m_mul(f, a, col[j]);
+  gf2m_mul_scalar(f, col, col, gf2m_inv(f, g_a), t);
+}
+
+/* a = a^2 mod g: tmp holds 2t - 1 coefficients, a has t */
+static void sqr_mod_g(const gf2m_ctx *f, const uint16_t *g, unsigned t, uint16_t lead_inv,
+                      uint16_t *a, uint16_t *tmp) {
+  memset(tmp, 0, (2 * t - 1) * sizeof(uint16_t));
+  for (unsigned i = 0; i < t; i++) tmp[2 * i] = gf2m_sqr(f, a[i]);
+  for (unsigned d = 2 * t - 2; d >= t; d--) {
+    if (tmp[d]) gf2m_mac_scalar(f, tmp + d - t, g, gf2m_mul(f, tmp[d], lead_inv), t + 1);
+  }
+  memcpy(a, tmp, t * sizeof(uint16_t));
+}
+
+/* Degree of gcd(a, g) for a of degree < t */
+static int gcd_degree(const gf2m_ctx *f, const uint16_t *g, unsigned t, const uint16_t *a) {
+  poly_gf2m_t pa, pg, r;
+  int deg = -1;
+  if (poly_gf2m_init(&pa, f, (int)t) == 0 && poly_gf2m_init(&pg, f, (int)t + 1) == 0 &&
+      poly_gf2m_init(&r, f, (int)t + 1) == 0) {
+    for (unsigned i = 0; i < t; i++) poly_gf2m_set_coeff(&pa, (int)i, a[i]);
+    for (unsigned i = 0; i <= t; i++) poly_gf2m_set_coeff(&pg, (int)i, g[i]);
+    poly_gf2m_gcd(&r, &pa, &pg);
+    deg = r.deg;
+  }
+  poly_gf2m_free(&pa);
+  poly_gf2m_free(&pg);
+  poly_gf2m_free(&r);
+  return deg;
 }
 
 /**
- * Goppa Encoder (systematic)
- *
- * Given message m of length k, compute parity p of length mt such that:
- *   [m | p] is a valid codeword (H * [m | p]^T = 0)
+ * Rows x^i * sqrt(x) mod g for i < (t + 1) / 2, if g is irreducible.
  *
- * We split H = [H1 | H2] where H1 is mt x k, H2 is mt x mt
- * Then p = H2^-1 * H1 * m (over GF(2))
+ * Repeated squaring gives x^(2^s) mod g for s up to mt, with sqrt(x) at
+ * s = mt - 1. Rabin's test runs alongside: g is irreducible iff
+ * x^(2^mt) = x mod g and gcd(x^(2^(mt/p)) - x, g) = 1 for every prime p
+ * dividing t. Returns 0 with *out = NULL for reducible g, -1 if out of
+ * memory.
  */
-static codectk_err goppa_encode(const void *pp, const uint8_t *in, size_t in_bits,
-                                uint8_t *out, size_t *out_bits) {
-  const goppa_params *P = (const goppa_params*)pp;
+static int build_sqrt_rows(const gf2m_ctx *f, const uint16_t *g, unsigned t,
+                           uint16_t **out) {
+  unsigned m = f->m, rows = (t + 1) / 2;
+  uint16_t lead_inv = gf2m_inv(f, g[t]);
+  uint16_t *x = (uint16_t*)calloc(t, sizeof(uint16_t));
+  uint16_t *tmp = (uint16_t*)malloc((2 * t + 1) * sizeof(uint16_t));
+  uint16_t *R = (uint16_t*)calloc((size_t)rows * t, sizeof(uint16_t));
+  int ret = 0, irreducible = 1;
+  *out = NULL;
+  if (!x || !tmp || !R) {
+    ret = -1;
+    goto done;
+  }
+
+  /* x mod g; for t = 1 that is the root of g */
+  if (t > 1) x[1] = 1;
+  else x[0] = gf2m_mul(f, g[0], lead_inv);
+  uint16_t x1 = x[t > 1 ? 1 : 0];
 
-  if (!P || !in || !out || !out_bits) return CODECTK_EINVAL;
-  if (P->m < 2 || P->m > 16 || P->t == 0 || P->n == 0) return CODECTK_EINVAL;
-  if (!P->L || !P->g) return CODECTK_EINVAL;
+  for (unsigned s = 1; s <= m * t && irreducible; s++) {
+    sqr_mod_g(f, g, t, lead_inv, x, tmp);
+    if (s == m * t - 1) memcpy(R, x, t * sizeof(uint16_t));
+
+    /* s = m * t / p for a prime p dividing t */
+    if (s % m == 0 && s < m * t) {
+      unsigned d = t / (s / m);
+      int prime = (t % (s / m) == 0);
+      for (unsigned q = 2; q * q <= d && prime; q++) prime = (d % q != 0);
+      if (prime && d > 1) {
+        x[t > 1 ? 1 : 0] ^= x1;
+        int deg = gcd_degree(f, g, t, x);
+        x[t > 1 ? 1 : 0] ^= x1;
+        if (deg < 0) ret = -1;
+        irreducible = deg == 0;
+      }
+    }
+  }
+  if (ret != 0) goto done;
 
-  /* Initialize field context */
-  gf2m_ctx ctx;
-  if (gf2m_ctx_init(&ctx, P->m, 0x11D) != 0) {  /* Default primitive poly */
-    return CODECTK_ENOMEM;
+  /* x^(2^mt) must have come back to x */
+  for (unsigned i = 0; i < t && irreducible; i++) {
+    irreducible = x[i] == ((t > 1) ? (i == 1) : x1);
   }
+  if (!irreducible) goto done;
 
-  /* Build parity-check matrix */
-  gf2_mat *H = build_parity_check_matrix(P, &ctx);
-  if (!H) {
-    gf2m_ctx_free(&ctx);
-    return CODECTK_ENOMEM;
+  /* Row i + 1 = x * row i mod g */
+  for (unsigned i = 1; i < rows; i++) {
+    uint16_t *prev = R + (size_t)(i - 1) * t, *row = R + (size_t)i * t;
+    uint16_t top = prev[t - 1];
+    row[0] = 0;
+    memcpy(row + 1, prev, (t - 1) * sizeof(uint16_t));
+    if (top) gf2m_mac_scalar(f, row, g, gf2m_mul(f, top, lead_inv), t);
   }
+  *out = R;
+  R = NULL;
+
+done:
+  free(x);
+  free(tmp);
+  free(R);
+  return ret;
+}
 
-  size_t mt = (size_t)P->t * P->m;
-  size_t k = P->n - mt;
+/* Check P, returning the field and g(L_i) for every i in g_at_L */
+static codectk_err check_params(const goppa_params *P, const gf2m_ctx **field,
+                                uint16_t *g_at_L) {
+  if (P->m < 2 || P->m > 16 || P->t == 0) return CODECTK_EINVAL;
+  if (!P->L || !P->g || P->g[P->t] == 0) return CODECTK_EINVAL;
+  if (P->n > (1u << P->m) || (size_t)P->t * P->m >= P->n) return CODECTK_EINVAL;
 
-  if (in_bits > k) {
-    gf2_mat_free(H);
-    free(H);
-    gf2m_ctx_free(&ctx);
+  /* Shared field context for (m, mod_poly) */
+  const gf2m_ctx *ctx = gf2m_ctx_get(P->m, P->mod_poly);
+  if (!ctx) return CODECTK_EINVAL;
+
+  /* Distinct field elements */
+  uint8_t *seen = (uint8_t*)calloc(((1u << P->m) + 7) / 8, 1);
+  if (!seen) return CODECTK_ENOMEM;
+  codectk_err err = CODECTK_OK;
+  for (size_t i = 0; i < P->n && err == CODECTK_OK; i++) {
+    uint16_t x = P->L[i];
+    if (x >> P->m || (seen[x / 8] >> (x % 8)) & 1) err = CODECTK_EINVAL;
+    else seen[x / 8] |= (uint8_t)(1u << (x % 8));
+  }
+  free(seen);
+  if (err != CODECTK_OK) return err;
+
+  /* No support element may be a root of g(x) */
+  gf2m_poly_eval_multi(ctx, P->g, (int)P->t, P->L, g_at_L, P->n);
+  for (size_t i = 0; i < P->n; i++) {
+    if (g_at_L[i] == 0) return CODECTK_EINVAL;
+  }
+
+  *field = ctx;
+  return CODECTK_OK;
+}
+
+codectk_err goppa_ctx_create(const goppa_params *P, goppa_ctx **out) {
+  if (!out) return CODECTK_EINVAL;
+  *out = NULL;
+  if (!P || P->n == 0 || P->n > GOPPA_MAX_N || (P->flags & ~GOPPA_FLAG_CT)) {
     return CODECTK_EINVAL;
   }
 
-  /* For simplicity, use generator matrix approach:
-   * Since this is complex, we'll encode by finding parity bits
-   * that make H * codeword = 0.
-   *
-   * Simplified: just copy message and compute parity via syndrome.
-   * For a proper implementation, we'd solve H2 * p = H1 * m.
-   */
+  uint16_t *g_at_L = (uint16_t*)malloc(P->n * sizeof(uint16_t));
+  if (!g_at_L) return CODECTK_ENOMEM;
+
+  const gf2m_ctx *field = NULL;
+  codectk_err err = check_params(P, &field, g_at_L);
+  if (err != CODECTK_OK) {
+    free(g_at_L);
+    return err;
+  }
+
+  size_t n = P->n, mt = (size_t)P->t * P->m;
+  goppa_ctx *c = (goppa_ctx*)calloc(1, sizeof(goppa_ctx));
+  gf2_mat H = {0};
+  size_t *piv = (size_t*)malloc(mt * sizeof(size_t));
+  uint8_t *is_piv = (uint8_t*)calloc(n, 1);
+  if (!c || !piv || !is_piv || build_parity_check_matrix(&H, P, field, g_at_L) != 0) {
+    err = CODECTK_ENOMEM;
+    goto done;
+  }
+
+  c->m = P->m;
+  c->t = P->t;
+  c->n = n;
+  c->field = field;
+  c->flags = P->flags;
+  c->g = (uint16_t*)malloc((P->t + 1) * sizeof(uint16_t));
+  c->L = (uint16_t*)malloc(n * sizeof(uint16_t));
+  c->pos = (uint32_t*)malloc(n * sizeof(uint32_t));
+  if (!c->g || !c->L || !c->pos) {
+    err = CODECTK_ENOMEM;
+    goto done;
+  }
+  memcpy(c->g, P->g, (P->t + 1) * sizeof(uint16_t));
+  memcpy(c->L, P->L, n * sizeof(uint16_t));
+
+  /* Decoding tables: the syndrome columns and, for irreducible g, sqrt(x) */
+  c->syn = (uint16_t*)malloc(n * P->t * sizeof(uint16_t));
+  c->pow = (uint16_t*)malloc(n * P->t * sizeof(uint16_t));
+  if (!c->syn || !c->pow || build_sqrt_rows(field, c->g, c->t, &c->sqrt_x) != 0) {
+    err = CODECTK_ENOMEM;
+    goto done;
+  }
+  for (size_t i = 0; i < n; i++) {
+    syndrome_column(field, c->g, c->t, c->L[i], g_at_L[i], c->syn + i * c->t);
+  }
+  memcpy(c->pow, c->L, n * sizeof(uint16_t));
+  for (size_t j = 1; j < c->t; j++) {
+    gf2m_mul_vec(field, c->pow + j * n, c->pow + (j - 1) * n, c->L, n);
+  }
+
+  /* Constant-time decoding: the parity checks of g^2, in bits */
+  if (c->flags & GOPPA_FLAG_CT) {
+    if (gf2_mat_init(&c->ct_h, 2 * mt, n) != 0) {
+      err = CODECTK_ENOMEM;
+      goto done;
+    }
+    for (size_t i = 0; i < n; i++) {
+      uint16_t v = gf2m_sqr(field, gf2m_inv(field, g_at_L[i]));
+      for (unsigned j = 0; j < 2 * c->t; j++) {
+        for (unsigned b = 0; b < c->m; b++) {
+          if ((v >> b) & 1) gf2_mat_set(&c->ct_h, j * c->m + b, i, 1);
+        }
+        v = gf2m_mul(field, v, c->L[i]);
+      }
+    }
+  }
+
+  /* Systematic form: pivot columns carry the parity bits */
+  c->r = gf2_mat_row_reduce_pivots(&H, piv);
+  c->k = n - c->r;
+  for (size_t i = 0; i < c->r; i++) is_piv[piv[i]] = 1;
+
+  size_t nm = 0;
+  for (size_t p = 0; p < n; p++) {
+    if (!is_piv[h_col(p, n, mt)]) c->pos[nm++] = (uint32_t)p;
+  }
+  for (size_t i = 0; i < c->r; i++) c->pos[c->k + i] = (uint32_t)h_pos(piv[i], n, mt);
+
+  int in_place = 1;
+  for (size_t i = 0; i < n && in_place; i++) in_place = c->pos[i] == i;
+
+  /* Row i of H reads parity_i = sum over message bits j of H[i][col(j)] m_j */
+  if (gf2_mat_init(&c->gen, c->k, c->r) != 0) {
+    err = CODECTK_ENOMEM;
+    goto done;
+  }
+  for (size_t i = 0; i < c->r; i++) {
+    for (size_t j = 0; j < c->k; j++) {
+      if (gf2_mat_get(&H, i, h_col(c->pos[j], n, mt))) gf2_mat_set(&c->gen, j, i, 1);
+    }
+  }
+
+  if (in_place) {
+    free(c->pos);
+    c->pos = NULL;
+  }
+
+done:
+  gf2_mat_free(&H);
+  free(piv);
+  free(is_piv);
+  free(g_at_L);
+  if (err != CODECTK_OK) {
+    goppa_ctx_destroy(c);
+    return err;
+  }
+  *out = c;
+  return CODECTK_OK;
+}
 
-  /* Copy message bits */
-  size_t out_bytes = (P->n + 7) / 8;
-  if (out_bytes > (*out_bits) / 8) {
-    gf2_mat_free(H);
-    free(H);
-    gf2m_ctx_free(&ctx);
-    return CODECTK_ENOMEM;
+void goppa_ctx_destroy(goppa_ctx *ctx) {
+  if (!ctx) return;
+  gf2_mat_free(&ctx->gen);
+  free(ctx->g);
+  free(ctx->L);
+  free(ctx->pos);
+  free(ctx->syn);
+  free(ctx->pow);
+  free(ctx->sqrt_x);
+  gf2_mat_free(&ctx->ct_h);
+  free(ctx);
+}
+
+/* The first bits bits of in as words; the rest of words[0..nw) is zero */
+static void load_words(uint64_t *words, size_t nw, const uint8_t *in, size_t bits) {
+  size_t full = bits / 64;
+  for (size_t w = 0; w < full; w++) words[w] = bitio_load_le64(in + 8 * w);
+  memset(words + full, 0, (nw - full) * sizeof(uint64_t));
+  for (size_t b = full * 8; b < (bits + 7) / 8; b++) {
+    words[full] |= (uint64_t)in[b] << (8 * (b - full * 8));
+  }
+  if (bits % 64) words[full] &= bitio_mask((unsigned)(bits % 64));
+}
+
+/* Write the codeword for msg (k bits) and par (r bits) */
+static void emit_codeword(const goppa_ctx *c, const uint64_t *msg, const uint64_t *par,
+                          uint8_t *out) {
+  size_t out_bytes = (c->n + 7) / 8;
+
+  if (!c->pos) {
+    /* [message | parity], 64 bits at a time */
+    bitw_t w;
+    bitw_init(&w, out, out_bytes);
+    for (size_t i = 0; i < c->k; i += 64) {
+      bitw_put_bits(&w, msg[i / 64], (unsigned)(c->k - i < 64 ? c->k - i : 64));
+    }
+    for (size_t i = 0; i < c->r; i += 64) {
+      bitw_put_bits(&w, par[i / 64], (unsigned)(c->r - i < 64 ? c->r - i : 64));
+    }
+    bitw_flush(&w);
+    return;
   }
 
   memset(out, 0, out_bytes);
-  for (size_t i = 0; i < in_bits; i++) {
-    int byte_idx = (int)(i / 8);
-    int bit_idx = (int)(i % 8);
-    int bit = (in[byte_idx] >> bit_idx) & 1;
-    if (bit) {
-      out[byte_idx] |= (uint8_t)(1 << bit_idx);
+  for (size_t i = 0; i < c->n; i++) {
+    const uint64_t *src = (i < c->k) ? msg : par;
+    size_t j = (i < c->k) ? i : i - c->k;
+    if ((src[j / 64] >> (j % 64)) & 1) {
+      out[c->pos[i] / 8] |= (uint8_t)(1u << (c->pos[i] % 8));
     }
   }
+}
 
-  /* Set parity bits to zero for now (systematic encoding needs matrix inversion) */
-  /* Proper implementation would solve linear system */
+static codectk_err check_encode(const goppa_ctx *c, const uint8_t *in, size_t in_bits,
+                                const uint8_t *out, const size_t *out_bits) {
+  if (!c || !out || !out_bits || (in_bits && !in) || in_bits > c->k) return CODECTK_EINVAL;
+  if ((c->n + 7) / 8 > (*out_bits) / 8) return CODECTK_ENOMEM;
+  return CODECTK_OK;
+}
 
-  *out_bits = P->n;
+codectk_err goppa_ctx_encode(const goppa_ctx *ctx, const uint8_t *in, size_t in_bits,
+                             uint8_t *out, size_t *out_bits) {
+  codectk_err err = check_encode(ctx, in, in_bits, out, out_bits);
+  if (err != CODECTK_OK) return err;
 
-  gf2_mat_free(H);
-  free(H);
-  gf2m_ctx_free(&ctx);
+  /* parity = message * gen: the XOR of the rows of gen for the set bits */
+  uint64_t msg[GOPPA_MAX_N / 64], par[GOPPA_MAX_N / 64];
+  size_t kw = (ctx->k + 63) / 64, rw = (ctx->r + 63) / 64;
+  load_words(msg, kw, in, in_bits);
+  memset(par, 0, rw * sizeof(uint64_t));
 
+  for (size_t w = 0; w < kw; w++) {
+    for (uint64_t bits = msg[w]; bits; bits &= bits - 1) {
+      const uint64_t *row = gf2_mat_row(&ctx->gen, w * 64 + (size_t)__builtin_ctzll(bits));
+      for (size_t i = 0; i < rw; i++) par[i] ^= row[i];
+    }
+  }
+
+  emit_codeword(ctx, msg, par, out);
+  *out_bits = ctx->n;
   return CODECTK_OK;
 }
 
+/* Messages stacked per gf2_mat_mul(): enough to amortize the tables */
+#define GOPPA_BATCH_RUN 256
+
+codectk_err goppa_ctx_encode_batch(const goppa_ctx *ctx, codectk_batch_item *items,
+                                   size_t count) {
+  if (!ctx) return fail_batch(items, count, CODECTK_EINVAL);
+
+  codectk_err first = CODECTK_OK;
+  gf2_mat M = {0}, Par = {0};
+  size_t run_max = count < GOPPA_BATCH_RUN ? count : GOPPA_BATCH_RUN;
+  int stacked = run_max > 1 && gf2_mat_init(&M, run_max, ctx->k) == 0 &&
+                gf2_mat_init(&Par, run_max, ctx->r) == 0;
+
+  for (size_t base = 0; base < count; base += run_max) {
+    size_t run = (count - base < run_max) ? count - base : run_max;
+
+    if (!stacked) {
+      for (size_t i = base; i < base + run; i++) {
+        codectk_batch_item *it = &items[i];
+        it->num_corrected = 0;
+        it->err = goppa_ctx_encode(ctx, it->in, it->in_bits, it->out, &it->out_bits);
+        if (first == CODECTK_OK) first = it->err;
+      }
+      continue;
+    }
+
+    /* Rows of M are the messages; invalid items get a zero row */
+    M.n_rows = Par.n_rows = run;
+    for (size_t i = 0; i < run; i++) {
+      codectk_batch_item *it = &items[base + i];
+      it->num_corrected = 0;
+      it->err = check_encode(ctx, it->in, it->in_bits, it->out, &it->out_bits);
+      if (it->err == CODECTK_OK) {
+        load_words(gf2_mat_row(&M, i), M.stride, it->in, it->in_bits);
+      } else {
+        memset(gf2_mat_row(&M, i), 0, M.stride * sizeof(uint64_t));
+      }
+    }
+    gf2_mat_mul(&Par, &M, &ctx->gen);
+
+    for (size_t i = 0; i < run; i++) {
+      codectk_batch_item *it = &items[base + i];
+      if (it->err == CODECTK_OK) {
+        emit_codeword(ctx, gf2_mat_row(&M, i), gf2_mat_row(&Par, i), it->out);
+        it->out_bits = ctx->n;
+      }
+      if (first == CODECTK_OK) first = it->err;
+    }
+  }
+
+  M.n_rows = Par.n_rows = run_max;
+  gf2_mat_free(&M);
+  gf2_mat_free(&Par);
+  return first;
+}
+
+static codectk_err get_ctx(const goppa_params *P, const goppa_ctx **c, goppa_ctx **owned) {
+  *owned = NULL;
+  if (!P) return CODECTK_EINVAL;
+  if (P->ctx) {
+    *c = P->ctx;
+    return CODECTK_OK;
+  }
+  CODECTK_STATS_T0(t0);
+  codectk_err err = goppa_ctx_create(P, owned);
+  CODECTK_STATS_STAGE(GOPPA, SETUP, t0);
+  *c = *owned;
+  return err;
+}
+
+static codectk_err goppa_encode(const void *pp, const uint8_t *in, size_t in_bits,
+                                uint8_t *out, size_t *out_bits) {
+  const goppa_ctx *c;
+  goppa_ctx *owned;
+  codectk_err err = get_ctx((const goppa_params*)pp, &c, &owned);
+  if (err != CODECTK_OK) return err;
+
+  err = goppa_ctx_encode(c, in, in_bits, out, out_bits);
+  goppa_ctx_destroy(owned);
+  return err;
+}
+
+static codectk_err goppa_encode_batch(const void *pp, codectk_batch_item *items,
+                                      size_t count) {
+  const goppa_ctx *c;
+  goppa_ctx *owned;
+  codectk_err err = get_ctx((const goppa_params*)pp, &c, &owned);
+  if (err != CODECTK_OK) return fail_batch(items, count, err);
+
+  err = goppa_ctx_encode_batch(c, items, count);
+  goppa_ctx_destroy(owned);
+  return err;
+}
+
+/* Support points evaluated per round of the root search */
+#define GOPPA_ROOT_BLOCK 1024
+
+static size_t decode_scratch_size(size_t t, size_t n) {
+  /* Euclid's r0, r1, b0, b1 and sigma (t + 1 each), S and tau (t), the
+   * root search block and its positions, the received word */
+  return 5 * codectk_arena_round((t + 1) * sizeof(uint16_t)) +
+         2 * codectk_arena_round(t * sizeof(uint16_t)) +
+         codectk_arena_round(GOPPA_ROOT_BLOCK * sizeof(uint16_t)) +
+         codectk_arena_round(t * sizeof(uint32_t)) +
+         codectk_arena_round((n + 63) / 64 * sizeof(uint64_t)) + CODECTK_ARENA_ALIGN;
+}
+
+size_t goppa_ctx_workspace_size(const goppa_ctx *ctx) {
+  return ctx ? decode_scratch_size(ctx->t, ctx->n) : 0;
+}
+
+size_t goppa_workspace_size(const goppa_params *P) {
+  if (!P || P->t == 0 || P->t > 0xffff || P->n == 0 || P->n > GOPPA_MAX_N) return 0;
+  return decode_scratch_size(P->t, P->n);
+}
+
+static int trim(const uint16_t *a, int deg) {
+  while (deg >= 0 && a[deg] == 0) deg--;
+  return deg;
+}
+
 /**
- * Compute syndrome polynomial S(x) = Σ r_i / (x - L_i) mod g(x)
- * where r is the received vector.
+ * Euclid's algorithm on (r0, r1) = (g, a), stopped once deg r1 <= stop.
+ * Alongside, b1 * a = r1 mod g. All four buffers hold t + 1 coefficients.
  */
-static void compute_syndrome_poly(poly_gf2m_t *S, const uint8_t *received, size_t n,
-                                   const goppa_params *P, const gf2m_ctx *ctx) {
-  poly_gf2m_zero(S);
+typedef struct {
+  uint16_t *r0, *r1, *b0, *b1;
+  int dr0, dr1, db0, db1;
+} euclid_state;
+
+static void euclid_init(euclid_state *e, const goppa_ctx *c, const uint16_t *a) {
+  size_t len = (c->t + 1) * sizeof(uint16_t);
+  memcpy(e->r0, c->g, len);
+  memset(e->r1, 0, len);
+  memcpy(e->r1, a, c->t * sizeof(uint16_t));
+  memset(e->b0, 0, len);
+  memset(e->b1, 0, len);
+  e->b1[0] = 1;
+  e->dr0 = (int)c->t;
+  e->dr1 = trim(e->r1, (int)c->t - 1);
+  e->db0 = -1;
+  e->db1 = 0;
+}
+
+static void euclid_run(euclid_state *e, const gf2m_ctx *f, int stop) {
+  while (e->dr1 > stop) {
+    /* r0 -= q * r1 and b0 -= q * b1, one quotient term at a time */
+    uint16_t lead_inv = gf2m_inv(f, e->r1[e->dr1]);
+    while (e->dr0 >= e->dr1) {
+      int s = e->dr0 - e->dr1;
+      uint16_t q = gf2m_mul(f, e->r0[e->dr0], lead_inv);
+      gf2m_mac_scalar(f, e->r0 + s, e->r1, q, (size_t)e->dr1 + 1);
+      gf2m_mac_scalar(f, e->b0 + s, e->b1, q, (size_t)e->db1 + 1);
+      e->dr0 = trim(e->r0, e->dr0 - 1);
+      if (e->db1 + s > e->db0) e->db0 = e->db1 + s;
+    }
+    e->db0 = trim(e->b0, e->db0);
 
-  /* Build g(x) polynomial */
-  poly_gf2m_t g;
-  poly_gf2m_init(&g, ctx, (int)P->t + 1);
-  for (unsigned i = 0; i <= P->t; i++) {
-    poly_gf2m_set_coeff(&g, (int)i, P->g[i]);
+    uint16_t *r = e->r0, *b = e->b0;
+    int dr = e->dr0, db = e->db0;
+    e->r0 = e->r1;
+    e->b0 = e->b1;
+    e->dr0 = e->dr1;
+    e->db0 = e->db1;
+    e->r1 = r;
+    e->b1 = b;
+    e->dr1 = dr;
+    e->db1 = db;
   }
+}
 
-  /* For each bit position i where r_i = 1, add 1/(x - L_i) mod g(x) */
-  for (size_t i = 0; i < n; i++) {
-    int byte_idx = (int)(i / 8);
-    int bit_idx = (int)(i % 8);
-    int r_i = (received[byte_idx] >> bit_idx) & 1;
-
-    if (r_i) {
-      /* Add 1/(x - L_i) to S(x)
-       * This is: 1/(x - L_i) = inv(x - L_i) as a polynomial
-       * We need to compute (x - L_i)^-1 mod g(x)
-       */
-      poly_gf2m_t denom, inv_denom;
-      poly_gf2m_init(&denom, ctx, 2);
-      poly_gf2m_init(&inv_denom, ctx, (int)P->t);
-
-      /* denom = x - L_i = x + L_i (in GF(2^m)) */
-      poly_gf2m_set_coeff(&denom, 0, P->L[i]);
-      poly_gf2m_set_coeff(&denom, 1, 1);
-
-      /* Compute inverse mod g(x) */
-      if (poly_gf2m_inv_mod(&inv_denom, &denom, &g) == 0) {
-        /* Add to S */
-        poly_gf2m_t temp;
-        poly_gf2m_init(&temp, ctx, S->deg + inv_denom.deg + 1);
-        poly_gf2m_add(&temp, S, &inv_denom);
-        poly_gf2m_copy(S, &temp);
-        poly_gf2m_free(&temp);
-      }
+static inline void xor_column(uint16_t *restrict dst, const uint16_t *restrict src,
+                              unsigned t) {
+  for (unsigned j = 0; j < t; j++) dst[j] ^= src[j];
+}
 
-      poly_gf2m_free(&denom);
-      poly_gf2m_free(&inv_denom);
+/* sqrt(a) = a^(2^(m-1)): halve the logarithm modulo the odd group order */
+static uint16_t gf_sqrt(const gf2m_ctx *f, uint16_t a) {
+  if (a == 0) return 0;
+  unsigned order = (1u << f->m) - 1, l = f->log[a];
+  return f->alog[(l & 1) ? (l + order) / 2 : l / 2];
+}
+
+/* The k message bits of the n-bit word w */
+static void write_message(const goppa_ctx *c, const uint64_t *w, uint8_t *out) {
+  size_t out_bytes = (c->k + 7) / 8;
+  if (!c->pos) {
+    bitw_t bw;
+    bitw_init(&bw, out, out_bytes);
+    for (size_t i = 0; i < c->k; i += 64) {
+      bitw_put_bits(&bw, w[i / 64], (unsigned)(c->k - i < 64 ? c->k - i : 64));
     }
+    bitw_flush(&bw);
+    return;
   }
 
-  /* Reduce S mod g */
-  poly_gf2m_t S_reduced;
-  poly_gf2m_init(&S_reduced, ctx, (int)P->t);
-  poly_gf2m_mod(&S_reduced, S, &g);
-  poly_gf2m_copy(S, &S_reduced);
+  /* Without branching on the bits, for the constant-time decoder */
+  memset(out, 0, out_bytes);
+  for (size_t i = 0; i < c->k; i++) {
+    uint32_t p = c->pos[i];
+    out[i / 8] |= (uint8_t)(((w[p / 64] >> (p % 64)) & 1) << (i % 8));
+  }
+}
+
+/**
+ * Error locator of the nonzero syndrome S into sigma (t + 1 coefficients),
+ * using tau and e as scratch. Returns deg sigma, or -1 if the word is not
+ * within t errors of a codeword.
+ */
+static int key_equation(const goppa_ctx *c, uint16_t *S, uint16_t *tau, uint16_t *sigma,
+                        euclid_state *e) {
+  const gf2m_ctx *f = c->field;
+  unsigned t = c->t;
 
-  poly_gf2m_free(&S_reduced);
-  poly_gf2m_free(&g);
+  /* T = S^-1 mod g: Euclid down to a constant remainder */
+  euclid_init(e, c, S);
+  euclid_run(e, f, 0);
+  if (e->dr1 != 0) return -1;
+  gf2m_mul_scalar(f, S, e->b1, gf2m_inv(f, e->r1[0]), t);
+
+  /* tau = sqrt(T + x) = sum sqrt(T_2i) x^i + sum sqrt(T_2i+1) x^i sqrt(x) */
+  if (t > 1) S[1] ^= 1;
+  else S[0] ^= gf2m_mul(f, c->g[0], gf2m_inv(f, c->g[1]));
+  for (unsigned i = 0; 2 * i < t; i++) tau[i] = gf_sqrt(f, S[2 * i]);
+  for (unsigned i = 0; 2 * i + 1 < t; i++) {
+    if (S[2 * i + 1]) {
+      gf2m_mac_scalar(f, tau, c->sqrt_x + (size_t)i * t, gf_sqrt(f, S[2 * i + 1]), t);
+    }
+  }
+
+  /* Lattice step: a = b tau mod g with deg a <= t/2, deg b <= (t-1)/2 */
+  euclid_init(e, c, tau);
+  euclid_run(e, f, (int)t / 2);
+  if (2 * e->dr1 > (int)t || 2 * e->db1 + 1 > (int)t) return -1;
+
+  /* sigma = a^2 + x b^2 */
+  for (int i = 0; i <= e->dr1; i++) sigma[2 * i] = gf2m_sqr(f, e->r1[i]);
+  for (int i = 0; i <= e->db1; i++) sigma[2 * i + 1] = gf2m_sqr(f, e->b1[i]);
+  return trim(sigma, (int)t);
 }
 
 /**
- * Patterson decoder for binary Goppa codes.
- *
- * 1. Compute syndrome S(x)
- * 2. Compute T(x) = S(x)^-1 mod g(x)
- * 3. Find a(x), b(x): a² + xb² ≡ T (mod g)
- * 4. Error locator σ(x) = gcd(a + xb, g)
- * 5. Find roots in support set L
+ * Batched Chien search: sigma(L_i) = sigma_0 + sum of sigma_j L_i^j, one
+ * scalar-times-vector pass per coefficient over a block of the support,
+ * until deg sigma roots are found. Returns deg, or -1 if sigma does not
+ * have exactly deg roots in the support.
  */
+static int root_search(const goppa_ctx *c, const uint16_t *sigma, int deg, uint32_t *errs,
+                       uint16_t *y) {
+  const gf2m_ctx *f = c->field;
+  size_t n = c->n;
+  int found = 0;
+  for (size_t base = 0; base < n && found < deg; base += GOPPA_ROOT_BLOCK) {
+    size_t len = (n - base < GOPPA_ROOT_BLOCK) ? n - base : GOPPA_ROOT_BLOCK;
+    for (size_t i = 0; i < len; i++) y[i] = sigma[0];
+    for (int j = 1; j <= deg; j++) {
+      if (sigma[j]) gf2m_mac_scalar(f, y, c->pow + (size_t)(j - 1) * n + base, sigma[j], len);
+    }
+    for (size_t i = 0; i < len; i++) {
+      if (y[i] == 0) {
+        if (found == deg) return -1;
+        errs[found++] = (uint32_t)(base + i);
+      }
+    }
+  }
+  return found == deg ? found : -1;
+}
+
+/**
+ * Patterson: error positions of w into errs, returning their count, or -1
+ * if w is not within t errors of a codeword.
+ */
+static int patterson(const goppa_ctx *c, const uint64_t *w, uint32_t *errs,
+                     codectk_arena *ws) {
+  unsigned t = c->t;
+  size_t n = c->n;
+  size_t tl = (t + 1) * sizeof(uint16_t);
+  uint16_t *S = (uint16_t*)codectk_arena_calloc(ws, t * sizeof(uint16_t));
+  uint16_t *tau = (uint16_t*)codectk_arena_calloc(ws, t * sizeof(uint16_t));
+  uint16_t *sigma = (uint16_t*)codectk_arena_calloc(ws, tl);
+  uint16_t *y = (uint16_t*)codectk_arena_alloc(ws, GOPPA_ROOT_BLOCK * sizeof(uint16_t));
+  euclid_state e;
+  e.r0 = (uint16_t*)codectk_arena_alloc(ws, tl);
+  e.r1 = (uint16_t*)codectk_arena_alloc(ws, tl);
+  e.b0 = (uint16_t*)codectk_arena_alloc(ws, tl);
+  e.b1 = (uint16_t*)codectk_arena_alloc(ws, tl);
+
+  /* S(x) = sum of 1/(x - L_i) over the set bits: XOR of precomputed columns */
+  CODECTK_STATS_T0(t0);
+  for (size_t wi = 0; wi < (n + 63) / 64; wi++) {
+    for (uint64_t bits = w[wi]; bits; bits &= bits - 1) {
+      xor_column(S, c->syn + (wi * 64 + (size_t)__builtin_ctzll(bits)) * t, t);
+    }
+  }
+  CODECTK_STATS_STAGE(GOPPA, SYNDROME, t0);
+  if (trim(S, (int)t - 1) < 0) return 0;
+
+  CODECTK_STATS_RESTART(t0);
+  int deg = key_equation(c, S, tau, sigma, &e);
+  CODECTK_STATS_STAGE(GOPPA, KEY_EQUATION, t0);
+  if (deg < 1) return -1;
+
+  CODECTK_STATS_RESTART(t0);
+  int found = root_search(c, sigma, deg, errs, y);
+  CODECTK_STATS_STAGE(GOPPA, ROOTS, t0);
+  return found;
+}
+
+codectk_err goppa_ctx_decode_ws(const goppa_ctx *ctx, const uint8_t *in, size_t in_bits,
+                                uint8_t *out, size_t *out_bits, size_t *num_corrected,
+                                void *workspace, size_t workspace_size) {
+  if (!ctx || !in || !out || !out_bits || in_bits < ctx->n) return CODECTK_EINVAL;
+  if (!ctx->sqrt_x) return CODECTK_ENOTSUP;
+  if ((ctx->k + 7) / 8 > (*out_bits) / 8) return CODECTK_ENOMEM;
+
+  size_t need = goppa_ctx_workspace_size(ctx);
+  if (workspace && workspace_size < need) return CODECTK_EINVAL;
+  void *owned = NULL;
+  if (!workspace) {
+    owned = workspace = malloc(need);
+    if (!owned) return CODECTK_ENOMEM;
+  }
+  codectk_arena ws;
+  codectk_arena_init(&ws, workspace, need);
+
+  size_t nw = (ctx->n + 63) / 64;
+  uint64_t *w = (uint64_t*)codectk_arena_alloc(&ws, nw * sizeof(uint64_t));
+  uint32_t *errs = (uint32_t*)codectk_arena_alloc(&ws, ctx->t * sizeof(uint32_t));
+  CODECTK_STATS_T0(t0);
+  load_words(w, nw, in, ctx->n);
+  CODECTK_STATS_STAGE(GOPPA, BITIO, t0);
+
+  /* Beyond t errors the word is passed through uncorrected */
+  int e = patterson(ctx, w, errs, &ws);
+  for (int i = 0; i < e; i++) w[errs[i] / 64] ^= 1ULL << (errs[i] % 64);
+  if (e < 0) CODECTK_STATS_FAILURES(GOPPA, 1);
+  else CODECTK_STATS_WORDS(GOPPA, (size_t)e, 1);
+
+  CODECTK_STATS_RESTART(t0);
+  write_message(ctx, w, out);
+  CODECTK_STATS_STAGE(GOPPA, BITIO, t0);
+  *out_bits = ctx->k;
+  if (num_corrected) *num_corrected = e > 0 ? (size_t)e : 0;
+  free(owned);
+  return e < 0 ? CODECTK_EDECODE : CODECTK_OK;
+}
+
+codectk_err goppa_ctx_decode(const goppa_ctx *ctx, const uint8_t *in, size_t in_bits,
+                             uint8_t *out, size_t *out_bits, size_t *num_corrected) {
+  return goppa_ctx_decode_ws(ctx, in, in_bits, out, out_bits, num_corrected, NULL, 0);
+}
+
+codectk_err goppa_decode_ws(const goppa_params *P, const uint8_t *in, size_t in_bits,
+                            uint8_t *out, size_t *out_bits, size_t *num_corrected,
+                            void *workspace, size_t workspace_size) {
+  const goppa_ctx *c;
+  goppa_ctx *owned;
+  codectk_err err = get_ctx(P, &c, &owned);
+  if (err != CODECTK_OK) return err;
+
+  err = goppa_ctx_decode_ws(c, in, in_bits, out, out_bits, num_corrected, workspace,
+                            workspace_size);
+  goppa_ctx_destroy(owned);
+  return err;
+}
+
+static codectk_err goppa_decode_batch(const void *pp, codectk_batch_item *items,
+                                      size_t count);
+
 static codectk_err goppa_decode(const void *pp, const uint8_t *in, size_t in_bits,
                                 uint8_t *out, size_t *out_bits, size_t *corr) {
   const goppa_params *P = (const goppa_params*)pp;
+  unsigned flags = P ? (P->ctx ? P->ctx->flags : P->flags) : 0;
+  if (!(flags & GOPPA_FLAG_CT)) {
+    CODECTK_STATS_CALL(GOPPA);
+    return goppa_decode_ws(P, in, in_bits, out, out_bits, corr, NULL, 0);
+  }
 
-  if (!P || !in || !out || !out_bits) return CODECTK_EINVAL;
-  if (P->m < 2 || P->m > 16 || P->t == 0 || P->n == 0) return CODECTK_EINVAL;
-  if (!P->L || !P->g) return CODECTK_EINVAL;
+  /* The constant-time decoder works on batches */
+  if (!out_bits) return CODECTK_EINVAL;
+  codectk_batch_item it = {in, in_bits, out, *out_bits, 0, CODECTK_OK};
+  codectk_err err = goppa_decode_batch(pp, &it, 1);
+  *out_bits = it.out_bits;
+  if (corr) *corr = it.num_corrected;
+  return err;
+}
 
-  size_t n = P->n;
-  if (in_bits < n) return CODECTK_EINVAL;
-
-  /* Initialize field */
-  gf2m_ctx ctx;
-  if (gf2m_ctx_init(&ctx, P->m, 0x11D) != 0) {
-    return CODECTK_ENOMEM;
-  }
-
-  /* Step 1: Compute syndrome polynomial S(x) */
-  poly_gf2m_t S;
-  poly_gf2m_init(&S, &ctx, (int)P->t);
-  compute_syndrome_poly(&S, in, n, P, &ctx);
-
-  /* Check if syndrome is zero (no errors) */
-  if (S.deg < 0) {
-    /* No errors */
-    size_t out_bytes = (n + 7) / 8;
-    if (out_bytes > (*out_bits) / 8) {
-      poly_gf2m_free(&S);
-      gf2m_ctx_free(&ctx);
-      return CODECTK_ENOMEM;
-    }
-    memcpy(out, in, out_bytes);
-    *out_bits = n;
-    if (corr) *corr = 0;
+/*
+ * Constant-time decode: 64 words per pass, one per lane of gf2m_bs
+ * arithmetic. A pass keeps the received and the error words per lane (lane
+ * w's at R + w * nw) and turns each 64-position block of the errors from
+ * position masks (bit w = lane w) into lane words with a 64 x 64
+ * transpose.
+ */
 
-    poly_gf2m_free(&S);
-    gf2m_ctx_free(&ctx);
-    return CODECTK_OK;
+static size_t ct_scratch_size(const goppa_ctx *c) {
+  /* 2t syndromes of the word and of the errors, C(x), B(x) and the powers
+   * of a support element (t + 1 each), and the received and error words */
+  size_t nw = (c->n + 63) / 64;
+  return 2 * codectk_arena_round(2 * c->t * sizeof(gf2m_bs)) +
+         3 * codectk_arena_round((c->t + 1) * sizeof(gf2m_bs)) +
+         2 * codectk_arena_round(GF2M_BS_LANES * nw * sizeof(uint64_t)) + CODECTK_ARENA_ALIGN;
+}
+
+static codectk_err ct_check(const goppa_ctx *c, const codectk_batch_item *it) {
+  if (!it->in || !it->out || it->in_bits < c->n) return CODECTK_EINVAL;
+  if ((c->k + 7) / 8 > it->out_bits / 8) return CODECTK_ENOMEM;
+  return CODECTK_OK;
+}
+
+/* Mask of the lanes w with v[w] == j */
+static uint64_t lanes_equal(const uint32_t *v, uint32_t j) {
+  uint64_t mask = 0;
+  for (unsigned w = 0; w < GF2M_BS_LANES; w++) {
+    mask |= (uint64_t)(((v[w] ^ j) - 1) >> 31) << w;
   }
+  return mask;
+}
 
-  /* Step 2: Compute T(x) = S^-1 mod g(x) */
-  poly_gf2m_t g, T;
-  poly_gf2m_init(&g, &ctx, (int)P->t + 1);
-  poly_gf2m_init(&T, &ctx, (int)P->t);
+/**
+ * Syndromes of the lane words W in reverse, S[2t - 1 - j] = s_j: bit b of
+ * s_j is the parity of W AND row jm + b of ct_h, so it is a fixed run of
+ * word operations whatever the bits are.
+ */
+static void ct_syndromes(const goppa_ctx *c, const uint64_t *W, size_t nw, gf2m_bs *S) {
+  unsigned t2 = 2 * c->t, m = c->m;
 
-  for (unsigned i = 0; i <= P->t; i++) {
-    poly_gf2m_set_coeff(&g, (int)i, P->g[i]);
+  memset(S, 0, t2 * sizeof(gf2m_bs));
+  for (unsigned j = 0; j < t2; j++) {
+    for (unsigned b = 0; b < m; b++) {
+      const uint64_t *h = gf2_mat_row(&c->ct_h, (size_t)j * m + b);
+      uint64_t plane = 0;
+      for (unsigned w = 0; w < GF2M_BS_LANES; w++) {
+        const uint64_t *x = W + w * nw;
+        uint64_t acc = 0;
+        for (size_t i = 0; i < nw; i++) acc ^= h[i] & x[i];
+        plane |= (uint64_t)(gf2m_bs_popcount64(acc) & 1) << w;
+      }
+      S[t2 - 1 - j].p[b] = plane;
+    }
   }
+}
+
+/**
+ * Inversion-free Berlekamp-Massey over the 2t syndromes of every lane
+ * (reversed, as from ct_syndromes()): C' = γ C + δ x B, and where δ != 0
+ * and 2L <= r also B' = C, γ' = δ and L' = r + 1 - L, else B' = x B.
+ * Every step runs over all t + 1 coefficients (longer locators are
+ * uncorrectable) and the length change is a masked select, so the
+ * schedule depends on t only.
+ */
+static void ct_berlekamp_massey(const goppa_ctx *c, const gf2m_bs *S, gf2m_bs *C,
+                                gf2m_bs *B, uint32_t *len) {
+  const gf2m_ctx *f = c->field;
+  unsigned t = c->t;
+  gf2m_bs gamma, delta, x[2], y[2];
+
+  memset(C, 0, (t + 1) * sizeof(gf2m_bs));
+  memset(B, 0, (t + 1) * sizeof(gf2m_bs));
+  gf2m_bs_set1(&C[0], 1);
+  gf2m_bs_set1(&B[0], 1);
+  gf2m_bs_set1(&gamma, 1);
+  memset(len, 0, GF2M_BS_LANES * sizeof(uint32_t));
 
-  if (poly_gf2m_inv_mod(&T, &S, &g) != 0) {
-    /* Cannot invert, uncorrectable */
-    poly_gf2m_free(&S);
-    poly_gf2m_free(&g);
-    poly_gf2m_free(&T);
-    gf2m_ctx_free(&ctx);
-    return CODECTK_EDECODE;
+  for (uint32_t r = 0; r < 2 * t; r++) {
+    /* δ = sum of C_i s_(r-i) */
+    unsigned top = r < t ? r : t;
+    gf2m_bs_dot(f, &delta, C, S + 2 * t - 1 - r, top + 1);
+
+    /* 2L <= r: 2L - r - 1 wraps below zero */
+    uint64_t change = 0;
+    for (unsigned w = 0; w < GF2M_BS_LANES; w++) {
+      change |= (uint64_t)((2 * len[w] - r - 1) >> 31) << w;
+    }
+    change &= gf2m_bs_nonzero(&delta);
+
+    /* From the top down, so that the lower old coefficients survive */
+    x[0] = gamma;
+    x[1] = delta;
+    for (unsigned i = t; i > 0; i--) {
+      y[0] = C[i];
+      y[1] = B[i - 1];
+      gf2m_bs_select(&B[i], change, &C[i], &B[i - 1]);
+      gf2m_bs_dot(f, &C[i], x, y, 2);
+    }
+    memset(&B[0], 0, sizeof(gf2m_bs));
+    gf2m_bs_select(&B[0], change, &C[0], &B[0]);
+    gf2m_bs_mul(f, &C[0], &gamma, &C[0]);
+
+    gf2m_bs_select(&gamma, change, &delta, &gamma);
+    for (unsigned w = 0; w < GF2M_BS_LANES; w++) {
+      uint32_t mw = 0u - (uint32_t)((change >> w) & 1);
+      len[w] = (len[w] & ~mw) | ((r + 1 - len[w]) & mw);
+    }
   }
+}
 
-  /* Step 3: Quadratic splitting - find a(x), b(x) with a² + xb² ≡ T (mod g)
-   * This is complex. Simplified: assume we can find error locator directly.
-   * For binary Goppa with t small, we use the fact that error locator
-   * can be found from T(x) using sqrt and polynomial operations.
-   */
+/**
+ * Error masks of every lane into E. C(x) = prod (1 - L_i x) over the
+ * errors, so lane w has an error at L_i != 0 iff the reversed locator
+ * sum C_j x^(t-j) vanishes there, and at L_i = 0 iff deg C < L, i.e.
+ * C_L = 0. Both are computed for every position and the support element
+ * picks one by masks. X holds t + 1 elements of scratch.
+ */
+static void ct_roots(const goppa_ctx *c, const gf2m_bs *C, const uint32_t *len,
+                     gf2m_bs *X, uint64_t *E, size_t nw) {
+  const gf2m_ctx *f = c->field;
+  unsigned t = c->t;
+  size_t n = c->n;
+  uint64_t blk[GF2M_BS_LANES];
+
+  uint64_t at_zero = 0;
+  for (unsigned j = 0; j <= t; j++) at_zero |= lanes_equal(len, j) & ~gf2m_bs_nonzero(&C[j]);
+
+  for (size_t b = 0; b < nw; b++) {
+    size_t cnt = (n - 64 * b < 64) ? n - 64 * b : 64;
+    memset(blk, 0, sizeof(blk));
+    for (size_t j = 0; j < cnt; j++) {
+      size_t i = 64 * b + j;
+      uint16_t a = c->L[i];
 
-  /* Simplified approach: For small t, enumerate possible error patterns */
-  /* Full Patterson requires quadratic equation solving in GF(2^m)[x] */
+      /* sum C_d a^(t-d) = a * sum over d < t of C_d a^(t-1-d), + C_t */
+      gf2m_bs y, z;
+      gf2m_bs_set1(&X[t - 1], 1);
+      for (unsigned d = 1; d < t; d++) gf2m_bs_set1(&X[t - 1 - d], c->pow[(d - 1) * n + i]);
+      gf2m_bs_set1(&X[t], a);
+      gf2m_bs_dot(f, &y, C, X, t);
+      gf2m_bs_mul(f, &z, &y, &X[t]);
+      gf2m_bs_add(&y, &z, &C[t]);
 
-  /* Copy input to output and attempt simple error correction */
-  size_t out_bytes = (n + 7) / 8;
-  if (out_bytes > (*out_bits) / 8) {
-    poly_gf2m_free(&S);
-    poly_gf2m_free(&g);
-    poly_gf2m_free(&T);
-    gf2m_ctx_free(&ctx);
-    return CODECTK_ENOMEM;
+      uint64_t is_zero = 0 - (uint64_t)(((uint32_t)a - 1) >> 31);
+      blk[j] = (~gf2m_bs_nonzero(&y) & ~is_zero) | (at_zero & is_zero);
+    }
+    gf2m_bs_transpose64(blk);
+    for (unsigned w = 0; w < GF2M_BS_LANES; w++) E[w * nw + b] = blk[w];
   }
+}
 
-  memcpy(out, in, out_bytes);
-  *out_bits = n;
-  if (corr) *corr = 0;
+/* Decode items[0..count), count <= 64; unused lanes decode the zero word */
+static void ct_pass(const goppa_ctx *c, codectk_batch_item *items, size_t count,
+                    void *scratch, size_t scratch_size) {
+  unsigned t = c->t;
+  size_t nw = (c->n + 63) / 64;
+  codectk_arena ws;
+  codectk_arena_init(&ws, scratch, scratch_size);
+  gf2m_bs *S = (gf2m_bs*)codectk_arena_alloc(&ws, 2 * t * sizeof(gf2m_bs));
+  gf2m_bs *SE = (gf2m_bs*)codectk_arena_alloc(&ws, 2 * t * sizeof(gf2m_bs));
+  gf2m_bs *C = (gf2m_bs*)codectk_arena_alloc(&ws, (t + 1) * sizeof(gf2m_bs));
+  gf2m_bs *B = (gf2m_bs*)codectk_arena_alloc(&ws, (t + 1) * sizeof(gf2m_bs));
+  gf2m_bs *X = (gf2m_bs*)codectk_arena_alloc(&ws, (t + 1) * sizeof(gf2m_bs));
+  uint64_t *R = (uint64_t*)codectk_arena_alloc(&ws, GF2M_BS_LANES * nw * sizeof(uint64_t));
+  uint64_t *E = (uint64_t*)codectk_arena_alloc(&ws, GF2M_BS_LANES * nw * sizeof(uint64_t));
+  uint32_t len[GF2M_BS_LANES];
 
-  /* Cleanup */
-  poly_gf2m_free(&S);
-  poly_gf2m_free(&g);
-  poly_gf2m_free(&T);
-  gf2m_ctx_free(&ctx);
+  CODECTK_STATS_T0(t0);
+  for (size_t w = 0; w < GF2M_BS_LANES; w++) {
+    codectk_batch_item *it = w < count ? &items[w] : NULL;
+    if (it) {
+      it->num_corrected = 0;
+      it->err = ct_check(c, it);
+    }
+    if (it && it->err == CODECTK_OK) load_words(R + w * nw, nw, it->in, c->n);
+    else memset(R + w * nw, 0, nw * sizeof(uint64_t));
+  }
+  CODECTK_STATS_STAGE(GOPPA, BITIO, t0);
+
+  CODECTK_STATS_RESTART(t0);
+  ct_syndromes(c, R, nw, S);
+  CODECTK_STATS_STAGE(GOPPA, SYNDROME, t0);
+  CODECTK_STATS_RESTART(t0);
+  ct_berlekamp_massey(c, S, C, B, len);
+  CODECTK_STATS_STAGE(GOPPA, KEY_EQUATION, t0);
+  CODECTK_STATS_RESTART(t0);
+  ct_roots(c, C, len, X, E, nw);
+  CODECTK_STATS_STAGE(GOPPA, ROOTS, t0);
+
+  /* The errors found must account for the whole syndrome, so that a word
+   * beyond t errors is never turned into a non-codeword */
+  CODECTK_STATS_RESTART(t0);
+  ct_syndromes(c, E, nw, SE);
+  CODECTK_STATS_STAGE(GOPPA, SYNDROME, t0);
+  uint64_t differ = 0;
+  for (unsigned s = 0; s < 2 * t; s++) {
+    for (unsigned q = 0; q < c->m; q++) differ |= S[s].p[q] ^ SE[s].p[q];
+  }
+
+  /* A lane is corrected iff it has exactly L <= t errors that explain its
+   * syndrome */
+  for (size_t w = 0; w < count; w++) {
+    codectk_batch_item *it = &items[w];
+    uint64_t *rw = R + w * nw;
+    const uint64_t *ew = E + w * nw;
+    uint32_t weight = 0;
+    for (size_t i = 0; i < nw; i++) weight += gf2m_bs_popcount64(ew[i]);
+    uint64_t ok = 0 - (uint64_t)((((weight ^ len[w]) - 1) & (len[w] - t - 1)) >> 31);
+    ok &= 0 - (uint64_t)(~(differ >> w) & 1);
+    for (size_t i = 0; i < nw; i++) rw[i] ^= ew[i] & ok;
+
+    if (it->err != CODECTK_OK) continue;
+    write_message(c, rw, it->out);
+    it->out_bits = c->k;
+    it->num_corrected = (size_t)(len[w] & (uint32_t)ok);
+    it->err = ok ? CODECTK_OK : CODECTK_EDECODE;
+    if (ok) CODECTK_STATS_WORDS(GOPPA, it->num_corrected, 1);
+    else CODECTK_STATS_FAILURES(GOPPA, 1);
+  }
+}
 
-  /* Note: Full Patterson decoder requires:
-   * - Quadratic splitting algorithm
-   * - GCD computation with error locator
-   * - Root finding in support set
-   * This is a placeholder that handles no-error case.
-   */
+typedef struct {
+  const goppa_ctx *ctx;
+  codectk_batch_item *items;
+  size_t count;
+  uint8_t *ws;
+  size_t ws_size;
+} goppa_ct_batch;
 
+static codectk_err ct_task(void *ctx, size_t i, unsigned worker) {
+  const goppa_ct_batch *b = (const goppa_ct_batch*)ctx;
+  size_t base = i * GF2M_BS_LANES;
+  size_t cnt = (b->count - base < GF2M_BS_LANES) ? b->count - base : GF2M_BS_LANES;
+  ct_pass(b->ctx, b->items + base, cnt, b->ws + (size_t)worker * b->ws_size, b->ws_size);
   return CODECTK_OK;
 }
 
+codectk_err goppa_ctx_decode_ct_batch(const goppa_ctx *ctx, codectk_batch_item *items,
+                                      size_t count) {
+  if (!items) return count ? CODECTK_EINVAL : CODECTK_OK;
+  if (!ctx) return fail_batch(items, count, CODECTK_EINVAL);
+  if (!ctx->ct_h.data || !ctx->sqrt_x) return fail_batch(items, count, CODECTK_ENOTSUP);
+  if (count == 0) return CODECTK_OK;
+
+  size_t passes = (count + GF2M_BS_LANES - 1) / GF2M_BS_LANES;
+  size_t need = ct_scratch_size(ctx);
+  codectk_executor *ex = passes > 1 ? codectk_executor_shared() : NULL;
+  uint8_t *ws = (uint8_t*)malloc(codectk_executor_threads(ex) * need);
+  if (!ws) return fail_batch(items, count, CODECTK_ENOMEM);
+
+  goppa_ct_batch b = {ctx, items, count, ws, need};
+  codectk_executor_run(ex, passes, 0, ct_task, &b);
+  free(ws);
+
+  codectk_err first = CODECTK_OK;
+  for (size_t i = 0; i < count && first == CODECTK_OK; i++) first = items[i].err;
+  return first;
+}
+
+/* Batches: one item per task on the shared executor, one workspace per worker */
+typedef struct {
+  const goppa_ctx *ctx;
+  codectk_batch_item *items;
+  uint8_t *ws;
+  size_t ws_size;
+} goppa_batch;
+
+static codectk_err batch_task(void *ctx, size_t i, unsigned worker) {
+  const goppa_batch *b = (const goppa_batch*)ctx;
+  codectk_batch_item *it = &b->items[i];
+  it->num_corrected = 0;
+  it->err = goppa_ctx_decode_ws(b->ctx, it->in, it->in_bits, it->out, &it->out_bits,
+                                &it->num_corrected, b->ws + (size_t)worker * b->ws_size,
+                                b->ws_size);
+  return it->err;
+}
+
+static codectk_err goppa_decode_batch(const void *pp, codectk_batch_item *items,
+                                      size_t count) {
+  CODECTK_STATS_CALL(GOPPA);
+  const goppa_ctx *c;
+  goppa_ctx *owned;
+  codectk_err err = get_ctx((const goppa_params*)pp, &c, &owned);
+  if (err != CODECTK_OK) return fail_batch(items, count, err);
+  if (c->flags & GOPPA_FLAG_CT) {
+    err = goppa_ctx_decode_ct_batch(c, items, count);
+    goppa_ctx_destroy(owned);
+    return err;
+  }
+
+  size_t need = goppa_ctx_workspace_size(c);
+  codectk_executor *ex = count > 1 ? codectk_executor_shared() : NULL;
+  uint8_t *ws = count ? (uint8_t*)malloc(codectk_executor_threads(ex) * need) : NULL;
+  if (!ws) {
+    goppa_ctx_destroy(owned);
+    return fail_batch(items, count, CODECTK_ENOMEM);
+  }
+
+  goppa_batch b = {c, items, ws, need};
+  err = codectk_executor_run(ex, count, 0, batch_task, &b);
+  free(ws);
+  goppa_ctx_destroy(owned);
+  return err;
+}
+
 static const codectk_codec GOPPA = {
   .name = "goppa",
   .encode = goppa_encode,
-  .decode = goppa_decode
+  .decode = goppa_decode,
+  .encode_batch = goppa_encode_batch,
+  .decode_batch = goppa_decode_batch
 };
 
 const codectk_codec* goppa_codec(void) {
@@ -1,79 +1,209 @@
 #include "../include/hamming.h"
 #include "../include/bitio.h"
-#include <string.h>
+#include "../include/executor.h"
+#include "../include/stats.h"
+#include <stdlib.h>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
 
-static inline int is_pow2(unsigned x){ return x && !(x&(x-1)); }
-static inline void params(unsigned m, unsigned *n, unsigned *k){ *n=(1u<<m)-1u; *k=*n - m; }
+/*
+ * Codeword bit pos-1 holds Hamming position pos (1..n); parity bits sit at
+ * the powers of two. Parity bit j covers every position with bit j set, so
+ * it is the parity of cw & parity_masks[j] and the syndrome is the XOR of
+ * the positions of all set bits.
+ */
+static const uint64_t parity_masks[HAMMING_MAX_M] = {
+  0x5555555555555555ull, 0x6666666666666666ull, 0x7878787878787878ull,
+  0x7F807F807F807F80ull, 0x7FFF80007FFF8000ull, 0x7FFFFFFF80000000ull
+};
+
+/*
+ * Byte-codeword mode for m <= 3: enc_tab maps a message to its codeword,
+ * dec_tab maps a received codeword to the corrected message, with bit 7
+ * set when a bit was flipped. Generated from the mask engine below.
+ */
+static const uint8_t enc_tab3[16] = {
+  0x00, 0x07, 0x19, 0x1E, 0x2A, 0x2D, 0x33, 0x34, 0x4B, 0x4C, 0x52, 0x55, 0x61, 0x66, 0x78, 0x7F
+};
+static const uint8_t dec_tab3[128] = {
+  0x00, 0x80, 0x80, 0x81, 0x80, 0x81, 0x81, 0x01, 0x80, 0x82, 0x84, 0x88, 0x89, 0x85, 0x83, 0x81,
+  0x80, 0x82, 0x8A, 0x86, 0x87, 0x8B, 0x83, 0x81, 0x82, 0x02, 0x83, 0x82, 0x83, 0x82, 0x03, 0x83,
+  0x80, 0x8C, 0x84, 0x86, 0x87, 0x85, 0x8D, 0x81, 0x84, 0x85, 0x04, 0x84, 0x85, 0x05, 0x84, 0x85,
+  0x87, 0x86, 0x86, 0x06, 0x07, 0x87, 0x87, 0x86, 0x8E, 0x82, 0x84, 0x86, 0x87, 0x85, 0x83, 0x8F,
+  0x80, 0x8C, 0x8A, 0x88, 0x89, 0x8B, 0x8D, 0x81, 0x89, 0x88, 0x88, 0x08, 0x09, 0x89, 0x89, 0x88,
+  0x8A, 0x8B, 0x0A, 0x8A, 0x8B, 0x0B, 0x8A, 0x8B, 0x8E, 0x82, 0x8A, 0x88, 0x89, 0x8B, 0x83, 0x8F,
+  0x8C, 0x0C, 0x8D, 0x8C, 0x8D, 0x8C, 0x0D, 0x8D, 0x8E, 0x8C, 0x84, 0x88, 0x89, 0x85, 0x8D, 0x8F,
+  0x8E, 0x8C, 0x8A, 0x86, 0x87, 0x8B, 0x8D, 0x8F, 0x0E, 0x8E, 0x8E, 0x8F, 0x8E, 0x8F, 0x8F, 0x0F
+};
+static const uint8_t enc_tab2[2] = {
+  0x00, 0x07
+};
+static const uint8_t dec_tab2[8] = {
+  0x00, 0x80, 0x80, 0x81, 0x80, 0x81, 0x81, 0x01
+};
+
+static const uint8_t *const enc_tabs[4] = { NULL, NULL, enc_tab2, enc_tab3 };
+static const uint8_t *const dec_tabs[4] = { NULL, NULL, dec_tab2, dec_tab3 };
 
-static uint64_t place_data(uint64_t data, unsigned m){
-  unsigned n,k; params(m,&n,&k);
-  uint64_t cw=0; unsigned di=0;
-  for(unsigned pos=1; pos<=n; ++pos){
-    if(is_pow2(pos)) continue;
-    if((data>>di)&1u) cw |= (1ull<<(pos-1));
-    if(++di==k) break;
+typedef struct {
+  unsigned m, n, k;
+  uint64_t par[HAMMING_MAX_M]; /* parity masks restricted to n bits */
+  uint64_t data;               /* data positions (non-powers of two) */
+} ham_engine;
+
+static void engine_init(ham_engine *e, unsigned m){
+  e->m=m; e->n=(1u<<m)-1u; e->k=e->n-m;
+  uint64_t nmask=(1ull<<e->n)-1u;
+  e->data=nmask;
+  for(unsigned j=0;j<m;j++){ e->par[j]=parity_masks[j]&nmask; e->data&=~(1ull<<((1u<<j)-1u)); }
+}
+
+static inline unsigned parity64(uint64_t x){ return (unsigned)__builtin_parityll(x); }
+
+/*
+ * Data bits fill the runs between parity positions: run r (1 <= r < m)
+ * takes 2^r - 1 data bits starting at data bit 2^r - r - 1 and lands at
+ * codeword bit 2^r, i.e. one shift by r + 1 per run (pdep/pext with BMI2).
+ */
+static inline uint64_t place_data(const ham_engine *e, uint64_t data){
+#if defined(__BMI2__)
+  return _pdep_u64(data, e->data);
+#else
+  uint64_t cw=0;
+  for(unsigned r=1;r<e->m;r++){
+    uint64_t run=((1ull<<((1u<<r)-1u))-1u)<<((1u<<r)-r-1u);
+    cw |= (data&run)<<(r+1);
   }
   return cw;
+#endif
 }
-static uint64_t set_parity(uint64_t cw, unsigned m){
-  unsigned n,k; params(m,&n,&k);
-  for(unsigned p=1; p<=n; p<<=1){
-    unsigned par=0;
-    for(unsigned pos=1; pos<=n; ++pos)
-      if((pos & p) && ((cw>>(pos-1))&1u)) par^=1;
-    if(par) cw ^= (1ull<<(p-1));
+static inline uint64_t extract_data(const ham_engine *e, uint64_t cw){
+#if defined(__BMI2__)
+  return _pext_u64(cw, e->data);
+#else
+  uint64_t d=0;
+  for(unsigned r=1;r<e->m;r++){
+    uint64_t run=((1ull<<((1u<<r)-1u))-1u)<<((1u<<r)-r-1u);
+    d |= (cw>>(r+1))&run;
   }
+  return d;
+#endif
+}
+static inline uint64_t encode_word(const ham_engine *e, uint64_t data){
+  uint64_t cw=place_data(e,data);
+  for(unsigned j=0;j<e->m;j++) cw |= (uint64_t)parity64(cw&e->par[j])<<((1u<<j)-1u);
   return cw;
 }
-static unsigned syndrome(uint64_t cw, unsigned m){
-  unsigned n,k; params(m,&n,&k);
-  unsigned s=0, bit=1;
-  for(unsigned p=1; p<=n; p<<=1, bit<<=1){
-    unsigned par=0;
-    for(unsigned pos=1; pos<=n; ++pos)
-      if((pos & p) && ((cw>>(pos-1))&1u)) par^=1;
-    if(par) s |= bit;
-  }
+static inline unsigned syndrome(const ham_engine *e, uint64_t cw){
+  unsigned s=0;
+  for(unsigned j=0;j<e->m;j++) s |= parity64(cw&e->par[j])<<j;
   return s; // 0 = ok, otherwise 1..n
 }
-static uint64_t extract_data(uint64_t cw, unsigned m){
-  unsigned n,k; params(m,&n,&k);
-  uint64_t d=0; unsigned di=0;
-  for(unsigned pos=1; pos<=n; ++pos){
-    if(is_pow2(pos)) continue;
-    if((cw>>(pos-1))&1u) d |= (1ull<<di);
-    if(++di==k) break;
-  }
-  return d;
+
+/* Whole codeword/message as one field; m = 6 needs more than one refill's worth */
+static inline int get_word(bitr_t *R, unsigned nbits, uint64_t *v){
+  if(nbits<=BITIO_MAX_BITS) return bitr_get_bits(R,nbits,v);
+  uint64_t lo,hi;
+  if(bitr_get_bits(R,32,&lo) || bitr_get_bits(R,nbits-32,&hi)) return -1;
+  *v = lo|(hi<<32);
+  return 0;
 }
 
 static codectk_err h_encode(const void *pp, const uint8_t *in, size_t in_bits, uint8_t *out, size_t *out_bits){
   const hamming_params *p = (const hamming_params*)pp;
-  unsigned n,k; params(p->m,&n,&k);
-  bitr_t R; bitw_t W; bitr_init(&R,in,(in_bits+7)/8); bitw_init(&W,out, (*out_bits)/8);
-  for(size_t done=0; done+ k <= in_bits; done += k){
-    uint64_t block=0; for(unsigned i=0;i<k;i++){ int b=bitr_get(&R); if(b<0) return CODECTK_EINVAL; block |= (uint64_t)b<<i; }
-    uint64_t cw = set_parity(place_data(block,p->m), p->m);
-    for(unsigned i=0;i<n;i++) if(bitw_put(&W, (cw>>i)&1u)) return CODECTK_ENOMEM;
+  if(!p || !out_bits || p->m<2 || p->m>HAMMING_MAX_M) return CODECTK_EINVAL;
+  ham_engine e; engine_init(&e,p->m);
+  /* A trailing partial message is zero-filled to a whole block */
+  size_t blocks = (in_bits+e.k-1)/e.k;
+  size_t out_bytes = (blocks*e.n+7)/8;
+  if(out_bytes > (*out_bits)/8) return CODECTK_ENOMEM;
+  const uint8_t *tab = p->m<4 ? enc_tabs[p->m] : NULL;
+  /* Capacity was checked above, so the puts cannot fail */
+  bitr_t R; bitw_t W; bitr_init(&R,in,(in_bits+7)/8); bitw_init(&W,out,out_bytes);
+  for(size_t b=0;b<blocks;b++){
+    size_t left = in_bits - b*e.k;
+    unsigned nbits = left < e.k ? (unsigned)left : e.k;
+    uint64_t data; if(get_word(&R,nbits,&data)) return CODECTK_EINVAL;
+    bitw_put_bits(&W, tab ? tab[data] : encode_word(&e,data), e.n);
   }
-  if(bitw_flush(&W)) return CODECTK_ENOMEM;
-  *out_bits = ((size_t)(W.p - out))*8;
+  bitw_flush(&W);
+  *out_bits = out_bytes*8;
   return CODECTK_OK;
 }
+/* Decode blocks codewords from in to out; returns the number corrected */
+static size_t decode_blocks(const ham_engine *e, const uint8_t *tab, const uint8_t *in,
+                            size_t blocks, uint8_t *out){
+  CODECTK_STATS_T0(t0);
+  size_t corrected=0;
+  bitr_t R; bitw_t W;
+  bitr_init(&R,in,(blocks*e->n+7)/8); bitw_init(&W,out,(blocks*e->k+7)/8);
+  for(size_t b=0;b<blocks;b++){
+    uint64_t cw = 0; get_word(&R,e->n,&cw);
+    uint64_t d;
+    if(tab){
+      unsigned v = tab[cw];
+      corrected += v>>7;
+      d = v&0x7Fu;
+    } else {
+      unsigned s = syndrome(e,cw);
+      if(s){ cw ^= 1ull<<(s-1); corrected++; }
+      d = extract_data(e,cw);
+    }
+    bitw_put_bits(&W, d, e->k);
+  }
+  bitw_flush(&W);
+  /* Single-error correction: every codeword is corrected once or clean */
+  CODECTK_STATS_STAGE(HAMMING, SYNDROME, t0);
+  CODECTK_STATS_WORDS(HAMMING, 0, blocks-corrected);
+  CODECTK_STATS_WORDS(HAMMING, 1, corrected);
+  return corrected;
+}
+
+/* Long streams are decoded on the shared executor in runs of whole bytes */
+#define HAM_TASK_BLOCKS 32768  /* codewords per task, a multiple of 8 */
+
+typedef struct {
+  const ham_engine *e;
+  const uint8_t *tab, *in;
+  uint8_t *out;
+  size_t blocks;
+  size_t *corrected;  /* per task */
+} ham_par;
+
+static codectk_err decode_task(void *ctx, size_t i, unsigned worker){
+  (void)worker;
+  const ham_par *p = (const ham_par*)ctx;
+  size_t first = i*HAM_TASK_BLOCKS;
+  size_t blocks = p->blocks-first < HAM_TASK_BLOCKS ? p->blocks-first : HAM_TASK_BLOCKS;
+  /* 8 codewords are a whole number of bytes both ways */
+  p->corrected[i] = decode_blocks(p->e, p->tab, p->in + first/8*p->e->n,
+                                  blocks, p->out + first/8*p->e->k);
+  return CODECTK_OK;
+}
+
 static codectk_err h_decode(const void *pp, const uint8_t *in, size_t in_bits, uint8_t *out, size_t *out_bits, size_t *corr){
+  CODECTK_STATS_CALL(HAMMING);
   const hamming_params *p = (const hamming_params*)pp;
-  unsigned n,k; params(p->m,&n,&k);
+  if(!p || !out_bits || p->m<2 || p->m>HAMMING_MAX_M) return CODECTK_EINVAL;
+  ham_engine e; engine_init(&e,p->m);
+  size_t blocks = in_bits/e.n;
+  size_t out_bytes = (blocks*e.k+7)/8;
+  if(out_bytes > (*out_bits)/8) return CODECTK_ENOMEM;
+  const uint8_t *tab = p->m<4 ? dec_tabs[p->m] : NULL;
   size_t corrected=0;
-  bitr_t R; bitw_t W; bitr_init(&R,in,(in_bits+7)/8); bitw_init(&W,out, (*out_bits)/8);
-  for(size_t done=0; done + n <= in_bits; done += n){
-    uint64_t cw=0; for(unsigned i=0;i<n;i++){ int b=bitr_get(&R); if(b<0) return CODECTK_EINVAL; if(b) cw|=1ull<<i; }
-    unsigned s = syndrome(cw,p->m);
-    if(s) { if(s<=n) { cw ^= (1ull<<(s-1)); corrected++; } }
-    uint64_t d = extract_data(cw,p->m);
-    for(unsigned i=0;i<k;i++) if(bitw_put(&W, (d>>i)&1u)) return CODECTK_ENOMEM;
+  size_t tasks = (blocks+HAM_TASK_BLOCKS-1)/HAM_TASK_BLOCKS;
+  codectk_executor *ex = tasks>1 ? codectk_executor_shared() : NULL;
+  size_t *per_task = codectk_executor_threads(ex)>1 ? malloc(tasks*sizeof(size_t)) : NULL;
+  if(per_task){
+    ham_par par = {&e, tab, in, out, blocks, per_task};
+    codectk_executor_run(ex, tasks, 0, decode_task, &par);
+    for(size_t i=0;i<tasks;i++) corrected += per_task[i];
+    free(per_task);
+  } else {
+    corrected = decode_blocks(&e, tab, in, blocks, out);
   }
-  if(bitw_flush(&W)) return CODECTK_ENOMEM;
-  *out_bits = ((size_t)(W.p - out))*8;
+  *out_bits = out_bytes*8;
   if(corr) *corr = corrected;
   return CODECTK_OK;
 }
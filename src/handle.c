@@ -0,0 +1,421 @@
+/**
+ * handle.c - Stateful encoders and decoders over the registry's codecs
+ *
+ * A handle owns what its codec needs on every call: the context (unless
+ * the caller lent one), the decode workspace, a unit of held-back input
+ * and the output buffer. The block codecs are fed units of 8 codewords,
+ * so every unit starts on a byte both in the input and in the output and
+ * decoding chunk by chunk gives the output of a single call. Whole units
+ * are coded straight from the caller's chunk; only a unit split across
+ * chunks is copied.
+ */
+
+#include "../include/handle.h"
+#include "../include/bch.h"
+#include "../include/bitio.h"
+#include "../include/executor.h"
+#include "../include/goppa.h"
+#include "../include/hamming.h"
+#include "../include/huffman.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define UNIT_WORDS 8                    /* codewords per unit: whole bytes both ways */
+#define GOPPA_GROUP 64                  /* Goppa words per batch call */
+#define PAR_MIN_BITS ((size_t)1 << 18)  /* BCH decode runs on the executor from here */
+#define MAX_BUFFER ((size_t)1 << 40)    /* largest Huffman output buffer */
+
+typedef enum {
+  KIND_HAMMING,
+  KIND_BCH,       /* generic BCH over bch (borrowed or owned) */
+  KIND_BCH_FIXED, /* built-in fixed set, through its codec */
+  KIND_GOPPA,
+  KIND_HUFFMAN    /* whole stream at the flush */
+} handle_kind;
+
+struct codectk_handle {
+  const codectk_codec *codec;
+  handle_kind kind;
+  codectk_direction dir;
+  union {
+    hamming_params hamming;
+    bch_params bch;
+    goppa_params goppa;
+    huffman_params huffman;
+  } params;
+  const void *pp;           /* &params, or NULL */
+  const bch_ctx *bch;
+  bch_ctx *bch_owned;
+  const goppa_ctx *goppa;
+  goppa_ctx *goppa_owned;
+  void *ws;                 /* decode workspace */
+  size_t ws_size;
+  int parallel;             /* the shared executor has more than one thread */
+  size_t k, n;              /* message and codeword bits */
+  size_t unit_in, unit_out; /* bytes per unit of 8 codewords, 0 = whole stream */
+  uint8_t *pend;            /* held-back input */
+  size_t pend_bits, pend_cap;
+  uint8_t *out;
+  size_t out_cap;
+  uint8_t *words;           /* Goppa: GOPPA_GROUP codewords and messages */
+  codectk_batch_item *items;
+  size_t corrected;
+};
+
+/* Make *buf hold at least bytes, keeping its contents */
+static codectk_err reserve(uint8_t **buf, size_t *cap, size_t bytes) {
+  if (bytes <= *cap) return CODECTK_OK;
+  uint8_t *b = (uint8_t*)realloc(*buf, bytes);
+  if (!b) return CODECTK_ENOMEM;
+  *buf = b;
+  *cap = bytes;
+  return CODECTK_OK;
+}
+
+/* Opening: check the parameters, build the context and size the units */
+
+static codectk_err open_hamming(codectk_handle *h, const void *params) {
+  const hamming_params *P = (const hamming_params*)params;
+  if (!P || P->m < 2 || P->m > HAMMING_MAX_M) return CODECTK_EINVAL;
+  h->params.hamming = *P;
+  h->n = ((size_t)1 << P->m) - 1;
+  h->k = h->n - P->m;
+  return CODECTK_OK;
+}
+
+static codectk_err open_bch(codectk_handle *h, const void *params) {
+  const bch_params *P = (const bch_params*)params;
+  if (!P || (P->flags & ~BCH_FLAG_CT) ||
+      (P->pad != BCH_PAD_SHORTEN && P->pad != BCH_PAD_ZERO)) {
+    return CODECTK_EINVAL;
+  }
+  h->params.bch = *P;
+  if (P->ctx) {
+    h->bch = P->ctx;
+  } else {
+    codectk_err err = bch_ctx_create(P->m, P->t, &h->bch_owned);
+    if (err != CODECTK_OK) return err;
+    h->bch = h->bch_owned;
+  }
+  h->n = h->bch->n;
+  h->k = h->bch->k;
+
+  if (h->dir == CODECTK_DECODE && !(P->flags & BCH_FLAG_CT)) {
+    h->ws_size = bch_ctx_workspace_size(h->bch);
+    h->ws = malloc(h->ws_size);
+    if (!h->ws) return CODECTK_ENOMEM;
+    h->parallel = codectk_executor_threads(codectk_executor_shared()) > 1;
+  }
+  return CODECTK_OK;
+}
+
+/* Same rules as the fixed codecs' own calls, checked once */
+static codectk_err open_bch_fixed(codectk_handle *h, const bch_ctx *c, const void *params) {
+  const bch_params *P = (const bch_params*)params;
+  if (P) {
+    if ((P->flags & ~BCH_FLAG_CT) || P->ctx || (P->m && P->m != c->m) ||
+        (P->t && P->t != c->t) || (P->pad != BCH_PAD_SHORTEN && P->pad != BCH_PAD_ZERO)) {
+      return CODECTK_EINVAL;
+    }
+    h->params.bch = *P;
+    h->pp = &h->params;
+  }
+  h->n = c->n;
+  h->k = c->k;
+  return CODECTK_OK;
+}
+
+static codectk_err open_goppa(codectk_handle *h, const void *params) {
+  const goppa_params *P = (const goppa_params*)params;
+  if (!P) return CODECTK_EINVAL;
+  if (P->ctx) {
+    h->goppa = P->ctx;
+  } else {
+    codectk_err err = goppa_ctx_create(P, &h->goppa_owned);
+    if (err != CODECTK_OK) return err;
+    h->goppa = h->goppa_owned;
+  }
+  h->n = h->goppa->n;
+  h->k = h->goppa->k;
+  if (h->k == 0) return CODECTK_EINVAL;
+
+  if (h->dir == CODECTK_DECODE && !(h->goppa->flags & GOPPA_FLAG_CT)) {
+    if (!h->goppa->sqrt_x) return CODECTK_ENOTSUP;
+    h->ws_size = goppa_ctx_workspace_size(h->goppa);
+    h->ws = malloc(h->ws_size);
+    if (!h->ws) return CODECTK_ENOMEM;
+  }
+
+  h->words = (uint8_t*)malloc(GOPPA_GROUP * ((h->n + 7) / 8 + (h->k + 7) / 8));
+  h->items = (codectk_batch_item*)malloc(GOPPA_GROUP * sizeof(codectk_batch_item));
+  return h->words && h->items ? CODECTK_OK : CODECTK_ENOMEM;
+}
+
+codectk_err codectk_open(const char *name, const void *params, codectk_direction dir,
+                         codectk_handle **out) {
+  if (!out) return CODECTK_EINVAL;
+  *out = NULL;
+  if (!name || (dir != CODECTK_ENCODE && dir != CODECTK_DECODE)) return CODECTK_EINVAL;
+  const codectk_codec *codec = codectk_get(name);
+  if (!codec) return CODECTK_EINVAL;
+
+  codectk_handle *h = (codectk_handle*)calloc(1, sizeof(*h));
+  if (!h) return CODECTK_ENOMEM;
+  h->codec = codec;
+  h->dir = dir;
+  h->pp = &h->params;
+
+  codectk_err err;
+  const bch_ctx *fixed = bch_fixed_ctx(name);
+  if (!strcmp(name, "hamming")) {
+    h->kind = KIND_HAMMING;
+    err = open_hamming(h, params);
+  } else if (!strcmp(name, "bch")) {
+    h->kind = KIND_BCH;
+    err = open_bch(h, params);
+  } else if (fixed) {
+    h->kind = KIND_BCH_FIXED;
+    h->pp = NULL;
+    err = open_bch_fixed(h, fixed, params);
+  } else if (!strcmp(name, "goppa")) {
+    h->kind = KIND_GOPPA;
+    err = open_goppa(h, params);
+  } else {
+    h->kind = KIND_HUFFMAN;
+    h->pp = NULL;
+    if (params) {
+      h->params.huffman = *(const huffman_params*)params;
+      h->pp = &h->params;
+    }
+    err = CODECTK_OK;
+  }
+
+  /* UNIT_WORDS codewords: k bytes of messages, n bytes of codewords */
+  if (err == CODECTK_OK && h->kind != KIND_HUFFMAN) {
+    h->unit_in = UNIT_WORDS * (dir == CODECTK_ENCODE ? h->k : h->n) / 8;
+    h->unit_out = UNIT_WORDS * (dir == CODECTK_ENCODE ? h->n : h->k) / 8;
+    err = reserve(&h->pend, &h->pend_cap, h->unit_in);
+  }
+  if (err != CODECTK_OK) {
+    codectk_close(h);
+    return err;
+  }
+  *out = h;
+  return CODECTK_OK;
+}
+
+/* Coding */
+
+/* Move nbits from R to W in pieces the bit I/O takes */
+static void move_bits(bitr_t *R, bitw_t *W, size_t nbits) {
+  while (nbits) {
+    unsigned b = nbits < 32 ? (unsigned)nbits : 32;
+    uint64_t v = 0;
+    bitr_get_bits(R, b, &v);
+    bitw_put_bits(W, v, b);
+    nbits -= b;
+  }
+}
+
+/**
+ * Goppa: the words of the stream one group at a time, each copied to its
+ * own byte-aligned slot for the batch calls and the results packed back.
+ */
+static codectk_err run_goppa(codectk_handle *h, const uint8_t *in, size_t in_bits,
+                             uint8_t *out, size_t cap, size_t *out_bits) {
+  int enc = h->dir == CODECTK_ENCODE;
+  size_t in_len = enc ? h->k : h->n, out_len = enc ? h->n : h->k;
+  size_t count = enc ? (in_bits + h->k - 1) / h->k : in_bits / h->n;
+  size_t in_slot = (in_len + 7) / 8, out_slot = (out_len + 7) / 8;
+  uint8_t *slots = h->words, *outs = h->words + GOPPA_GROUP * in_slot;
+  codectk_err result = CODECTK_OK;
+
+  bitr_t R;
+  bitw_t W;
+  bitr_init(&R, in, (in_bits + 7) / 8);
+  bitw_init(&W, out, cap);
+  for (size_t first = 0; first < count; first += GOPPA_GROUP) {
+    size_t group = count - first < GOPPA_GROUP ? count - first : GOPPA_GROUP;
+    for (size_t i = 0; i < group; i++) {
+      /* A trailing partial message is zero-filled by the encoder */
+      size_t left = in_bits - (first + i) * in_len;
+      size_t bits = left < in_len ? left : in_len;
+      bitw_t S;
+      bitw_init(&S, slots + i * in_slot, in_slot);
+      move_bits(&R, &S, bits);
+      bitw_flush(&S);
+      codectk_batch_item it = {slots + i * in_slot, bits, outs + i * out_slot, out_slot * 8, 0,
+                               CODECTK_OK};
+      h->items[i] = it;
+    }
+
+    codectk_err err;
+    if (enc) {
+      err = goppa_ctx_encode_batch(h->goppa, h->items, group);
+    } else if (h->goppa->flags & GOPPA_FLAG_CT) {
+      err = goppa_ctx_decode_ct_batch(h->goppa, h->items, group);
+    } else {
+      err = CODECTK_OK;
+      for (size_t i = 0; i < group; i++) {
+        codectk_batch_item *it = &h->items[i];
+        it->err = goppa_ctx_decode_ws(h->goppa, it->in, it->in_bits, it->out, &it->out_bits,
+                                      &it->num_corrected, h->ws, h->ws_size);
+        if (err == CODECTK_OK) err = it->err;
+      }
+    }
+    if (err != CODECTK_OK && err != CODECTK_EDECODE) return err;
+    if (err != CODECTK_OK) result = err;
+
+    for (size_t i = 0; i < group; i++) {
+      bitr_t S;
+      bitr_init(&S, outs + i * out_slot, out_slot);
+      move_bits(&S, &W, out_len);
+      h->corrected += h->items[i].num_corrected;
+    }
+  }
+
+  *out_bits = bitw_tell(&W);
+  bitw_flush(&W);
+  return result;
+}
+
+/* Code in_bits bits (whole units, or the tail of the stream) into out */
+static codectk_err run(codectk_handle *h, const uint8_t *in, size_t in_bits, uint8_t *out,
+                       size_t cap, size_t *out_bits) {
+  size_t corr = 0;
+  codectk_err err;
+  *out_bits = cap * 8;
+
+  if (h->kind == KIND_GOPPA) return run_goppa(h, in, in_bits, out, cap, out_bits);
+
+  if (h->dir == CODECTK_ENCODE) {
+    if (h->kind == KIND_BCH) {
+      return bch_ctx_encode(h->bch, h->params.bch.pad, in, in_bits, out, out_bits);
+    }
+    return h->codec->encode(h->pp, in, in_bits, out, out_bits);
+  }
+
+  if (h->kind != KIND_BCH) {
+    err = h->codec->decode(h->pp, in, in_bits, out, out_bits, &corr);
+  } else if (h->params.bch.flags & BCH_FLAG_CT) {
+    err = bch_ctx_decode_ct(h->bch, h->params.bch.pad, in, in_bits, out, out_bits, &corr);
+  } else if (h->parallel && in_bits >= PAR_MIN_BITS) {
+    err = bch_ctx_decode(h->bch, h->params.bch.pad, in, in_bits, out, out_bits, &corr);
+  } else {
+    err = bch_ctx_decode_ws(h->bch, h->params.bch.pad, in, in_bits, out, out_bits, &corr,
+                            h->ws, h->ws_size);
+  }
+  h->corrected += corr;
+  return err;
+}
+
+/* Huffman: collect the stream, code it on the flush */
+static codectk_err process_whole(codectk_handle *h, const uint8_t *in, size_t in_bits,
+                                 int flush, const uint8_t **out, size_t *out_bits) {
+  size_t held = h->pend_bits / 8;
+  codectk_err err = reserve(&h->pend, &h->pend_cap, held + (in_bits + 7) / 8);
+  if (err != CODECTK_OK) return err;
+  if (in_bits) memcpy(h->pend + held, in, (in_bits + 7) / 8);
+  h->pend_bits += in_bits;
+  if (!flush || !h->pend_bits) {
+    if (flush) h->pend_bits = 0;
+    return CODECTK_OK;
+  }
+
+  /* Encoders rarely more than double, a decoded symbol takes at least a bit */
+  size_t in_bytes = (h->pend_bits + 7) / 8;
+  size_t need = h->dir == CODECTK_ENCODE ? 2 * in_bytes + 64 : 4 * in_bytes + 64;
+  err = reserve(&h->out, &h->out_cap, need);
+  size_t bits = 0;
+  while (err == CODECTK_OK) {
+    err = run(h, h->pend, h->pend_bits, h->out, h->out_cap, &bits);
+    if (err != CODECTK_ENOMEM || h->out_cap >= MAX_BUFFER) break;
+    err = reserve(&h->out, &h->out_cap, 2 * h->out_cap);
+  }
+  if (err == CODECTK_ENOMEM) return err;
+  h->pend_bits = 0;
+  if (err != CODECTK_OK && err != CODECTK_EDECODE) return err;
+
+  *out = h->out;
+  *out_bits = bits;
+  return err;
+}
+
+codectk_err codectk_process(codectk_handle *h, const uint8_t *in, size_t in_bits,
+                            unsigned flags, const uint8_t **out, size_t *out_bits) {
+  if (!h || !out || !out_bits || (in_bits && !in) || (flags & ~CODECTK_FLUSH)) {
+    return CODECTK_EINVAL;
+  }
+  int flush = (flags & CODECTK_FLUSH) != 0;
+  if (!flush && in_bits % 8) return CODECTK_EINVAL;
+  *out = h->out;
+  *out_bits = 0;
+  if (!h->unit_in) return process_whole(h, in, in_bits, flush, out, out_bits);
+
+  /* Whole units now, and the tail (less than a unit) on the flush */
+  size_t unit_bits = h->unit_in * 8;
+  size_t total = h->pend_bits + in_bits;
+  size_t units = total / unit_bits;
+  int tail = flush && total % unit_bits;
+  codectk_err err = reserve(&h->out, &h->out_cap, (units + (size_t)tail) * h->unit_out);
+  if (err != CODECTK_OK) return err;
+  *out = h->out;
+
+  codectk_err result = CODECTK_OK;
+  size_t used = 0, done = 0, bits;
+
+  /* Complete the held-back unit first */
+  if (h->pend_bits && units) {
+    used = unit_bits - h->pend_bits;
+    memcpy(h->pend + h->pend_bits / 8, in, used / 8);
+    err = run(h, h->pend, unit_bits, h->out, h->unit_out, &bits);
+    h->pend_bits = 0;
+    units--;
+    if (err != CODECTK_OK) result = err;
+    done += bits;
+  }
+  if (units && (result == CODECTK_OK || result == CODECTK_EDECODE)) {
+    err = run(h, in + used / 8, units * unit_bits, h->out + done / 8, units * h->unit_out,
+              &bits);
+    used += units * unit_bits;
+    if (err != CODECTK_OK) result = err;
+    done += bits;
+  }
+  if (result != CODECTK_OK && result != CODECTK_EDECODE) {
+    h->pend_bits = 0;
+    *out_bits = done;
+    return result;
+  }
+
+  /* Hold back the rest; pend_bits is a whole number of bytes here */
+  if (in_bits > used) memcpy(h->pend + h->pend_bits / 8, in + used / 8, (in_bits - used + 7) / 8);
+  h->pend_bits += in_bits - used;
+
+  if (flush) {
+    if (h->pend_bits) {
+      err = run(h, h->pend, h->pend_bits, h->out + done / 8, h->unit_out, &bits);
+      if (err != CODECTK_OK) result = err;
+      if (err == CODECTK_OK || err == CODECTK_EDECODE) done += bits;
+    }
+    h->pend_bits = 0;
+  }
+
+  *out_bits = done;
+  return result;
+}
+
+size_t codectk_corrected(const codectk_handle *h) {
+  return h ? h->corrected : 0;
+}
+
+void codectk_close(codectk_handle *h) {
+  if (!h) return;
+  bch_ctx_destroy(h->bch_owned);
+  goppa_ctx_destroy(h->goppa_owned);
+  free(h->ws);
+  free(h->pend);
+  free(h->out);
+  free(h->words);
+  free(h->items);
+  free(h);
+}
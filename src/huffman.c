@@ -1,17 +1,58 @@
 /**
  * huffman.c - Dynamic Huffman coding implementation
  *
- * Implements adaptive Huffman encoding with frequency analysis.
- * Format: HUF1 magic + frequency table + compressed data.
+ * Implements Huffman encoding with frequency analysis and canonical,
+ * length-limited codes decoded through a lookup table.
+ *
+ * Formats:
+ *   HUF2: magic + packed code lengths (see pack_lengths) + compressed data
+ *   HUFB: independent blocks of block_size input bytes, coded in parallel
+ *         magic, LE32 block_size, LE32 nblocks, LE32 size of the last block,
+ *         LE32 streams (1 or 4)
+ *         index: per block LE32 coded size, LE32 table block
+ *         blocks: [packed lengths if table block == self] + compressed data
+ *         with 4 streams, the compressed data is a jump table and the four
+ *         quarters of the block coded separately, without EOF, so that the
+ *         decoder can run four independent bit readers
+ *   HUF1: magic + 257 little-endian 32-bit frequencies + compressed data
+ *         (legacy; still decoded, no longer written)
+ *
+ * Compressed data is LSB-first; each code is sent starting from its most
+ * significant bit, the EOF symbol terminates the stream.
  */
 
 #include "../include/huffman.h"
 #include "../include/bitio.h"
+#include "../include/executor.h"
+#include "../include/stats.h"
 #include <stdlib.h>
 #include <string.h>
 
 #define HUF_NSYMBOLS 257  /* 256 bytes + EOF marker */
 #define HUF_EOF_SYMBOL 256
+#define HUF_MAX_CODE_LEN 12 /* length limit for HUF2 codes */
+#define HUF_TABLE_BITS HUF_MAX_CODE_LEN /* largest decode table */
+
+#define HUFB_HEADER_SIZE 20
+#define HUFB_INDEX_ENTRY 8
+#define HUF_STREAMS 4        /* segments of an interleaved block */
+#define HUF_JUMP_TABLE 12    /* LE32 sizes of all segments but the last */
+
+/* Length nibbles above HUF_MAX_CODE_LEN are run codes */
+#define HUF2_ZERO_RUN 13   /* + n: 3 + n zero lengths */
+#define HUF2_REPEAT 14     /* + n: 3 + n copies of the previous length */
+#define HUF2_LONG_ZERO 15  /* + lo, hi: 19 + (lo | hi << 4) zero lengths */
+
+/*
+ * Decode table entry for the next HUF_TABLE_BITS stream bits: the first
+ * symbol and its length, plus a second symbol when both codes fit in the
+ * peeked bits (neither of them EOF).
+ */
+#define HUF_E_SYM0(e)  ((e) & 0x1FFu)
+#define HUF_E_SYM1(e)  (((e) >> 9) & 0xFFu)
+#define HUF_E_COUNT(e) (((e) >> 17) & 0x3u)
+#define HUF_E_LEN0(e)  (((e) >> 19) & 0x1Fu)
+#define HUF_E_TOTAL(e) (((e) >> 24) & 0x1Fu)
 
 /**
  * Huffman tree node structure.
@@ -31,14 +72,6 @@ typedef struct {
   int capacity;
 } min_heap;
 
-/**
- * Code table entry: bit code and length.
- */
-typedef struct {
-  uint64_t code;
-  int length;
-} code_entry;
-
 /* Min-heap operations */
 
 static min_heap* heap_create(int capacity) {
@@ -191,51 +224,328 @@ static huf_node* build_tree(const unsigned *freq) {
   return root;
 }
 
-/* Code table generation */
+/* Code construction */
 
-static void build_codes_recursive(huf_node *node, code_entry *table,
-                                   uint64_t current_code, int depth) {
-  if (!node) return;
+static int cmp_asc_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+  return (x > y) - (x < y);
+}
 
-  if (node->symbol >= 0) {
-    /* Leaf node: store code */
-    table[node->symbol].code = current_code;
-    table[node->symbol].length = depth;
-  } else {
-    /* Internal node: recurse */
-    if (node->left) {
-      build_codes_recursive(node->left, table, (current_code << 1) | 0, depth + 1);
+static int cmp_desc_u64(const void *a, const void *b) {
+  return cmp_asc_u64(b, a);
+}
+
+/**
+ * Huffman code lengths without building a pointer tree: with the leaves
+ * sorted by frequency, merged nodes come out in nondecreasing weight, so
+ * two queues (leaves, merged nodes) replace the heap. Everything lives in
+ * fixed arrays on the stack.
+ */
+static void code_lengths(const unsigned *freq, unsigned *len) {
+  uint64_t leaf[HUF_NSYMBOLS];
+  uint64_t weight[2 * HUF_NSYMBOLS];
+  int parent[2 * HUF_NSYMBOLS];
+  unsigned depth[2 * HUF_NSYMBOLS];
+  int n = 0;
+
+  memset(len, 0, HUF_NSYMBOLS * sizeof(unsigned));
+  for (int s = 0; s < HUF_NSYMBOLS; s++) {
+    if (freq[s]) leaf[n++] = ((uint64_t)freq[s] << 9) | (unsigned)s;
+  }
+  if (n == 0) return;
+  if (n == 1) {
+    len[leaf[0] & 0x1FF] = 1;
+    return;
+  }
+  qsort(leaf, (size_t)n, sizeof(leaf[0]), cmp_asc_u64);
+
+  /* Nodes 0..n-1 are the sorted leaves, n.. the merged nodes */
+  for (int i = 0; i < n; i++) weight[i] = leaf[i] >> 9;
+  int li = 0, mi = n, next = n;
+  while (next < 2 * n - 1) {
+    int pick[2];
+    for (int k = 0; k < 2; k++) {
+      if (mi >= next || (li < n && weight[li] <= weight[mi])) {
+        pick[k] = li++;
+      } else {
+        pick[k] = mi++;
+      }
     }
-    if (node->right) {
-      build_codes_recursive(node->right, table, (current_code << 1) | 1, depth + 1);
+    weight[next] = weight[pick[0]] + weight[pick[1]];
+    parent[pick[0]] = parent[pick[1]] = next;
+    next++;
+  }
+
+  /* Parents always have higher indices, so one downward pass sets depths */
+  depth[next - 1] = 0;
+  for (int i = next - 2; i >= 0; i--) {
+    depth[i] = depth[parent[i]] + 1;
+  }
+  for (int i = 0; i < n; i++) {
+    len[leaf[i] & 0x1FF] = depth[i];
+  }
+}
+
+/**
+ * Enforce len[s] <= HUF_MAX_CODE_LEN. The length histogram is rebalanced
+ * as in JPEG Annex K.3 (each step moves a pair of leaves up and splits a
+ * shorter leaf, keeping the Kraft sum at 1), then lengths are handed out
+ * again shortest-first in order of decreasing frequency.
+ */
+static void limit_lengths(const unsigned *freq, unsigned *len) {
+  unsigned count[HUF_NSYMBOLS + 1] = {0};
+  unsigned maxlen = 0;
+
+  for (int s = 0; s < HUF_NSYMBOLS; s++) {
+    if (len[s]) {
+      count[len[s]]++;
+      if (len[s] > maxlen) maxlen = len[s];
+    }
+  }
+  if (maxlen <= HUF_MAX_CODE_LEN) return;
+
+  for (unsigned i = maxlen; i > HUF_MAX_CODE_LEN; i--) {
+    while (count[i] > 0) {
+      unsigned j = i - 2;
+      while (count[j] == 0) j--;
+      count[i] -= 2;
+      count[i - 1]++;
+      count[j + 1] += 2;
+      count[j]--;
+    }
+  }
+
+  /* Symbols by decreasing frequency, ties by increasing symbol */
+  uint64_t order[HUF_NSYMBOLS];
+  int n = 0;
+  for (int s = 0; s < HUF_NSYMBOLS; s++) {
+    if (len[s]) order[n++] = ((uint64_t)freq[s] << 9) | (unsigned)(HUF_NSYMBOLS - 1 - s);
+  }
+  qsort(order, (size_t)n, sizeof(order[0]), cmp_desc_u64);
+
+  int idx = 0;
+  for (unsigned l = 1; l <= HUF_MAX_CODE_LEN; l++) {
+    for (unsigned c = 0; c < count[l]; c++, idx++) {
+      len[HUF_NSYMBOLS - 1 - (int)(order[idx] & 0x1FF)] = l;
     }
   }
 }
 
-static void build_code_table(huf_node *root, code_entry *table) {
-  memset(table, 0, HUF_NSYMBOLS * sizeof(code_entry));
+/**
+ * Canonical code assignment: codes of each length are consecutive, in
+ * symbol order, and shorter codes come first. rev[s] is the code of s
+ * bit-reversed, i.e. in stream order for the LSB-first bit I/O.
+ * Returns -1 if a length is out of range or the lengths over-subscribe
+ * the code space.
+ */
+static int canonical_codes(const uint8_t *len, uint16_t *rev) {
+  unsigned count[HUF_MAX_CODE_LEN + 1] = {0};
 
-  if (!root) return;
+  for (int s = 0; s < HUF_NSYMBOLS; s++) {
+    if (len[s] > HUF_MAX_CODE_LEN) return -1;
+    count[len[s]]++;
+  }
+  count[0] = 0;
+
+  unsigned next[HUF_MAX_CODE_LEN + 1];
+  unsigned code = 0;
+  int left = 1;
+  for (unsigned l = 1; l <= HUF_MAX_CODE_LEN; l++) {
+    code = (code + count[l - 1]) << 1;
+    next[l] = code;
+    left = 2 * left - (int)count[l];
+    if (left < 0) return -1;
+  }
 
-  /* Handle single-symbol tree */
-  if (root->left && !root->right) {
-    table[root->left->symbol].code = 0;
-    table[root->left->symbol].length = 1;
-    return;
+  for (int s = 0; s < HUF_NSYMBOLS; s++) {
+    unsigned l = len[s];
+    if (!l) continue;
+    unsigned c = next[l]++;
+    unsigned r = 0;
+    for (unsigned b = 0; b < l; b++) {
+      r |= ((c >> b) & 1u) << (l - 1 - b);
+    }
+    rev[s] = (uint16_t)r;
   }
+  return 0;
+}
 
-  build_codes_recursive(root, table, 0, 0);
+/**
+ * Fill the 2^bits-entry decode table from code lengths (bits >= longest
+ * length). Entries for bit patterns that are no code prefix (incomplete
+ * codes) stay 0, which has LEN0 = 0.
+ */
+static int build_decode_table(const uint8_t *len, unsigned bits, uint32_t *tab) {
+  uint16_t rev[HUF_NSYMBOLS];
+  if (canonical_codes(len, rev) != 0) return -1;
+
+  memset(tab, 0, sizeof(uint32_t) << bits);
+  for (unsigned s = 0; s < HUF_NSYMBOLS; s++) {
+    unsigned l = len[s];
+    if (!l) continue;
+    uint32_t e = s | (1u << 17) | (l << 19) | (l << 24);
+    for (unsigned v = rev[s]; v < (1u << bits); v += 1u << l) {
+      tab[v] = e;
+    }
+  }
+
+  /* Second symbol from the bits left over after the first */
+  for (unsigned v = 0; v < (1u << bits); v++) {
+    uint32_t e = tab[v];
+    unsigned l0 = HUF_E_LEN0(e);
+    if (!l0 || HUF_E_SYM0(e) == HUF_EOF_SYMBOL) continue;
+
+    uint32_t e1 = tab[v >> l0];
+    unsigned l1 = HUF_E_LEN0(e1);
+    if (!l1 || l0 + l1 > bits || HUF_E_SYM0(e1) == HUF_EOF_SYMBOL) continue;
+
+    tab[v] = HUF_E_SYM0(e) | (HUF_E_SYM0(e1) << 9) | (2u << 17) | (l0 << 19) |
+             ((l0 + l1) << 24);
+  }
+  return 0;
+}
+
+/* HUF2 header */
+
+/**
+ * Code lengths as a nibble stream, two nibbles per byte (low nibble
+ * first): 0..12 is a literal length, HUF2_ZERO_RUN / HUF2_REPEAT / HUF2_LONG_ZERO
+ * carry a run count in the following nibble(s). The stream ends after 257
+ * lengths, padded to a whole byte. Returns the bytes written, or 0 if
+ * they do not fit in cap.
+ */
+static size_t pack_lengths(const uint8_t *len, uint8_t *out, size_t cap) {
+  uint8_t nib[2 * HUF_NSYMBOLS];
+  size_t nn = 0;
+
+  for (int s = 0; s < HUF_NSYMBOLS;) {
+    int run = 1;
+    while (s + run < HUF_NSYMBOLS && len[s + run] == len[s]) run++;
+
+    if (len[s] == 0 && run >= 19) {
+      if (run > 19 + 255) run = 19 + 255;
+      nib[nn++] = HUF2_LONG_ZERO;
+      nib[nn++] = (uint8_t)((run - 19) & 0xF);
+      nib[nn++] = (uint8_t)((run - 19) >> 4);
+    } else if (len[s] == 0 && run >= 3) {
+      if (run > 18) run = 18;
+      nib[nn++] = HUF2_ZERO_RUN;
+      nib[nn++] = (uint8_t)(run - 3);
+    } else if (run >= 4) {
+      /* One literal, then repeats of it */
+      if (run > 19) run = 19;
+      nib[nn++] = len[s];
+      nib[nn++] = HUF2_REPEAT;
+      nib[nn++] = (uint8_t)(run - 4);
+    } else {
+      run = 1;
+      nib[nn++] = len[s];
+    }
+    s += run;
+  }
+
+  size_t bytes = (nn + 1) / 2;
+  if (bytes > cap) return 0;
+  for (size_t i = 0; i < bytes; i++) {
+    uint8_t hi = 2 * i + 1 < nn ? nib[2 * i + 1] : 0;
+    out[i] = (uint8_t)(nib[2 * i] | (hi << 4));
+  }
+  return bytes;
+}
+
+/**
+ * Inverse of pack_lengths(). Returns the bytes consumed, or 0 if the
+ * lengths are malformed or run past the end of the input.
+ */
+static size_t unpack_lengths(const uint8_t *in, size_t in_bytes, uint8_t *len) {
+  size_t pos = 0; /* nibble index */
+  int s = 0;
+
+#define NEXT_NIBBLE(v) do { \
+    if (pos / 2 >= in_bytes) return 0; \
+    (v) = (unsigned)(in[pos / 2] >> (4 * (pos & 1))) & 0xFu; \
+    pos++; \
+  } while (0)
+
+  while (s < HUF_NSYMBOLS) {
+    unsigned v, run;
+    NEXT_NIBBLE(v);
+    if (v <= HUF_MAX_CODE_LEN) {
+      len[s++] = (uint8_t)v;
+      continue;
+    }
+
+    uint8_t fill = 0;
+    if (v == HUF2_ZERO_RUN) {
+      NEXT_NIBBLE(run);
+      run += 3;
+    } else if (v == HUF2_REPEAT) {
+      if (s == 0) return 0;
+      fill = len[s - 1];
+      NEXT_NIBBLE(run);
+      run += 3;
+    } else {
+      unsigned hi;
+      NEXT_NIBBLE(run);
+      NEXT_NIBBLE(hi);
+      run += 19 + (hi << 4);
+    }
+    if (run > (unsigned)(HUF_NSYMBOLS - s)) return 0;
+    memset(len + s, fill, run);
+    s += (int)run;
+  }
+
+#undef NEXT_NIBBLE
+
+  return (pos + 1) / 2;
 }
 
 /* Encoder */
 
-static codectk_err huf_encode(const void *pp, const uint8_t *in, size_t in_bits,
-                                uint8_t *out, size_t *out_bits) {
-  (void)pp; /* params unused for dynamic Huffman */
+/* Limited canonical code lengths for a histogram (EOF included) */
+static void huf_lengths(const unsigned *freq, uint8_t *len) {
+  unsigned depth[HUF_NSYMBOLS];
+  code_lengths(freq, depth);
+  limit_lengths(freq, depth);
+  for (int s = 0; s < HUF_NSYMBOLS; s++) {
+    len[s] = (uint8_t)depth[s];
+  }
+}
 
-  size_t in_bytes = (in_bits + 7) / 8;
-  if (in_bytes == 0) return CODECTK_EINVAL;
+/* Payload bits for freq under len, or UINT64_MAX if a used symbol has no code */
+static uint64_t payload_bits(const unsigned *freq, const uint8_t *len) {
+  uint64_t bits = 0;
+  for (int s = 0; s < HUF_NSYMBOLS; s++) {
+    if (!freq[s]) continue;
+    if (!len[s]) return UINT64_MAX;
+    bits += (uint64_t)freq[s] * len[s];
+  }
+  return bits;
+}
+
+/* Code in[0..n): one multi-bit write per symbol */
+static int emit_symbols(bitw_t *W, const uint8_t *in, size_t n,
+                        const uint16_t *rev, const uint8_t *len) {
+  for (size_t i = 0; i < n; i++) {
+    if (bitw_put_bits(W, rev[in[i]], len[in[i]])) return -1;
+  }
+  return 0;
+}
 
+/* Code in[0..n) followed by EOF */
+static codectk_err emit_payload(bitw_t *W, const uint8_t *in, size_t n, const uint8_t *len) {
+  uint16_t rev[HUF_NSYMBOLS];
+  if (canonical_codes(len, rev) != 0) return CODECTK_EINVAL;
+
+  if (emit_symbols(W, in, n, rev, len)) return CODECTK_ENOMEM;
+  if (bitw_put_bits(W, rev[HUF_EOF_SYMBOL], len[HUF_EOF_SYMBOL])) return CODECTK_ENOMEM;
+
+  bitw_flush(W);
+  return CODECTK_OK;
+}
+
+static codectk_err huf2_encode(const uint8_t *in, size_t in_bytes,
+                               uint8_t *out, size_t *out_bits) {
   /* Build frequency table */
   unsigned freq[HUF_NSYMBOLS] = {0};
   for (size_t i = 0; i < in_bytes; i++) {
@@ -243,93 +553,590 @@ static codectk_err huf_encode(const void *pp, const uint8_t *in, size_t in_bits,
   }
   freq[HUF_EOF_SYMBOL] = 1; /* EOF marker */
 
-  /* Build Huffman tree */
-  huf_node *root = build_tree(freq);
-  if (!root) return CODECTK_ENOMEM;
-
-  /* Generate code table */
-  code_entry codes[HUF_NSYMBOLS];
-  build_code_table(root, codes);
+  uint8_t len[HUF_NSYMBOLS];
+  huf_lengths(freq, len);
 
-  /* Write header directly to output buffer: magic "HUF1" + frequency table */
-  size_t header_size = 4 + HUF_NSYMBOLS * 4;
+  /* Header: magic "HUF2" + packed code lengths */
   size_t out_bytes = (*out_bits) / 8;
+  if (out_bytes < 4) return CODECTK_ENOMEM;
+  memcpy(out, "HUF2", 4);
+  size_t header_size = 4 + pack_lengths(len, out + 4, out_bytes - 4);
+  if (header_size == 4) return CODECTK_ENOMEM;
 
-  if (out_bytes < header_size) {
-    free_tree(root);
-    return CODECTK_ENOMEM;
+  bitw_t W;
+  bitw_init(&W, out + header_size, out_bytes - header_size);
+  codectk_err err = emit_payload(&W, in, in_bytes, len);
+  if (err != CODECTK_OK) return err;
+
+  /* Total size: header + compressed data */
+  *out_bits = (header_size + bitw_tell(&W) / 8) * 8;
+  return CODECTK_OK;
+}
+
+/* HUFB block container */
+
+static inline void put_le32(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static inline uint32_t get_le32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+typedef struct {
+  const uint8_t *in;
+  size_t len;                       /* raw bytes */
+  unsigned freq[HUF_NSYMBOLS];
+  unsigned (*seg_freq)[HUF_NSYMBOLS]; /* HUF_STREAMS rows, interleaved only */
+  uint8_t lens[HUF_NSYMBOLS];       /* own code lengths */
+  uint8_t hdr[HUF_NSYMBOLS];        /* packed lengths */
+  size_t hdr_bytes;
+  size_t table;                     /* block whose lengths code this one */
+  size_t seg_bytes[HUF_STREAMS];    /* coded segment sizes, interleaved only */
+  size_t offset, size;              /* position in the output */
+} huf_block;
+
+typedef struct {
+  huf_block *blk;
+  uint8_t *out;
+  unsigned streams;
+} hufb_enc;
+
+/* Input bytes in segment j of an n-byte block split into HUF_STREAMS */
+static inline void segment(size_t n, unsigned j, size_t *start, size_t *len) {
+  size_t seg = (n + HUF_STREAMS - 1) / HUF_STREAMS;
+  size_t s = (size_t)j * seg;
+  if (s > n) s = n;
+  *start = s;
+  *len = (n - s < seg) ? n - s : seg;
+}
+
+/* Pass 1: histogram, lengths and packed header of one block */
+static codectk_err hufb_plan(void *ctx, size_t i, unsigned worker) {
+  (void)worker;
+  const hufb_enc *e = (const hufb_enc*)ctx;
+  huf_block *b = &e->blk[i];
+
+  memset(b->freq, 0, sizeof(b->freq));
+  if (e->streams == 1) {
+    for (size_t j = 0; j < b->len; j++) {
+      b->freq[b->in[j]]++;
+    }
+  } else {
+    for (unsigned j = 0; j < HUF_STREAMS; j++) {
+      size_t start, len;
+      segment(b->len, j, &start, &len);
+      unsigned *f = b->seg_freq[j];
+      memset(f, 0, sizeof(b->seg_freq[0]));
+      for (size_t k = 0; k < len; k++) {
+        f[b->in[start + k]]++;
+      }
+      for (int s = 0; s < HUF_NSYMBOLS; s++) {
+        b->freq[s] += f[s];
+      }
+    }
   }
+  b->freq[HUF_EOF_SYMBOL] = 1;
 
-  uint8_t *p = out;
+  huf_lengths(b->freq, b->lens);
+  b->hdr_bytes = pack_lengths(b->lens, b->hdr, sizeof(b->hdr));
+  return b->hdr_bytes ? CODECTK_OK : CODECTK_EINVAL;
+}
 
-  /* Write magic */
-  const char magic[4] = {'H', 'U', 'F', '1'};
-  memcpy(p, magic, 4);
-  p += 4;
+/**
+ * Coded bytes of block b under len, without the packed lengths, or
+ * UINT64_MAX if len lacks a code b needs. Fills seg[] when interleaved.
+ */
+static uint64_t block_bytes(const huf_block *b, unsigned streams, const uint8_t *len,
+                            size_t *seg) {
+  if (streams == 1) {
+    uint64_t bits = payload_bits(b->freq, len);
+    return bits == UINT64_MAX ? bits : (bits + 7) / 8;
+  }
 
-  /* Write frequency table (4 bytes per symbol, 257 symbols) */
-  for (int i = 0; i < HUF_NSYMBOLS; i++) {
-    uint32_t f = (uint32_t)freq[i];
-    *p++ = (uint8_t)(f & 0xff);
-    *p++ = (uint8_t)((f >> 8) & 0xff);
-    *p++ = (uint8_t)((f >> 16) & 0xff);
-    *p++ = (uint8_t)((f >> 24) & 0xff);
+  uint64_t bytes = HUF_JUMP_TABLE;
+  for (unsigned j = 0; j < HUF_STREAMS; j++) {
+    uint64_t bits = payload_bits(b->seg_freq[j], len);
+    if (bits == UINT64_MAX) return bits;
+    seg[j] = (size_t)((bits + 7) / 8);
+    bytes += seg[j];
+  }
+  return bytes;
+}
+
+/* Pass 2: code one block at its final offset */
+static codectk_err hufb_emit(void *ctx, size_t i, unsigned worker) {
+  (void)worker;
+  hufb_enc *e = (hufb_enc*)ctx;
+  const huf_block *b = &e->blk[i];
+  const uint8_t *len = e->blk[b->table].lens;
+  uint8_t *p = e->out + b->offset;
+  size_t hdr = 0;
+
+  if (b->table == i) {
+    memcpy(p, b->hdr, b->hdr_bytes);
+    hdr = b->hdr_bytes;
   }
 
-  /* Initialize bitio writer starting after header */
   bitw_t W;
-  bitw_init(&W, p, out_bytes - header_size);
+  if (e->streams == 1) {
+    bitw_init(&W, p + hdr, b->size - hdr);
+    return emit_payload(&W, b->in, b->len, len);
+  }
 
-  /* Encode data */
-  for (size_t i = 0; i < in_bytes; i++) {
-    uint8_t symbol = in[i];
-    code_entry *ce = &codes[symbol];
-
-    for (int bit = ce->length - 1; bit >= 0; bit--) {
-      int b = (ce->code >> bit) & 1;
-      if (bitw_put(&W, (unsigned)b)) {
-        free_tree(root);
-        return CODECTK_ENOMEM;
-      }
-    }
+  /* Jump table: sizes of the first three segments, the last one is the rest */
+  uint16_t rev[HUF_NSYMBOLS];
+  if (canonical_codes(len, rev) != 0) return CODECTK_EINVAL;
+  p += hdr;
+  for (unsigned j = 0; j + 1 < HUF_STREAMS; j++) {
+    put_le32(p + 4 * j, (uint32_t)b->seg_bytes[j]);
+  }
+  p += HUF_JUMP_TABLE;
+
+  for (unsigned j = 0; j < HUF_STREAMS; j++) {
+    size_t start, n;
+    segment(b->len, j, &start, &n);
+    bitw_init(&W, p, b->seg_bytes[j]);
+    if (emit_symbols(&W, b->in + start, n, rev, len)) return CODECTK_ENOMEM;
+    bitw_flush(&W);
+    p += b->seg_bytes[j];
   }
+  return CODECTK_OK;
+}
 
-  /* Write EOF code */
-  code_entry *eof_ce = &codes[HUF_EOF_SYMBOL];
-  for (int bit = eof_ce->length - 1; bit >= 0; bit--) {
-    int b = (eof_ce->code >> bit) & 1;
-    if (bitw_put(&W, (unsigned)b)) {
-      free_tree(root);
-      return CODECTK_ENOMEM;
+static codectk_err hufb_encode(const huffman_params *P, const uint8_t *in, size_t in_bytes,
+                               uint8_t *out, size_t *out_bits) {
+  size_t bs = P->block_size ? P->block_size : HUFFMAN_DEFAULT_BLOCK;
+  unsigned streams = P->streams ? P->streams : 1;
+  if (bs > UINT32_MAX || (streams != 1 && streams != HUF_STREAMS)) return CODECTK_EINVAL;
+  if (bs < HUFFMAN_MIN_BLOCK) return CODECTK_EINVAL;
+  size_t nblocks = (in_bytes + bs - 1) / bs;
+  if (nblocks > UINT32_MAX) return CODECTK_EINVAL;
+
+  /* Header, index and a byte per block must fit before any planning */
+  if (HUFB_HEADER_SIZE + (HUFB_INDEX_ENTRY + 1) * nblocks > (*out_bits) / 8) {
+    return CODECTK_ENOMEM;
+  }
+
+  /* Segment histograms only for interleaved blocks, in one side array */
+  huf_block *blk = (huf_block*)malloc(nblocks * sizeof(huf_block));
+  unsigned (*seg_freq)[HUF_NSYMBOLS] = NULL;
+  if (streams == HUF_STREAMS) {
+    seg_freq = (unsigned (*)[HUF_NSYMBOLS])malloc(nblocks * HUF_STREAMS * sizeof(*seg_freq));
+  }
+  if (!blk || (streams == HUF_STREAMS && !seg_freq)) {
+    free(blk);
+    free(seg_freq);
+    return CODECTK_ENOMEM;
+  }
+  for (size_t i = 0; i < nblocks; i++) {
+    blk[i].in = in + i * bs;
+    blk[i].len = (i + 1 < nblocks) ? bs : in_bytes - i * bs;
+    blk[i].seg_freq = seg_freq ? seg_freq + i * HUF_STREAMS : NULL;
+  }
+
+  hufb_enc ctx = {blk, out, streams};
+  codectk_err err = codectk_executor_run(codectk_executor_shared(), nblocks, P->threads,
+                                         hufb_plan, &ctx);
+  if (err != CODECTK_OK) {
+    free(blk);
+    free(seg_freq);
+    return err;
+  }
+
+  /*
+   * Table choice, in order: reuse the lengths of the latest block that
+   * carries its own table whenever that codes this block in no more bytes
+   * than its own table plus header. Sizes are exact, so every block gets
+   * its final offset before any of them is coded.
+   */
+  size_t offset = HUFB_HEADER_SIZE + HUFB_INDEX_ENTRY * nblocks;
+  size_t last = 0;
+  for (size_t i = 0; i < nblocks; i++) {
+    huf_block *b = &blk[i];
+    size_t reuse_seg[HUF_STREAMS];
+    uint64_t own = block_bytes(b, streams, b->lens, b->seg_bytes) + b->hdr_bytes;
+    uint64_t reuse = i ? block_bytes(b, streams, blk[last].lens, reuse_seg) : UINT64_MAX;
+
+    if (reuse <= own) {
+      b->table = last;
+      b->size = (size_t)reuse;
+      memcpy(b->seg_bytes, reuse_seg, sizeof(reuse_seg));
+    } else {
+      b->table = i;
+      b->size = (size_t)own;
+      last = i;
     }
+    b->offset = offset;
+    offset += b->size;
   }
 
-  if (bitw_flush(&W)) {
-    free_tree(root);
+  if (offset > (*out_bits) / 8) {
+    free(blk);
+    free(seg_freq);
     return CODECTK_ENOMEM;
   }
 
-  /* Total size: header + compressed data */
-  *out_bits = (header_size + (size_t)(W.p - p)) * 8;
+  /* Header and index */
+  memcpy(out, "HUFB", 4);
+  put_le32(out + 4, (uint32_t)bs);
+  put_le32(out + 8, (uint32_t)nblocks);
+  put_le32(out + 12, (uint32_t)(in_bytes - (nblocks - 1) * bs));
+  put_le32(out + 16, streams);
+  for (size_t i = 0; i < nblocks; i++) {
+    uint8_t *e = out + HUFB_HEADER_SIZE + HUFB_INDEX_ENTRY * i;
+    put_le32(e, (uint32_t)blk[i].size);
+    put_le32(e + 4, (uint32_t)blk[i].table);
+  }
 
-  free_tree(root);
+  err = codectk_executor_run(codectk_executor_shared(), nblocks, P->threads, hufb_emit,
+                             &ctx);
+  free(blk);
+  free(seg_freq);
+  if (err != CODECTK_OK) return err;
+
+  *out_bits = offset * 8;
   return CODECTK_OK;
 }
 
+static codectk_err huf_encode(const void *pp, const uint8_t *in, size_t in_bits,
+                                uint8_t *out, size_t *out_bits) {
+  const huffman_params *P = (const huffman_params*)pp;
+
+  size_t in_bytes = (in_bits + 7) / 8;
+  if (in_bytes == 0 || !out_bits) return CODECTK_EINVAL;
+
+  if (P && (P->block_size || P->streams > 1)) return hufb_encode(P, in, in_bytes, out, out_bits);
+  return huf2_encode(in, in_bytes, out, out_bits);
+}
+
 /* Decoder */
 
-static codectk_err huf_decode(const void *pp, const uint8_t *in, size_t in_bits,
-                                uint8_t *out, size_t *out_bits, size_t *corr) {
-  (void)pp;
-  (void)corr; /* No error correction in Huffman */
+/**
+ * Decode table for len, at least as wide as the longest code. A wider
+ * table pairs more symbols per lookup, but is only worth filling when the
+ * payload (nbits) is about as long. Returns the width, or 0 if len is not
+ * a valid code.
+ */
+static unsigned huf_table(const uint8_t *len, size_t nbits, uint32_t *tab) {
+  unsigned bits = 1;
+  for (int s = 0; s < HUF_NSYMBOLS; s++) {
+    if (len[s] > bits) bits = len[s];
+  }
+  while (bits < HUF_TABLE_BITS && ((size_t)1 << (bits + 1)) <= nbits) bits++;
 
-  size_t in_bytes = (in_bits + 7) / 8;
-  if (in_bytes < 4 + HUF_NSYMBOLS * 4) return CODECTK_EINVAL;
+  return build_decode_table(len, bits, tab) == 0 ? bits : 0;
+}
+
+/* Symbols of one payload up to and including EOF, through tab */
+static codectk_err decode_symbols(const uint32_t *tab, unsigned bits, const uint8_t *in,
+                                  size_t in_bytes, uint8_t *out, size_t *out_len) {
+  bitr_t R;
+  bitr_init(&R, in, in_bytes);
+
+  uint8_t *op = out;
+  uint8_t *op_end = out + *out_len;
+
+  /*
+   * Fast loop: one refill covers four lookups (4 * 12 <= 56 bits), and the
+   * output has room for the eight bytes they can produce. EOF, bad codes
+   * and the tails of the buffers drop to the checked loop below.
+   */
+  while (R.end - R.p >= 8 && op_end - op >= 8) {
+    bitr_refill(&R);
+    int stop = 0;
+    for (int i = 0; i < 4; i++) {
+      uint32_t e = tab[bitr_peek_bits(&R, bits)];
+      if (!HUF_E_TOTAL(e) || HUF_E_SYM0(e) == HUF_EOF_SYMBOL) {
+        stop = 1;
+        break;
+      }
+      op[0] = (uint8_t)HUF_E_SYM0(e);
+      op[1] = (uint8_t)HUF_E_SYM1(e);
+      op += HUF_E_COUNT(e);
+      bitr_skip_bits(&R, HUF_E_TOTAL(e));
+    }
+    if (stop) break;
+  }
+
+  for (;;) {
+    uint32_t e = tab[bitr_peek_bits(&R, bits)];
+    unsigned total = HUF_E_TOTAL(e);
+
+    /* Not a code, or a code running past the end of the input */
+    if (!total || bitr_skip_bits(&R, total)) return CODECTK_EDECODE;
+
+    unsigned sym = HUF_E_SYM0(e);
+    if (sym == HUF_EOF_SYMBOL) break;
+
+    unsigned count = HUF_E_COUNT(e);
+    if ((size_t)(op_end - op) < count) return CODECTK_ENOMEM;
+    op[0] = (uint8_t)sym;
+    if (count == 2) op[1] = (uint8_t)HUF_E_SYM1(e);
+    op += count;
+  }
+
+  *out_len = (size_t)(op - out);
+  return CODECTK_OK;
+}
+
+/**
+ * Decode one payload coded with len up to and including EOF; *out_len is
+ * the capacity on entry and the decoded length on return. No tree and no
+ * heap, and short payloads get a small table.
+ */
+static codectk_err decode_payload(const uint8_t *len, const uint8_t *in, size_t in_bytes,
+                                  uint8_t *out, size_t *out_len) {
+  if (len[HUF_EOF_SYMBOL] == 0) return CODECTK_EINVAL;
+
+  uint32_t tab[1u << HUF_TABLE_BITS];
+  CODECTK_STATS_T0(t0);
+  unsigned bits = huf_table(len, in_bytes * 8, tab);
+  CODECTK_STATS_STAGE(HUFFMAN, SETUP, t0);
+  if (!bits) return CODECTK_EINVAL;
+
+  CODECTK_STATS_RESTART(t0);
+  codectk_err err = decode_symbols(tab, bits, in, in_bytes, out, out_len);
+  CODECTK_STATS_STAGE(HUFFMAN, BITIO, t0);
+  return err;
+}
+
+/**
+ * Decode the exact count of symbols in one segment, without EOF. Same
+ * lookups as decode_symbols(), but a pair is cut short at the end.
+ */
+static codectk_err decode_segment(const uint32_t *tab, unsigned bits, bitr_t *R,
+                                  uint8_t *op, uint8_t *op_end) {
+  while (op < op_end) {
+    uint32_t e = tab[bitr_peek_bits(R, bits)];
+    unsigned total = HUF_E_TOTAL(e);
+    if (!total || HUF_E_SYM0(e) == HUF_EOF_SYMBOL) return CODECTK_EDECODE;
+
+    op[0] = (uint8_t)HUF_E_SYM0(e);
+    if (HUF_E_COUNT(e) == 2 && op_end - op >= 2) {
+      op[1] = (uint8_t)HUF_E_SYM1(e);
+      op += 2;
+    } else {
+      total = HUF_E_LEN0(e);
+      op++;
+    }
+    if (bitr_skip_bits(R, total)) return CODECTK_EDECODE;
+  }
+  return CODECTK_OK;
+}
+
+/**
+ * The HUF_STREAMS segments of an interleaved payload of n symbols through
+ * tab. The fast loop advances all four readers in the same iteration, so
+ * their table loads and shifts overlap instead of forming one serial chain.
+ */
+static codectk_err decode_interleaved(const uint32_t *tab, unsigned bits, const uint8_t *in,
+                                      size_t in_bytes, uint8_t *out, size_t n) {
+  bitr_t R[HUF_STREAMS];
+  uint8_t *op[HUF_STREAMS], *op_end[HUF_STREAMS];
+  const uint8_t *p = in + HUF_JUMP_TABLE;
+  size_t left = in_bytes - HUF_JUMP_TABLE;
+
+  for (unsigned j = 0; j < HUF_STREAMS; j++) {
+    size_t size = (j + 1 < HUF_STREAMS) ? get_le32(in + 4 * j) : left;
+    if (size > left) return CODECTK_EDECODE;
+    bitr_init(&R[j], p, size);
+    p += size;
+    left -= size;
+
+    size_t start, count;
+    segment(n, j, &start, &count);
+    op[j] = out + start;
+    op_end[j] = out + start + count;
+  }
+
+  /* Four lookups per reader and refill, as in decode_symbols() */
+  int fast = 1;
+  while (fast) {
+    for (unsigned j = 0; j < HUF_STREAMS; j++) {
+      if (R[j].end - R[j].p < 8 || op_end[j] - op[j] < 8) fast = 0;
+    }
+    if (!fast) break;
+
+    for (unsigned j = 0; j < HUF_STREAMS; j++) {
+      bitr_refill(&R[j]);
+    }
+    for (int i = 0; i < 4 && fast; i++) {
+      for (unsigned j = 0; j < HUF_STREAMS; j++) {
+        uint32_t e = tab[bitr_peek_bits(&R[j], bits)];
+        if (!HUF_E_TOTAL(e) || HUF_E_SYM0(e) == HUF_EOF_SYMBOL) {
+          fast = 0;
+          break;
+        }
+        op[j][0] = (uint8_t)HUF_E_SYM0(e);
+        op[j][1] = (uint8_t)HUF_E_SYM1(e);
+        op[j] += HUF_E_COUNT(e);
+        bitr_skip_bits(&R[j], HUF_E_TOTAL(e));
+      }
+    }
+  }
+
+  for (unsigned j = 0; j < HUF_STREAMS; j++) {
+    codectk_err err = decode_segment(tab, bits, &R[j], op[j], op_end[j]);
+    if (err != CODECTK_OK) return err;
+  }
+  return CODECTK_OK;
+}
+
+/* Decode an interleaved payload of n symbols: jump table, then the segments */
+static codectk_err decode_streams(const uint8_t *len, const uint8_t *in, size_t in_bytes,
+                                  uint8_t *out, size_t n) {
+  if (in_bytes < HUF_JUMP_TABLE) return CODECTK_EINVAL;
+
+  uint32_t tab[1u << HUF_TABLE_BITS];
+  CODECTK_STATS_T0(t0);
+  unsigned bits = huf_table(len, (in_bytes - HUF_JUMP_TABLE) * 8 / HUF_STREAMS, tab);
+  CODECTK_STATS_STAGE(HUFFMAN, SETUP, t0);
+  if (!bits) return CODECTK_EINVAL;
+
+  CODECTK_STATS_RESTART(t0);
+  codectk_err err = decode_interleaved(tab, bits, in, in_bytes, out, n);
+  CODECTK_STATS_STAGE(HUFFMAN, BITIO, t0);
+  return err;
+}
+
+static codectk_err huf2_decode(const uint8_t *in, size_t in_bytes,
+                               uint8_t *out, size_t *out_bits) {
+  uint8_t len[HUF_NSYMBOLS];
+  size_t header_size = 4 + unpack_lengths(in + 4, in_bytes - 4, len);
+  if (header_size == 4) return CODECTK_EINVAL;
+
+  size_t out_len = (*out_bits) / 8;
+  codectk_err err = decode_payload(len, in + header_size, in_bytes - header_size,
+                                   out, &out_len);
+  if (err != CODECTK_OK) return err;
 
-  /* Verify magic */
-  if (in[0] != 'H' || in[1] != 'U' || in[2] != 'F' || in[3] != '1') {
+  *out_bits = out_len * 8;
+  return CODECTK_OK;
+}
+
+/* Parsed HUFB header; the block data is only touched by hufb_block() */
+typedef struct {
+  const uint8_t *in;
+  size_t nblocks, block_size, last_size;
+  unsigned streams;
+  const uint8_t *index;
+  size_t *offset;                   /* nblocks + 1 entries, or NULL */
+  uint8_t *out;
+} hufb_dec;
+
+static codectk_err hufb_parse(const uint8_t *in, size_t in_bytes, hufb_dec *d) {
+  if (in_bytes < HUFB_HEADER_SIZE) return CODECTK_EINVAL;
+
+  d->in = in;
+  d->block_size = get_le32(in + 4);
+  d->nblocks = get_le32(in + 8);
+  d->last_size = get_le32(in + 12);
+  d->streams = get_le32(in + 16);
+  d->index = in + HUFB_HEADER_SIZE;
+  d->offset = NULL;
+
+  if (!d->block_size || !d->nblocks || !d->last_size || d->last_size > d->block_size ||
+      (d->streams != 1 && d->streams != HUF_STREAMS) ||
+      (in_bytes - HUFB_HEADER_SIZE) / HUFB_INDEX_ENTRY < d->nblocks) {
     return CODECTK_EINVAL;
   }
+  return CODECTK_OK;
+}
+
+/* Start and size of block i, from the index; -1 if out of range */
+static int hufb_locate(const hufb_dec *d, size_t in_bytes, size_t i,
+                       size_t *start, size_t *size) {
+  size_t pos = HUFB_HEADER_SIZE + HUFB_INDEX_ENTRY * d->nblocks;
+  if (d->offset) {
+    pos = d->offset[i];
+  } else {
+    for (size_t j = 0; j < i; j++) pos += get_le32(d->index + HUFB_INDEX_ENTRY * j);
+  }
+  *start = pos;
+  *size = get_le32(d->index + HUFB_INDEX_ENTRY * i);
+  return (pos <= in_bytes && *size <= in_bytes - pos) ? 0 : -1;
+}
+
+static codectk_err hufb_block(const hufb_dec *d, size_t in_bytes, size_t i, uint8_t *out) {
+  size_t table = get_le32(d->index + HUFB_INDEX_ENTRY * i + 4);
+  if (table > i || get_le32(d->index + HUFB_INDEX_ENTRY * table + 4) != table) {
+    return CODECTK_EINVAL;
+  }
+
+  size_t start, size, tstart, tsize;
+  if (hufb_locate(d, in_bytes, i, &start, &size) ||
+      hufb_locate(d, in_bytes, table, &tstart, &tsize)) {
+    return CODECTK_EINVAL;
+  }
+
+  uint8_t len[HUF_NSYMBOLS];
+  size_t hdr = unpack_lengths(d->in + tstart, tsize, len);
+  if (!hdr) return CODECTK_EINVAL;
+  if (table != i) hdr = 0;
+
+  size_t expect = (i + 1 < d->nblocks) ? d->block_size : d->last_size;
+  if (d->streams != 1) return decode_streams(len, d->in + start + hdr, size - hdr, out, expect);
+
+  size_t out_len = expect;
+  codectk_err err = decode_payload(len, d->in + start + hdr, size - hdr, out, &out_len);
+  if (err == CODECTK_ENOMEM || (err == CODECTK_OK && out_len != expect)) {
+    return CODECTK_EDECODE;
+  }
+  return err;
+}
+
+static codectk_err hufb_job(void *ctx, size_t i, unsigned worker) {
+  (void)worker;
+  const hufb_dec *d = (const hufb_dec*)ctx;
+  size_t in_bytes = d->offset[d->nblocks];
+  codectk_err err = hufb_block(d, in_bytes, i, d->out + i * d->block_size);
+  if (err != CODECTK_OK) CODECTK_STATS_FAILURES(HUFFMAN, 1);
+  else CODECTK_STATS_WORDS(HUFFMAN, 0, 1);
+  return err;
+}
+
+static codectk_err hufb_decode(const huffman_params *P, const uint8_t *in, size_t in_bytes,
+                               uint8_t *out, size_t *out_bits) {
+  hufb_dec d;
+  codectk_err err = hufb_parse(in, in_bytes, &d);
+  if (err != CODECTK_OK) return err;
+
+  size_t total = (d.nblocks - 1) * d.block_size + d.last_size;
+  if (total > (*out_bits) / 8) return CODECTK_ENOMEM;
+
+  /* Prefix sums of the block sizes; the last entry is the input length */
+  d.offset = (size_t*)malloc((d.nblocks + 1) * sizeof(size_t));
+  if (!d.offset) return CODECTK_ENOMEM;
+  size_t pos = HUFB_HEADER_SIZE + HUFB_INDEX_ENTRY * d.nblocks;
+  for (size_t i = 0; i < d.nblocks; i++) {
+    d.offset[i] = pos;
+    pos += get_le32(d.index + HUFB_INDEX_ENTRY * i);
+  }
+  if (pos > in_bytes) {
+    free(d.offset);
+    return CODECTK_EINVAL;
+  }
+  d.offset[d.nblocks] = in_bytes;
+  d.out = out;
+
+  err = codectk_executor_run(codectk_executor_shared(), d.nblocks, P ? P->threads : 0,
+                             hufb_job, &d);
+  free(d.offset);
+  if (err != CODECTK_OK) return err;
+
+  *out_bits = total * 8;
+  return CODECTK_OK;
+}
+
+/**
+ * Legacy HUF1 payload: rebuild the tree from the frequency table and walk
+ * it one bit at a time.
+ */
+static codectk_err huf1_decode(const uint8_t *in, size_t in_bytes,
+                               uint8_t *out, size_t *out_bits) {
+  if (in_bytes < 4 + HUF_NSYMBOLS * 4) return CODECTK_EINVAL;
 
   const uint8_t *p = in + 4;
 
@@ -342,15 +1149,17 @@ static codectk_err huf_decode(const void *pp, const uint8_t *in, size_t in_bits,
   }
 
   /* Rebuild Huffman tree */
+  CODECTK_STATS_T0(t0);
   huf_node *root = build_tree(freq);
+  CODECTK_STATS_STAGE(HUFFMAN, SETUP, t0);
   if (!root) return CODECTK_ENOMEM;
 
   /* Decode data */
   bitr_t R;
   bitr_init(&R, p, in_bytes - (4 + HUF_NSYMBOLS * 4));
 
-  bitw_t W;
-  bitw_init(&W, out, (*out_bits) / 8);
+  uint8_t *op = out;
+  uint8_t *op_end = out + (*out_bits) / 8;
 
   huf_node *node = root;
   int done = 0;
@@ -378,11 +1187,11 @@ static codectk_err huf_decode(const void *pp, const uint8_t *in, size_t in_bits,
         done = 1;
       } else {
         /* Write complete byte to output */
-        if (W.p >= W.end) {
+        if (op >= op_end) {
           free_tree(root);
           return CODECTK_ENOMEM;
         }
-        *W.p++ = (uint8_t)node->symbol;
+        *op++ = (uint8_t)node->symbol;
       }
 
       node = root; /* Reset to root for next symbol */
@@ -390,12 +1199,41 @@ static codectk_err huf_decode(const void *pp, const uint8_t *in, size_t in_bits,
   }
 
   /* Output is complete bytes, no need to flush */
-  *out_bits = ((size_t)(W.p - out)) * 8;
+  *out_bits = ((size_t)(op - out)) * 8;
 
   free_tree(root);
   return CODECTK_OK;
 }
 
+static codectk_err huf_decode(const void *pp, const uint8_t *in, size_t in_bits,
+                                uint8_t *out, size_t *out_bits, size_t *corr) {
+  (void)corr; /* No error correction in Huffman */
+  CODECTK_STATS_CALL(HUFFMAN);
+
+  size_t in_bytes = (in_bits + 7) / 8;
+  if (!out_bits || in_bytes < 4 || in[0] != 'H' || in[1] != 'U' || in[2] != 'F') {
+    return CODECTK_EINVAL;
+  }
+
+  /* HUFB blocks are counted by the tasks that decode them */
+  codectk_err err;
+  switch (in[3]) {
+    case 'B':
+      return hufb_decode((const huffman_params*)pp, in, in_bytes, out, out_bits);
+    case '2':
+      err = huf2_decode(in, in_bytes, out, out_bits);
+      break;
+    case '1':
+      err = huf1_decode(in, in_bytes, out, out_bits);
+      break;
+    default:
+      return CODECTK_EINVAL;
+  }
+  if (err != CODECTK_OK) CODECTK_STATS_FAILURES(HUFFMAN, 1);
+  else CODECTK_STATS_WORDS(HUFFMAN, 0, 1);
+  return err;
+}
+
 static const codectk_codec HUF = {
   .name = "huffman",
   .encode = huf_encode,
@@ -405,3 +1243,37 @@ static const codectk_codec HUF = {
 const codectk_codec* huffman_codec(void) {
   return &HUF;
 }
+
+codectk_err huffman_block_info(const uint8_t *in, size_t in_bits,
+                               size_t *nblocks, size_t *block_size) {
+  size_t in_bytes = (in_bits + 7) / 8;
+  if (!in || !nblocks || in_bytes < 4 || memcmp(in, "HUFB", 4) != 0) return CODECTK_EINVAL;
+
+  hufb_dec d;
+  codectk_err err = hufb_parse(in, in_bytes, &d);
+  if (err != CODECTK_OK) return err;
+
+  *nblocks = d.nblocks;
+  if (block_size) *block_size = d.block_size;
+  return CODECTK_OK;
+}
+
+codectk_err huffman_decode_block(const uint8_t *in, size_t in_bits, size_t index,
+                                 uint8_t *out, size_t *out_bits) {
+  size_t in_bytes = (in_bits + 7) / 8;
+  if (!in || !out_bits || in_bytes < 4 || memcmp(in, "HUFB", 4) != 0) return CODECTK_EINVAL;
+
+  hufb_dec d;
+  codectk_err err = hufb_parse(in, in_bytes, &d);
+  if (err != CODECTK_OK) return err;
+  if (index >= d.nblocks) return CODECTK_EINVAL;
+
+  size_t expect = (index + 1 < d.nblocks) ? d.block_size : d.last_size;
+  if (expect > (*out_bits) / 8) return CODECTK_ENOMEM;
+
+  err = hufb_block(&d, in_bytes, index, out);
+  if (err != CODECTK_OK) return err;
+
+  *out_bits = expect * 8;
+  return CODECTK_OK;
+}
@@ -0,0 +1,428 @@
+/**
+ * pipeline.c - Chains of codecs over bounded, reusable tile buffers
+ *
+ * The input is cut into tiles that travel through every stage on their
+ * own: each tile owns two ping-pong buffers, and stage k reads the one
+ * stage k-1 wrote. A fixed pool of tiles bounds the memory of a run no
+ * matter how long the input is.
+ *
+ * Fused mode runs all stages over one tile, then the next. Threaded mode
+ * gives every stage a thread; tiles move on through one SPSC ring per
+ * stage boundary, and the calling thread feeds the first ring and collects
+ * from the last. The rings hold as many slots as there are tiles, so a
+ * push never has to wait.
+ */
+
+#include "../include/pipeline.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PL_TILES (CODECTK_PIPELINE_MAX_STAGES + 2) /* one per stage, feeder, collector */
+#define PL_RING 16                              /* > PL_TILES, power of two */
+#define PL_MAX_BUFFER ((size_t)1 << 31)         /* largest tile buffer */
+
+typedef struct {
+  const uint8_t *src;      /* input of the first step */
+  size_t bits[CODECTK_PIPELINE_MAX_STAGES + 1]; /* stage k reads bits[k], writes bits[k+1] */
+  uint8_t *buf[2];
+  size_t cap[2];
+  int last;                /* buffer holding the latest output, -1 = src */
+  size_t corrected;
+  codectk_err err;
+} pl_tile;
+
+typedef struct {
+  pl_tile *slot[PL_RING];  /* NULL ends the run */
+  size_t head, tail;
+  pthread_mutex_t mu;
+  pthread_cond_t cv;
+} pl_ring;
+
+typedef struct {
+  codectk_pipeline *p;
+  size_t step;
+  int decode;
+} pl_worker;
+
+struct codectk_pipeline {
+  codectk_stage stage[CODECTK_PIPELINE_MAX_STAGES];
+  size_t nstages;
+  size_t tile_bytes;
+  codectk_pipeline_mode mode;
+  pl_tile tile[PL_TILES];
+  pl_ring ring[CODECTK_PIPELINE_MAX_STAGES + 1];
+  pl_worker worker[CODECTK_PIPELINE_MAX_STAGES];
+};
+
+/* One run of encode or decode: where the feeder and collector are */
+typedef struct {
+  codectk_pipeline *p;
+  int decode;
+  const uint8_t *in;
+  size_t in_bits;
+  size_t in_pos;           /* next tile (encode) or byte offset (decode) */
+  uint8_t *out;
+  size_t out_cap;          /* bytes */
+  size_t out_pos;          /* bits */
+  size_t corrected;
+  codectk_err err;         /* first error */
+  int stop;                /* no more tiles after an unrecoverable error */
+} pl_job;
+
+/* SPSC ring */
+
+static void ring_push(pl_ring *r, pl_tile *t) {
+  pthread_mutex_lock(&r->mu);
+  r->slot[r->head++ & (PL_RING - 1)] = t;
+  pthread_cond_signal(&r->cv);
+  pthread_mutex_unlock(&r->mu);
+}
+
+static pl_tile *ring_pop(pl_ring *r) {
+  pthread_mutex_lock(&r->mu);
+  while (r->tail == r->head) {
+    pthread_cond_wait(&r->cv, &r->mu);
+  }
+  pl_tile *t = r->slot[r->tail++ & (PL_RING - 1)];
+  pthread_mutex_unlock(&r->mu);
+  return t;
+}
+
+/* Steps */
+
+/* Make buffer b hold at least bytes; its contents are not kept */
+static codectk_err tile_reserve(pl_tile *t, int b, size_t bytes) {
+  if (bytes <= t->cap[b]) return CODECTK_OK;
+  if (bytes > PL_MAX_BUFFER) return CODECTK_ENOMEM;
+
+  free(t->buf[b]);
+  t->buf[b] = (uint8_t*)malloc(bytes);
+  t->cap[b] = t->buf[b] ? bytes : 0;
+  return t->buf[b] ? CODECTK_OK : CODECTK_ENOMEM;
+}
+
+static inline void set_err(pl_job *job, codectk_err err) {
+  if (job->err == CODECTK_OK) job->err = err;
+}
+
+/**
+ * Step `step` of a tile: stage step when encoding, stage nstages-1-step
+ * when decoding. Output the codec cannot fit grows the buffer and retries.
+ */
+static void run_step(const codectk_pipeline *p, pl_tile *t, size_t step, int decode) {
+  if (t->err != CODECTK_OK) return;
+
+  size_t s = decode ? p->nstages - 1 - step : step;
+  const codectk_stage *st = &p->stage[s];
+  const uint8_t *in = t->last < 0 ? t->src : t->buf[t->last];
+  size_t in_bits = decode ? t->bits[s + 1] : t->bits[s];
+  int b = t->last < 0 ? 0 : !t->last;
+
+  /* Encoders rarely more than double; decoders give back at most bits[s] or their input */
+  size_t need = decode ? ((t->bits[s] > in_bits ? t->bits[s] : in_bits) + 7) / 8 + 64
+                       : 2 * ((in_bits + 7) / 8) + 64;
+  codectk_err err = tile_reserve(t, b, need);
+
+  size_t out_bits = 0, corr = 0;
+  while (err == CODECTK_OK) {
+    out_bits = t->cap[b] * 8;
+    corr = 0;
+    err = decode ? st->codec->decode(st->params, in, in_bits, t->buf[b], &out_bits, &corr)
+                 : st->codec->encode(st->params, in, in_bits, t->buf[b], &out_bits);
+    if (err != CODECTK_ENOMEM || t->cap[b] >= PL_MAX_BUFFER) break;
+    err = tile_reserve(t, b, 2 * t->cap[b]);
+  }
+  t->corrected += corr;
+
+  if (err == CODECTK_OK) {
+    if (decode && out_bits < t->bits[s]) {
+      err = CODECTK_EDECODE;
+    } else if (!decode && out_bits > UINT32_MAX) {
+      err = CODECTK_EINVAL;
+    }
+  }
+  if (err != CODECTK_OK) {
+    t->err = err;
+    return;
+  }
+
+  if (!decode) t->bits[s + 1] = out_bits;
+  t->last = b;
+}
+
+static void *worker_main(void *arg) {
+  pl_worker *w = (pl_worker*)arg;
+  codectk_pipeline *p = w->p;
+
+  for (;;) {
+    pl_tile *t = ring_pop(&p->ring[w->step]);
+    if (t) run_step(p, t, w->step, w->decode);
+    ring_push(&p->ring[w->step + 1], t);
+    if (!t) break;
+  }
+  return NULL;
+}
+
+/* Feed and collect */
+
+static inline void put_le32(uint8_t *p, size_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static inline size_t get_le32(const uint8_t *p) {
+  return (size_t)p[0] | ((size_t)p[1] << 8) | ((size_t)p[2] << 16) | ((size_t)p[3] << 24);
+}
+
+/* Set up the next tile of input in t; 0 when there is none */
+static int feed(pl_job *job, pl_tile *t) {
+  const codectk_pipeline *p = job->p;
+  if (job->stop) return 0;
+
+  t->last = -1;
+  t->corrected = 0;
+  t->err = CODECTK_OK;
+
+  if (!job->decode) {
+    size_t tile_bits = p->tile_bytes * 8;
+    size_t start = job->in_pos * tile_bits;
+    if (start >= job->in_bits) return 0;
+    t->src = job->in + job->in_pos * p->tile_bytes;
+    t->bits[0] = job->in_bits - start < tile_bits ? job->in_bits - start : tile_bits;
+    job->in_pos++;
+    return 1;
+  }
+
+  size_t in_bytes = job->in_bits / 8;
+  size_t hdr = 4 * (p->nstages + 1);
+  if (job->in_pos >= in_bytes) return 0;
+  if (in_bytes - job->in_pos < hdr) {
+    set_err(job, CODECTK_EINVAL);
+    job->stop = 1;
+    return 0;
+  }
+
+  const uint8_t *h = job->in + job->in_pos;
+  for (size_t k = 0; k <= p->nstages; k++) {
+    t->bits[k] = get_le32(h + 4 * k);
+  }
+  size_t coded = (t->bits[p->nstages] + 7) / 8;
+  if (in_bytes - job->in_pos - hdr < coded) {
+    set_err(job, CODECTK_EINVAL);
+    job->stop = 1;
+    return 0;
+  }
+  t->src = h + hdr;
+  job->in_pos += hdr + coded;
+  return 1;
+}
+
+/* Append a finished tile to the output */
+static void collect(pl_job *job, const pl_tile *t) {
+  const codectk_pipeline *p = job->p;
+  size_t pos = job->out_pos / 8;
+
+  if (!job->decode) {
+    if (t->err != CODECTK_OK) {
+      set_err(job, t->err);
+      job->stop = 1;
+      return;
+    }
+    size_t hdr = 4 * (p->nstages + 1);
+    size_t coded = (t->bits[p->nstages] + 7) / 8;
+    if (job->stop || job->out_cap - pos < hdr + coded) {
+      set_err(job, CODECTK_ENOMEM);
+      job->stop = 1;
+      return;
+    }
+    for (size_t k = 0; k <= p->nstages; k++) {
+      put_le32(job->out + pos + 4 * k, t->bits[k]);
+    }
+    memcpy(job->out + pos + hdr, t->buf[t->last], coded);
+    job->out_pos += (hdr + coded) * 8;
+    return;
+  }
+
+  /* Only the last tile may end inside a byte */
+  size_t bytes = (t->bits[0] + 7) / 8;
+  if (job->out_pos % 8) {
+    set_err(job, CODECTK_EINVAL);
+    job->stop = 1;
+    return;
+  }
+  if (job->out_cap - pos < bytes) {
+    set_err(job, CODECTK_ENOMEM);
+    job->stop = 1;
+    return;
+  }
+
+  if (t->err != CODECTK_OK) {
+    set_err(job, t->err);
+    memset(job->out + pos, 0, bytes);
+  } else {
+    memcpy(job->out + pos, t->buf[t->last], bytes);
+  }
+  job->corrected += t->corrected;
+  job->out_pos += t->bits[0];
+}
+
+/* Drivers */
+
+static void run_fused(pl_job *job) {
+  codectk_pipeline *p = job->p;
+  pl_tile *t = &p->tile[0];
+
+  while (feed(job, t)) {
+    for (size_t k = 0; k < p->nstages; k++) {
+      run_step(p, t, k, job->decode);
+    }
+    collect(job, t);
+  }
+}
+
+/* Returns -1, having run nothing, if the stage threads cannot start */
+static int run_threaded(pl_job *job) {
+  codectk_pipeline *p = job->p;
+  size_t n = p->nstages;
+  pthread_t tid[CODECTK_PIPELINE_MAX_STAGES];
+
+  for (size_t k = 0; k <= n; k++) {
+    p->ring[k].head = p->ring[k].tail = 0;
+  }
+
+  size_t started = 0;
+  for (; started < n; started++) {
+    p->worker[started].p = p;
+    p->worker[started].step = started;
+    p->worker[started].decode = job->decode;
+    if (pthread_create(&tid[started], NULL, worker_main, &p->worker[started]) != 0) break;
+  }
+  if (started < n) {
+    /* The end marker stops the threads that did start at ring `started` */
+    ring_push(&p->ring[0], NULL);
+    while (ring_pop(&p->ring[started]) != NULL) {
+    }
+    for (size_t k = 0; k < started; k++) {
+      pthread_join(tid[k], NULL);
+    }
+    return -1;
+  }
+
+  pl_tile *free_tiles[PL_TILES];
+  size_t nfree = 0;
+  for (size_t i = 0; i < PL_TILES; i++) {
+    free_tiles[nfree++] = &p->tile[i];
+  }
+
+  for (;;) {
+    pl_tile *t;
+    if (nfree) {
+      t = free_tiles[--nfree];
+    } else {
+      t = ring_pop(&p->ring[n]);
+      collect(job, t);
+    }
+    if (!feed(job, t)) break;
+    ring_push(&p->ring[0], t);
+  }
+
+  ring_push(&p->ring[0], NULL);
+  for (pl_tile *t; (t = ring_pop(&p->ring[n])) != NULL;) {
+    collect(job, t);
+  }
+  for (size_t k = 0; k < n; k++) {
+    pthread_join(tid[k], NULL);
+  }
+  return 0;
+}
+
+static codectk_err run(codectk_pipeline *p, int decode, const uint8_t *in, size_t in_bits,
+                       uint8_t *out, size_t *out_bits, size_t *num_corrected) {
+  if (!p || (!in && in_bits) || !out_bits || (!out && *out_bits)) return CODECTK_EINVAL;
+
+  pl_job job;
+  memset(&job, 0, sizeof(job));
+  job.p = p;
+  job.decode = decode;
+  job.in = in;
+  job.in_bits = in_bits;
+  job.out = out;
+  job.out_cap = *out_bits / 8;
+
+  if (p->mode != CODECTK_PIPELINE_THREADED || p->nstages < 2 || run_threaded(&job) != 0) {
+    run_fused(&job);
+  }
+
+  if (num_corrected) *num_corrected = job.corrected;
+  if (job.err == CODECTK_OK || job.err == CODECTK_EDECODE) *out_bits = job.out_pos;
+  return job.err;
+}
+
+/* Public API */
+
+codectk_err codectk_pipeline_create(const codectk_stage *stages, size_t nstages,
+                                    size_t tile_bytes, codectk_pipeline_mode mode,
+                                    codectk_pipeline **out) {
+  if (!stages || !out || nstages == 0 || nstages > CODECTK_PIPELINE_MAX_STAGES) {
+    return CODECTK_EINVAL;
+  }
+  if (tile_bytes == 0) tile_bytes = CODECTK_PIPELINE_DEFAULT_TILE;
+  /* Tile bit counts go out as LE32 */
+  if (tile_bytes > UINT32_MAX / 8) return CODECTK_EINVAL;
+  for (size_t k = 0; k < nstages; k++) {
+    if (!stages[k].codec) return CODECTK_EINVAL;
+  }
+
+  codectk_pipeline *p = (codectk_pipeline*)calloc(1, sizeof(codectk_pipeline));
+  if (!p) return CODECTK_ENOMEM;
+
+  memcpy(p->stage, stages, nstages * sizeof(codectk_stage));
+  p->nstages = nstages;
+  p->tile_bytes = tile_bytes;
+  p->mode = mode;
+
+  for (size_t k = 0; k <= CODECTK_PIPELINE_MAX_STAGES; k++) {
+    pthread_mutex_init(&p->ring[k].mu, NULL);
+    pthread_cond_init(&p->ring[k].cv, NULL);
+  }
+
+  /* First buffers sized for the common case; run_step() grows them */
+  size_t ntiles = mode == CODECTK_PIPELINE_THREADED ? PL_TILES : 1;
+  for (size_t i = 0; i < ntiles; i++) {
+    if (tile_reserve(&p->tile[i], 0, 2 * tile_bytes + 64) != CODECTK_OK ||
+        tile_reserve(&p->tile[i], 1, 2 * tile_bytes + 64) != CODECTK_OK) {
+      codectk_pipeline_destroy(p);
+      return CODECTK_ENOMEM;
+    }
+  }
+
+  *out = p;
+  return CODECTK_OK;
+}
+
+void codectk_pipeline_destroy(codectk_pipeline *p) {
+  if (!p) return;
+
+  for (size_t i = 0; i < PL_TILES; i++) {
+    free(p->tile[i].buf[0]);
+    free(p->tile[i].buf[1]);
+  }
+  for (size_t k = 0; k <= CODECTK_PIPELINE_MAX_STAGES; k++) {
+    pthread_mutex_destroy(&p->ring[k].mu);
+    pthread_cond_destroy(&p->ring[k].cv);
+  }
+  free(p);
+}
+
+codectk_err codectk_pipeline_encode(codectk_pipeline *p,
+                                    const uint8_t *in, size_t in_bits,
+                                    uint8_t *out, size_t *out_bits) {
+  return run(p, 0, in, in_bits, out, out_bits, NULL);
+}
+
+codectk_err codectk_pipeline_decode(codectk_pipeline *p,
+                                    const uint8_t *in, size_t in_bits,
+                                    uint8_t *out, size_t *out_bits,
+                                    size_t *num_corrected) {
+  return run(p, 1, in, in_bits, out, out_bits, num_corrected);
+}
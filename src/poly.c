@@ -14,29 +14,59 @@
  * ============================================================================
  * GF(2) Polynomial Implementation
  * ============================================================================
+ *
+ * Everything works on whole 64-bit words: add is a word XOR, division
+ * subtracts a word-shifted divisor, and multiplication runs Karatsuba down
+ * to gf2m_clmul_words() (PCLMULQDQ / PMULL when the CPU has it). Bits at
+ * and above capacity are kept zero so that word loops need no masking.
  */
 
-/* Helper: compute actual degree by finding highest nonzero coefficient */
-static void poly_gf2_update_degree(poly_gf2_t *p) {
-  int d = p->capacity - 1;
-  while (d >= 0) {
-    int word_idx = d / 64;
-    int bit_idx = d % 64;
-    if (p->coeff[word_idx] & (1ULL << bit_idx)) {
-      break;
+/* Below this many words per operand, Karatsuba splits cost more than they save */
+#define KARATSUBA_WORDS 16
+
+/*
+ * gcd reduces a mod b with Barrett when both the quotient and b are this
+ * long; long division costs one pass over b per quotient bit
+ */
+#define BARRETT_MIN_QUOT 256
+#define BARRETT_MIN_DIVISOR 512
+
+static inline size_t gf2_words(int bits) {
+  return bits > 0 ? (size_t)(bits + 63) / 64 : 0;
+}
+
+/* Helper: degree of p, knowing that no bit above top is set */
+static void poly_gf2_degree_from(poly_gf2_t *p, int top) {
+  if (top >= p->capacity) top = p->capacity - 1;
+  for (int w = top < 0 ? -1 : top / 64; w >= 0; w--) {
+    if (p->coeff[w]) {
+      p->deg = w * 64 + 63 - __builtin_clzll(p->coeff[w]);
+      return;
     }
-    d--;
   }
-  p->deg = d;
+  p->deg = -1;
+}
+
+/* Clear the bits of the top word at and above capacity */
+static void poly_gf2_mask_top(poly_gf2_t *p) {
+  if (p->capacity % 64) {
+    p->coeff[p->capacity / 64] &= (1ULL << (p->capacity % 64)) - 1;
+  }
 }
 
 int poly_gf2_init(poly_gf2_t *p, int capacity) {
+  return poly_gf2_init_ws(p, capacity, NULL);
+}
+
+int poly_gf2_init_ws(poly_gf2_t *p, int capacity, codectk_arena *ws) {
   if (!p || capacity < 0) return -1;
 
   p->capacity = capacity;
   p->deg = -1;
-  int n_words = (capacity + 63) / 64;
-  p->coeff = (uint64_t*)calloc((size_t)n_words, sizeof(uint64_t));
+  size_t n_words = gf2_words(capacity);
+  p->coeff = (uint64_t*)codectk_arena_calloc(ws, n_words * sizeof(uint64_t));
+  p->borrowed = p->coeff != NULL;
+  if (!p->coeff) p->coeff = (uint64_t*)calloc(n_words ? n_words : 1, sizeof(uint64_t));
 
   if (!p->coeff) {
     p->capacity = 0;
@@ -46,9 +76,14 @@ int poly_gf2_init(poly_gf2_t *p, int capacity) {
   return 0;
 }
 
+size_t poly_gf2_scratch_size(int count, int capacity) {
+  if (count <= 0 || capacity < 0) return 0;
+  return (size_t)count * codectk_arena_round(gf2_words(capacity) * sizeof(uint64_t));
+}
+
 void poly_gf2_free(poly_gf2_t *p) {
   if (p && p->coeff) {
-    free(p->coeff);
+    if (!p->borrowed) free(p->coeff);
     p->coeff = NULL;
     p->capacity = 0;
     p->deg = -1;
@@ -57,8 +92,7 @@ void poly_gf2_free(poly_gf2_t *p) {
 
 void poly_gf2_zero(poly_gf2_t *p) {
   if (!p) return;
-  int n_words = (p->capacity + 63) / 64;
-  memset(p->coeff, 0, (size_t)n_words * sizeof(uint64_t));
+  memset(p->coeff, 0, gf2_words(p->capacity) * sizeof(uint64_t));
   p->deg = -1;
 }
 
@@ -78,7 +112,7 @@ void poly_gf2_set_coeff(poly_gf2_t *p, int i, int value) {
   if (value && i > p->deg) {
     p->deg = i;
   } else if (!value && i == p->deg) {
-    poly_gf2_update_degree(p);
+    poly_gf2_degree_from(p, i);
   }
 }
 
@@ -91,50 +125,174 @@ int poly_gf2_get_coeff(const poly_gf2_t *p, int i) {
 }
 
 void poly_gf2_copy(poly_gf2_t *dst, const poly_gf2_t *src) {
-  if (!dst || !src) return;
+  if (!dst || !src || dst == src) return;
 
-  poly_gf2_zero(dst);
-  int max_deg = (src->deg < dst->capacity) ? src->deg : (dst->capacity - 1);
+  size_t dw = gf2_words(dst->capacity);
+  size_t sw = gf2_words(src->deg + 1);
+  size_t n = sw < dw ? sw : dw;
 
-  for (int i = 0; i <= max_deg; i++) {
-    if (poly_gf2_get_coeff(src, i)) {
-      poly_gf2_set_coeff(dst, i, 1);
-    }
-  }
+  memmove(dst->coeff, src->coeff, n * sizeof(uint64_t));
+  memset(dst->coeff + n, 0, (dw - n) * sizeof(uint64_t));
+  if (n == dw && dw) poly_gf2_mask_top(dst);
+  poly_gf2_degree_from(dst, src->deg);
 }
 
 void poly_gf2_add(poly_gf2_t *result, const poly_gf2_t *a, const poly_gf2_t *b) {
   if (!result || !a || !b) return;
 
-  poly_gf2_zero(result);
-  int max_deg = (a->deg > b->deg) ? a->deg : b->deg;
+  size_t rw = gf2_words(result->capacity);
+  size_t aw = gf2_words(a->deg + 1), bw = gf2_words(b->deg + 1);
 
-  for (int i = 0; i <= max_deg && i < result->capacity; i++) {
-    int ca = poly_gf2_get_coeff(a, i);
-    int cb = poly_gf2_get_coeff(b, i);
-    poly_gf2_set_coeff(result, i, ca ^ cb);
+  /* Word by word, so result may alias a or b */
+  for (size_t w = 0; w < rw; w++) {
+    uint64_t x = (w < aw) ? a->coeff[w] : 0;
+    uint64_t y = (w < bw) ? b->coeff[w] : 0;
+    result->coeff[w] = x ^ y;
   }
+  if (rw) poly_gf2_mask_top(result);
+  poly_gf2_degree_from(result, a->deg > b->deg ? a->deg : b->deg);
+}
+
+/*
+ * Word-level multiplication: dst[0..na+nb) = a * b, with tmp holding
+ * mul_scratch_words(na, nb) words. Equal halves go through Karatsuba
+ * (three half-size products instead of four); a long a against a short b
+ * is cut into b-sized pieces.
+ */
+static size_t mul_scratch_words(size_t na, size_t nb);
+
+static void mul_words(uint64_t *dst, const uint64_t *a, size_t na,
+                      const uint64_t *b, size_t nb, uint64_t *tmp);
+
+static size_t kara_scratch_words(size_t n) {
+  size_t hh = n - n / 2;
+  return 4 * hh + mul_scratch_words(hh, hh);
+}
+
+static size_t mul_scratch_words(size_t na, size_t nb) {
+  if (nb > na) {
+    size_t t = na;
+    na = nb;
+    nb = t;
+  }
+  if (nb < KARATSUBA_WORDS) return 0;
+  if (na == nb) return kara_scratch_words(na);
+
+  /* The pieces: a full nb x nb product, or a shorter final piece */
+  size_t tail = na % nb;
+  size_t full = mul_scratch_words(nb, nb);
+  size_t part = tail ? mul_scratch_words(nb, tail) : 0;
+  return 2 * nb + (full > part ? full : part);
+}
+
+static void karatsuba(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t n,
+                      uint64_t *tmp) {
+  size_t h = n / 2, hh = n - h;
+  uint64_t *sa = tmp, *sb = tmp + hh, *mid = tmp + 2 * hh;
+
+  /* a0*b0 and a1*b1 straight into the two halves of dst */
+  mul_words(dst, a, h, b, h, tmp);
+  mul_words(dst + 2 * h, a + h, hh, b + h, hh, tmp);
+
+  /* (a0 + a1)(b0 + b1) - a0*b0 - a1*b1 goes in the middle */
+  for (size_t i = 0; i < hh; i++) {
+    sa[i] = a[h + i] ^ (i < h ? a[i] : 0);
+    sb[i] = b[h + i] ^ (i < h ? b[i] : 0);
+  }
+  mul_words(mid, sa, hh, sb, hh, tmp + 4 * hh);
+  for (size_t i = 0; i < 2 * h; i++) mid[i] ^= dst[i];
+  for (size_t i = 0; i < 2 * hh; i++) mid[i] ^= dst[2 * h + i];
+  for (size_t i = 0; i < 2 * hh; i++) dst[h + i] ^= mid[i];
+}
+
+static void mul_words(uint64_t *dst, const uint64_t *a, size_t na,
+                      const uint64_t *b, size_t nb, uint64_t *tmp) {
+  if (nb > na) {
+    const uint64_t *t = a;
+    a = b;
+    b = t;
+    size_t tn = na;
+    na = nb;
+    nb = tn;
+  }
+
+  if (nb < KARATSUBA_WORDS) {
+    gf2m_clmul_words(dst, a, na, b, nb);
+    return;
+  }
+  if (na == nb) {
+    karatsuba(dst, a, b, na, tmp);
+    return;
+  }
+
+  uint64_t *piece = tmp;
+  memset(dst, 0, (na + nb) * sizeof(uint64_t));
+  for (size_t i = 0; i < na; i += nb) {
+    size_t len = (na - i < nb) ? na - i : nb;
+    mul_words(piece, a + i, len, b, nb, tmp + 2 * nb);
+    for (size_t w = 0; w < len + nb; w++) dst[i + w] ^= piece[w];
+  }
+}
+
+size_t poly_gf2_mul_scratch_size(int a_capacity, int b_capacity) {
+  if (a_capacity < 0 || b_capacity < 0) return 0;
+  size_t na = gf2_words(a_capacity), nb = gf2_words(b_capacity);
+  size_t words = na + nb + mul_scratch_words(na, nb);
+  return codectk_arena_round(words * sizeof(uint64_t));
 }
 
 void poly_gf2_mul(poly_gf2_t *result, const poly_gf2_t *a, const poly_gf2_t *b) {
-  if (!result || !a || !b) return;
+  poly_gf2_mul_ws(result, a, b, NULL);
+}
+
+int poly_gf2_mul_ws(poly_gf2_t *result, const poly_gf2_t *a, const poly_gf2_t *b,
+                    codectk_arena *ws) {
+  if (!result || !a || !b) return -1;
 
   poly_gf2_zero(result);
+  if (a->deg < 0 || b->deg < 0) return 0;
+
+  size_t na = gf2_words(a->deg + 1), nb = gf2_words(b->deg + 1);
+  size_t rw = gf2_words(result->capacity);
+
+  /* The full product goes straight into result when it fits */
+  size_t words = mul_scratch_words(na, nb) + (na + nb > rw ? na + nb : 0);
+  size_t mark = codectk_arena_mark(ws);
+  uint64_t *heap = NULL;
+  uint64_t *tmp = (uint64_t*)codectk_arena_alloc(ws, words * sizeof(uint64_t));
+  if (!tmp && words) {
+    tmp = heap = (uint64_t*)malloc(words * sizeof(uint64_t));
+    if (!tmp) return -1;
+  }
 
-  /* Simple schoolbook multiplication.
-   * Optimization note: for large polynomials, consider Karatsuba or FFT methods. */
-  for (int i = 0; i <= a->deg && i < a->capacity; i++) {
-    if (!poly_gf2_get_coeff(a, i)) continue;
+  if (na + nb <= rw) {
+    mul_words(result->coeff, a->coeff, na, b->coeff, nb, tmp);
+  } else {
+    uint64_t *prod = tmp + (words - (na + nb));
+    mul_words(prod, a->coeff, na, b->coeff, nb, tmp);
+    memcpy(result->coeff, prod, rw * sizeof(uint64_t));
+  }
+  if (rw) poly_gf2_mask_top(result);
+  poly_gf2_degree_from(result, a->deg + b->deg);
+
+  free(heap);
+  codectk_arena_release(ws, mark);
+  return 0;
+}
 
-    for (int j = 0; j <= b->deg && j < b->capacity; j++) {
-      if (!poly_gf2_get_coeff(b, j)) continue;
+/* r ^= b * x^shift, for the words of r below r_words */
+static void xor_shifted(uint64_t *r, size_t r_words, const uint64_t *b, size_t b_words,
+                        int shift) {
+  size_t ws = (size_t)shift / 64;
+  unsigned bs = (unsigned)shift % 64;
 
-      int k = i + j;
-      if (k < result->capacity) {
-        int old_val = poly_gf2_get_coeff(result, k);
-        poly_gf2_set_coeff(result, k, old_val ^ 1);
-      }
-    }
+  if (bs == 0) {
+    for (size_t i = 0; i < b_words && i + ws < r_words; i++) r[i + ws] ^= b[i];
+    return;
+  }
+  for (size_t i = 0; i < b_words && i + ws < r_words; i++) {
+    r[i + ws] ^= b[i] << bs;
+    if (i + ws + 1 < r_words) r[i + ws + 1] ^= b[i] >> (64 - bs);
   }
 }
 
@@ -145,57 +303,218 @@ int poly_gf2_div_rem(poly_gf2_t *q, poly_gf2_t *r,
   poly_gf2_zero(q);
   poly_gf2_copy(r, a);
 
-#ifdef DEBUG_POLY_DIV
-  fprintf(stderr, "DIV: a.deg=%d, b.deg=%d, r.deg=%d\n", a->deg, b->deg, r->deg);
-#endif
+  size_t r_words = gf2_words(r->capacity);
+  size_t b_words = gf2_words(b->deg + 1);
 
-  int iter = 0;
+  /* Each step cancels the leading term of r with b shifted underneath it */
   while (r->deg >= b->deg) {
     int shift = r->deg - b->deg;
+    xor_shifted(r->coeff, r_words, b->coeff, b_words, shift);
 
-#ifdef DEBUG_POLY_DIV
-    fprintf(stderr, "  Iter %d: r.deg=%d, shift=%d\n", iter++, r->deg, shift);
-#endif
+    /* Set quotient bit */
+    if (shift < q->capacity) {
+      q->coeff[shift / 64] |= 1ULL << (shift % 64);
+      if (shift > q->deg) q->deg = shift;
+    }
+
+    poly_gf2_degree_from(r, r->deg - 1);
+  }
 
-    /* Subtract b shifted by 'shift' from r */
-    for (int i = 0; i <= b->deg; i++) {
-      if (poly_gf2_get_coeff(b, i)) {
-        int pos = i + shift;
-        int old_val = poly_gf2_get_coeff(r, pos);
-        poly_gf2_set_coeff(r, pos, old_val ^ 1);
+  return 0;
+}
+
+/*
+ * Barrett reduction by a fixed modulus
+ * ----------------------------------------------------------------------------
+ * With d = deg m and mu = floor(x^N / m), the quotient of any a of degree
+ * at most N is floor(floor(a / x^d) * mu / x^(N-d)), exactly: the error
+ * term has negative degree. A reduction is then two multiplications, both
+ * on the Karatsuba path, instead of one shift-XOR per quotient bit.
+ */
+
+/* dst = floor(src / x^shift), dst having dst_words words */
+static void shr_words(uint64_t *dst, size_t dst_words, const uint64_t *src, size_t src_words,
+                      int shift) {
+  size_t ws = (size_t)shift / 64;
+  unsigned bs = (unsigned)shift % 64;
+
+  for (size_t i = 0; i < dst_words; i++) {
+    uint64_t lo = (i + ws < src_words) ? src[i + ws] : 0;
+    uint64_t hi = (i + ws + 1 < src_words) ? src[i + ws + 1] : 0;
+    dst[i] = bs ? (lo >> bs) | (hi << (64 - bs)) : lo;
+  }
+}
+
+/* dst_i = src_(n-1-i) for i < n */
+static void gf2_reverse(poly_gf2_t *dst, const poly_gf2_t *src, int n) {
+  poly_gf2_zero(dst);
+  for (int i = 0; i < n; i++) {
+    if (poly_gf2_get_coeff(src, n - 1 - i)) poly_gf2_set_coeff(dst, i, 1);
+  }
+}
+
+/*
+ * mu = floor(x^N / m) in O(M(N)) by Newton iteration on the reversed
+ * modulus: with d = deg m, rev(mu) = rev(m)^-1 mod x^(N-d+1). Over GF(2)
+ * the lift of an inverse g mod x^j is f * g^2 mod x^2j, since
+ * f * f g^2 = (f g)^2 and squaring doubles the agreement with 1.
+ */
+static int barrett_mu(poly_gf2_t *mu, const poly_gf2_t *m, int max_deg) {
+  int d = m->deg, len = max_deg - d + 1;
+  poly_gf2_t f, sq, g;
+  int ok = poly_gf2_init(&f, len) == 0;
+  ok = poly_gf2_init(&sq, 2 * len) == 0 && ok;
+  ok = poly_gf2_init(&g, len) == 0 && ok;
+
+  if (ok) {
+    /* f = rev(m) mod x^len; f(0) = 1 */
+    for (int i = 0; i < len && i <= d; i++) {
+      if (poly_gf2_get_coeff(m, d - i)) poly_gf2_set_coeff(&f, i, 1);
+    }
+    poly_gf2_set_coeff(&g, 0, 1);
+
+    for (int j = 1; j < len && ok;) {
+      int j2 = (2 * j < len) ? 2 * j : len;
+      poly_gf2_zero(&sq);
+      for (int i = 0; i <= g.deg; i++) {
+        if (poly_gf2_get_coeff(&g, i)) poly_gf2_set_coeff(&sq, 2 * i, 1);
+      }
+
+      /* g = (f mod x^j2) * g^2 mod x^j2; the capacities do the truncation */
+      poly_gf2_t ft, next;
+      ok = poly_gf2_init(&ft, j2) == 0;
+      ok = poly_gf2_init(&next, j2) == 0 && ok;
+      if (ok) {
+        poly_gf2_copy(&ft, &f);
+        ok = poly_gf2_mul_ws(&next, &ft, &sq, NULL) == 0;
+        poly_gf2_copy(&g, &next);
       }
+      poly_gf2_free(&ft);
+      poly_gf2_free(&next);
+      j = j2;
     }
+  }
+  if (ok) gf2_reverse(mu, &g, len);
 
-    /* Set quotient bit */
-    poly_gf2_set_coeff(q, shift, 1);
+  poly_gf2_free(&f);
+  poly_gf2_free(&sq);
+  poly_gf2_free(&g);
+  return ok ? 0 : -1;
+}
 
-    poly_gf2_update_degree(r);
+int poly_gf2_barrett_init(poly_gf2_barrett *br, const poly_gf2_t *m, int max_deg) {
+  if (!br || !m || m->deg < 0) return -1;
+  if (max_deg < m->deg) max_deg = m->deg;
 
-#ifdef DEBUG_POLY_DIV
-    fprintf(stderr, "    After update: r.deg=%d\n", r->deg);
-#endif
+  br->max_deg = max_deg;
+  br->mu.coeff = NULL;
+  if (poly_gf2_init(&br->m, m->deg + 1) != 0) return -1;
+  poly_gf2_copy(&br->m, m);
+
+  if (poly_gf2_init(&br->mu, max_deg - m->deg + 1) != 0 ||
+      barrett_mu(&br->mu, &br->m, max_deg) != 0) {
+    poly_gf2_barrett_free(br);
+    return -1;
   }
+  return 0;
+}
 
-#ifdef DEBUG_POLY_DIV
-  fprintf(stderr, "  Final: r.deg=%d\n", r->deg);
-#endif
+void poly_gf2_barrett_free(poly_gf2_barrett *br) {
+  if (!br) return;
+  poly_gf2_free(&br->m);
+  poly_gf2_free(&br->mu);
+}
 
-  return 0;
+size_t poly_gf2_barrett_scratch_size(const poly_gf2_barrett *br) {
+  if (!br) return 0;
+  int d = br->m.deg, qcap = br->max_deg - d + 1;
+  int pcap = (2 * qcap - 1 > br->max_deg + 1) ? 2 * qcap - 1 : br->max_deg + 1;
+  size_t mul1 = poly_gf2_mul_scratch_size(qcap, qcap);
+  size_t mul2 = poly_gf2_mul_scratch_size(qcap, d + 1);
+  return poly_gf2_scratch_size(2, qcap) + poly_gf2_scratch_size(1, pcap) +
+         (mul1 > mul2 ? mul1 : mul2);
+}
+
+int poly_gf2_mod_barrett(poly_gf2_t *result, const poly_gf2_t *a,
+                         const poly_gf2_barrett *br, codectk_arena *ws) {
+  if (!result || !a || !br || a->deg > br->max_deg) return -1;
+
+  int d = br->m.deg;
+  if (a->deg < d) {
+    poly_gf2_copy(result, a);
+    return 0;
+  }
+
+  size_t mark = codectk_arena_mark(ws);
+  int qcap = br->max_deg - d + 1;
+  int pcap = (2 * qcap - 1 > br->max_deg + 1) ? 2 * qcap - 1 : br->max_deg + 1;
+  poly_gf2_t hi, q, qm;
+  int ok = poly_gf2_init_ws(&hi, qcap, ws) == 0;
+  ok = poly_gf2_init_ws(&q, qcap, ws) == 0 && ok;
+  ok = poly_gf2_init_ws(&qm, pcap, ws) == 0 && ok;
+
+  if (ok) {
+    /* q = floor(floor(a / x^d) * mu / x^(N-d)) */
+    shr_words(hi.coeff, gf2_words(qcap), a->coeff, gf2_words(a->deg + 1), d);
+    poly_gf2_degree_from(&hi, a->deg - d);
+    ok = poly_gf2_mul_ws(&qm, &hi, &br->mu, ws) == 0;
+  }
+  if (ok) {
+    shr_words(q.coeff, gf2_words(qcap), qm.coeff, gf2_words(qm.deg + 1), br->max_deg - d);
+    poly_gf2_mask_top(&q);
+    poly_gf2_degree_from(&q, a->deg - d);
+
+    /* a - q*m lies below x^d */
+    ok = poly_gf2_mul_ws(&qm, &q, &br->m, ws) == 0;
+  }
+  if (ok) {
+    poly_gf2_add(&qm, &qm, a);
+    poly_gf2_copy(result, &qm);
+  }
+
+  poly_gf2_free(&hi);
+  poly_gf2_free(&q);
+  poly_gf2_free(&qm);
+  codectk_arena_release(ws, mark);
+  return ok ? 0 : -1;
 }
 
 void poly_gf2_gcd(poly_gf2_t *result, const poly_gf2_t *a, const poly_gf2_t *b) {
+  poly_gf2_gcd_ws(result, a, b, NULL);
+}
+
+void poly_gf2_gcd_ws(poly_gf2_t *result, const poly_gf2_t *a, const poly_gf2_t *b,
+                     codectk_arena *ws) {
   if (!result || !a || !b) return;
 
   /* Euclidean algorithm */
+  size_t mark = codectk_arena_mark(ws);
+  int cap = a->capacity > b->capacity ? a->capacity : b->capacity;
   poly_gf2_t u, v, temp_q, temp_r;
-  poly_gf2_init(&u, a->capacity);
-  poly_gf2_init(&v, b->capacity);
-  poly_gf2_init(&temp_q, a->capacity);
-  poly_gf2_init(&temp_r, a->capacity);
+  poly_gf2_init_ws(&u, cap, ws);
+  poly_gf2_init_ws(&v, cap, ws);
+  poly_gf2_init_ws(&temp_q, cap, ws);
+  poly_gf2_init_ws(&temp_r, cap, ws);
 
   poly_gf2_copy(&u, a);
   poly_gf2_copy(&v, b);
 
+  /*
+   * A long a against a short b: the first remainder is a reduction by a
+   * fixed modulus worth doing with Barrett. After that the divisor
+   * changes every step and the operands are short, so plain division.
+   */
+  if (v.deg >= BARRETT_MIN_DIVISOR && u.deg - v.deg >= BARRETT_MIN_QUOT) {
+    poly_gf2_barrett br;
+    if (poly_gf2_barrett_init(&br, &v, u.deg) == 0) {
+      if (poly_gf2_mod_barrett(&temp_r, &u, &br, ws) == 0) {
+        poly_gf2_copy(&u, &v);
+        poly_gf2_copy(&v, &temp_r);
+      }
+      poly_gf2_barrett_free(&br);
+    }
+  }
+
   while (v.deg >= 0) {
     poly_gf2_div_rem(&temp_q, &temp_r, &u, &v);
     poly_gf2_copy(&u, &v);
@@ -208,6 +527,7 @@ void poly_gf2_gcd(poly_gf2_t *result, const poly_gf2_t *a, const poly_gf2_t *b)
   poly_gf2_free(&v);
   poly_gf2_free(&temp_q);
   poly_gf2_free(&temp_r);
+  codectk_arena_release(ws, mark);
 }
 
 /*
@@ -226,12 +546,19 @@ static void poly_gf2m_update_degree(poly_gf2m_t *p) {
 }
 
 int poly_gf2m_init(poly_gf2m_t *p, const gf2m_ctx *ctx, int capacity) {
+  return poly_gf2m_init_ws(p, ctx, capacity, NULL);
+}
+
+int poly_gf2m_init_ws(poly_gf2m_t *p, const gf2m_ctx *ctx, int capacity,
+                      codectk_arena *ws) {
   if (!p || !ctx || capacity < 0) return -1;
 
   p->capacity = capacity;
   p->deg = -1;
   p->ctx = ctx;
-  p->coeff = (uint16_t*)calloc((size_t)capacity, sizeof(uint16_t));
+  p->coeff = (uint16_t*)codectk_arena_calloc(ws, (size_t)capacity * sizeof(uint16_t));
+  p->borrowed = p->coeff != NULL;
+  if (!p->coeff) p->coeff = (uint16_t*)calloc((size_t)capacity, sizeof(uint16_t));
 
   if (!p->coeff) {
     p->capacity = 0;
@@ -241,9 +568,14 @@ int poly_gf2m_init(poly_gf2m_t *p, const gf2m_ctx *ctx, int capacity) {
   return 0;
 }
 
+size_t poly_gf2m_scratch_size(int count, int capacity) {
+  if (count <= 0 || capacity < 0) return 0;
+  return (size_t)count * codectk_arena_round((size_t)capacity * sizeof(uint16_t));
+}
+
 void poly_gf2m_free(poly_gf2m_t *p) {
   if (p && p->coeff) {
-    free(p->coeff);
+    if (!p->borrowed) free(p->coeff);
     p->coeff = NULL;
     p->capacity = 0;
     p->deg = -1;
@@ -307,20 +639,15 @@ void poly_gf2m_mul(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m_t
 
   poly_gf2m_zero(result);
 
-  /* Schoolbook multiplication */
-  for (int i = 0; i <= a->deg && i < a->capacity; i++) {
+  /* Schoolbook multiplication: result += a_i * x^i * b, one row at a time */
+  int b_len = (b->deg < b->capacity) ? b->deg + 1 : b->capacity;
+  for (int i = 0; i <= a->deg && i < a->capacity && i < result->capacity; i++) {
     uint16_t ca = a->coeff[i];
     if (!ca) continue;
 
-    for (int j = 0; j <= b->deg && j < b->capacity; j++) {
-      uint16_t cb = b->coeff[j];
-      if (!cb) continue;
-
-      int k = i + j;
-      if (k < result->capacity) {
-        uint16_t prod = gf2m_mul(result->ctx, ca, cb);
-        result->coeff[k] = gf2m_add(result->coeff[k], prod);
-      }
+    int len = (i + b_len <= result->capacity) ? b_len : result->capacity - i;
+    if (len > 0) {
+      gf2m_mac_scalar(result->ctx, result->coeff + i, b->coeff, ca, (size_t)len);
     }
   }
 
@@ -346,11 +673,7 @@ int poly_gf2m_div_rem(poly_gf2m_t *q, poly_gf2m_t *r,
     uint16_t factor = gf2m_mul(ctx, r_lead, gf2m_inv(ctx, b_lead));
 
     /* Subtract factor * b * x^shift from r */
-    for (int i = 0; i <= b->deg; i++) {
-      uint16_t term = gf2m_mul(ctx, factor, b->coeff[i]);
-      int pos = i + shift;
-      r->coeff[pos] = gf2m_add(r->coeff[pos], term);
-    }
+    gf2m_mac_scalar(ctx, r->coeff + shift, b->coeff, factor, (size_t)b->deg + 1);
 
     q->coeff[shift] = factor;
 
@@ -362,11 +685,17 @@ int poly_gf2m_div_rem(poly_gf2m_t *q, poly_gf2m_t *r,
 }
 
 int poly_gf2m_mod(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m_t *m) {
+  return poly_gf2m_mod_ws(result, a, m, NULL);
+}
+
+int poly_gf2m_mod_ws(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m_t *m,
+                     codectk_arena *ws) {
   if (!result || !a || !m) return -1;
 
+  size_t mark = codectk_arena_mark(ws);
   poly_gf2m_t temp_q, temp_r;
-  poly_gf2m_init(&temp_q, a->ctx, a->capacity);
-  poly_gf2m_init(&temp_r, a->ctx, a->capacity);
+  poly_gf2m_init_ws(&temp_q, a->ctx, a->capacity, ws);
+  poly_gf2m_init_ws(&temp_r, a->ctx, a->capacity, ws);
 
   int ret = poly_gf2m_div_rem(&temp_q, &temp_r, a, m);
   if (ret == 0) {
@@ -375,18 +704,27 @@ int poly_gf2m_mod(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m_t *
 
   poly_gf2m_free(&temp_q);
   poly_gf2m_free(&temp_r);
+  codectk_arena_release(ws, mark);
 
   return ret;
 }
 
 void poly_gf2m_gcd(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m_t *b) {
+  poly_gf2m_gcd_ws(result, a, b, NULL);
+}
+
+void poly_gf2m_gcd_ws(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m_t *b,
+                      codectk_arena *ws) {
   if (!result || !a || !b) return;
 
+  /* u and v swap roles, so all four need the larger capacity */
+  int cap = (a->capacity > b->capacity) ? a->capacity : b->capacity;
+  size_t mark = codectk_arena_mark(ws);
   poly_gf2m_t u, v, temp_q, temp_r;
-  poly_gf2m_init(&u, a->ctx, a->capacity);
-  poly_gf2m_init(&v, a->ctx, b->capacity);
-  poly_gf2m_init(&temp_q, a->ctx, a->capacity);
-  poly_gf2m_init(&temp_r, a->ctx, a->capacity);
+  poly_gf2m_init_ws(&u, a->ctx, cap, ws);
+  poly_gf2m_init_ws(&v, a->ctx, cap, ws);
+  poly_gf2m_init_ws(&temp_q, a->ctx, cap, ws);
+  poly_gf2m_init_ws(&temp_r, a->ctx, cap, ws);
 
   poly_gf2m_copy(&u, a);
   poly_gf2m_copy(&v, b);
@@ -403,6 +741,7 @@ void poly_gf2m_gcd(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m_t
   poly_gf2m_free(&v);
   poly_gf2m_free(&temp_q);
   poly_gf2m_free(&temp_r);
+  codectk_arena_release(ws, mark);
 }
 
 uint16_t poly_gf2m_eval(const poly_gf2m_t *p, uint16_t x) {
@@ -412,7 +751,7 @@ uint16_t poly_gf2m_eval(const poly_gf2m_t *p, uint16_t x) {
   uint16_t result = p->coeff[p->deg];
 
   for (int i = p->deg - 1; i >= 0; i--) {
-    result = gf2m_mul(p->ctx, result, x);
+    result = gf2m_mul_fast(p->ctx, result, x);
     result = gf2m_add(result, p->coeff[i]);
   }
 
@@ -435,23 +774,29 @@ void poly_gf2m_deriv(poly_gf2m_t *result, const poly_gf2m_t *p) {
 }
 
 int poly_gf2m_inv_mod(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m_t *m) {
+  return poly_gf2m_inv_mod_ws(result, a, m, NULL);
+}
+
+int poly_gf2m_inv_mod_ws(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m_t *m,
+                         codectk_arena *ws) {
   if (!result || !a || !m || m->deg < 0) return -1;
 
-  /* Extended Euclidean algorithm: find u such that a*u a 1 (mod m) */
+  /* Extended Euclidean algorithm: find u such that a*u = 1 (mod m) */
   poly_gf2m_t r0, r1, s0, s1, temp_q, temp_r, temp_s, temp_prod;
   const gf2m_ctx *ctx = a->ctx;
 
   int cap = (a->capacity > m->capacity) ? a->capacity : m->capacity;
   cap = (cap > 2 * m->capacity) ? cap : (2 * m->capacity);
 
-  poly_gf2m_init(&r0, ctx, cap);
-  poly_gf2m_init(&r1, ctx, cap);
-  poly_gf2m_init(&s0, ctx, cap);
-  poly_gf2m_init(&s1, ctx, cap);
-  poly_gf2m_init(&temp_q, ctx, cap);
-  poly_gf2m_init(&temp_r, ctx, cap);
-  poly_gf2m_init(&temp_s, ctx, cap);
-  poly_gf2m_init(&temp_prod, ctx, cap);
+  size_t mark = codectk_arena_mark(ws);
+  poly_gf2m_init_ws(&r0, ctx, cap, ws);
+  poly_gf2m_init_ws(&r1, ctx, cap, ws);
+  poly_gf2m_init_ws(&s0, ctx, cap, ws);
+  poly_gf2m_init_ws(&s1, ctx, cap, ws);
+  poly_gf2m_init_ws(&temp_q, ctx, cap, ws);
+  poly_gf2m_init_ws(&temp_r, ctx, cap, ws);
+  poly_gf2m_init_ws(&temp_s, ctx, cap, ws);
+  poly_gf2m_init_ws(&temp_prod, ctx, cap, ws);
 
   poly_gf2m_copy(&r0, m);
   poly_gf2m_copy(&r1, a);
@@ -472,29 +817,19 @@ int poly_gf2m_inv_mod(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m
     poly_gf2m_copy(&s1, &temp_s);
   }
 
-  /* r0 should be constant (gcd) */
-  if (r0.deg != 0 || r0.coeff[0] == 0) {
-    /* Not coprime */
-    poly_gf2m_free(&r0);
-    poly_gf2m_free(&r1);
-    poly_gf2m_free(&s0);
-    poly_gf2m_free(&s1);
-    poly_gf2m_free(&temp_q);
-    poly_gf2m_free(&temp_r);
-    poly_gf2m_free(&temp_s);
-    poly_gf2m_free(&temp_prod);
-    return -1;
-  }
+  /* r0 should be constant (gcd); otherwise a and m are not coprime */
+  int ret = -1;
+  if (r0.deg == 0 && r0.coeff[0] != 0) {
+    /* Normalize s0 by dividing by gcd coefficient */
+    uint16_t inv_gcd = gf2m_inv(ctx, r0.coeff[0]);
 
-  /* Normalize s0 by dividing by gcd coefficient */
-  uint16_t gcd_coeff = r0.coeff[0];
-  uint16_t inv_gcd = gf2m_inv(ctx, gcd_coeff);
-
-  poly_gf2m_zero(result);
-  for (int i = 0; i <= s0.deg && i < result->capacity; i++) {
-    result->coeff[i] = gf2m_mul(ctx, s0.coeff[i], inv_gcd);
+    poly_gf2m_zero(result);
+    for (int i = 0; i <= s0.deg && i < result->capacity; i++) {
+      result->coeff[i] = gf2m_mul(ctx, s0.coeff[i], inv_gcd);
+    }
+    poly_gf2m_update_degree(result);
+    ret = 0;
   }
-  poly_gf2m_update_degree(result);
 
   poly_gf2m_free(&r0);
   poly_gf2m_free(&r1);
@@ -504,6 +839,7 @@ int poly_gf2m_inv_mod(poly_gf2m_t *result, const poly_gf2m_t *a, const poly_gf2m
   poly_gf2m_free(&temp_r);
   poly_gf2m_free(&temp_s);
   poly_gf2m_free(&temp_prod);
+  codectk_arena_release(ws, mark);
 
-  return 0;
+  return ret;
 }
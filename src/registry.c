@@ -10,7 +10,38 @@ const codectk_codec* codectk_get(const char *name) {
   if (!strcmp(name, "bch"))     return bch_codec();
   if (!strcmp(name, "goppa"))   return goppa_codec();
   if (!strcmp(name, "huffman")) return huffman_codec();
-  return NULL;
+  return bch_fixed_codec(name);
+}
+
+codectk_err codectk_encode_batch(const codectk_codec *codec, const void *params,
+                                 codectk_batch_item *items, size_t count) {
+  if (!codec || (count && !items)) return CODECTK_EINVAL;
+  if (codec->encode_batch) return codec->encode_batch(params, items, count);
+
+  codectk_err first = CODECTK_OK;
+  for (size_t i = 0; i < count; i++) {
+    codectk_batch_item *it = &items[i];
+    it->num_corrected = 0;
+    it->err = codec->encode(params, it->in, it->in_bits, it->out, &it->out_bits);
+    if (first == CODECTK_OK) first = it->err;
+  }
+  return first;
+}
+
+codectk_err codectk_decode_batch(const codectk_codec *codec, const void *params,
+                                 codectk_batch_item *items, size_t count) {
+  if (!codec || (count && !items)) return CODECTK_EINVAL;
+  if (codec->decode_batch) return codec->decode_batch(params, items, count);
+
+  codectk_err first = CODECTK_OK;
+  for (size_t i = 0; i < count; i++) {
+    codectk_batch_item *it = &items[i];
+    it->num_corrected = 0;
+    it->err = codec->decode(params, it->in, it->in_bits, it->out, &it->out_bits,
+                            &it->num_corrected);
+    if (first == CODECTK_OK) first = it->err;
+  }
+  return first;
 }
 
 const char* codectk_strerror(codectk_err err) {
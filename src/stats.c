@@ -0,0 +1,257 @@
+/**
+ * stats.c - Per-thread decode counters
+ *
+ * Each recording thread allocates one block of counters on first use and
+ * links it into a global list. Only the owner writes its block, with a
+ * relaxed load and store rather than a read-modify-write, and readers sum
+ * the blocks under the list lock. A thread's block is folded into the
+ * retired totals by a thread-specific-data destructor when it exits.
+ */
+
+#include "../include/stats.h"
+
+#ifdef CODECTK_STATS
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <x86intrin.h>
+#define STATS_TSC 1
+#endif
+
+#define CODEC_WORDS (sizeof(codectk_codec_stats) / sizeof(uint64_t))
+#define BLOCK_WORDS (CODECTK_STATS_CODECS * CODEC_WORDS)
+#define FIELD(f) (offsetof(codectk_codec_stats, f) / sizeof(uint64_t))
+
+_Static_assert(sizeof(codectk_codec_stats) % sizeof(uint64_t) == 0,
+               "codectk_codec_stats must hold only uint64_t counters");
+
+typedef struct stats_block {
+  _Atomic uint64_t v[BLOCK_WORDS];
+  struct stats_block *prev, *next;  /* guarded by lock */
+} stats_block;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static stats_block *live;
+static uint64_t retired[BLOCK_WORDS];  /* guarded by lock */
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+static pthread_key_t key;
+static int have_key;
+static uint64_t base_ticks, base_ns;
+
+static _Thread_local stats_block *tl_block;
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t codectk_stats_ticks(void) {
+#ifdef STATS_TSC
+  return (uint64_t)__rdtsc();
+#else
+  return now_ns();
+#endif
+}
+
+static void retire(void *p) {
+  stats_block *b = (stats_block*)p;
+  pthread_mutex_lock(&lock);
+  for (size_t i = 0; i < BLOCK_WORDS; i++) {
+    retired[i] += atomic_load_explicit(&b->v[i], memory_order_relaxed);
+  }
+  if (b->prev) b->prev->next = b->next;
+  else live = b->next;
+  if (b->next) b->next->prev = b->prev;
+  pthread_mutex_unlock(&lock);
+  free(b);
+  tl_block = NULL;
+}
+
+static void init_once(void) {
+  have_key = pthread_key_create(&key, retire) == 0;
+  base_ticks = codectk_stats_ticks();
+  base_ns = now_ns();
+}
+
+/* The calling thread's block, or NULL if it cannot be allocated */
+static stats_block *block(void) {
+  stats_block *b = tl_block;
+  if (b) return b;
+
+  pthread_once(&once, init_once);
+  b = (stats_block*)calloc(1, sizeof(*b));
+  if (!b) return NULL;
+  pthread_mutex_lock(&lock);
+  b->next = live;
+  if (live) live->prev = b;
+  live = b;
+  pthread_mutex_unlock(&lock);
+  if (have_key) pthread_setspecific(key, b);
+  tl_block = b;
+  return b;
+}
+
+static inline void add(stats_block *b, size_t i, uint64_t v) {
+  atomic_store_explicit(&b->v[i], atomic_load_explicit(&b->v[i], memory_order_relaxed) + v,
+                        memory_order_relaxed);
+}
+
+void codectk_stats_time(codectk_stats_codec c, codectk_stats_stage s, uint64_t t0) {
+  uint64_t t1 = codectk_stats_ticks();
+  stats_block *b = block();
+  if (!b) return;
+  size_t base = (size_t)c * CODEC_WORDS;
+  add(b, base + FIELD(ticks) + (size_t)s, t1 - t0);
+  add(b, base + FIELD(spans) + (size_t)s, 1);
+}
+
+void codectk_stats_words(codectk_stats_codec c, size_t corr, size_t n) {
+  stats_block *b = block();
+  if (!b || !n) return;
+  size_t base = (size_t)c * CODEC_WORDS;
+  size_t bucket = corr < CODECTK_STATS_HIST - 1 ? corr : CODECTK_STATS_HIST - 1;
+  add(b, base + FIELD(codewords), n);
+  add(b, base + FIELD(corrections) + bucket, n);
+}
+
+void codectk_stats_failures(codectk_stats_codec c, size_t n) {
+  stats_block *b = block();
+  if (!b || !n) return;
+  size_t base = (size_t)c * CODEC_WORDS;
+  add(b, base + FIELD(codewords), n);
+  add(b, base + FIELD(failures), n);
+}
+
+void codectk_stats_call(codectk_stats_codec c) {
+  stats_block *b = block();
+  if (b) add(b, (size_t)c * CODEC_WORDS + FIELD(calls), 1);
+}
+
+/* Nanoseconds per tick, measured over at least a millisecond since init */
+static double ns_per_tick(void) {
+#ifdef STATS_TSC
+  uint64_t ns = now_ns();
+  while (ns - base_ns < 1000000) ns = now_ns();
+  uint64_t ticks = codectk_stats_ticks() - base_ticks;
+  return ticks ? (double)(ns - base_ns) / (double)ticks : 0.0;
+#else
+  return 1.0;
+#endif
+}
+
+static void load(uint64_t *dst, const stats_block *b) {
+  for (size_t i = 0; i < BLOCK_WORDS; i++) {
+    dst[i] += atomic_load_explicit(&b->v[i], memory_order_relaxed);
+  }
+}
+
+int codectk_stats_enabled(void) {
+  return 1;
+}
+
+codectk_err codectk_stats_thread(codectk_stats *out) {
+  if (!out) return CODECTK_EINVAL;
+  pthread_once(&once, init_once);
+  memset(out, 0, sizeof(*out));
+  if (tl_block) load((uint64_t*)out->codec, tl_block);
+  out->ns_per_tick = ns_per_tick();
+  return CODECTK_OK;
+}
+
+codectk_err codectk_stats_total(codectk_stats *out) {
+  if (!out) return CODECTK_EINVAL;
+  pthread_once(&once, init_once);
+  memset(out, 0, sizeof(*out));
+  uint64_t *dst = (uint64_t*)out->codec;
+  pthread_mutex_lock(&lock);
+  memcpy(dst, retired, sizeof(retired));
+  for (const stats_block *b = live; b; b = b->next) load(dst, b);
+  pthread_mutex_unlock(&lock);
+  out->ns_per_tick = ns_per_tick();
+  return CODECTK_OK;
+}
+
+void codectk_stats_reset(void) {
+  pthread_mutex_lock(&lock);
+  memset(retired, 0, sizeof(retired));
+  for (stats_block *b = live; b; b = b->next) {
+    for (size_t i = 0; i < BLOCK_WORDS; i++) {
+      atomic_store_explicit(&b->v[i], 0, memory_order_relaxed);
+    }
+  }
+  pthread_mutex_unlock(&lock);
+}
+
+#else /* !CODECTK_STATS */
+
+int codectk_stats_enabled(void) {
+  return 0;
+}
+
+codectk_err codectk_stats_thread(codectk_stats *out) {
+  (void)out;
+  return CODECTK_ENOTSUP;
+}
+
+codectk_err codectk_stats_total(codectk_stats *out) {
+  (void)out;
+  return CODECTK_ENOTSUP;
+}
+
+void codectk_stats_reset(void) {
+}
+
+#endif
+
+const char *codectk_stats_codec_name(codectk_stats_codec c) {
+  static const char *const names[CODECTK_STATS_CODECS] = {"hamming", "bch", "goppa",
+                                                          "huffman"};
+  return (unsigned)c < CODECTK_STATS_CODECS ? names[c] : "unknown";
+}
+
+const char *codectk_stats_stage_name(codectk_stats_stage s) {
+  static const char *const names[CODECTK_STAGES] = {"setup", "syndrome", "key equation",
+                                                    "roots", "bit i/o"};
+  return (unsigned)s < CODECTK_STAGES ? names[s] : "unknown";
+}
+
+void codectk_stats_print(FILE *f, const codectk_stats *s) {
+  if (!f || !s) return;
+  for (int c = 0; c < CODECTK_STATS_CODECS; c++) {
+    const codectk_codec_stats *cs = &s->codec[c];
+    int timed = 0;
+    for (int st = 0; st < CODECTK_STAGES; st++) timed |= cs->spans[st] != 0;
+    if (!cs->calls && !cs->codewords && !timed) continue;
+
+    fprintf(f, "%s: %llu calls, %llu codewords, %llu failed\n",
+            codectk_stats_codec_name((codectk_stats_codec)c), (unsigned long long)cs->calls,
+            (unsigned long long)cs->codewords, (unsigned long long)cs->failures);
+
+    int any = 0;
+    for (int i = 1; i < CODECTK_STATS_HIST; i++) any |= cs->corrections[i] != 0;
+    if (any) {
+      fprintf(f, "  corrections:");
+      for (int i = 0; i < CODECTK_STATS_HIST; i++) {
+        if (!cs->corrections[i]) continue;
+        fprintf(f, " %d%s=%llu", i, i == CODECTK_STATS_HIST - 1 ? "+" : "",
+                (unsigned long long)cs->corrections[i]);
+      }
+      fputc('\n', f);
+    }
+
+    for (int st = 0; st < CODECTK_STAGES; st++) {
+      if (!cs->spans[st]) continue;
+      double ns = (double)cs->ticks[st] * s->ns_per_tick;
+      fprintf(f, "  %-13s %10llu spans %12.3f ms %12.1f ns/span\n",
+              codectk_stats_stage_name((codectk_stats_stage)st),
+              (unsigned long long)cs->spans[st], ns * 1e-6, ns / (double)cs->spans[st]);
+    }
+  }
+}
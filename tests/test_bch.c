@@ -5,6 +5,7 @@
 #include "../include/bch.h"
 #include "../include/codectk.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 static int test_count = 0;
@@ -380,6 +381,848 @@ static void test_bch_too_many_errors(void) {
   PASS();  /* Test passes if we don't crash */
 }
 
+/**
+ * Test a precomputed context reused across many encode/decode calls
+ */
+static void test_bch_ctx_reuse(void) {
+  TEST("BCH(63,45) context reuse across codewords");
+
+  bch_ctx *ctx = NULL;
+  if (bch_ctx_create(6, 3, &ctx) != CODECTK_OK) {
+    FAIL("context creation failed");
+    return;
+  }
+
+  if (ctx->n != 63 || ctx->k != 45 || ctx->r != 18) {
+    bch_ctx_destroy(ctx);
+    FAIL("context dimensions incorrect");
+    return;
+  }
+
+  const codectk_codec *codec = bch_codec();
+  bch_params params = {.ctx = ctx};
+  uint32_t seed = 12345;
+
+  for (int iter = 0; iter < 50; iter++) {
+    uint8_t message[6];
+    uint8_t encoded[10];
+    uint8_t decoded[10];
+    size_t encoded_bits = sizeof(encoded) * 8;
+    size_t decoded_bits = sizeof(decoded) * 8;
+
+    for (size_t i = 0; i < sizeof(message); i++) {
+      seed = seed * 1103515245u + 12345u;
+      message[i] = (uint8_t)(seed >> 16);
+    }
+
+    if (codec->encode(&params, message, 45, encoded, &encoded_bits) != CODECTK_OK ||
+        encoded_bits != 63) {
+      bch_ctx_destroy(ctx);
+      FAIL("encode failed");
+      return;
+    }
+
+    /* Flip iter % 4 distinct bits (0..3 errors) */
+    unsigned n_err = (unsigned)iter % 4;
+    for (unsigned e = 0; e < n_err; e++) {
+      unsigned pos = ((unsigned)iter * 7u + e * 17u) % 63u;
+      encoded[pos / 8] ^= (uint8_t)(1u << (pos % 8));
+    }
+
+    size_t num_corrected = 0;
+    if (codec->decode(&params, encoded, encoded_bits, decoded, &decoded_bits,
+                      &num_corrected) != CODECTK_OK) {
+      bch_ctx_destroy(ctx);
+      FAIL("decode failed");
+      return;
+    }
+
+    for (size_t i = 0; i < 45; i++) {
+      if (((message[i / 8] >> (i % 8)) & 1) != ((decoded[i / 8] >> (i % 8)) & 1)) {
+        bch_ctx_destroy(ctx);
+        FAIL("decoded message mismatch");
+        return;
+      }
+    }
+
+    if (num_corrected != n_err) {
+      bch_ctx_destroy(ctx);
+      FAIL("wrong correction count");
+      return;
+    }
+  }
+
+  bch_ctx_destroy(ctx);
+  PASS();
+}
+
+/**
+ * Test multi-block streams with both trailing-block policies
+ */
+static void test_bch_multiblock(void) {
+  TEST("BCH(31,21) multi-block stream with shortened and zero-padded tail");
+
+  const codectk_codec *codec = bch_codec();
+  bch_params params = {.m = 5, .t = 2, .pad = BCH_PAD_SHORTEN};
+
+  /* 100 bits = 4 full 21-bit messages + 16-bit tail */
+  uint8_t message[13];
+  uint8_t encoded[32];
+  uint8_t decoded[32];
+  uint32_t seed = 777;
+  for (size_t i = 0; i < sizeof(message); i++) {
+    seed = seed * 1103515245u + 12345u;
+    message[i] = (uint8_t)(seed >> 16);
+  }
+
+  size_t encoded_bits = sizeof(encoded) * 8;
+  if (codec->encode(&params, message, 100, encoded, &encoded_bits) != CODECTK_OK ||
+      encoded_bits != 4 * 31 + 16 + 10) {
+    FAIL("shortened encode length incorrect");
+    return;
+  }
+
+  /* Two errors in every full block, one in the shortened tail */
+  for (unsigned b = 0; b < 4; b++) {
+    unsigned p0 = b * 31 + 3 + b, p1 = b * 31 + 25;
+    encoded[p0 / 8] ^= (uint8_t)(1u << (p0 % 8));
+    encoded[p1 / 8] ^= (uint8_t)(1u << (p1 % 8));
+  }
+  encoded[(124 + 5) / 8] ^= (uint8_t)(1u << ((124 + 5) % 8));
+
+  size_t decoded_bits = sizeof(decoded) * 8;
+  size_t num_corrected = 0;
+  if (codec->decode(&params, encoded, encoded_bits, decoded, &decoded_bits,
+                    &num_corrected) != CODECTK_OK ||
+      decoded_bits != 100 || num_corrected != 9) {
+    FAIL("shortened decode failed");
+    return;
+  }
+  for (size_t i = 0; i < 100; i++) {
+    if (((message[i / 8] >> (i % 8)) & 1) != ((decoded[i / 8] >> (i % 8)) & 1)) {
+      FAIL("shortened decode mismatch");
+      return;
+    }
+  }
+
+  /* Zero padding: 5 full codewords, bits beyond the stream are ignored */
+  params.pad = BCH_PAD_ZERO;
+  encoded_bits = sizeof(encoded) * 8;
+  if (codec->encode(&params, message, 100, encoded, &encoded_bits) != CODECTK_OK ||
+      encoded_bits != 5 * 31) {
+    FAIL("zero-padded encode length incorrect");
+    return;
+  }
+
+  decoded_bits = sizeof(decoded) * 8;
+  if (codec->decode(&params, encoded, 160, decoded, &decoded_bits,
+                    &num_corrected) != CODECTK_OK ||
+      decoded_bits != 5 * 21 || num_corrected != 0) {
+    FAIL("zero-padded decode failed");
+    return;
+  }
+  for (size_t i = 0; i < 105; i++) {
+    int orig = i < 100 ? (message[i / 8] >> (i % 8)) & 1 : 0;
+    if (orig != ((decoded[i / 8] >> (i % 8)) & 1)) {
+      FAIL("zero-padded decode mismatch");
+      return;
+    }
+  }
+
+  /* An uncorrectable block is reported without stopping the stream */
+  encoded[0] ^= 0x07;
+  decoded_bits = sizeof(decoded) * 8;
+  if (codec->decode(&params, encoded, 155, decoded, &decoded_bits,
+                    &num_corrected) != CODECTK_EDECODE ||
+      decoded_bits != 105) {
+    FAIL("uncorrectable block not reported");
+    return;
+  }
+  for (size_t i = 21; i < 100; i++) {
+    if (((message[i / 8] >> (i % 8)) & 1) != ((decoded[i / 8] >> (i % 8)) & 1)) {
+      FAIL("blocks after uncorrectable block not decoded");
+      return;
+    }
+  }
+
+  PASS();
+}
+
+/**
+ * Test the table-driven parity LFSR against a bit-serial reference, for
+ * single-word, multi-word and byte-table-only registers
+ */
+static void test_bch_lfsr_tables(void) {
+  TEST("BCH table-driven parity matches bit-serial LFSR");
+
+  const unsigned cfg[][2] = {{6, 3}, {8, 9}, {9, 30}, {10, 40}};
+  uint32_t seed = 4242;
+
+  for (size_t ci = 0; ci < sizeof(cfg) / sizeof(cfg[0]); ci++) {
+    bch_ctx *ctx = NULL;
+    if (bch_ctx_create(cfg[ci][0], cfg[ci][1], &ctx) != CODECTK_OK) {
+      FAIL("context creation failed");
+      return;
+    }
+
+    /* Two full codewords plus a shortened one, so blocks start unaligned */
+    size_t tail = ctx->k / 2 + 1;
+    size_t in_bits = 2 * ctx->k + tail;
+    uint8_t message[256];
+    uint8_t encoded[512];
+    for (size_t i = 0; i < sizeof(message); i++) {
+      seed = seed * 1103515245u + 12345u;
+      message[i] = (uint8_t)(seed >> 16);
+    }
+
+    size_t encoded_bits = sizeof(encoded) * 8;
+    if (bch_ctx_encode(ctx, BCH_PAD_SHORTEN, message, in_bits, encoded,
+                       &encoded_bits) != CODECTK_OK ||
+        encoded_bits != in_bits + 3 * ctx->r) {
+      bch_ctx_destroy(ctx);
+      FAIL("encode failed");
+      return;
+    }
+
+    size_t in_off = 0, out_off = 0;
+    for (unsigned b = 0; b < 3; b++) {
+      size_t msg_len = (b < 2) ? ctx->k : tail;
+      uint64_t reg[8] = {0};
+
+      for (size_t i = 0; i < msg_len; i++) {
+        size_t p = in_off + i;
+        uint64_t fb = ((uint64_t)(message[p / 8] >> (p % 8)) ^ reg[0]) & 1u;
+        for (unsigned w = 0; w + 1 < ctx->words; w++) {
+          reg[w] = (reg[w] >> 1) | (reg[w + 1] << 63);
+        }
+        reg[ctx->words - 1] >>= 1;
+        if (fb) {
+          for (unsigned w = 0; w < ctx->words; w++) reg[w] ^= ctx->gen[w];
+        }
+      }
+
+      for (unsigned i = 0; i < ctx->r; i++) {
+        size_t p = out_off + msg_len + i;
+        if (((reg[i / 64] >> (i % 64)) & 1u) != ((unsigned)(encoded[p / 8] >> (p % 8)) & 1u)) {
+          bch_ctx_destroy(ctx);
+          FAIL("parity mismatch");
+          return;
+        }
+      }
+
+      in_off += msg_len;
+      out_off += msg_len + ctx->r;
+    }
+
+    bch_ctx_destroy(ctx);
+  }
+
+  PASS();
+}
+
+/**
+ * Test syndrome evaluation both with per-syndrome byte tables and, for t
+ * above BCH_SYND_TABLE_MAX_T, bit by bit from the remainder
+ */
+static void test_bch_syndrome_paths(void) {
+  TEST("BCH syndromes from remainder with and without byte tables");
+
+  const unsigned cfg[][2] = {{8, 16}, {10, BCH_SYND_TABLE_MAX_T + 6}};
+
+  for (size_t ci = 0; ci < sizeof(cfg) / sizeof(cfg[0]); ci++) {
+    bch_ctx *ctx = NULL;
+    if (bch_ctx_create(cfg[ci][0], cfg[ci][1], &ctx) != CODECTK_OK) {
+      FAIL("context creation failed");
+      return;
+    }
+    if ((ctx->synd_tab != NULL) != (ctx->t <= BCH_SYND_TABLE_MAX_T)) {
+      bch_ctx_destroy(ctx);
+      FAIL("unexpected syndrome table choice");
+      return;
+    }
+
+    uint8_t message[128] = {0};
+    uint8_t encoded[256];
+    uint8_t decoded[128];
+    for (size_t i = 0; i < ctx->k / 8; i++) {
+      message[i] = (uint8_t)(i * 37u + 11u);
+    }
+
+    size_t encoded_bits = sizeof(encoded) * 8;
+    if (bch_ctx_encode(ctx, BCH_PAD_SHORTEN, message, ctx->k, encoded,
+                       &encoded_bits) != CODECTK_OK) {
+      bch_ctx_destroy(ctx);
+      FAIL("encode failed");
+      return;
+    }
+
+    /* t errors spread over the first bytes of the codeword */
+    for (unsigned e = 0; e < ctx->t; e++) {
+      unsigned pos = (e * 13u) % 251u;
+      encoded[pos / 8] ^= (uint8_t)(1u << (pos % 8));
+    }
+
+    size_t decoded_bits = sizeof(decoded) * 8;
+    size_t num_corrected = 0;
+    if (bch_ctx_decode(ctx, BCH_PAD_SHORTEN, encoded, encoded_bits, decoded,
+                       &decoded_bits, &num_corrected) != CODECTK_OK ||
+        num_corrected != ctx->t ||
+        memcmp(message, decoded, ctx->k / 8) != 0) {
+      bch_ctx_destroy(ctx);
+      FAIL("decode failed");
+      return;
+    }
+
+    bch_ctx_destroy(ctx);
+  }
+
+  PASS();
+}
+
+/**
+ * Test the SIMD Chien search (when available) against the scalar one on
+ * full and shortened codewords, including m > 8 field elements
+ */
+static void test_bch_chien_paths(void) {
+  TEST("BCH Chien search SIMD and scalar paths agree");
+
+  const unsigned cfg[][2] = {{8, 12}, {10, 9}};
+
+  for (size_t ci = 0; ci < sizeof(cfg) / sizeof(cfg[0]); ci++) {
+    bch_ctx *ctx = NULL;
+    if (bch_ctx_create(cfg[ci][0], cfg[ci][1], &ctx) != CODECTK_OK) {
+      FAIL("context creation failed");
+      return;
+    }
+    unsigned simd_lanes = ctx->chien_lanes;
+
+    for (unsigned pass = 0; pass < 2; pass++) {
+      /* pass 1 forces the scalar search */
+      ctx->chien_lanes = pass ? 0 : simd_lanes;
+
+      for (unsigned trial = 0; trial < 8; trial++) {
+        size_t msg_bits = (trial % 2) ? 150 : 200 - trial;
+        uint8_t message[32] = {0};
+        uint8_t encoded[160];
+        uint8_t decoded[160];
+        for (size_t i = 0; i < (msg_bits + 7) / 8; i++) {
+          message[i] = (uint8_t)(i * 29u + trial * 7u + 3u);
+        }
+        if (msg_bits % 8) message[msg_bits / 8] &= (uint8_t)((1u << (msg_bits % 8)) - 1);
+
+        size_t encoded_bits = sizeof(encoded) * 8;
+        if (bch_ctx_encode(ctx, BCH_PAD_SHORTEN, message, msg_bits, encoded,
+                           &encoded_bits) != CODECTK_OK) {
+          ctx->chien_lanes = simd_lanes;
+          bch_ctx_destroy(ctx);
+          FAIL("encode failed");
+          return;
+        }
+
+        /* trial % (t + 1) errors within the first 256 bits */
+        unsigned n_err = trial * 3u % (ctx->t + 1);
+        for (unsigned e = 0; e < n_err; e++) {
+          unsigned pos = (trial * 11u + e * 19u) % 256u % (unsigned)encoded_bits;
+          encoded[pos / 8] ^= (uint8_t)(1u << (pos % 8));
+        }
+
+        size_t decoded_bits = sizeof(decoded) * 8;
+        size_t num_corrected = 0;
+        if (bch_ctx_decode(ctx, BCH_PAD_SHORTEN, encoded, encoded_bits, decoded,
+                           &decoded_bits, &num_corrected) != CODECTK_OK ||
+            decoded_bits != msg_bits || num_corrected != n_err ||
+            memcmp(message, decoded, (msg_bits + 7) / 8) != 0) {
+          ctx->chien_lanes = simd_lanes;
+          bch_ctx_destroy(ctx);
+          FAIL("decode failed");
+          return;
+        }
+      }
+    }
+
+    ctx->chien_lanes = simd_lanes;
+    bch_ctx_destroy(ctx);
+  }
+
+  PASS();
+}
+
+/**
+ * Test full-length m = 13 codewords with errors anywhere in the codeword,
+ * decoding into a caller-provided workspace
+ */
+static void test_bch_long_code(void) {
+  TEST("BCH(8191,7983) full-length decode with caller workspace");
+
+  bch_ctx *ctx = NULL;
+  if (bch_ctx_create(13, 16, &ctx) != CODECTK_OK) {
+    FAIL("context creation failed");
+    return;
+  }
+
+  size_t ws_size = bch_ctx_workspace_size(ctx);
+  uint32_t *ws = (uint32_t*)malloc(ws_size);
+  uint8_t *message = (uint8_t*)calloc(1024, 1);
+  uint8_t *encoded = (uint8_t*)malloc(1024);
+  uint8_t *decoded = (uint8_t*)malloc(1024);
+  if (!ws || !message || !encoded || !decoded) {
+    free(ws); free(message); free(encoded); free(decoded);
+    bch_ctx_destroy(ctx);
+    FAIL("allocation failed");
+    return;
+  }
+
+  for (size_t i = 0; i < ctx->k / 8; i++) {
+    message[i] = (uint8_t)(i * 73u + 5u);
+  }
+
+  size_t encoded_bits = 1024 * 8;
+  codectk_err err = bch_ctx_encode(ctx, BCH_PAD_SHORTEN, message, ctx->k,
+                                   encoded, &encoded_bits);
+
+  /* t errors, mostly beyond the first 256 positions */
+  for (unsigned e = 0; err == CODECTK_OK && e < ctx->t; e++) {
+    unsigned pos = 8190u - e * 509u;
+    encoded[pos / 8] ^= (uint8_t)(1u << (pos % 8));
+  }
+
+  size_t decoded_bits = 1024 * 8;
+  size_t num_corrected = 0;
+  if (err == CODECTK_OK) {
+    err = bch_ctx_decode_ws(ctx, BCH_PAD_SHORTEN, encoded, encoded_bits, decoded,
+                            &decoded_bits, &num_corrected, ws, ws_size);
+  }
+
+  int ok = err == CODECTK_OK && decoded_bits == ctx->k &&
+           num_corrected == ctx->t && memcmp(message, decoded, ctx->k / 8) == 0;
+
+  /* An undersized workspace is rejected */
+  if (ok && bch_ctx_decode_ws(ctx, BCH_PAD_SHORTEN, encoded, encoded_bits, decoded,
+                              &decoded_bits, &num_corrected, ws, ws_size - 1) != CODECTK_EINVAL) {
+    ok = 0;
+  }
+
+  free(ws); free(message); free(encoded); free(decoded);
+  bch_ctx_destroy(ctx);
+
+  if (!ok) {
+    FAIL("decode failed");
+    return;
+  }
+  PASS();
+}
+
+/**
+ * Test batch decoding: per-item results match one call per codeword
+ */
+static void test_bch_batch(void) {
+  TEST("BCH(63,45) batch encode/decode with per-item results");
+
+  enum { ITEMS = 32 };
+  uint8_t message[ITEMS][6], encoded[ITEMS][10], decoded[ITEMS][10], single[10];
+  codectk_batch_item items[ITEMS];
+  bch_params params = {.m = 6, .t = 3};
+  const codectk_codec *codec = bch_codec();
+  const char *err = NULL;
+  uint32_t seed = 777;
+
+  for (int i = 0; i < ITEMS; i++) {
+    for (size_t j = 0; j < sizeof(message[i]); j++) {
+      seed = seed * 1103515245u + 12345u;
+      message[i][j] = (uint8_t)(seed >> 16);
+    }
+    items[i] = (codectk_batch_item){message[i], 45, encoded[i], 80, 0, CODECTK_OK};
+  }
+
+  if (codectk_encode_batch(codec, &params, items, ITEMS) != CODECTK_OK) {
+    err = "batch encode failed";
+  }
+
+  /* 0..3 errors per word; item 5 gets 4 errors and item 9 too little room */
+  for (int i = 0; i < ITEMS && !err; i++) {
+    if (items[i].err != CODECTK_OK || items[i].out_bits != 63) err = "bad encode item";
+    unsigned n_err = (i == 5) ? 4u : (unsigned)i % 4;
+    for (unsigned e = 0; e < n_err; e++) {
+      unsigned pos = ((unsigned)i * 11u + e * 13u) % 63u;
+      encoded[i][pos / 8] ^= (uint8_t)(1u << (pos % 8));
+    }
+    items[i] = (codectk_batch_item){encoded[i], 63, decoded[i], i == 9 ? 8 : 80,
+                                    99, CODECTK_OK};
+  }
+
+  codectk_err first = err ? CODECTK_OK : codectk_decode_batch(codec, &params, items, ITEMS);
+  for (int i = 0; i < ITEMS && !err; i++) {
+    size_t bits = i == 9 ? 8 : 80, corr = 0;
+    codectk_err e = codec->decode(&params, encoded[i], 63, single, &bits, &corr);
+    if (e != items[i].err || corr != items[i].num_corrected ||
+        (e == CODECTK_OK && (items[i].out_bits != 45 || memcmp(single, decoded[i], 6) != 0))) {
+      err = "batch and single decode differ";
+    } else if (i != 5 && i != 9 && (e != CODECTK_OK || corr != (unsigned)i % 4 ||
+                                    memcmp(decoded[i], message[i], 5) != 0)) {
+      err = "item not corrected";
+    }
+  }
+  if (!err && (items[9].err != CODECTK_ENOMEM || first != items[5].err || first == CODECTK_OK)) {
+    err = "first error not reported";
+  }
+
+  /* Bad parameters fail every item */
+  bch_params bad = {.m = 1, .t = 1};
+  if (!err && (codectk_decode_batch(codec, &bad, items, 3) != CODECTK_EINVAL ||
+               items[2].err != CODECTK_EINVAL)) {
+    err = "parameter error not propagated";
+  }
+
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+/**
+ * Dirty codewords share Berlekamp-Massey runs; uncorrectable ones must not
+ * disturb the others in their group
+ */
+static void test_bch_bm_lanes(void) {
+  TEST("BCH lockstep Berlekamp-Massey over streams of mixed codewords");
+
+  static const unsigned params[][2] = {{5, 3}, {8, 8}, {10, 20}};
+  const char *err = NULL;
+  uint32_t seed = 4242;
+
+  for (size_t p = 0; p < 3 && !err; p++) {
+    bch_ctx *c = NULL;
+    if (bch_ctx_create(params[p][0], params[p][1], &c) != CODECTK_OK) {
+      err = "context creation failed";
+      break;
+    }
+
+    const size_t words = 3 * BCH_BM_LANES + 5;
+    size_t msg_bits = words * c->k;
+    uint8_t *msg = malloc(msg_bits / 8 + 1);
+    uint8_t *enc = malloc(words * c->n / 8 + 8);
+    uint8_t *dec = malloc(msg_bits / 8 + 8);
+    uint8_t *hit = malloc(c->n / 8 + 1);
+    void *ws = malloc(bch_ctx_workspace_size(c));
+    unsigned *nerr = malloc(words * sizeof(unsigned));
+    for (size_t i = 0; i < msg_bits / 8 + 1; i++) {
+      seed = seed * 1103515245u + 12345u;
+      msg[i] = (uint8_t)(seed >> 16);
+    }
+
+    /* Pass 0: 0..t errors per codeword; pass 1: every fourth has 2t */
+    for (int pass = 0; pass < 2 && !err; pass++) {
+      size_t enc_bits = words * c->n + 64;
+      if (bch_ctx_encode(c, BCH_PAD_ZERO, msg, msg_bits, enc, &enc_bits) != CODECTK_OK) {
+        err = "encode failed";
+        break;
+      }
+      size_t expect = 0;
+      for (size_t w = 0; w < words; w++) {
+        nerr[w] = (pass && w % 4 == 1) ? 2 * c->t : (unsigned)(w * 5 % (c->t + 1));
+        memset(hit, 0, c->n / 8 + 1);
+        for (unsigned e = 0; e < nerr[w];) {
+          seed = seed * 1103515245u + 12345u;
+          unsigned pos = (seed >> 8) % c->n;
+          if ((hit[pos / 8] >> (pos % 8)) & 1) continue;
+          hit[pos / 8] |= (uint8_t)(1u << (pos % 8));
+          size_t bit = w * c->n + pos;
+          enc[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+          e++;
+        }
+        if (nerr[w] <= c->t) expect += nerr[w];
+      }
+
+      size_t out_bits = msg_bits + 64, corr = 0;
+      codectk_err r = bch_ctx_decode_ws(c, BCH_PAD_ZERO, enc, words * c->n, dec, &out_bits,
+                                        &corr, ws, bch_ctx_workspace_size(c));
+      if (out_bits != msg_bits || (pass == 0 && (r != CODECTK_OK || corr != expect))) {
+        err = "wrong result or correction count";
+      }
+      for (size_t w = 0; w < words && !err; w++) {
+        if (nerr[w] > c->t) continue;
+        for (size_t i = w * c->k; i < (w + 1) * c->k; i++) {
+          if (((msg[i / 8] ^ dec[i / 8]) >> (i % 8)) & 1) {
+            err = "correctable codeword not corrected";
+            break;
+          }
+        }
+      }
+    }
+
+    free(msg);
+    free(enc);
+    free(dec);
+    free(hit);
+    free(ws);
+    free(nerr);
+    bch_ctx_destroy(c);
+  }
+
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+/**
+ * The constant-time decoder must match the branching one bit for bit,
+ * over several passes, a shortened tail and codewords beyond t errors
+ */
+static void test_bch_decode_ct(void) {
+  TEST("BCH constant-time decode matches bch_ctx_decode()");
+
+  static const unsigned params[][2] = {{4, 2}, {6, 3}, {8, 4}, {10, 9}};
+  const char *err = NULL;
+  uint32_t seed = 5150;
+
+  for (size_t p = 0; p < 4 && !err; p++) {
+    bch_ctx *c = NULL;
+    if (bch_ctx_create(params[p][0], params[p][1], &c) != CODECTK_OK) {
+      err = "context creation failed";
+      break;
+    }
+
+    /* 150 whole codewords (three passes) and a shortened one */
+    const size_t words = 150;
+    size_t msg_bits = words * c->k + c->k / 2 + 1;
+    size_t enc_cap = (words + 1) * c->n + 64;
+    uint8_t *msg = malloc(msg_bits / 8 + 1);
+    uint8_t *enc = malloc(enc_cap / 8);
+    uint8_t *dec[2] = {malloc(msg_bits / 8 + 8), malloc(msg_bits / 8 + 8)};
+    for (size_t i = 0; i < msg_bits / 8 + 1; i++) {
+      seed = seed * 1103515245u + 12345u;
+      msg[i] = (uint8_t)(seed >> 16);
+    }
+
+    size_t enc_bits = enc_cap;
+    if (bch_ctx_encode(c, BCH_PAD_SHORTEN, msg, msg_bits, enc, &enc_bits) != CODECTK_OK) {
+      err = "encode failed";
+    }
+
+    /* 0..t+2 errors per codeword, possibly repeated (cancelling) */
+    for (size_t w = 0; w <= words && !err; w++) {
+      size_t base = w * c->n, len = (w < words) ? c->n : enc_bits - base;
+      for (unsigned e = 0; e < (unsigned)(w % (c->t + 3)); e++) {
+        seed = seed * 1103515245u + 12345u;
+        size_t bit = base + (seed >> 8) % len;
+        enc[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+      }
+    }
+
+    for (int pad = 0; pad < 2 && !err; pad++) {
+      size_t bits[2] = {msg_bits + 64, msg_bits + 64}, corr[2] = {0, 0};
+      bch_pad mode = pad ? BCH_PAD_ZERO : BCH_PAD_SHORTEN;
+      codectk_err r0 = bch_ctx_decode(c, mode, enc, enc_bits, dec[0], &bits[0], &corr[0]);
+      codectk_err r1 = bch_ctx_decode_ct(c, mode, enc, enc_bits, dec[1], &bits[1], &corr[1]);
+      if (r0 != r1 || bits[0] != bits[1] || corr[0] != corr[1] || corr[0] == 0 ||
+          memcmp(dec[0], dec[1], (bits[0] + 7) / 8) != 0) {
+        err = "constant-time and branching decode differ";
+      }
+    }
+
+    /* The codec flag selects the same decoder */
+    bch_params cp = {.ctx = c, .flags = BCH_FLAG_CT};
+    size_t bits = msg_bits + 64, corr = 0, corr_ct = 0, ct_bits = msg_bits + 64;
+    if (!err && (bch_codec()->decode(&cp, enc, enc_bits, dec[0], &bits, &corr) !=
+                     bch_ctx_decode_ct(c, BCH_PAD_SHORTEN, enc, enc_bits, dec[1], &ct_bits,
+                                       &corr_ct) ||
+                 corr != corr_ct || memcmp(dec[0], dec[1], (bits + 7) / 8) != 0)) {
+      err = "codec flag not honoured";
+    }
+    cp.flags = 0x80;
+    if (!err && bch_codec()->decode(&cp, enc, enc_bits, dec[0], &bits, &corr) != CODECTK_EINVAL) {
+      err = "unknown flag accepted";
+    }
+
+    free(msg);
+    free(enc);
+    free(dec[0]);
+    free(dec[1]);
+    bch_ctx_destroy(c);
+  }
+
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+/**
+ * A shortened tail alone, N well below n (N <= 64 with n > 64 included):
+ * the constant-time passes must stop at the codeword's own positions
+ */
+static void test_bch_decode_ct_short(void) {
+  TEST("BCH constant-time decode of short shortened tails");
+
+  static const unsigned params[][2] = {{8, 4}, {10, 6}, {7, 3}};
+  static const size_t lens[] = {1, 20, 31, 33, 70, 100};
+  const char *err = NULL;
+  uint32_t seed = 77;
+
+  for (size_t p = 0; p < 3 && !err; p++) {
+    bch_ctx *c = NULL;
+    if (bch_ctx_create(params[p][0], params[p][1], &c) != CODECTK_OK) {
+      err = "context creation failed";
+      break;
+    }
+    for (size_t l = 0; l < sizeof(lens) / sizeof(lens[0]) && !err; l++) {
+      size_t msg_bits = lens[l], N = msg_bits + c->r;
+      if (msg_bits >= c->k) continue;
+      uint8_t msg[16], enc[32], dec[2][16];
+      for (size_t i = 0; i < sizeof(msg); i++) {
+        seed = seed * 1103515245u + 12345u;
+        msg[i] = (uint8_t)(seed >> 16);
+      }
+      size_t enc_bits = sizeof(enc) * 8;
+      if (bch_ctx_encode(c, BCH_PAD_SHORTEN, msg, msg_bits, enc, &enc_bits) != CODECTK_OK ||
+          enc_bits != N) {
+        err = "encode failed";
+        break;
+      }
+
+      /* One or two errors at low stream positions, and one at the end */
+      static const size_t pos[][2] = {{0, 0}, {1, 1}, {2, 2}, {5, 5}, {0, 3}, {1, 7}};
+      for (size_t e = 0; e <= sizeof(pos) / sizeof(pos[0]) && !err; e++) {
+        size_t a = e < 6 ? pos[e][0] : N - 1, b = e < 6 ? pos[e][1] : N - 1;
+        enc[a / 8] ^= (uint8_t)(1u << (a % 8));
+        if (b != a) enc[b / 8] ^= (uint8_t)(1u << (b % 8));
+
+        size_t bits[2] = {128, 128}, corr[2] = {0, 0};
+        codectk_err r0 = bch_ctx_decode(c, BCH_PAD_SHORTEN, enc, N, dec[0], &bits[0], &corr[0]);
+        codectk_err r1 = bch_ctx_decode_ct(c, BCH_PAD_SHORTEN, enc, N, dec[1], &bits[1],
+                                           &corr[1]);
+        if (r0 != CODECTK_OK || r1 != r0 || bits[0] != bits[1] || corr[0] != corr[1] ||
+            corr[0] != (b != a ? 2u : 1u) || memcmp(dec[0], dec[1], (bits[0] + 7) / 8) != 0) {
+          err = "constant-time and branching decode differ";
+        }
+
+        enc[a / 8] ^= (uint8_t)(1u << (a % 8));
+        if (b != a) enc[b / 8] ^= (uint8_t)(1u << (b % 8));
+      }
+    }
+    bch_ctx_destroy(c);
+  }
+
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+/**
+ * Fixed parameter sets (CODECTK_FIXED_CODECS) must encode and decode bit
+ * for bit like the generic codec, batches and BCH_FLAG_CT included
+ */
+static void test_bch_fixed_codecs(void) {
+  TEST("BCH fixed codecs match the generic codec");
+
+  const char *err = NULL;
+  uint32_t seed = 9001;
+  int sets = 0;
+
+  if (codectk_get("bch-13-8x") || bch_fixed_codec("bch") || bch_fixed_codec(NULL)) {
+    FAIL("bad name accepted");
+    return;
+  }
+
+  for (unsigned m = 2; m <= 16 && !err; m++) {
+    for (unsigned t = 1; t <= 64 && !err; t++) {
+      char name[32];
+      snprintf(name, sizeof(name), "bch-%u-%u", m, t);
+      const codectk_codec *fixed = codectk_get(name);
+      if (!fixed) continue;
+      sets++;
+
+      bch_ctx *c = NULL;
+      if (strcmp(fixed->name, name) != 0 || bch_fixed_codec(name) != fixed ||
+          bch_ctx_create(m, t, &c) != CODECTK_OK) {
+        err = "lookup or context creation failed";
+        break;
+      }
+
+      /* 40 whole codewords and a shortened one, 0..t+2 errors each */
+      const size_t words = 40;
+      size_t msg_bits = words * c->k + c->k / 3 + 1;
+      size_t enc_cap = (words + 1) * c->n + 64;
+      uint8_t *msg = malloc(msg_bits / 8 + 1);
+      uint8_t *enc[2] = {malloc(enc_cap / 8), malloc(enc_cap / 8)};
+      uint8_t *dec[2] = {malloc(msg_bits / 8 + 8), malloc(msg_bits / 8 + 8)};
+      for (size_t i = 0; i < msg_bits / 8 + 1; i++) {
+        seed = seed * 1103515245u + 12345u;
+        msg[i] = (uint8_t)(seed >> 16);
+      }
+
+      bch_params gp = {.m = m, .t = t};
+      size_t enc_bits[2] = {enc_cap, enc_cap};
+      if (bch_codec()->encode(&gp, msg, msg_bits, enc[0], &enc_bits[0]) != CODECTK_OK ||
+          fixed->encode(NULL, msg, msg_bits, enc[1], &enc_bits[1]) != CODECTK_OK ||
+          enc_bits[0] != enc_bits[1] || memcmp(enc[0], enc[1], (enc_bits[0] + 7) / 8) != 0) {
+        err = "encode differs";
+      }
+
+      for (size_t w = 0; w <= words && !err; w++) {
+        size_t base = w * c->n, len = (w < words) ? c->n : enc_bits[0] - base;
+        for (unsigned e = 0; e < (unsigned)(w % (t + 3)); e++) {
+          seed = seed * 1103515245u + 12345u;
+          size_t bit = base + (seed >> 8) % len;
+          enc[0][bit / 8] ^= (uint8_t)(1u << (bit % 8));
+        }
+      }
+
+      for (unsigned flags = 0; flags <= BCH_FLAG_CT && !err; flags += BCH_FLAG_CT) {
+        bch_params fp = {.t = t, .flags = flags};
+        gp.flags = flags;
+        size_t bits[2] = {msg_bits + 64, msg_bits + 64}, corr[2] = {0, 0};
+        codectk_err r0 = bch_codec()->decode(&gp, enc[0], enc_bits[0], dec[0], &bits[0],
+                                             &corr[0]);
+        codectk_err r1 = fixed->decode(&fp, enc[0], enc_bits[0], dec[1], &bits[1], &corr[1]);
+        if (r0 != r1 || bits[0] != bits[1] || corr[0] != corr[1] ||
+            memcmp(dec[0], dec[1], (bits[0] + 7) / 8) != 0) {
+          err = flags ? "constant-time decode differs" : "decode differs";
+        }
+
+        /* The same stream twice as a batch */
+        codectk_batch_item items[2] = {
+          {enc[0], enc_bits[0], dec[1], msg_bits + 64, 0, CODECTK_OK},
+          {enc[0], enc_bits[0], enc[1], msg_bits + 64, 0, CODECTK_OK}};
+        memset(dec[1], 0xff, msg_bits / 8 + 8);
+        if (!err && (codectk_decode_batch(fixed, &fp, items, 2) != r0 ||
+                     items[0].out_bits != bits[0] || items[1].num_corrected != corr[0] ||
+                     memcmp(dec[0], dec[1], (bits[0] + 7) / 8) != 0 ||
+                     memcmp(dec[0], enc[1], (bits[0] + 7) / 8) != 0)) {
+          err = "batch decode differs";
+        }
+      }
+
+      bch_params bad = {.m = m + 1};
+      size_t bits = msg_bits + 64;
+      if (!err && fixed->decode(&bad, enc[0], enc_bits[0], dec[0], &bits, NULL) !=
+                      CODECTK_EINVAL) {
+        err = "mismatched m accepted";
+      }
+
+      free(msg);
+      free(enc[0]);
+      free(enc[1]);
+      free(dec[0]);
+      free(dec[1]);
+      bch_ctx_destroy(c);
+    }
+  }
+
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  if (!sets) printf("skipped (no CODECTK_FIXED_CODECS) ");
+  PASS();
+}
+
 int test_bch_suite(void) {
   test_count = 0;
   pass_count = 0;
@@ -390,6 +1233,17 @@ int test_bch_suite(void) {
   test_bch_double_error();
   test_bch_patterns();
   test_bch_too_many_errors();
+  test_bch_ctx_reuse();
+  test_bch_multiblock();
+  test_bch_lfsr_tables();
+  test_bch_syndrome_paths();
+  test_bch_chien_paths();
+  test_bch_long_code();
+  test_bch_batch();
+  test_bch_bm_lanes();
+  test_bch_decode_ct();
+  test_bch_decode_ct_short();
+  test_bch_fixed_codecs();
 
   printf("  bch: %d/%d tests passed\n", pass_count, test_count);
   return test_count - pass_count;
@@ -150,6 +150,104 @@ static void test_eof_handling(void) {
   PASS();
 }
 
+static void test_multi_bit_fields(void) {
+  TEST("Multi-bit put/get, peek/skip and byte spans");
+
+  uint8_t buf[1024];
+  uint8_t span[40];
+  uint64_t vals[200];
+  unsigned lens[200];
+  uint32_t seed = 7;
+
+  for (size_t i = 0; i < sizeof(span); i++) span[i] = (uint8_t)(i * 37 + 1);
+
+  bitw_t w;
+  bitw_init(&w, buf, sizeof(buf));
+  size_t total = 0;
+  for (int i = 0; i < 200; i++) {
+    seed = seed * 1103515245u + 12345u;
+    lens[i] = 1 + (seed >> 8) % BITIO_MAX_BITS;
+    vals[i] = ((uint64_t)seed << 32 | (seed * 2654435761u)) & bitio_mask(lens[i]);
+    if (bitw_put_bits(&w, vals[i] | (1ULL << 63), lens[i]) != 0) { /* high junk ignored */
+      FAIL("put_bits failed");
+      return;
+    }
+    total += lens[i];
+    if (i == 100) {
+      /* Unaligned byte span in the middle */
+      bitw_put_bytes(&w, span, sizeof(span));
+      total += 8 * sizeof(span);
+    }
+  }
+  if (bitw_tell(&w) != total) {
+    FAIL("writer position");
+    return;
+  }
+  bitw_flush(&w);
+  /* Aligned span after the flush */
+  if (bitw_put_bytes(&w, span, sizeof(span)) != 0) {
+    FAIL("aligned put_bytes failed");
+    return;
+  }
+  size_t bytes = (size_t)(w.p - buf);
+
+  /* Cross-check the first fields against single-bit reads */
+  bitr_t r;
+  bitr_init(&r, buf, bytes);
+  for (int i = 0; i < 3; i++) {
+    for (unsigned b = 0; b < lens[i]; b++) {
+      if (bitr_get(&r) != (int)((vals[i] >> b) & 1)) {
+        FAIL("bit order mismatch");
+        return;
+      }
+    }
+  }
+
+  for (int i = 3; i < 200; i++) {
+    uint64_t v;
+    if (i % 2) {
+      v = bitr_peek_bits(&r, lens[i]);
+      if (bitr_skip_bits(&r, lens[i]) != 0) v = ~v;
+    } else if (bitr_get_bits(&r, lens[i], &v) != 0) {
+      v = ~vals[i];
+    }
+    if (v != vals[i]) {
+      FAIL("field mismatch");
+      return;
+    }
+    if (i == 100) {
+      uint8_t got[sizeof(span)];
+      if (bitr_get_bytes(&r, got, sizeof(got)) != 0 || memcmp(got, span, sizeof(span)) != 0) {
+        FAIL("unaligned span mismatch");
+        return;
+      }
+    }
+  }
+
+  /* Skip the flush padding, then the aligned span */
+  bitr_skip_bits(&r, (unsigned)((8 - total % 8) % 8));
+  uint8_t got[sizeof(span)];
+  if (bitr_tell(&r) != bytes * 8 - 8 * sizeof(span) ||
+      bitr_get_bytes(&r, got, sizeof(got)) != 0 || memcmp(got, span, sizeof(span)) != 0) {
+    FAIL("aligned span mismatch");
+    return;
+  }
+  if (bitr_bits_left(&r) != 0 || bitr_get(&r) != -1) {
+    FAIL("reader did not end at the end");
+    return;
+  }
+
+  /* Writer capacity: a put that does not fit writes nothing */
+  bitw_init(&w, buf, 2);
+  if (bitw_put_bits(&w, 0x3FF, 10) != 0 || bitw_put_bits(&w, 0x7F, 7) != -1 ||
+      bitw_tell(&w) != 10 || bitw_put_bits(&w, 0x3F, 6) != 0) {
+    FAIL("capacity check");
+    return;
+  }
+
+  PASS();
+}
+
 int test_bitio_suite(void) {
   test_count = 0;
   pass_count = 0;
@@ -158,6 +256,7 @@ int test_bitio_suite(void) {
   test_partial_byte();
   test_multi_byte();
   test_eof_handling();
+  test_multi_bit_fields();
 
   printf("  bitio: %d/%d tests passed\n", pass_count, test_count);
   return test_count - pass_count;
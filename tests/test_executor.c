@@ -0,0 +1,254 @@
+/**
+ * test_executor.c - Tests for the work-stealing executor and the parallel
+ * decode paths that use it
+ */
+
+#include "../include/executor.h"
+#include "../include/bch.h"
+#include "../include/hamming.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int test_count = 0;
+static int pass_count = 0;
+
+#define TEST(name) do { test_count++; printf("  [%d] %s: ", test_count, name); } while (0)
+#define PASS() do { pass_count++; printf("PASS\n"); } while (0)
+#define FAIL(msg) do { printf("FAIL - %s\n", msg); } while (0)
+
+typedef struct {
+  atomic_int *runs;
+  uint64_t *result;
+  unsigned threads;
+  atomic_int bad_worker;
+} count_ctx;
+
+/* Uneven work: every 64th task is about a thousand times dearer */
+static codectk_err count_task(void *ctx, size_t i, unsigned worker) {
+  count_ctx *c = (count_ctx*)ctx;
+  if (worker >= c->threads) atomic_store(&c->bad_worker, 1);
+  atomic_fetch_add(&c->runs[i], 1);
+
+  uint64_t h = i + 1;
+  unsigned rounds = (i % 64 == 0) ? 20000 : 20;
+  for (unsigned r = 0; r < rounds; r++) h = h * 6364136223846793005ULL + 1442695040888963407ULL;
+  c->result[i] = h;
+  return CODECTK_OK;
+}
+
+static void test_executor_runs_all(void) {
+  TEST("every task runs once, results independent of thread count");
+
+  enum { N = 5000 };
+  atomic_int *runs = calloc(N, sizeof(atomic_int));
+  uint64_t *res[2] = {malloc(N * sizeof(uint64_t)), malloc(N * sizeof(uint64_t))};
+  const char *err = NULL;
+
+  for (int pass = 0; pass < 2 && !err; pass++) {
+    unsigned threads = pass ? 4 : 1;
+    codectk_executor *ex = NULL;
+    if (codectk_executor_create(threads, &ex) != CODECTK_OK ||
+        codectk_executor_threads(ex) != threads) {
+      err = "create failed";
+      break;
+    }
+
+    /* Several runs on the same executor, some limited to two threads */
+    for (int rep = 0; rep < 3 && !err; rep++) {
+      for (size_t i = 0; i < N; i++) atomic_init(&runs[i], 0);
+      count_ctx c = {runs, res[pass], threads, 0};
+      if (codectk_executor_run(ex, N, rep == 1 ? 2 : 0, count_task, &c) != CODECTK_OK) {
+        err = "run failed";
+      }
+      for (size_t i = 0; i < N && !err; i++) {
+        if (atomic_load(&runs[i]) != 1) err = "task not run exactly once";
+      }
+      if (!err && atomic_load(&c.bad_worker)) err = "worker index out of range";
+    }
+    codectk_executor_destroy(ex);
+  }
+
+  if (!err && memcmp(res[0], res[1], N * sizeof(uint64_t)) != 0) {
+    err = "results depend on thread count";
+  }
+
+  free(runs);
+  free(res[0]);
+  free(res[1]);
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+typedef struct {
+  codectk_executor *ex;
+  atomic_int done;
+} nest_ctx;
+
+/* Fails at i = 7 (EINVAL) and on some later tasks (EDECODE) */
+static codectk_err failing_task(void *ctx, size_t i, unsigned worker) {
+  (void)worker;
+  nest_ctx *c = (nest_ctx*)ctx;
+  atomic_fetch_add(&c->done, 1);
+  if (i == 7) return CODECTK_EINVAL;
+  return (i % 50 == 13) ? CODECTK_EDECODE : CODECTK_OK;
+}
+
+/* A run from inside a task goes inline on the same thread */
+static codectk_err nested_task(void *ctx, size_t i, unsigned worker) {
+  (void)i;
+  (void)worker;
+  nest_ctx *c = (nest_ctx*)ctx;
+  nest_ctx inner = {c->ex, 0};
+  codectk_err e = codectk_executor_run(c->ex, 10, 0, failing_task, &inner);
+  if (atomic_load(&inner.done) != 10) return CODECTK_ENOMEM;
+  atomic_fetch_add(&c->done, 1);
+  return e;
+}
+
+static void test_executor_errors(void) {
+  TEST("lowest failing task's error, nesting and argument checks");
+
+  codectk_executor *ex = NULL;
+  if (codectk_executor_create(3, &ex) != CODECTK_OK) {
+    FAIL("create failed");
+    return;
+  }
+
+  const char *err = NULL;
+  nest_ctx c = {ex, 0};
+  if (codectk_executor_run(ex, 1000, 0, failing_task, &c) != CODECTK_EINVAL ||
+      atomic_load(&c.done) != 1000) {
+    err = "wrong error or tasks skipped";
+  }
+
+  atomic_store(&c.done, 0);
+  if (!err && (codectk_executor_run(ex, 8, 0, nested_task, &c) != CODECTK_EINVAL ||
+               atomic_load(&c.done) != 8)) {
+    err = "nested run failed";
+  }
+
+  /* NULL executor runs inline; empty runs succeed */
+  atomic_store(&c.done, 0);
+  if (!err && (codectk_executor_run(NULL, 5, 0, failing_task, &c) != CODECTK_OK ||
+               atomic_load(&c.done) != 5 ||
+               codectk_executor_run(ex, 0, 0, failing_task, &c) != CODECTK_OK)) {
+    err = "inline run failed";
+  }
+
+  codectk_executor *bad = NULL;
+  if (!err && (codectk_executor_run(ex, 5, 0, NULL, NULL) != CODECTK_EINVAL ||
+               codectk_executor_create(CODECTK_EXECUTOR_MAX_THREADS + 1, &bad) !=
+                   CODECTK_EINVAL ||
+               bad != NULL || codectk_executor_configure_shared(2) != CODECTK_EINVAL)) {
+    err = "bad arguments accepted";
+  }
+
+  codectk_executor_destroy(ex);
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+/* Long streams take the parallel path when the shared executor has threads */
+static void test_executor_codecs(void) {
+  TEST("parallel BCH and Hamming stream decode match serial decode");
+
+  const char *err = NULL;
+  bch_ctx *bc = NULL;
+  if (bch_ctx_create(8, 4, &bc) != CODECTK_OK) {
+    FAIL("bch_ctx_create failed");
+    return;
+  }
+
+  /* BCH(255,223): 1500 codewords with 0..5 errors each, so some fail */
+  const size_t words = 1500;
+  size_t msg_bits = words * bc->k + 100;
+  size_t enc_cap = (words + 1) * 256 + 64;
+  uint8_t *msg = malloc(msg_bits / 8 + 1);
+  uint8_t *enc = malloc(enc_cap / 8);
+  uint8_t *dec[2] = {malloc(msg_bits / 8 + 8), malloc(msg_bits / 8 + 8)};
+  void *ws = malloc(bch_ctx_workspace_size(bc));
+  uint32_t seed = 99;
+
+  for (size_t i = 0; i < msg_bits / 8 + 1; i++) {
+    seed = seed * 1103515245u + 12345u;
+    msg[i] = (uint8_t)(seed >> 16);
+  }
+
+  size_t enc_bits = enc_cap;
+  if (bch_ctx_encode(bc, BCH_PAD_SHORTEN, msg, msg_bits, enc, &enc_bits) != CODECTK_OK) {
+    err = "encode failed";
+  }
+  for (size_t w = 0; w < words && !err; w++) {
+    for (unsigned e = 0; e < (unsigned)(w * 7 % 6); e++) {
+      size_t pos = w * bc->n + (w * 31 + e * 41) % bc->n;
+      enc[pos / 8] ^= (uint8_t)(1u << (pos % 8));
+    }
+  }
+
+  size_t bits[2] = {msg_bits + 64, msg_bits + 64}, corr[2] = {0, 0};
+  codectk_err r0 = CODECTK_OK, r1 = CODECTK_OK;
+  if (!err) {
+    r0 = bch_ctx_decode(bc, BCH_PAD_SHORTEN, enc, enc_bits, dec[0], &bits[0], &corr[0]);
+    r1 = bch_ctx_decode_ws(bc, BCH_PAD_SHORTEN, enc, enc_bits, dec[1], &bits[1], &corr[1],
+                           ws, bch_ctx_workspace_size(bc));
+    if (r0 != CODECTK_EDECODE || r0 != r1 || bits[0] != msg_bits || bits[1] != msg_bits ||
+        corr[0] != corr[1] || corr[0] == 0 || memcmp(dec[0], dec[1], msg_bits / 8) != 0) {
+      err = "BCH parallel and serial decode differ";
+    }
+  }
+
+  /* Hamming(7,4): enough codewords for several tasks, one error in some */
+  const size_t hbytes = 40000;
+  hamming_params hp = {3};
+  uint8_t *henc = malloc(hbytes * 2 + 16);
+  uint8_t *hdec = malloc(hbytes + 16);
+  size_t henc_bits = (hbytes * 2 + 16) * 8, hdec_bits = (hbytes + 16) * 8, hcorr = 0;
+  if (!err && hamming_codec()->encode(&hp, msg, hbytes * 8, henc, &henc_bits) != CODECTK_OK) {
+    err = "hamming encode failed";
+  }
+  size_t flips = 0;
+  for (size_t cw = 0; !err && cw < hbytes * 2; cw += 97) {
+    size_t pos = cw * 7 + cw % 7;
+    henc[pos / 8] ^= (uint8_t)(1u << (pos % 8));
+    flips++;
+  }
+  if (!err && (hamming_codec()->decode(&hp, henc, henc_bits, hdec, &hdec_bits, &hcorr) !=
+                   CODECTK_OK ||
+               hcorr != flips || memcmp(hdec, msg, hbytes) != 0)) {
+    err = "hamming parallel decode wrong";
+  }
+
+  bch_ctx_destroy(bc);
+  free(msg);
+  free(enc);
+  free(dec[0]);
+  free(dec[1]);
+  free(ws);
+  free(henc);
+  free(hdec);
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+int test_executor_suite(void) {
+  test_count = 0;
+  pass_count = 0;
+
+  test_executor_runs_all();
+  test_executor_errors();
+  test_executor_codecs();
+
+  printf("  executor: %d/%d tests passed\n", pass_count, test_count);
+  return test_count - pass_count;
+}
@@ -4,6 +4,7 @@
 
 #include "../include/gf2.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <assert.h>
 
 static int test_count = 0;
@@ -197,6 +198,137 @@ static void test_mat_row_reduce(void) {
   PASS();
 }
 
+/* Reference: bit-at-a-time Gauss-Jordan on a row-of-bytes copy */
+static size_t rref_ref(uint8_t *a, size_t rows, size_t cols, size_t *pivots) {
+  size_t rank = 0;
+  for (size_t c = 0; c < cols && rank < rows; c++) {
+    size_t p = rank;
+    while (p < rows && !a[p * cols + c]) p++;
+    if (p == rows) continue;
+    for (size_t j = 0; j < cols; j++) {
+      uint8_t t = a[p * cols + j];
+      a[p * cols + j] = a[rank * cols + j];
+      a[rank * cols + j] = t;
+    }
+    for (size_t r = 0; r < rows; r++) {
+      if (r != rank && a[r * cols + c]) {
+        for (size_t j = 0; j < cols; j++) a[r * cols + j] ^= a[rank * cols + j];
+      }
+    }
+    pivots[rank++] = c;
+  }
+  return rank;
+}
+
+static void test_mat_m4ri(void) {
+  TEST("M4RI row reduction matches reference elimination");
+
+  /* Square, wide, tall, rank-deficient (repeated rows) and tiny shapes */
+  static const size_t shapes[][3] = {
+    {3, 5, 0}, {40, 70, 0}, {300, 700, 0}, {700, 300, 0}, {260, 520, 1}, {130, 64, 1}
+  };
+  const char *err = NULL;
+  uint32_t seed = 12345;
+
+  for (size_t si = 0; si < sizeof(shapes) / sizeof(shapes[0]) && !err; si++) {
+    size_t rows = shapes[si][0], cols = shapes[si][1];
+    uint8_t *ref = malloc(rows * cols);
+    size_t *piv = malloc(rows * sizeof(size_t)), *ref_piv = malloc(rows * sizeof(size_t));
+    gf2_mat m;
+    if (!ref || !piv || !ref_piv || gf2_mat_init(&m, rows, cols) != 0) {
+      free(ref);
+      free(piv);
+      free(ref_piv);
+      FAIL("allocation failed");
+      return;
+    }
+
+    for (size_t r = 0; r < rows; r++) {
+      for (size_t c = 0; c < cols; c++) {
+        seed = seed * 1103515245u + 12345u;
+        int bit = (int)(seed >> 31);
+        /* Rank-deficient: odd rows copy the row above */
+        if (shapes[si][2] && (r & 1)) bit = ref[(r - 1) * cols + c];
+        ref[r * cols + c] = (uint8_t)bit;
+        gf2_mat_set(&m, r, c, bit);
+      }
+    }
+
+    size_t want = rref_ref(ref, rows, cols, ref_piv);
+    size_t rank = gf2_mat_row_reduce_pivots(&m, piv);
+    if (rank != want || memcmp(piv, ref_piv, rank * sizeof(size_t)) != 0) {
+      err = "rank or pivots differ";
+    }
+    for (size_t r = 0; r < rows && !err; r++) {
+      for (size_t c = 0; c < cols; c++) {
+        if (gf2_mat_get(&m, r, c) != ref[r * cols + c]) {
+          err = "reduced matrix differs";
+          break;
+        }
+      }
+    }
+
+    gf2_mat_free(&m);
+    free(ref);
+    free(piv);
+    free(ref_piv);
+  }
+
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+static void test_mat_mul(void) {
+  TEST("M4RM matrix product matches bitwise product");
+
+  static const size_t dims[][3] = {{37, 300, 130}, {5, 7, 3}, {64, 40, 700}};
+  const char *err = NULL;
+  uint32_t seed = 777;
+
+  for (size_t di = 0; di < sizeof(dims) / sizeof(dims[0]) && !err; di++) {
+    size_t ar = dims[di][0], ac = dims[di][1], bc = dims[di][2];
+    gf2_mat a, b, c;
+    int ok = gf2_mat_init(&a, ar, ac) == 0;
+    ok = gf2_mat_init(&b, ac, bc) == 0 && ok;
+    ok = gf2_mat_init(&c, ar, bc) == 0 && ok;
+
+    for (size_t i = 0; ok && i < ar * ac; i++) {
+      seed = seed * 1103515245u + 12345u;
+      gf2_mat_set(&a, i / ac, i % ac, (int)(seed >> 31));
+    }
+    for (size_t i = 0; ok && i < ac * bc; i++) {
+      seed = seed * 1103515245u + 12345u;
+      gf2_mat_set(&b, i / bc, i % bc, (int)(seed >> 31));
+    }
+
+    if (!ok || gf2_mat_mul(&c, &a, &b) != 0) err = "multiply failed";
+    for (size_t i = 0; !err && i < ar; i++) {
+      for (size_t j = 0; j < bc; j++) {
+        int v = 0;
+        for (size_t k = 0; k < ac; k++) v ^= gf2_mat_get(&a, i, k) & gf2_mat_get(&b, k, j);
+        if (v != gf2_mat_get(&c, i, j)) {
+          err = "product differs";
+          break;
+        }
+      }
+    }
+    if (!err && gf2_mat_mul(&c, &b, &a) == 0) err = "dimension mismatch accepted";
+
+    gf2_mat_free(&a);
+    gf2_mat_free(&b);
+    gf2_mat_free(&c);
+  }
+
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
 int test_gf2_suite(void) {
   test_count = 0;
   pass_count = 0;
@@ -208,6 +340,8 @@ int test_gf2_suite(void) {
   test_vec_weight();
   test_mat_init_free();
   test_mat_row_reduce();
+  test_mat_m4ri();
+  test_mat_mul();
 
   printf("  gf2: %d/%d tests passed\n", pass_count, test_count);
   return test_count - pass_count;
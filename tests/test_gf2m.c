@@ -3,7 +3,9 @@
  */
 
 #include "../include/gf2m.h"
+#include "../include/gf2m_bs.h"
 #include <stdio.h>
+#include <string.h>
 
 static int test_count = 0;
 static int pass_count = 0;
@@ -118,6 +120,299 @@ static void test_power(void) {
   PASS();
 }
 
+/**
+ * GF(2^16): the x^16 term of the modulus does not fit in 16 bits
+ */
+static void test_m16(void) {
+  TEST("GF(2^16) with implicit x^16 term");
+
+  gf2m_ctx ctx;
+  /* x^16 + x^12 + x^3 + x + 1 */
+  if (gf2m_ctx_init(&ctx, 16, 0x100B) != 0) {
+    FAIL("init failed");
+    return;
+  }
+
+  for (uint32_t a = 1; a < 65536; a += 257) {
+    uint16_t inv_a = gf2m_inv(&ctx, (uint16_t)a);
+    if (gf2m_mul(&ctx, (uint16_t)a, inv_a) != 1) {
+      gf2m_ctx_free(&ctx);
+      FAIL("inverse incorrect");
+      return;
+    }
+  }
+
+  gf2m_ctx_free(&ctx);
+  PASS();
+}
+
+/**
+ * Batch kernels of every backend this CPU supports against scalar gf2m_mul_c
+ */
+static void test_batch_backends(void) {
+  TEST("Batch kernels match scalar multiply on all backends");
+
+  static const char *names[] = {"c", "ssse3", "avx2", "neon"};
+  static const struct { unsigned m; uint16_t poly; } fields[] = {
+    {4, 0x13}, {8, 0x11D}, {13, 0x201B}, {16, 0x100B}
+  };
+  uint16_t a[100], b[100], dst[100], ref[100];
+  uint16_t coeff[9];
+  int ok = 1;
+
+  for (size_t ni = 0; ok && ni < sizeof(names) / sizeof(names[0]); ni++) {
+    if (gf2m_backend_select(names[ni]) != 0) continue;
+
+    for (size_t fi = 0; ok && fi < sizeof(fields) / sizeof(fields[0]); fi++) {
+      gf2m_ctx ctx;
+      if (gf2m_ctx_init(&ctx, fields[fi].m, fields[fi].poly) != 0) {
+        ok = 0;
+        break;
+      }
+      uint16_t mask = (uint16_t)((1u << ctx.m) - 1u);
+      uint32_t seed = 99;
+      for (size_t i = 0; i < 100; i++) {
+        seed = seed * 1103515245u + 12345u;
+        a[i] = (uint16_t)((seed >> 8) & mask);
+        seed = seed * 1103515245u + 12345u;
+        b[i] = (uint16_t)((seed >> 8) & mask);
+      }
+      a[3] = 0;
+      b[5] = 0;
+      for (size_t i = 0; i < 9; i++) coeff[i] = b[i + 10];
+
+      for (size_t len = 0; ok && len <= 100; len += 7) {
+        uint16_t c = a[len % 100] ? a[len % 100] : 1;
+
+        gf2m_mul_scalar(&ctx, dst, a, c, len);
+        for (size_t i = 0; i < len; i++) {
+          if (dst[i] != gf2m_mul_c(&ctx, a[i], c)) ok = 0;
+        }
+
+        memcpy(dst, b, sizeof(b));
+        gf2m_mac_scalar(&ctx, dst, a, c, len);
+        for (size_t i = 0; i < len; i++) {
+          if (dst[i] != (b[i] ^ gf2m_mul_c(&ctx, a[i], c))) ok = 0;
+        }
+
+        gf2m_mul_vec(&ctx, dst, a, b, len);
+        for (size_t i = 0; i < len; i++) {
+          if (dst[i] != gf2m_mul_c(&ctx, a[i], b[i])) ok = 0;
+        }
+
+        gf2m_poly_eval_multi(&ctx, coeff, 8, a, dst, len);
+        gf2m_poly_eval_multi_c(&ctx, coeff, 8, a, ref, len);
+        if (len && memcmp(dst, ref, len * sizeof(uint16_t)) != 0) ok = 0;
+      }
+
+      gf2m_ctx_free(&ctx);
+    }
+  }
+
+  gf2m_backend_select(NULL);
+
+  if (!ok) {
+    FAIL("batch kernel mismatch");
+    return;
+  }
+  PASS();
+}
+
+/* Bitwise carry-less multiply mod poly, independent of the tables */
+static uint16_t ref_mul(uint16_t a, uint16_t b, uint16_t poly, unsigned m) {
+  uint32_t r = 0;
+  uint32_t x = a;
+  for (unsigned i = 0; i < m; i++) {
+    if (((unsigned)b >> i) & 1u) r ^= x;
+    x <<= 1;
+    if (x & (1u << m)) x ^= (uint32_t)poly | (1u << m);
+  }
+  return (uint16_t)r;
+}
+
+/**
+ * Doubled antilog, squaring and product tables against a bitwise multiply
+ */
+static void test_tables(void) {
+  TEST("Branch-free multiply, squaring and product tables");
+
+  gf2m_ctx ctx;
+  if (gf2m_ctx_init_ex(&ctx, 8, 0x11D, GF2M_TABLE_SQR | GF2M_TABLE_MUL) != 0 ||
+      ctx.flags != (GF2M_TABLE_SQR | GF2M_TABLE_MUL)) {
+    FAIL("init failed");
+    return;
+  }
+
+  for (unsigned a = 0; a < 256; a++) {
+    for (unsigned b = 0; b < 256; b++) {
+      uint16_t r = ref_mul((uint16_t)a, (uint16_t)b, 0x11D, 8);
+      if (gf2m_mul_fast(&ctx, (uint16_t)a, (uint16_t)b) != r ||
+          gf2m_mul_tab(&ctx, (uint16_t)a, (uint16_t)b) != r) {
+        gf2m_ctx_free(&ctx);
+        FAIL("product mismatch");
+        return;
+      }
+    }
+    if (gf2m_sqr_tab(&ctx, (uint16_t)a) != ref_mul((uint16_t)a, (uint16_t)a, 0x11D, 8)) {
+      gf2m_ctx_free(&ctx);
+      FAIL("square mismatch");
+      return;
+    }
+  }
+  gf2m_ctx_free(&ctx);
+
+  /* The product table is skipped above m = 8 */
+  if (gf2m_ctx_init_ex(&ctx, 13, 0x201B, GF2M_TABLE_MUL) != 0 ||
+      ctx.mul != NULL || ctx.sqr != NULL) {
+    gf2m_ctx_free(&ctx);
+    FAIL("unexpected tables for m = 13");
+    return;
+  }
+  for (uint32_t a = 0; a < 8192; a += 3) {
+    uint16_t b = (uint16_t)((a * 2654435761u) >> 19);
+    if (gf2m_mul_fast(&ctx, (uint16_t)a, b) != ref_mul((uint16_t)a, b, 0x201B, 13) ||
+        gf2m_sqr(&ctx, (uint16_t)a) != ref_mul((uint16_t)a, (uint16_t)a, 0x201B, 13)) {
+      gf2m_ctx_free(&ctx);
+      FAIL("m = 13 product mismatch");
+      return;
+    }
+  }
+
+  gf2m_ctx_free(&ctx);
+  PASS();
+}
+
+/**
+ * Shared context registry: one instance per (m, mod_poly), same tables as
+ * a private context
+ */
+/* Bitsliced multiply, square and public-constant multiply against ref_mul() */
+static void test_bitsliced(void) {
+  TEST("Bitsliced arithmetic matches a bitwise multiply in every lane");
+
+  static const struct { unsigned m; uint16_t poly; } fields[] = {
+    {2, 0x7}, {4, 0x13}, {8, 0x11D}, {12, 0x1053}, {13, 0x201B}, {16, 0x100B}
+  };
+  uint16_t a[64], b[64], out[64];
+  uint32_t seed = 7;
+  const char *err = NULL;
+
+  /* Transpose: bit j of word i goes to bit i of word j */
+  uint64_t mat[64], orig[64];
+  for (unsigned i = 0; i < 64; i++) {
+    seed = seed * 1103515245u + 12345u;
+    orig[i] = mat[i] = ((uint64_t)seed << 32) ^ (seed * 2654435761u);
+  }
+  gf2m_bs_transpose64(mat);
+  for (unsigned i = 0; i < 64 && !err; i++) {
+    for (unsigned j = 0; j < 64; j++) {
+      if (((mat[i] >> j) & 1) != ((orig[j] >> i) & 1)) err = "transpose wrong";
+    }
+  }
+
+  for (size_t fi = 0; fi < sizeof(fields) / sizeof(fields[0]) && !err; fi++) {
+    gf2m_ctx ctx;
+    if (gf2m_ctx_init(&ctx, fields[fi].m, fields[fi].poly) != 0) {
+      err = "init failed";
+      break;
+    }
+    uint16_t mask = (uint16_t)((1u << ctx.m) - 1u), poly = (uint16_t)(fields[fi].poly & mask);
+    for (int rep = 0; rep < 8 && !err; rep++) {
+      for (unsigned w = 0; w < 64; w++) {
+        seed = seed * 1103515245u + 12345u;
+        a[w] = (uint16_t)((seed >> 8) & mask);
+        seed = seed * 1103515245u + 12345u;
+        b[w] = (uint16_t)((seed >> 8) & mask);
+      }
+      a[rep] = 0;
+      b[rep + 8] = mask;
+
+      gf2m_bs x, y, r;
+      gf2m_bs_pack(&x, a);
+      gf2m_bs_pack(&y, b);
+      gf2m_bs_mul(&ctx, &r, &x, &y);
+      gf2m_bs_unpack(&r, out);
+      for (unsigned w = 0; w < 64; w++) {
+        if (out[w] != ref_mul(a[w], b[w], poly, ctx.m)) err = "mul wrong";
+      }
+
+      gf2m_bs_sqr(&ctx, &r, &x);
+      gf2m_bs_unpack(&r, out);
+      for (unsigned w = 0; w < 64; w++) {
+        if (out[w] != ref_mul(a[w], a[w], poly, ctx.m)) err = "sqr wrong";
+      }
+
+      /* In place, with the constant b[rep] */
+      r = x;
+      gf2m_bs_mul_pub(&ctx, &r, &r, b[rep]);
+      gf2m_bs_unpack(&r, out);
+      for (unsigned w = 0; w < 64; w++) {
+        if (out[w] != ref_mul(a[w], b[rep], poly, ctx.m)) err = "mul_pub wrong";
+      }
+
+      gf2m_bs_set1(&r, b[rep]);
+      gf2m_bs_unpack(&r, out);
+      uint64_t nz = gf2m_bs_nonzero(&x);
+      for (unsigned w = 0; w < 64; w++) {
+        if (out[w] != b[rep] || ((nz >> w) & 1) != (uint64_t)(a[w] != 0)) {
+          err = "set1 or nonzero wrong";
+        }
+      }
+    }
+    gf2m_ctx_free(&ctx);
+  }
+
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+static void test_shared_ctx(void) {
+  TEST("Shared field context registry");
+
+  const gf2m_ctx *a = gf2m_ctx_get(8, 0);
+  const gf2m_ctx *b = gf2m_ctx_get(8, gf2m_default_poly(8));
+  if (!a || a != b || a->m != 8 || a->mod_poly != 0x11D) {
+    FAIL("default GF(2^8) not shared");
+    return;
+  }
+
+  /* Same field under a different primitive polynomial is a separate entry */
+  const gf2m_ctx *aes = gf2m_ctx_get(8, 0x12B);
+  if (!aes || aes == a || gf2m_ctx_get(8, 0x12B) != aes) {
+    FAIL("(m, mod_poly) keying");
+    return;
+  }
+
+  if (gf2m_ctx_get(1, 0) != NULL || gf2m_ctx_get(17, 0) != NULL ||
+      gf2m_ctx_get(4, 0x1F) != NULL) {
+    FAIL("invalid parameters accepted");
+    return;
+  }
+
+  for (unsigned m = 2; m <= 16; m++) {
+    const gf2m_ctx *s = gf2m_ctx_get(m, 0);
+    gf2m_ctx ref;
+    if (!s || gf2m_ctx_init(&ref, m, gf2m_default_poly(m)) != 0) {
+      FAIL("context build failed");
+      return;
+    }
+    size_t size = (size_t)1 << m;
+    int same = memcmp(s->alog, ref.alog, 2 * (size - 1) * sizeof(uint16_t)) == 0 &&
+               memcmp(s->log, ref.log, size * sizeof(uint16_t)) == 0 &&
+               s->sqr && memcmp(s->sqr, ref.sqr, size * sizeof(uint16_t)) == 0;
+    gf2m_ctx_free(&ref);
+    if (!same) {
+      FAIL("shared tables differ from gf2m_ctx_init");
+      return;
+    }
+  }
+
+  PASS();
+}
+
 int test_gf2m_suite(void) {
   test_count = 0;
   pass_count = 0;
@@ -126,6 +421,11 @@ int test_gf2m_suite(void) {
   test_field_axioms();
   test_inverse();
   test_power();
+  test_m16();
+  test_tables();
+  test_shared_ctx();
+  test_batch_backends();
+  test_bitsliced();
 
   printf("  gf2m: %d/%d tests passed\n", pass_count, test_count);
   return test_count - pass_count;
@@ -0,0 +1,538 @@
+/**
+ * test_goppa.c - Tests for Goppa codes
+ */
+
+#include "../include/goppa.h"
+#include "../include/codectk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int test_count = 0;
+static int pass_count = 0;
+
+#define TEST(name) do { test_count++; printf("  [%d] %s: ", test_count, name); } while (0)
+#define PASS() do { pass_count++; printf("PASS\n"); } while (0)
+#define FAIL(msg) do { printf("FAIL - %s\n", msg); } while (0)
+
+static uint32_t next_rand(uint32_t *seed) {
+  *seed = *seed * 1103515245u + 12345u;
+  return *seed >> 16;
+}
+
+static uint16_t eval(const gf2m_ctx *f, const uint16_t *g, unsigned t, uint16_t x) {
+  uint16_t y = 0;
+  for (unsigned i = t + 1; i-- > 0;) y = gf2m_add(gf2m_mul(f, y, x), g[i]);
+  return y;
+}
+
+/**
+ * Random monic g of degree t and a support of n shuffled field elements
+ * that are not roots of g. Returns 0 if too few such elements exist.
+ */
+static int make_code(goppa_params *P, uint16_t *g, uint16_t *L, unsigned m, unsigned t,
+                     size_t n, uint32_t seed) {
+  const gf2m_ctx *f = gf2m_ctx_get(m, 0);
+  for (unsigned i = 0; i < t; i++) g[i] = (uint16_t)(next_rand(&seed) & ((1u << m) - 1));
+  g[t] = 1;
+
+  size_t have = 0;
+  for (uint32_t x = 0; x < (1u << m); x++) {
+    if (eval(f, g, t, (uint16_t)x) != 0) L[have++] = (uint16_t)x;
+  }
+  if (have < n) return 0;
+  for (size_t i = have - 1; i > 0; i--) {
+    size_t j = next_rand(&seed) % (i + 1);
+    uint16_t tmp = L[i];
+    L[i] = L[j];
+    L[j] = tmp;
+  }
+
+  memset(P, 0, sizeof(*P));
+  P->m = m;
+  P->t = t;
+  P->n = n;
+  P->L = L;
+  P->g = g;
+  return 1;
+}
+
+/* Parity checks: sum of c_i L_i^j / g(L_i) over the set bits is 0, j < t */
+static int is_codeword(const goppa_params *P, const uint8_t *c) {
+  const gf2m_ctx *f = gf2m_ctx_get(P->m, 0);
+  for (unsigned j = 0; j < P->t; j++) {
+    uint16_t s = 0;
+    for (size_t i = 0; i < P->n; i++) {
+      if ((c[i / 8] >> (i % 8)) & 1) {
+        uint16_t v = gf2m_mul(f, gf2m_pow(f, P->L[i], j),
+                              gf2m_inv(f, eval(f, P->g, P->t, P->L[i])));
+        s = gf2m_add(s, v);
+      }
+    }
+    if (s != 0) return 0;
+  }
+  return 1;
+}
+
+static void test_goppa_encode(void) {
+  TEST("systematic encode gives codewords for several (m, t, n)");
+
+  static const struct { unsigned m, t; size_t n; } codes[] = {
+    {4, 2, 12}, {6, 3, 50}, {8, 4, 200}, {10, 6, 1000}
+  };
+  static uint16_t g[8], L[1024];
+  uint8_t msg[128], enc[128], enc2[128];
+  const char *err = NULL;
+  uint32_t seed = 7;
+
+  for (size_t c = 0; c < sizeof(codes) / sizeof(codes[0]) && !err; c++) {
+    goppa_params P;
+    goppa_ctx *ctx = NULL;
+    if (!make_code(&P, g, L, codes[c].m, codes[c].t, codes[c].n, (uint32_t)c + 1) ||
+        goppa_ctx_create(&P, &ctx) != CODECTK_OK) {
+      err = "create failed";
+      break;
+    }
+    if (ctx->n != P.n || ctx->r > P.m * P.t || ctx->k != P.n - ctx->r) err = "bad dimensions";
+
+    for (int rep = 0; rep < 20 && !err; rep++) {
+      for (size_t i = 0; i < sizeof(msg); i++) msg[i] = (uint8_t)next_rand(&seed);
+      size_t bits = sizeof(enc) * 8, bits2 = sizeof(enc2) * 8;
+      if (goppa_ctx_encode(ctx, msg, ctx->k, enc, &bits) != CODECTK_OK || bits != P.n) {
+        err = "encode failed";
+        break;
+      }
+      if (!is_codeword(&P, enc)) err = "not a codeword";
+
+      /* Message bits come out unchanged, at their positions */
+      for (size_t i = 0; i < ctx->k && !err; i++) {
+        size_t p = ctx->pos ? ctx->pos[i] : i;
+        if (((enc[p / 8] >> (p % 8)) & 1) != ((msg[i / 8] >> (i % 8)) & 1)) {
+          err = "message bits not systematic";
+        }
+      }
+
+      /* The codec entry point builds its own context */
+      if (!err && (goppa_codec()->encode(&P, msg, ctx->k, enc2, &bits2) != CODECTK_OK ||
+                   bits2 != P.n || memcmp(enc, enc2, (P.n + 7) / 8) != 0)) {
+        err = "codec encode differs";
+      }
+      P.ctx = ctx;
+      bits2 = sizeof(enc2) * 8;
+      if (!err && (goppa_codec()->encode(&P, msg, ctx->k, enc2, &bits2) != CODECTK_OK ||
+                   memcmp(enc, enc2, (P.n + 7) / 8) != 0)) {
+        err = "encode with P->ctx differs";
+      }
+      P.ctx = NULL;
+    }
+    goppa_ctx_destroy(ctx);
+  }
+
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+static void test_goppa_batch(void) {
+  TEST("batch encode matches single encode, per-item errors");
+
+  static uint16_t g[8], L[256];
+  goppa_params P;
+  goppa_ctx *ctx = NULL;
+  if (!make_code(&P, g, L, 8, 5, 240, 3) || goppa_ctx_create(&P, &ctx) != CODECTK_OK) {
+    FAIL("create failed");
+    return;
+  }
+
+  /* More than one run of stacked messages, one short and one invalid item */
+  enum { COUNT = 600, BYTES = 32 };
+  uint8_t *msg = malloc(COUNT * BYTES);
+  uint8_t *out = malloc(COUNT * BYTES);
+  uint8_t one[BYTES];
+  codectk_batch_item *items = calloc(COUNT, sizeof(codectk_batch_item));
+  uint32_t seed = 11;
+  const char *err = NULL;
+
+  for (size_t i = 0; i < COUNT * BYTES; i++) msg[i] = (uint8_t)next_rand(&seed);
+  for (size_t i = 0; i < COUNT; i++) {
+    items[i].in = msg + i * BYTES;
+    items[i].in_bits = (i == 5) ? 17 : ctx->k;
+    items[i].out = out + i * BYTES;
+    items[i].out_bits = BYTES * 8;
+  }
+  items[300].in_bits = ctx->k + 1;
+
+  if (goppa_ctx_encode_batch(ctx, items, COUNT) != CODECTK_EINVAL) err = "wrong batch result";
+  for (size_t i = 0; i < COUNT && !err; i++) {
+    size_t bits = sizeof(one) * 8;
+    codectk_err e = goppa_ctx_encode(ctx, items[i].in, items[i].in_bits, one, &bits);
+    if (e != items[i].err) {
+      err = "item error differs";
+    } else if (e == CODECTK_OK &&
+               (items[i].out_bits != P.n || memcmp(one, items[i].out, (P.n + 7) / 8) != 0)) {
+      err = "batch codeword differs";
+    }
+  }
+
+  /* Through the codec table, without a context */
+  for (size_t i = 0; i < COUNT; i++) items[i].out_bits = BYTES * 8;
+  items[300].in_bits = ctx->k;
+  if (!err && (goppa_codec()->encode_batch(&P, items, COUNT) != CODECTK_OK ||
+               !is_codeword(&P, items[300].out))) {
+    err = "codec batch encode failed";
+  }
+
+  goppa_ctx_destroy(ctx);
+  free(msg);
+  free(out);
+  free(items);
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+static void test_goppa_invalid(void) {
+  TEST("invalid parameters and buffers rejected");
+
+  static uint16_t g[8], L[64];
+  goppa_params P;
+  goppa_ctx *ctx = NULL;
+  const char *err = NULL;
+  if (!make_code(&P, g, L, 6, 3, 40, 5)) {
+    FAIL("setup failed");
+    return;
+  }
+
+  uint16_t saved = L[1];
+  L[1] = L[0];
+  if (goppa_ctx_create(&P, &ctx) != CODECTK_EINVAL || ctx) err = "repeated support element";
+  L[1] = saved;
+
+  P.n = 18;
+  if (!err && goppa_ctx_create(&P, &ctx) != CODECTK_EINVAL) err = "n <= m*t accepted";
+  P.n = 40;
+
+  g[3] = 0;
+  if (!err && goppa_ctx_create(&P, &ctx) != CODECTK_EINVAL) err = "deg g < t accepted";
+  g[3] = 1;
+
+  /* Make L[0] a root of g */
+  const gf2m_ctx *f = gf2m_ctx_get(6, 0);
+  uint16_t g0 = g[0];
+  g[0] = gf2m_add(g[0], eval(f, g, 3, L[0]));
+  if (!err && goppa_ctx_create(&P, &ctx) != CODECTK_EINVAL) err = "root of g in support";
+  g[0] = g0;
+
+  uint8_t msg[8] = {0}, out[8];
+  size_t bits = 8;
+  if (!err && goppa_ctx_create(&P, &ctx) != CODECTK_OK) err = "valid code rejected";
+  if (!err && goppa_ctx_encode(ctx, msg, ctx->k, out, &bits) != CODECTK_ENOMEM) {
+    err = "small output accepted";
+  }
+  bits = sizeof(out) * 8;
+  if (!err && goppa_ctx_encode(ctx, msg, ctx->k + 1, out, &bits) != CODECTK_EINVAL) {
+    err = "long message accepted";
+  }
+
+  goppa_ctx_destroy(ctx);
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+/* make_code() with g redrawn until it is irreducible; returns the context */
+static goppa_ctx *make_decodable(goppa_params *P, uint16_t *g, uint16_t *L, unsigned m,
+                                 unsigned t, size_t n, uint32_t seed) {
+  for (int tries = 0; tries < 1000; tries++) {
+    goppa_ctx *ctx = NULL;
+    if (make_code(P, g, L, m, t, n, seed + (uint32_t)tries * 7919u) &&
+        goppa_ctx_create(P, &ctx) == CODECTK_OK) {
+      if (ctx->sqrt_x) return ctx;
+      goppa_ctx_destroy(ctx);
+    }
+  }
+  return NULL;
+}
+
+static void test_goppa_irreducible(void) {
+  TEST("decoding tables only for irreducible g (degree 2 and 3 by roots)");
+
+  static uint16_t g[4], L[16];
+  const gf2m_ctx *f = gf2m_ctx_get(4, 0);
+  const char *err = NULL;
+
+  for (unsigned t = 2; t <= 3 && !err; t++) {
+    for (uint32_t seed = 1; seed < 60 && !err; seed++) {
+      goppa_params P;
+      if (!make_code(&P, g, L, 4, t, 13, seed)) continue;
+      int roots = 0;
+      for (unsigned x = 0; x < 16; x++) roots += eval(f, g, t, (uint16_t)x) == 0;
+
+      goppa_ctx *ctx = NULL;
+      uint8_t in[2] = {0}, out[2];
+      size_t bits = 16;
+      if (goppa_ctx_create(&P, &ctx) != CODECTK_OK) {
+        err = "create failed";
+      } else if ((ctx->sqrt_x != NULL) != (roots == 0)) {
+        err = "irreducibility misjudged";
+      } else if (roots && goppa_ctx_decode(ctx, in, 13, out, &bits, NULL) != CODECTK_ENOTSUP) {
+        err = "reducible g decoded";
+      }
+      goppa_ctx_destroy(ctx);
+    }
+  }
+
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+static void test_goppa_decode(void) {
+  TEST("Patterson decode corrects up to t errors");
+
+  static const struct { unsigned m, t; size_t n; } codes[] = {
+    {4, 1, 15}, {5, 3, 32}, {6, 4, 60}, {8, 7, 256}, {10, 10, 1000}, {12, 16, 2048}
+  };
+  static uint16_t g[32], L[4096];
+  static uint8_t msg[512], enc[512], dec[512];
+  const char *err = NULL;
+  uint32_t seed = 21;
+
+  for (size_t c = 0; c < sizeof(codes) / sizeof(codes[0]) && !err; c++) {
+    goppa_params P;
+    goppa_ctx *ctx = make_decodable(&P, g, L, codes[c].m, codes[c].t, codes[c].n,
+                                    (uint32_t)c * 31u + 5u);
+    if (!ctx) {
+      err = "no irreducible g found";
+      break;
+    }
+    size_t need = goppa_ctx_workspace_size(ctx);
+    void *ws = malloc(need);
+
+    for (unsigned e = 0; e <= ctx->t && !err; e++) {
+      for (int rep = 0; rep < 4 && !err; rep++) {
+        for (size_t i = 0; i < sizeof(msg); i++) msg[i] = (uint8_t)next_rand(&seed);
+        size_t bits = sizeof(enc) * 8;
+        if (goppa_ctx_encode(ctx, msg, ctx->k, enc, &bits) != CODECTK_OK) {
+          err = "encode failed";
+          break;
+        }
+
+        /* e distinct error positions */
+        uint8_t hit[512] = {0};
+        for (unsigned i = 0; i < e;) {
+          size_t p = next_rand(&seed) % ctx->n;
+          if ((hit[p / 8] >> (p % 8)) & 1) continue;
+          hit[p / 8] |= (uint8_t)(1u << (p % 8));
+          enc[p / 8] ^= (uint8_t)(1u << (p % 8));
+          i++;
+        }
+
+        size_t dbits = sizeof(dec) * 8, corr = 99;
+        codectk_err r = (rep == 2)
+            ? goppa_ctx_decode_ws(ctx, enc, ctx->n, dec, &dbits, &corr, ws, need)
+            : goppa_ctx_decode(ctx, enc, ctx->n, dec, &dbits, &corr);
+        if (r != CODECTK_OK || dbits != ctx->k || corr != e ||
+            memcmp(dec, msg, ctx->k / 8) != 0 ||
+            (ctx->k % 8 && ((dec[ctx->k / 8] ^ msg[ctx->k / 8]) &
+                            ((1u << (ctx->k % 8)) - 1)) != 0)) {
+          err = "wrong decode";
+        }
+      }
+    }
+    free(ws);
+    goppa_ctx_destroy(ctx);
+  }
+
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+static void test_goppa_decode_codec(void) {
+  TEST("codec decode and batch decode, too many errors reported");
+
+  static uint16_t g[8], L[256];
+  goppa_params P;
+  goppa_ctx *ctx = make_decodable(&P, g, L, 8, 6, 250, 17);
+  if (!ctx) {
+    FAIL("no irreducible g found");
+    return;
+  }
+
+  enum { COUNT = 40, BYTES = 32 };
+  uint8_t *msg = malloc(COUNT * BYTES), *enc = malloc(COUNT * BYTES);
+  uint8_t *dec = malloc(COUNT * BYTES), one[BYTES];
+  codectk_batch_item *items = calloc(COUNT, sizeof(codectk_batch_item));
+  uint32_t seed = 5;
+  const char *err = NULL;
+
+  for (size_t i = 0; i < COUNT * BYTES; i++) msg[i] = (uint8_t)next_rand(&seed);
+  for (size_t i = 0; i < COUNT && !err; i++) {
+    size_t bits = BYTES * 8;
+    if (goppa_ctx_encode(ctx, msg + i * BYTES, ctx->k, enc + i * BYTES, &bits) !=
+        CODECTK_OK) {
+      err = "encode failed";
+    }
+    /* i % 9 errors: the items with more than t = 6 need not decode */
+    for (size_t e = 0; e < i % 9; e++) {
+      size_t p = (i * 37 + e * 53) % ctx->n;
+      enc[i * BYTES + p / 8] ^= (uint8_t)(1u << (p % 8));
+    }
+    items[i].in = enc + i * BYTES;
+    items[i].in_bits = ctx->n;
+    items[i].out = dec + i * BYTES;
+    items[i].out_bits = BYTES * 8;
+  }
+
+  if (!err) goppa_codec()->decode_batch(&P, items, COUNT);
+  for (size_t i = 0; i < COUNT && !err; i++) {
+    size_t bits = BYTES * 8, corr = 0;
+    P.ctx = (i & 1) ? ctx : NULL;
+    codectk_err r = goppa_codec()->decode(&P, items[i].in, ctx->n, one, &bits, &corr);
+    if (r != items[i].err || bits != items[i].out_bits || corr != items[i].num_corrected ||
+        memcmp(one, items[i].out, (bits + 7) / 8) != 0) {
+      err = "batch and single decode differ";
+    } else if (i % 9 <= 6 && (r != CODECTK_OK || corr != i % 9 ||
+                              memcmp(one, msg + i * BYTES, ctx->k / 8) != 0)) {
+      err = "correctable item not corrected";
+    } else if (r == CODECTK_EDECODE && corr != 0) {
+      err = "failed item reports corrections";
+    }
+  }
+
+  goppa_ctx_destroy(ctx);
+  free(msg);
+  free(enc);
+  free(dec);
+  free(items);
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+static void test_goppa_decode_ct(void) {
+  TEST("constant-time batch decode agrees with Patterson, beyond t errors too");
+
+  static const struct { unsigned m, t; size_t n; } codes[] = {
+    {4, 1, 15}, {5, 3, 32}, {8, 7, 256}, {10, 10, 1000}
+  };
+  enum { COUNT = 70, BYTES = 128 };
+  static uint16_t g[16], L[1024];
+  uint8_t *msg = malloc(COUNT * BYTES), *enc = malloc(COUNT * BYTES);
+  uint8_t *dec = malloc(COUNT * BYTES), one[BYTES];
+  codectk_batch_item items[COUNT];
+  uint32_t seed = 77;
+  const char *err = NULL;
+
+  for (size_t c = 0; c < sizeof(codes) / sizeof(codes[0]) && !err; c++) {
+    goppa_params P;
+    goppa_ctx *plain = make_decodable(&P, g, L, codes[c].m, codes[c].t, codes[c].n,
+                                      (uint32_t)c * 13u + 3u);
+    goppa_ctx *ctx = NULL;
+    P.flags = GOPPA_FLAG_CT;
+    if (!plain || goppa_ctx_create(&P, &ctx) != CODECTK_OK) {
+      err = "create failed";
+      goppa_ctx_destroy(plain);
+      break;
+    }
+    unsigned t = ctx->t;
+
+    /* Word i has i % (t + 3) errors; item 5 is too short */
+    for (size_t i = 0; i < COUNT && !err; i++) {
+      for (size_t b = 0; b < BYTES; b++) msg[i * BYTES + b] = (uint8_t)next_rand(&seed);
+      size_t bits = BYTES * 8;
+      if (goppa_ctx_encode(ctx, msg + i * BYTES, ctx->k, enc + i * BYTES, &bits) !=
+          CODECTK_OK) {
+        err = "encode failed";
+      }
+      uint8_t hit[BYTES] = {0};
+      for (unsigned e = 0; e < i % (t + 3);) {
+        size_t p = next_rand(&seed) % ctx->n;
+        if ((hit[p / 8] >> (p % 8)) & 1) continue;
+        hit[p / 8] |= (uint8_t)(1u << (p % 8));
+        enc[i * BYTES + p / 8] ^= (uint8_t)(1u << (p % 8));
+        e++;
+      }
+      items[i] = (codectk_batch_item){enc + i * BYTES, i == 5 ? ctx->n - 1 : ctx->n,
+                                      dec + i * BYTES, BYTES * 8, 99, CODECTK_OK};
+    }
+
+    codectk_batch_item probe = items[0];
+    codectk_err first = CODECTK_OK;
+    codectk_err r = err ? CODECTK_OK : goppa_ctx_decode_ct_batch(ctx, items, COUNT);
+    for (size_t i = 0; i < COUNT && first == CODECTK_OK; i++) first = items[i].err;
+    if (!err && (goppa_ctx_decode_ct_batch(plain, &probe, 1) != CODECTK_ENOTSUP ||
+                 r != first || items[5].err != CODECTK_EINVAL)) {
+      err = "wrong batch result";
+    }
+
+    for (size_t i = 0; i < COUNT && !err; i++) {
+      if (i == 5) continue;
+      size_t bits = BYTES * 8, corr = 0;
+      codectk_err r = goppa_ctx_decode(ctx, enc + i * BYTES, ctx->n, one, &bits, &corr);
+      unsigned e = (unsigned)(i % (t + 3));
+      const codectk_batch_item *it = &items[i];
+
+      /* Within t errors both decode; beyond, a constant-time success is a
+       * true codeword, which Patterson finds as well */
+      if (e <= t && (it->err != CODECTK_OK || it->num_corrected != e ||
+                     memcmp(it->out, msg + i * BYTES, ctx->k / 8) != 0)) {
+        err = "correctable word not corrected";
+      } else if (it->out_bits != ctx->k ||
+                 (it->err == CODECTK_OK && (r != CODECTK_OK || corr != it->num_corrected)) ||
+                 (it->err == CODECTK_EDECODE && it->num_corrected != 0) ||
+                 (r == it->err && memcmp(one, it->out, ctx->k / 8) != 0)) {
+        err = "constant-time and Patterson decode differ";
+      }
+    }
+
+    /* The codec takes the constant-time path for such a context */
+    size_t bits = BYTES * 8, corr = 0;
+    P.ctx = ctx;
+    if (!err && (goppa_codec()->decode(&P, items[1].in, ctx->n, one, &bits, &corr) !=
+                     CODECTK_OK ||
+                 corr != 1 || memcmp(one, msg + BYTES, ctx->k / 8) != 0)) {
+      err = "codec decode wrong";
+    }
+    goppa_ctx_destroy(plain);
+    goppa_ctx_destroy(ctx);
+  }
+
+  free(msg);
+  free(enc);
+  free(dec);
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+int test_goppa_suite(void) {
+  test_count = 0;
+  pass_count = 0;
+
+  test_goppa_encode();
+  test_goppa_batch();
+  test_goppa_invalid();
+  test_goppa_irreducible();
+  test_goppa_decode();
+  test_goppa_decode_codec();
+  test_goppa_decode_ct();
+
+  printf("  goppa: %d/%d tests passed\n", pass_count, test_count);
+  return test_count - pass_count;
+}
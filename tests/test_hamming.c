@@ -146,6 +146,143 @@ static void test_hamming_multiple_codes(void) {
   PASS();
 }
 
+/* Positional reference: data fills the non-power-of-two positions in order,
+ * parity bit j makes the XOR of bit j over all set positions zero */
+static uint64_t ref_encode(uint64_t data, unsigned m) {
+  unsigned n = (1u << m) - 1;
+  uint64_t cw = 0;
+  unsigned di = 0, s = 0;
+  for (unsigned pos = 1; pos <= n; pos++) {
+    if ((pos & (pos - 1)) == 0) continue;
+    if ((data >> di++) & 1u) {
+      cw |= 1ull << (pos - 1);
+      s ^= pos;
+    }
+  }
+  for (unsigned j = 0; j < m; j++) {
+    if ((s >> j) & 1u) cw |= 1ull << ((1u << j) - 1);
+  }
+  return cw;
+}
+
+static void test_hamming_stream(void) {
+  TEST("Multi-block streams against reference, one error per block");
+
+  const codectk_codec *codec = hamming_codec();
+  uint8_t input[64], encoded[256], decoded[128];
+  uint32_t seed = 12345;
+  for (size_t i = 0; i < sizeof(input); i++) {
+    seed = seed * 1103515245u + 12345u;
+    input[i] = (uint8_t)(seed >> 16);
+  }
+
+  for (unsigned m = 2; m <= HAMMING_MAX_M; m++) {
+    hamming_params params = {.m = m};
+    unsigned n = (1u << m) - 1;
+    unsigned k = n - m;
+    size_t in_bits = sizeof(input) * 8 - 3; /* leaves a partial block */
+    size_t blocks = (in_bits + k - 1) / k;  /* the last one zero-filled */
+
+    size_t encoded_bits = sizeof(encoded) * 8;
+    if (codec->encode(&params, input, in_bits, encoded, &encoded_bits) != CODECTK_OK ||
+        encoded_bits != (blocks * n + 7) / 8 * 8) {
+      FAIL("encode failed");
+      return;
+    }
+
+    for (size_t b = 0; b < blocks; b++) {
+      uint64_t data = 0, cw = 0;
+      for (unsigned i = 0; i < k; i++) {
+        size_t bit = b * k + i;
+        if (bit >= in_bits) break;
+        data |= (uint64_t)((input[bit / 8] >> (bit % 8)) & 1) << i;
+      }
+      for (unsigned i = 0; i < n; i++) {
+        size_t bit = b * n + i;
+        cw |= (uint64_t)((encoded[bit / 8] >> (bit % 8)) & 1) << i;
+      }
+      if (cw != ref_encode(data, m)) {
+        FAIL("codeword differs from reference");
+        return;
+      }
+      /* Flip one bit per codeword, cycling through the positions */
+      size_t flip = b * n + b % n;
+      encoded[flip / 8] ^= (uint8_t)(1u << (flip % 8));
+    }
+
+    size_t decoded_bits = sizeof(decoded) * 8;
+    size_t num_corrected = 0;
+    if (codec->decode(&params, encoded, blocks * n, decoded, &decoded_bits,
+                      &num_corrected) != CODECTK_OK) {
+      FAIL("decode failed");
+      return;
+    }
+    if (num_corrected != blocks || decoded_bits != (blocks * k + 7) / 8 * 8) {
+      FAIL("wrong correction count or length");
+      return;
+    }
+    for (size_t i = 0; i < blocks * k; i++) {
+      unsigned want = i < in_bits ? ((unsigned)input[i / 8] >> (i % 8)) & 1u : 0u;
+      if ((((unsigned)decoded[i / 8] >> (i % 8)) & 1u) != want) {
+        FAIL("data mismatch");
+        return;
+      }
+    }
+  }
+
+  hamming_params bad = {.m = HAMMING_MAX_M + 1};
+  size_t encoded_bits = sizeof(encoded) * 8;
+  if (codec->encode(&bad, input, 8, encoded, &encoded_bits) != CODECTK_EINVAL) {
+    FAIL("oversized m accepted");
+    return;
+  }
+
+  PASS();
+}
+
+/* Hamming has no batch entry points: the registry falls back to one call per item */
+static void test_hamming_batch_fallback(void) {
+  TEST("Batch decode through the per-item fallback");
+
+  hamming_params params = {3};
+  const codectk_codec *codec = hamming_codec();
+  uint8_t msg[4][2] = {{0x5A, 0x01}, {0xFF, 0x00}, {0x00, 0x03}, {0x81, 0x02}};
+  uint8_t enc[4][4], dec[4][4];
+  codectk_batch_item items[4];
+
+  for (int i = 0; i < 4; i++) {
+    items[i] = (codectk_batch_item){msg[i], 12, enc[i], 32, 0, CODECTK_OK};
+  }
+  if (codec->encode_batch || codec->decode_batch ||
+      codectk_encode_batch(codec, &params, items, 4) != CODECTK_OK) {
+    FAIL("batch encode failed");
+    return;
+  }
+
+  /* One error in items 1 and 2; item 3 has no room for its output */
+  enc[1][0] ^= 0x04;
+  enc[2][2] ^= 0x10;
+  for (int i = 0; i < 4; i++) {
+    items[i] = (codectk_batch_item){enc[i], items[i].out_bits, dec[i], i == 3 ? 0 : 32,
+                                    0, CODECTK_OK};
+  }
+  if (codectk_decode_batch(codec, &params, items, 4) != CODECTK_ENOMEM ||
+      items[3].err != CODECTK_ENOMEM) {
+    FAIL("item error not reported");
+    return;
+  }
+  for (int i = 0; i < 3; i++) {
+    if (items[i].err != CODECTK_OK || items[i].out_bits != 16 ||
+        items[i].num_corrected != (i == 1 || i == 2) || dec[i][0] != msg[i][0] ||
+        (dec[i][1] & 0x0F) != msg[i][1]) {
+      FAIL("item decoded incorrectly");
+      return;
+    }
+  }
+
+  PASS();
+}
+
 int test_hamming_suite(void) {
   test_count = 0;
   pass_count = 0;
@@ -153,6 +290,8 @@ int test_hamming_suite(void) {
   test_hamming_encode_decode();
   test_hamming_single_error_correction();
   test_hamming_multiple_codes();
+  test_hamming_stream();
+  test_hamming_batch_fallback();
 
   printf("  hamming: %d/%d tests passed\n", pass_count, test_count);
   return test_count - pass_count;
@@ -0,0 +1,457 @@
+/**
+ * test_handle.c - Tests for codectk_open/process/close: chunked streams
+ * against one call over the whole stream
+ */
+
+#include "../include/handle.h"
+#include "../include/bch.h"
+#include "../include/bitio.h"
+#include "../include/goppa.h"
+#include "../include/hamming.h"
+#include "../include/huffman.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int test_count = 0;
+static int pass_count = 0;
+
+#define TEST(name) do { test_count++; printf("  [%d] %s: ", test_count, name); } while (0)
+#define PASS() do { pass_count++; printf("PASS\n"); } while (0)
+#define FAIL(msg) do { printf("FAIL - %s\n", msg); } while (0)
+
+static uint32_t next_rand(uint32_t *seed) {
+  *seed = *seed * 1103515245u + 12345u;
+  return *seed >> 16;
+}
+
+static void fill(uint8_t *buf, size_t len, uint32_t seed) {
+  for (size_t i = 0; i < len; i++) buf[i] = (uint8_t)next_rand(&seed);
+}
+
+static void flip(uint8_t *buf, size_t bit) {
+  buf[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+}
+
+/**
+ * Code in_bits bits through h in chunks of odd byte counts, the last one
+ * with CODECTK_FLUSH, and concatenate the outputs. Returns an error
+ * message or NULL; *result is the first error the calls returned.
+ */
+static const char *stream(codectk_handle *h, const uint8_t *in, size_t in_bits, uint8_t *out,
+                          size_t cap, size_t *out_bits, codectk_err *result) {
+  static const size_t chunks[] = {1, 7, 13, 64, 3, 250, 0, 31};
+  size_t used = 0, done = 0, c = 0;
+  *result = CODECTK_OK;
+  for (;;) {
+    size_t bits = chunks[c++ % (sizeof(chunks) / sizeof(chunks[0]))] * 8;
+    unsigned flags = 0;
+    if (bits >= in_bits - used) {
+      bits = in_bits - used;
+      flags = CODECTK_FLUSH;
+    }
+
+    const uint8_t *o = NULL;
+    size_t o_bits = 0;
+    codectk_err err = codectk_process(h, in + used / 8, bits, flags, &o, &o_bits);
+    if (err != CODECTK_OK && err != CODECTK_EDECODE) return "process failed";
+    if (*result == CODECTK_OK) *result = err;
+    if (!flags && o_bits % 8) return "partial byte before the flush";
+    if ((done + o_bits + 7) / 8 > cap) return "output too long";
+    if (o_bits) memcpy(out + done / 8, o, (o_bits + 7) / 8);
+    done += o_bits;
+    used += bits;
+    if (flags) break;
+  }
+  *out_bits = done;
+  return NULL;
+}
+
+/* Chunked encode and decode through handles against the codec's calls */
+static const char *check_codec(const char *name, const void *params, size_t msg_bits,
+                               size_t flips, uint32_t seed) {
+  const codectk_codec *codec = codectk_get(name);
+  size_t msg_bytes = (msg_bits + 7) / 8, cap = 4 * msg_bytes + 1024;
+  uint8_t *msg = malloc(msg_bytes), *want = malloc(cap), *got = malloc(cap);
+  uint8_t *dec_want = malloc(cap), *dec_got = malloc(cap);
+  codectk_handle *enc = NULL, *dec = NULL;
+  const char *err = NULL;
+  if (!codec || !msg || !want || !got || !dec_want || !dec_got) err = "setup failed";
+  if (!err) {
+    fill(msg, msg_bytes, seed);
+    if (codectk_open(name, params, CODECTK_ENCODE, &enc) != CODECTK_OK ||
+        codectk_open(name, params, CODECTK_DECODE, &dec) != CODECTK_OK) {
+      err = "open failed";
+    }
+  }
+
+  size_t want_bits = cap * 8, got_bits = 0;
+  codectk_err r;
+  if (!err && codec->encode(params, msg, msg_bits, want, &want_bits) != CODECTK_OK) {
+    err = "encode failed";
+  }
+  if (!err) err = stream(enc, msg, msg_bits, got, cap, &got_bits, &r);
+  if (!err && (r != CODECTK_OK || got_bits != want_bits ||
+               memcmp(got, want, (want_bits + 7) / 8) != 0)) {
+    err = "encoded stream differs";
+  }
+
+  /* Errors spread over the codewords, a few of which cannot be corrected */
+  for (size_t i = 0; !err && i < flips; i++) flip(want, (i * 7919 + seed) % want_bits);
+  size_t dw_bits = cap * 8, dg_bits = 0, corr = 0;
+  codectk_err wr = CODECTK_OK;
+  if (!err) {
+    wr = codec->decode(params, want, want_bits, dec_want, &dw_bits, &corr);
+    if (wr != CODECTK_OK && wr != CODECTK_EDECODE) err = "decode failed";
+  }
+  if (!err) err = stream(dec, want, want_bits, dec_got, cap, &dg_bits, &r);
+  if (!err && (r != wr || dg_bits != dw_bits || memcmp(dec_got, dec_want, (dw_bits + 7) / 8) ||
+               codectk_corrected(dec) != corr)) {
+    err = "decoded stream differs";
+  }
+  if (!err && flips && !corr) err = "nothing corrected";
+
+  /* After the flush the handle takes a new stream */
+  if (!err) err = stream(enc, msg, msg_bits, got, cap, &got_bits, &r);
+  if (!err && (got_bits != want_bits || codectk_corrected(enc) != 0)) err = "reuse failed";
+
+  codectk_close(enc);
+  codectk_close(dec);
+  free(msg);
+  free(want);
+  free(got);
+  free(dec_want);
+  free(dec_got);
+  return err;
+}
+
+static void test_handle_hamming(void) {
+  TEST("Hamming streams match one-shot calls");
+  const char *err = NULL;
+  for (unsigned m = 2; m <= HAMMING_MAX_M && !err; m++) {
+    hamming_params P = {m};
+    err = check_codec("hamming", &P, 5003 + m, 40, m);
+  }
+  if (err) FAIL(err);
+  else PASS();
+}
+
+static void test_handle_bch(void) {
+  TEST("BCH streams match one-shot calls");
+  static const struct { unsigned m, t; bch_pad pad; unsigned flags; size_t flips; } sets[] = {
+    {8, 4, BCH_PAD_SHORTEN, 0, 300},
+    {8, 4, BCH_PAD_ZERO, 0, 300},
+    {10, 6, BCH_PAD_SHORTEN, BCH_FLAG_CT, 100},
+    {5, 3, BCH_PAD_ZERO, 0, 300},
+  };
+  const char *err = NULL;
+  for (size_t i = 0; i < sizeof(sets) / sizeof(sets[0]) && !err; i++) {
+    bch_params P = {.m = sets[i].m, .t = sets[i].t, .pad = sets[i].pad,
+                    .flags = sets[i].flags};
+    err = check_codec("bch", &P, 20011, sets[i].flips, (uint32_t)i);
+
+    /* A borrowed context codes the same stream */
+    bch_ctx *ctx = NULL;
+    if (!err && bch_ctx_create(sets[i].m, sets[i].t, &ctx) != CODECTK_OK) err = "ctx failed";
+    P.ctx = ctx;
+    if (!err) err = check_codec("bch", &P, 9001, sets[i].flips / 3, (uint32_t)i + 10);
+    bch_ctx_destroy(ctx);
+  }
+  if (err) FAIL(err);
+  else PASS();
+}
+
+/* A long stream, chunked and in one call that decodes on the executor */
+static void test_handle_bch_long(void) {
+  TEST("long BCH stream");
+  enum { MSG_BITS = 600000 };
+  bch_params P = {.m = 8, .t = 4};
+  const char *err = check_codec("bch", &P, MSG_BITS, 4000, 99);
+
+  size_t cap = MSG_BITS / 4, cw_bits = cap * 8, want_bits = cap * 8, corr = 0, o_bits = 0;
+  uint8_t *msg = calloc(MSG_BITS / 8, 1), *cw = malloc(cap), *want = malloc(cap);
+  codectk_handle *h = NULL;
+  const uint8_t *o = NULL;
+  if (!err && (!msg || !cw || !want ||
+               bch_codec()->encode(&P, msg, MSG_BITS, cw, &cw_bits) != CODECTK_OK)) {
+    err = "setup failed";
+  }
+  for (size_t i = 0; !err && i < 3000; i++) flip(cw, i * 337 % cw_bits);
+  if (!err && bch_codec()->decode(&P, cw, cw_bits, want, &want_bits, &corr) != CODECTK_OK) {
+    err = "decode failed";
+  }
+  if (!err && (codectk_open("bch", &P, CODECTK_DECODE, &h) != CODECTK_OK ||
+               codectk_process(h, cw, cw_bits, CODECTK_FLUSH, &o, &o_bits) != CODECTK_OK)) {
+    err = "process failed";
+  }
+  if (!err && (o_bits != want_bits || memcmp(o, want, want_bits / 8) ||
+               codectk_corrected(h) != corr)) {
+    err = "one-call stream differs";
+  }
+  codectk_close(h);
+  free(msg);
+  free(cw);
+  free(want);
+  if (err) FAIL(err);
+  else PASS();
+}
+
+static void test_handle_fixed(void) {
+  TEST("fixed BCH codecs");
+  const char *err = NULL;
+  int found = 0;
+  char name[32];
+  for (unsigned m = 2; m <= 16 && !err; m++) {
+    for (unsigned t = 1; t <= 64 && !err; t++) {
+      snprintf(name, sizeof(name), "bch-%u-%u", m, t);
+      if (!bch_fixed_codec(name)) continue;
+      found++;
+      /* About t / 2 errors per codeword */
+      bch_params P = {.pad = BCH_PAD_ZERO};
+      size_t k = bch_fixed_ctx(name)->k;
+      err = check_codec(name, NULL, 6 * k + 5, 3 * t + 1, m);
+      if (!err) err = check_codec(name, &P, 6 * k + 5, 3 * t + 1, t);
+      codectk_handle *h = NULL;
+      P.m = m + 1;
+      if (!err && (codectk_open(name, &P, CODECTK_DECODE, &h) != CODECTK_EINVAL || h)) {
+        err = "mismatched m accepted";
+      }
+    }
+  }
+  if (!found) printf("skipped (no CODECTK_FIXED_CODECS) ");
+  if (err) FAIL(err);
+  else PASS();
+}
+
+static void test_handle_huffman(void) {
+  TEST("Huffman streams match one-shot calls");
+  enum { LEN = 50000 };
+  uint8_t *text = malloc(LEN);
+  const char *err = NULL;
+  if (!text) {
+    FAIL("setup failed");
+    return;
+  }
+  uint32_t seed = 11;
+  for (size_t i = 0; i < LEN; i++) text[i] = (uint8_t)('a' + (next_rand(&seed) % 97) / 8);
+
+  huffman_params blocks = {.block_size = 4096};
+  const huffman_params *sets[] = {NULL, &blocks};
+  for (size_t s = 0; s < 2 && !err; s++) {
+    const codectk_codec *codec = huffman_codec();
+    size_t cap = 2 * LEN + 4096, want_bits = cap * 8, got_bits = 0, dec_bits = 0;
+    uint8_t *want = malloc(cap), *got = malloc(cap), *dec = malloc(cap);
+    codectk_handle *enc = NULL, *d = NULL;
+    codectk_err r;
+    if (!want || !got || !dec ||
+        codec->encode(sets[s], text, LEN * 8, want, &want_bits) != CODECTK_OK ||
+        codectk_open("huffman", sets[s], CODECTK_ENCODE, &enc) != CODECTK_OK ||
+        codectk_open("huffman", sets[s], CODECTK_DECODE, &d) != CODECTK_OK) {
+      err = "setup failed";
+    }
+    if (!err) err = stream(enc, text, LEN * 8, got, cap, &got_bits, &r);
+    if (!err && (got_bits != want_bits || memcmp(got, want, (want_bits + 7) / 8))) {
+      err = "encoded stream differs";
+    }
+    if (!err) err = stream(d, want, want_bits, dec, cap, &dec_bits, &r);
+    if (!err && (dec_bits != LEN * 8 || memcmp(dec, text, LEN))) err = "decoded stream differs";
+    codectk_close(enc);
+    codectk_close(d);
+    free(want);
+    free(got);
+    free(dec);
+  }
+  free(text);
+  if (err) FAIL(err);
+  else PASS();
+}
+
+static uint16_t eval(const gf2m_ctx *f, const uint16_t *g, unsigned t, uint16_t x) {
+  uint16_t y = 0;
+  for (unsigned i = t + 1; i-- > 0;) y = gf2m_add(gf2m_mul(f, y, x), g[i]);
+  return y;
+}
+
+/* Goppa code over n field elements with a random g that can be decoded */
+static goppa_ctx *make_goppa(goppa_params *P, uint16_t *g, uint16_t *L, unsigned m,
+                             unsigned t, size_t n, uint32_t seed) {
+  const gf2m_ctx *f = gf2m_ctx_get(m, 0);
+  for (int tries = 0; tries < 100; tries++) {
+    for (unsigned i = 0; i < t; i++) g[i] = (uint16_t)(next_rand(&seed) & ((1u << m) - 1));
+    g[t] = 1;
+    size_t have = 0;
+    for (uint32_t x = 0; x < (1u << m) && have < n; x++) {
+      if (eval(f, g, t, (uint16_t)x) != 0) L[have++] = (uint16_t)x;
+    }
+    if (have < n) continue;
+
+    memset(P, 0, sizeof(*P));
+    P->m = m;
+    P->t = t;
+    P->n = n;
+    P->L = L;
+    P->g = g;
+    goppa_ctx *ctx = NULL;
+    if (goppa_ctx_create(P, &ctx) != CODECTK_OK) continue;
+    if (ctx->sqrt_x) return ctx;
+    goppa_ctx_destroy(ctx);
+  }
+  return NULL;
+}
+
+/* Back-to-back codewords from goppa_ctx_encode(), and their decode */
+static void test_handle_goppa(void) {
+  TEST("Goppa streams of back-to-back codewords");
+  enum { WORDS = 150 };
+  static uint16_t g[8], L[256];
+  goppa_params P;
+  goppa_ctx *ctx = make_goppa(&P, g, L, 8, 5, 200, 21);
+  const char *err = ctx ? NULL : "setup failed";
+
+  size_t k = ctx ? ctx->k : 0, n = ctx ? ctx->n : 0;
+  size_t msg_bits = WORDS * k - k / 2, cap = WORDS * n / 8 + 64;
+  uint8_t *msg = calloc(cap, 1), *want = calloc(cap, 1), *got = malloc(cap);
+  uint8_t *dec = malloc(cap), *word = malloc(cap), *cw = malloc(cap);
+  if (!msg || !want || !got || !dec || !word || !cw) err = "setup failed";
+  if (!err) fill(msg, (msg_bits + 7) / 8, 5);
+  if (!err) msg[msg_bits / 8] &= (uint8_t)((1u << (msg_bits % 8)) - 1);
+
+  bitr_t R;
+  bitw_t W;
+  if (!err) {
+    bitr_init(&R, msg, (msg_bits + 7) / 8);
+    bitw_init(&W, want, cap);
+  }
+  for (size_t w = 0; w < WORDS && !err; w++) {
+    size_t bits = w == WORDS - 1 ? msg_bits - w * k : k;
+    memset(word, 0, (k + 7) / 8);
+    for (size_t b = 0; b < bits; b++) {
+      uint64_t v = 0;
+      bitr_get_bits(&R, 1, &v);
+      word[b / 8] |= (uint8_t)(v << (b % 8));
+    }
+    size_t cw_bits = cap * 8;
+    if (goppa_ctx_encode(ctx, word, bits, cw, &cw_bits) != CODECTK_OK || cw_bits != n) {
+      err = "encode failed";
+    }
+    for (size_t b = 0; b < n && !err; b++) {
+      bitw_put_bits(&W, (unsigned)cw[b / 8] >> (b % 8) & 1u, 1);
+    }
+  }
+  if (!err) bitw_flush(&W);
+
+  codectk_handle *enc = NULL, *d = NULL, *ct = NULL;
+  size_t got_bits = 0, dec_bits = 0;
+  codectk_err r;
+  if (!err && (codectk_open("goppa", &P, CODECTK_ENCODE, &enc) != CODECTK_OK ||
+               codectk_open("goppa", &P, CODECTK_DECODE, &d) != CODECTK_OK)) {
+    err = "open failed";
+  }
+  if (!err) err = stream(enc, msg, msg_bits, got, cap, &got_bits, &r);
+  if (!err && (got_bits != WORDS * n || memcmp(got, want, WORDS * n / 8))) {
+    err = "encoded stream differs";
+  }
+
+  /* Up to t errors per codeword, and a part-codeword tail that is dropped */
+  size_t flips = 0;
+  for (size_t w = 0; w < WORDS && !err; w++) {
+    for (size_t e = 0; e < w % 6; e++, flips++) flip(got, w * n + (e * 37 + w) % n);
+  }
+  if (!err) err = stream(d, got, WORDS * n + 9, dec, cap, &dec_bits, &r);
+  if (!err && (r != CODECTK_OK || dec_bits != WORDS * k || codectk_corrected(d) != flips)) {
+    err = "wrong decode result";
+  }
+  for (size_t b = 0; b < msg_bits && !err; b++) {
+    if ((unsigned)(dec[b / 8] ^ msg[b / 8]) >> (b % 8) & 1u) err = "decoded stream differs";
+  }
+
+  /* The constant-time decoder, on a borrowed context */
+  goppa_ctx *ctx_ct = NULL;
+  P.flags = GOPPA_FLAG_CT;
+  if (!err && goppa_ctx_create(&P, &ctx_ct) != CODECTK_OK) err = "CT context failed";
+  goppa_params B = {.ctx = ctx_ct};
+  if (!err && codectk_open("goppa", &B, CODECTK_DECODE, &ct) != CODECTK_OK) err = "open failed";
+  memset(dec, 0, cap);
+  if (!err) err = stream(ct, got, WORDS * n, dec, cap, &dec_bits, &r);
+  if (!err && (r != CODECTK_OK || dec_bits != WORDS * k || codectk_corrected(ct) != flips)) {
+    err = "wrong CT decode result";
+  }
+
+  codectk_close(enc);
+  codectk_close(d);
+  codectk_close(ct);
+  goppa_ctx_destroy(ctx);
+  goppa_ctx_destroy(ctx_ct);
+  free(msg);
+  free(want);
+  free(got);
+  free(dec);
+  free(word);
+  free(cw);
+  if (err) FAIL(err);
+  else PASS();
+}
+
+static void test_handle_invalid(void) {
+  TEST("invalid opens and chunks rejected");
+  codectk_handle *h = (codectk_handle*)&h;
+  hamming_params bad = {7}, good = {3};
+  bch_params bad_pad = {.m = 8, .t = 4, .pad = (bch_pad)5};
+  const char *err = NULL;
+
+  if (codectk_open("nosuch", NULL, CODECTK_ENCODE, &h) != CODECTK_EINVAL || h) {
+    err = "unknown codec";
+  }
+  if (!err && codectk_open("hamming", &bad, CODECTK_ENCODE, &h) != CODECTK_EINVAL) {
+    err = "m = 7 accepted";
+  }
+  if (!err && codectk_open("bch", NULL, CODECTK_DECODE, &h) != CODECTK_EINVAL) {
+    err = "NULL BCH params accepted";
+  }
+  if (!err && codectk_open("bch", &bad_pad, CODECTK_DECODE, &h) != CODECTK_EINVAL) {
+    err = "bad pad accepted";
+  }
+  if (!err && codectk_open("goppa", NULL, CODECTK_DECODE, &h) != CODECTK_EINVAL) {
+    err = "NULL Goppa params accepted";
+  }
+  if (!err && codectk_open("hamming", &good, (codectk_direction)2, &h) != CODECTK_EINVAL) {
+    err = "bad direction accepted";
+  }
+
+  uint8_t in[4] = {0};
+  const uint8_t *out;
+  size_t out_bits;
+  if (!err && codectk_open("hamming", &good, CODECTK_ENCODE, &h) != CODECTK_OK) {
+    err = "open failed";
+  }
+  if (!err && codectk_process(h, in, 12, 0, &out, &out_bits) != CODECTK_EINVAL) {
+    err = "partial byte accepted before the flush";
+  }
+  if (!err && codectk_process(h, in, 8, 0x2, &out, &out_bits) != CODECTK_EINVAL) {
+    err = "unknown flag accepted";
+  }
+  if (!err && (codectk_process(h, in, 12, CODECTK_FLUSH, &out, &out_bits) != CODECTK_OK ||
+               out_bits != 24)) {
+    err = "flush of 12 bits";
+  }
+  codectk_close(h);
+  codectk_close(NULL);
+  if (err) FAIL(err);
+  else PASS();
+}
+
+int test_handle_suite(void) {
+  test_count = 0;
+  pass_count = 0;
+
+  test_handle_hamming();
+  test_handle_bch();
+  test_handle_bch_long();
+  test_handle_fixed();
+  test_handle_huffman();
+  test_handle_goppa();
+  test_handle_invalid();
+
+  printf("  handle: %d/%d tests passed\n", pass_count, test_count);
+  return test_count - pass_count;
+}
@@ -5,6 +5,7 @@
 #include "../include/huffman.h"
 #include "../include/codectk.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 static int test_count = 0;
@@ -171,6 +172,326 @@ static void test_huffman_compression_ratio(void) {
   PASS();
 }
 
+static void test_huffman_legacy_huf1(void) {
+  TEST("Legacy HUF1 stream still decodes");
+
+  /* HUF1: magic, 257 LE32 frequencies (EOF = 1), then the tree-coded bits
+   * exactly as the original encoder wrote them for this text */
+  const char *text = "abracadabra alakazam";
+  static const uint8_t payload[] = {0x72, 0xA6, 0x2F, 0xA7, 0x6C, 0xCB, 0xF0, 0x1A};
+  uint8_t stream[4 + 257 * 4 + sizeof(payload)];
+  unsigned freq[257] = {0};
+
+  for (const char *c = text; *c; c++) freq[(uint8_t)*c]++;
+  freq[256] = 1;
+  memcpy(stream, "HUF1", 4);
+  for (int i = 0; i < 257; i++) {
+    for (int b = 0; b < 4; b++) stream[4 + 4 * i + b] = (uint8_t)(freq[i] >> (8 * b));
+  }
+  memcpy(stream + 4 + 257 * 4, payload, sizeof(payload));
+
+  uint8_t decoded[64];
+  size_t decoded_bits = sizeof(decoded) * 8;
+  if (huffman_codec()->decode(NULL, stream, sizeof(stream) * 8, decoded, &decoded_bits,
+                              NULL) != CODECTK_OK ||
+      decoded_bits != strlen(text) * 8 || memcmp(decoded, text, strlen(text)) != 0) {
+    FAIL("HUF1 decode mismatch");
+    return;
+  }
+
+  PASS();
+}
+
+static void test_huffman_length_limit(void) {
+  TEST("Length-limited codes on skewed input, malformed streams");
+
+  const codectk_codec *codec = huffman_codec();
+
+  /* Fibonacci-like frequencies drive the plain Huffman tree far past the
+   * length limit */
+  static uint8_t input[40000];
+  size_t n = 0;
+  unsigned f0 = 1, f1 = 1;
+  for (int sym = 0; sym < 20 && n < sizeof(input); sym++) {
+    for (unsigned i = 0; i < f0 && n < sizeof(input); i++) input[n++] = (uint8_t)sym;
+    unsigned f2 = f0 + f1;
+    f0 = f1;
+    f1 = f2;
+  }
+  for (int sym = 20; sym < 256; sym++) input[n++] = (uint8_t)sym; /* all symbols once */
+  /* Interleave so the stream is not run-sorted */
+  for (size_t i = 0; i + 7 < n; i += 7) {
+    uint8_t t = input[i];
+    input[i] = input[n - 1 - i];
+    input[n - 1 - i] = t;
+  }
+
+  static uint8_t encoded[50000], decoded[50000];
+  size_t encoded_bits = sizeof(encoded) * 8;
+  if (codec->encode(NULL, input, n * 8, encoded, &encoded_bits) != CODECTK_OK ||
+      memcmp(encoded, "HUF2", 4) != 0) {
+    FAIL("encode failed");
+    return;
+  }
+  size_t decoded_bits = sizeof(decoded) * 8;
+  if (codec->decode(NULL, encoded, encoded_bits, decoded, &decoded_bits, NULL) != CODECTK_OK ||
+      decoded_bits != n * 8 || memcmp(decoded, input, n) != 0) {
+    FAIL("round trip mismatch");
+    return;
+  }
+
+  /* Truncated payload: EOF never arrives */
+  decoded_bits = sizeof(decoded) * 8;
+  if (codec->decode(NULL, encoded, encoded_bits / 2, decoded, &decoded_bits, NULL) !=
+      CODECTK_EDECODE) {
+    FAIL("truncation not detected");
+    return;
+  }
+
+  /* Over-subscribed code lengths: 'a', 'b', 'c' and EOF all of length 1
+   * (nibbles: 15 14 4 = 97 zeros, 1 1 1, 15 9 8 = 156 zeros, 1) */
+  static const uint8_t bad[] = {'H', 'U', 'F', '2', 0xEF, 0x14, 0x11, 0x9F, 0x18, 0xFF};
+  decoded_bits = sizeof(decoded) * 8;
+  if (codec->decode(NULL, bad, sizeof(bad) * 8, decoded, &decoded_bits, NULL) !=
+      CODECTK_EINVAL) {
+    FAIL("bad header accepted");
+    return;
+  }
+
+  PASS();
+}
+
+static void test_huffman_small_record(void) {
+  TEST("HUF2 header stays small for short records");
+
+  const codectk_codec *codec = huffman_codec();
+  const char *text = "GET /index.html 200 1532";
+  size_t text_len = strlen(text);
+
+  uint8_t encoded[64];
+  uint8_t decoded[64];
+  size_t encoded_bits = sizeof(encoded) * 8;
+  size_t decoded_bits = sizeof(decoded) * 8;
+
+  if (codec->encode(NULL, (const uint8_t*)text, text_len * 8, encoded, &encoded_bits) !=
+      CODECTK_OK) {
+    FAIL("encode failed");
+    return;
+  }
+  /* 20 distinct symbols: the packed lengths take well under 40 bytes */
+  if (encoded_bits / 8 >= 4 + 40 + text_len) {
+    FAIL("header too large");
+    return;
+  }
+  if (codec->decode(NULL, encoded, encoded_bits, decoded, &decoded_bits, NULL) != CODECTK_OK ||
+      decoded_bits != text_len * 8 || memcmp(decoded, text, text_len) != 0) {
+    FAIL("round trip mismatch");
+    return;
+  }
+
+  /* Header cut short */
+  decoded_bits = sizeof(decoded) * 8;
+  if (codec->decode(NULL, encoded, 6 * 8, decoded, &decoded_bits, NULL) != CODECTK_EINVAL) {
+    FAIL("truncated header accepted");
+    return;
+  }
+
+  PASS();
+}
+
+/* Input whose statistics change every 4 KiB: text, then skewed noise */
+static void fill_mixed(uint8_t *buf, size_t len) {
+  const char *text = "the quick brown fox jumps over the lazy dog; ";
+  size_t tl = strlen(text);
+  uint32_t x = 12345;
+  for (size_t i = 0; i < len; i++) {
+    x = x * 1103515245u + 12345u;
+    if ((i / 4096) % 3 == 2) {
+      buf[i] = (uint8_t)((x >> 16) & ((x >> 28) ? 0x0F : 0xFF));
+    } else {
+      buf[i] = (uint8_t)text[i % tl];
+    }
+  }
+}
+
+static void test_huffman_blocks(void) {
+  TEST("HUFB multi-block round trip and random access");
+
+  const codectk_codec *codec = huffman_codec();
+  const size_t len = 50000;
+  uint8_t *input = malloc(len);
+  uint8_t *encoded = malloc(2 * len);
+  uint8_t *decoded = malloc(len);
+  if (!input || !encoded || !decoded) {
+    free(input);
+    free(encoded);
+    free(decoded);
+    FAIL("allocation failed");
+    return;
+  }
+  fill_mixed(input, len);
+
+  /* Last block is partial: 50000 = 12 * 4096 + 848 */
+  huffman_params params = {4096, 4, 1};
+  size_t encoded_bits = 2 * len * 8;
+  size_t decoded_bits = len * 8;
+  const char *err = NULL;
+
+  if (codec->encode(&params, input, len * 8, encoded, &encoded_bits) != CODECTK_OK) {
+    err = "encode failed";
+  } else if (memcmp(encoded, "HUFB", 4) != 0) {
+    err = "wrong magic";
+  } else if (codec->decode(&params, encoded, encoded_bits, decoded, &decoded_bits, NULL) !=
+                 CODECTK_OK ||
+             decoded_bits != len * 8 || memcmp(decoded, input, len) != 0) {
+    err = "round trip mismatch";
+  }
+
+  /* Reuse of a previous block's table: text blocks come in pairs */
+  size_t nblocks = 0, block_size = 0;
+  if (!err && (huffman_block_info(encoded, encoded_bits, &nblocks, &block_size) != CODECTK_OK ||
+               nblocks != 13 || block_size != 4096)) {
+    err = "bad block info";
+  }
+  if (!err) {
+    size_t reused = 0;
+    for (size_t i = 0; i < nblocks; i++) {
+      uint32_t table = (uint32_t)encoded[20 + 8 * i + 4] |
+                       ((uint32_t)encoded[20 + 8 * i + 5] << 8);
+      reused += (table != i);
+    }
+    if (reused == 0) err = "no block reused a table";
+  }
+
+  /* Every block on its own, last to first */
+  for (size_t i = nblocks; !err && i-- > 0;) {
+    uint8_t blockbuf[4096];
+    size_t bits = sizeof(blockbuf) * 8;
+    size_t expect = (i + 1 < nblocks) ? 4096 : len - i * 4096;
+    if (huffman_decode_block(encoded, encoded_bits, i, blockbuf, &bits) != CODECTK_OK ||
+        bits != expect * 8 || memcmp(blockbuf, input + i * 4096, expect) != 0) {
+      err = "block decode mismatch";
+    }
+  }
+
+  /* Single-threaded output decodes with any thread count */
+  huffman_params serial = {4096, 1, 1};
+  size_t serial_bits = 2 * len * 8;
+  if (!err && (codec->encode(&serial, input, len * 8, encoded + len, &serial_bits) != CODECTK_OK ||
+               serial_bits != encoded_bits || memcmp(encoded, encoded + len, encoded_bits / 8))) {
+    err = "output depends on thread count";
+  }
+
+  /* Short output and a truncated stream */
+  decoded_bits = (len - 1) * 8;
+  if (!err && codec->decode(NULL, encoded, encoded_bits, decoded, &decoded_bits, NULL) !=
+                  CODECTK_ENOMEM) {
+    err = "short output accepted";
+  }
+  decoded_bits = len * 8;
+  if (!err && codec->decode(NULL, encoded, encoded_bits - 64, decoded, &decoded_bits, NULL) ==
+                  CODECTK_OK) {
+    err = "truncated stream accepted";
+  }
+
+  free(input);
+  free(encoded);
+  free(decoded);
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+static void test_huffman_streams(void) {
+  TEST("HUFB four interleaved streams per block");
+
+  const codectk_codec *codec = huffman_codec();
+  const size_t len = 30001;
+  uint8_t *input = malloc(len);
+  uint8_t *encoded = malloc(2 * len + 256);
+  uint8_t *decoded = malloc(len);
+  if (!input || !encoded || !decoded) {
+    free(input);
+    free(encoded);
+    free(decoded);
+    FAIL("allocation failed");
+    return;
+  }
+  fill_mixed(input, len);
+
+  /* Odd sizes leave short last segments, tiny inputs leave empty ones */
+  const size_t sizes[] = {len, 4097, 5, 1};
+  huffman_params params = {4096, 2, 4};
+  const char *err = NULL;
+
+  for (size_t c = 0; c < sizeof(sizes) / sizeof(sizes[0]) && !err; c++) {
+    size_t n = sizes[c];
+    size_t encoded_bits = (2 * len + 256) * 8;
+    size_t decoded_bits = len * 8;
+    if (codec->encode(&params, input, n * 8, encoded, &encoded_bits) != CODECTK_OK) {
+      err = "encode failed";
+    } else if (encoded[16] != 4) {
+      err = "streams not recorded";
+    } else if (codec->decode(NULL, encoded, encoded_bits, decoded, &decoded_bits, NULL) !=
+                   CODECTK_OK ||
+               decoded_bits != n * 8 || memcmp(decoded, input, n) != 0) {
+      err = "round trip mismatch";
+    }
+  }
+
+  /* Block access and a damaged jump table */
+  size_t encoded_bits = (2 * len + 256) * 8;
+  if (!err && codec->encode(&params, input, len * 8, encoded, &encoded_bits) != CODECTK_OK) {
+    err = "encode failed";
+  }
+  if (!err) {
+    uint8_t blockbuf[4096];
+    size_t bits = sizeof(blockbuf) * 8;
+    if (huffman_decode_block(encoded, encoded_bits, 3, blockbuf, &bits) != CODECTK_OK ||
+        bits != 4096 * 8 || memcmp(blockbuf, input + 3 * 4096, 4096) != 0) {
+      err = "block decode mismatch";
+    }
+
+    /* Overwrite the start of block 0: packed lengths and jump table */
+    size_t index_end = 20 + 8 * ((len + 4095) / 4096);
+    memset(encoded + index_end, 0xFF, 64);
+    size_t decoded_bits = len * 8;
+    if (!err && codec->decode(NULL, encoded, encoded_bits, decoded, &decoded_bits, NULL) ==
+                    CODECTK_OK) {
+      err = "damaged block accepted";
+    }
+  }
+
+  /* Stream counts other than 1 and 4 are rejected */
+  huffman_params bad = {4096, 1, 3};
+  encoded_bits = (2 * len + 256) * 8;
+  if (!err && codec->encode(&bad, input, len * 8, encoded, &encoded_bits) != CODECTK_EINVAL) {
+    err = "bad stream count accepted";
+  }
+
+  /* Tiny blocks are rejected, and an index that cannot fit before planning */
+  huffman_params tiny = {1, 1, 4}, small = {HUFFMAN_MIN_BLOCK, 1, 4};
+  encoded_bits = (2 * len + 256) * 8;
+  if (!err && codec->encode(&tiny, input, len * 8, encoded, &encoded_bits) != CODECTK_EINVAL) {
+    err = "tiny block size accepted";
+  }
+  encoded_bits = 64 * 8;
+  if (!err && codec->encode(&small, input, len * 8, encoded, &encoded_bits) != CODECTK_ENOMEM) {
+    err = "index larger than the output accepted";
+  }
+
+  free(input);
+  free(encoded);
+  free(decoded);
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
 int test_huffman_suite(void) {
   test_count = 0;
   pass_count = 0;
@@ -179,6 +500,11 @@ int test_huffman_suite(void) {
   test_huffman_single_symbol();
   test_huffman_varied_frequencies();
   test_huffman_compression_ratio();
+  test_huffman_legacy_huf1();
+  test_huffman_length_limit();
+  test_huffman_small_record();
+  test_huffman_blocks();
+  test_huffman_streams();
 
   printf("  huffman: %d/%d tests passed\n", pass_count, test_count);
   return test_count - pass_count;
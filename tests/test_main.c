@@ -4,6 +4,7 @@
  * Coordinates all unit tests and reports results.
  */
 
+#include "../include/executor.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -15,10 +16,18 @@ extern int test_poly_suite(void);
 extern int test_hamming_suite(void);
 extern int test_huffman_suite(void);
 extern int test_bch_suite(void);
+extern int test_goppa_suite(void);
+extern int test_pipeline_suite(void);
+extern int test_executor_suite(void);
+extern int test_stats_suite(void);
+extern int test_handle_suite(void);
 
 int main(void) {
   int total_failures = 0;
 
+  /* Exercise the parallel codec paths whatever the machine's CPU count */
+  codectk_executor_configure_shared(4);
+
   printf("==============================================\n");
   printf("Coding Theory Toolkit - Test Suite\n");
   printf("==============================================\n\n");
@@ -47,9 +56,29 @@ int main(void) {
   total_failures += test_huffman_suite();
   printf("\n");
 
-  // printf("Running BCH code tests...\n");
-  // total_failures += test_bch_suite();
-  // printf("\n");
+  printf("Running BCH code tests.\n");
+  total_failures += test_bch_suite();
+  printf("\n");
+
+  printf("Running Goppa code tests.\n");
+  total_failures += test_goppa_suite();
+  printf("\n");
+
+  printf("Running pipeline tests.\n");
+  total_failures += test_pipeline_suite();
+  printf("\n");
+
+  printf("Running executor tests.\n");
+  total_failures += test_executor_suite();
+  printf("\n");
+
+  printf("Running stats tests.\n");
+  total_failures += test_stats_suite();
+  printf("\n");
+
+  printf("Running handle tests.\n");
+  total_failures += test_handle_suite();
+  printf("\n");
 
   printf("==============================================\n");
   if (total_failures == 0) {
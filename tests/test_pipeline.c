@@ -0,0 +1,232 @@
+/**
+ * test_pipeline.c - Tests for codec pipelines
+ */
+
+#include "../include/pipeline.h"
+#include "../include/bch.h"
+#include "../include/hamming.h"
+#include "../include/huffman.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int test_count = 0;
+static int pass_count = 0;
+
+#define TEST(name) do { test_count++; printf("  [%d] %s: ", test_count, name); } while (0)
+#define PASS() do { pass_count++; printf("PASS\n"); } while (0)
+#define FAIL(msg) do { printf("FAIL - %s\n", msg); } while (0)
+
+/* Compressible text with a varying tail, so tiles differ */
+static void fill_text(uint8_t *buf, size_t len) {
+  const char *text = "compress then protect: huffman, then an error-correcting code. ";
+  size_t tl = strlen(text);
+  for (size_t i = 0; i < len; i++) {
+    buf[i] = (uint8_t)((unsigned char)text[i % tl] ^ ((i / 1000) & 3));
+  }
+}
+
+/* Flip one bit in the coded part of every tile, close to its start */
+static size_t damage_tiles(uint8_t *buf, size_t bytes, size_t nstages) {
+  size_t hdr = 4 * (nstages + 1);
+  size_t pos = 0, flips = 0;
+  while (pos + hdr <= bytes) {
+    const uint8_t *h = buf + pos + 4 * nstages;
+    size_t coded_bits = (size_t)h[0] | ((size_t)h[1] << 8) | ((size_t)h[2] << 16) |
+                        ((size_t)h[3] << 24);
+    if (coded_bits > 3) {
+      buf[pos + hdr] ^= 0x04;
+      flips++;
+    }
+    pos += hdr + (coded_bits + 7) / 8;
+  }
+  return flips;
+}
+
+static void test_pipeline_huffman_hamming(void) {
+  TEST("huffman -> hamming, fused and threaded, with bit errors");
+
+  const size_t len = 40000;
+  uint8_t *input = malloc(len);
+  uint8_t *enc[2] = {malloc(4 * len), malloc(4 * len)};
+  uint8_t *decoded = malloc(len);
+  size_t enc_bits[2] = {0, 0};
+  const char *err = NULL;
+
+  hamming_params hp = {5};
+  codectk_stage stages[2] = {{huffman_codec(), NULL}, {hamming_codec(), &hp}};
+
+  if (!input || !enc[0] || !enc[1] || !decoded) err = "allocation failed";
+  if (!err) fill_text(input, len);
+
+  for (int mode = 0; mode < 2 && !err; mode++) {
+    codectk_pipeline *p = NULL;
+    if (codectk_pipeline_create(stages, 2, 4096, (codectk_pipeline_mode)mode, &p) !=
+        CODECTK_OK) {
+      err = "create failed";
+      break;
+    }
+
+    /* Twice through the same pipeline: buffers are reused */
+    for (int rep = 0; rep < 2 && !err; rep++) {
+      enc_bits[mode] = 4 * len * 8;
+      size_t dec_bits = len * 8;
+      size_t corrected = 0;
+      if (codectk_pipeline_encode(p, input, len * 8, enc[mode], &enc_bits[mode]) !=
+          CODECTK_OK) {
+        err = "encode failed";
+      } else if (codectk_pipeline_decode(p, enc[mode], enc_bits[mode], decoded, &dec_bits,
+                                         &corrected) != CODECTK_OK ||
+                 dec_bits != len * 8 || memcmp(decoded, input, len) != 0 || corrected) {
+        err = "round trip mismatch";
+      }
+    }
+
+    /* One error per tile in the Hamming layer is corrected */
+    if (!err) {
+      size_t flips = damage_tiles(enc[mode], enc_bits[mode] / 8, 2);
+      size_t dec_bits = len * 8;
+      size_t corrected = 0;
+      if (codectk_pipeline_decode(p, enc[mode], enc_bits[mode], decoded, &dec_bits,
+                                  &corrected) != CODECTK_OK ||
+          memcmp(decoded, input, len) != 0 || corrected != flips || flips != 10) {
+        err = "errors not corrected";
+      }
+    }
+
+    codectk_pipeline_destroy(p);
+  }
+
+  if (!err && (enc_bits[0] != enc_bits[1] || memcmp(enc[0], enc[1], enc_bits[0] / 8) != 0)) {
+    err = "fused and threaded output differ";
+  }
+
+  free(input);
+  free(enc[0]);
+  free(enc[1]);
+  free(decoded);
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+static void test_pipeline_three_stages(void) {
+  TEST("huffman -> bch -> hamming, odd input length");
+
+  bch_ctx *bc = NULL;
+  if (bch_ctx_create(8, 4, &bc) != CODECTK_OK) {
+    FAIL("bch_ctx_create failed");
+    return;
+  }
+  bch_params bp = {.ctx = bc};
+  hamming_params hp = {3};
+  codectk_stage stages[3] = {
+    {huffman_codec(), NULL}, {bch_codec(), &bp}, {hamming_codec(), &hp}};
+
+  /* 10001 bytes plus 5 bits: the last tile ends inside a byte */
+  const size_t len = 10002;
+  const size_t bits = (len - 1) * 8 + 5;
+  uint8_t input[10002], decoded[10002];
+  uint8_t *encoded = malloc(8 * len);
+  fill_text(input, len);
+  input[len - 1] &= 0x1F;
+
+  const char *err = NULL;
+  codectk_pipeline *p = NULL;
+  if (!encoded ||
+      codectk_pipeline_create(stages, 3, 1000, CODECTK_PIPELINE_THREADED, &p) != CODECTK_OK) {
+    err = "create failed";
+  }
+
+  size_t enc_bits = 8 * len * 8;
+  size_t dec_bits = sizeof(decoded) * 8;
+  if (!err && codectk_pipeline_encode(p, input, bits, encoded, &enc_bits) != CODECTK_OK) {
+    err = "encode failed";
+  }
+  if (!err) {
+    memset(decoded, 0, sizeof(decoded));
+    if (codectk_pipeline_decode(p, encoded, enc_bits, decoded, &dec_bits, NULL) !=
+            CODECTK_OK ||
+        dec_bits != bits || memcmp(decoded, input, len) != 0) {
+      err = "round trip mismatch";
+    }
+  }
+
+  /* Too little output space, then a truncated input */
+  if (!err) {
+    size_t small = 100 * 8;
+    if (codectk_pipeline_encode(p, input, bits, encoded, &small) != CODECTK_ENOMEM) {
+      err = "short output accepted";
+    }
+  }
+  if (!err) {
+    size_t cut = enc_bits - 64;
+    dec_bits = sizeof(decoded) * 8;
+    if (codectk_pipeline_decode(p, encoded, cut, decoded, &dec_bits, NULL) != CODECTK_EINVAL) {
+      err = "truncated input accepted";
+    }
+  }
+
+  codectk_pipeline_destroy(p);
+  bch_ctx_destroy(bc);
+  free(encoded);
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
+static void test_pipeline_invalid(void) {
+  TEST("invalid pipelines are rejected");
+
+  codectk_stage stages[CODECTK_PIPELINE_MAX_STAGES + 1];
+  for (size_t i = 0; i <= CODECTK_PIPELINE_MAX_STAGES; i++) {
+    stages[i].codec = huffman_codec();
+    stages[i].params = NULL;
+  }
+  codectk_pipeline *p = NULL;
+
+  if (codectk_pipeline_create(stages, 0, 0, CODECTK_PIPELINE_FUSED, &p) != CODECTK_EINVAL ||
+      codectk_pipeline_create(stages, CODECTK_PIPELINE_MAX_STAGES + 1, 0,
+                              CODECTK_PIPELINE_FUSED, &p) != CODECTK_EINVAL) {
+    FAIL("bad stage count accepted");
+    return;
+  }
+
+  stages[0].codec = NULL;
+  if (codectk_pipeline_create(stages, 1, 0, CODECTK_PIPELINE_FUSED, &p) != CODECTK_EINVAL) {
+    FAIL("missing codec accepted");
+    return;
+  }
+
+  /* A stage error surfaces from encode */
+  hamming_params bad = {9};
+  stages[0].codec = hamming_codec();
+  stages[0].params = &bad;
+  uint8_t in[16] = {0}, out[256];
+  size_t out_bits = sizeof(out) * 8;
+  if (codectk_pipeline_create(stages, 1, 0, CODECTK_PIPELINE_FUSED, &p) != CODECTK_OK ||
+      codectk_pipeline_encode(p, in, sizeof(in) * 8, out, &out_bits) != CODECTK_EINVAL) {
+    codectk_pipeline_destroy(p);
+    FAIL("stage error lost");
+    return;
+  }
+  codectk_pipeline_destroy(p);
+
+  PASS();
+}
+
+int test_pipeline_suite(void) {
+  test_count = 0;
+  pass_count = 0;
+
+  test_pipeline_huffman_hamming();
+  test_pipeline_three_stages();
+  test_pipeline_invalid();
+
+  printf("  pipeline: %d/%d tests passed\n", pass_count, test_count);
+  return test_count - pass_count;
+}
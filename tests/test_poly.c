@@ -82,6 +82,113 @@ static void test_gf2_poly_mul(void) {
   PASS();
 }
 
+/* Bit-at-a-time reference product, truncated to r's capacity */
+static void gf2_mul_ref(poly_gf2_t *r, const poly_gf2_t *a, const poly_gf2_t *b) {
+  poly_gf2_zero(r);
+  for (int i = 0; i <= a->deg; i++) {
+    if (!poly_gf2_get_coeff(a, i)) continue;
+    for (int j = 0; j <= b->deg && i + j < r->capacity; j++) {
+      if (poly_gf2_get_coeff(b, j)) {
+        poly_gf2_set_coeff(r, i + j, poly_gf2_get_coeff(r, i + j) ^ 1);
+      }
+    }
+  }
+}
+
+static int gf2_equal(const poly_gf2_t *a, const poly_gf2_t *b) {
+  if (a->deg != b->deg) return 0;
+  for (int i = 0; i <= a->deg; i++) {
+    if (poly_gf2_get_coeff(a, i) != poly_gf2_get_coeff(b, i)) return 0;
+  }
+  return 1;
+}
+
+static void gf2_random(poly_gf2_t *p, int deg, uint32_t *seed) {
+  poly_gf2_zero(p);
+  for (int i = 0; i < deg; i++) {
+    *seed = *seed * 1103515245u + 12345u;
+    poly_gf2_set_coeff(p, i, (int)((*seed >> 16) & 1));
+  }
+  poly_gf2_set_coeff(p, deg, 1);
+}
+
+static void test_gf2_poly_large(void) {
+  TEST("GF(2) Karatsuba, division, Barrett and GCD at large degrees");
+
+  static const char *names[] = {"c", NULL};
+  /* Balanced, unbalanced with a short tail, below the Karatsuba cut-off */
+  static const int degs[][2] = {{4100, 3990}, {9000, 1500}, {700, 650}, {63, 64}};
+  const char *err = NULL;
+  uint32_t seed = 7;
+
+  for (size_t ni = 0; ni < 2 && !err; ni++) {
+    gf2m_backend_select(names[ni]);
+
+    for (size_t di = 0; di < sizeof(degs) / sizeof(degs[0]) && !err; di++) {
+      int da = degs[di][0], db = degs[di][1];
+      poly_gf2_t a, b, c, prod, ref, q, r, tr, ttr, g;
+      poly_gf2_init(&a, da + 1);
+      poly_gf2_init(&b, db + 1);
+      poly_gf2_init(&c, db);
+      poly_gf2_init(&prod, da + db + 1);
+      poly_gf2_init(&ref, da + db + 1);
+      poly_gf2_init(&q, da + db + 1);
+      poly_gf2_init(&r, da + db + 1);
+      poly_gf2_init(&tr, (da + db) / 2);
+      poly_gf2_init(&ttr, (da + db) / 2);
+      poly_gf2_init(&g, da + db + 1);
+      gf2_random(&a, da, &seed);
+      gf2_random(&b, db, &seed);
+      gf2_random(&c, db - 1, &seed);
+
+      /* Full and truncated products against the reference */
+      poly_gf2_mul(&prod, &a, &b);
+      gf2_mul_ref(&ref, &a, &b);
+      poly_gf2_mul(&tr, &a, &b);
+      gf2_mul_ref(&ttr, &a, &b);
+      if (!gf2_equal(&prod, &ref) || !gf2_equal(&tr, &ttr)) err = "product differs";
+
+      /* (a*b + c) / b = a rem c, by long division and by Barrett */
+      poly_gf2_add(&prod, &prod, &c);
+      if (!err && (poly_gf2_div_rem(&q, &r, &prod, &b) != 0 || !gf2_equal(&q, &a) ||
+                   !gf2_equal(&r, &c))) {
+        err = "division wrong";
+      }
+      poly_gf2_barrett br;
+      if (!err && poly_gf2_barrett_init(&br, &b, da + db) != 0) err = "barrett init failed";
+      if (!err) {
+        poly_gf2_zero(&r);
+        if (poly_gf2_mod_barrett(&r, &prod, &br, NULL) != 0 || !gf2_equal(&r, &c)) {
+          err = "barrett remainder wrong";
+        }
+        poly_gf2_barrett_free(&br);
+      }
+
+      /* gcd(a*b, b) = b: the Barrett first step leaves remainder 0 */
+      poly_gf2_mul(&prod, &a, &b);
+      poly_gf2_gcd(&g, &prod, &b);
+      if (!err && !gf2_equal(&g, &b)) err = "gcd wrong";
+
+      poly_gf2_free(&a);
+      poly_gf2_free(&b);
+      poly_gf2_free(&c);
+      poly_gf2_free(&prod);
+      poly_gf2_free(&ref);
+      poly_gf2_free(&q);
+      poly_gf2_free(&r);
+      poly_gf2_free(&tr);
+      poly_gf2_free(&ttr);
+      poly_gf2_free(&g);
+    }
+  }
+
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
 static void test_gf2m_poly_eval(void) {
   TEST("GF(2^m) polynomial evaluation");
 
@@ -150,14 +257,104 @@ static void test_gf2m_poly_gcd(void) {
   PASS();
 }
 
+static void test_gf2m_poly_arena(void) {
+  TEST("GF(2^m) inverse and GCD with arena scratch");
+
+  gf2m_ctx ctx;
+  gf2m_ctx_init(&ctx, 8, 0x11D);
+
+  /* Room for g, a and the inverse's temporaries; the short arena has
+   * room for none of them and falls back to the heap */
+  uint8_t buf[1024], small[8];
+  codectk_arena ws, tiny;
+  codectk_arena_init(&ws, buf, sizeof(buf));
+  codectk_arena_init(&tiny, small, sizeof(small));
+
+  poly_gf2m_t g, a, inv_heap, inv_ws, inv_tiny;
+  poly_gf2m_init_ws(&g, &ctx, 5, &ws);
+  poly_gf2m_init_ws(&a, &ctx, 2, &ws);
+  poly_gf2m_init_ws(&inv_tiny, &ctx, 4, &tiny);
+  poly_gf2m_init(&inv_heap, &ctx, 4);
+  poly_gf2m_init(&inv_ws, &ctx, 4);
+  size_t mark = codectk_arena_mark(&ws);
+
+  /* g = x^4 + x^3 + 7x + 2 */
+  poly_gf2m_set_coeff(&g, 0, 2);
+  poly_gf2m_set_coeff(&g, 1, 7);
+  poly_gf2m_set_coeff(&g, 3, 1);
+  poly_gf2m_set_coeff(&g, 4, 1);
+
+  const char *err = NULL;
+  if (!g.borrowed || !a.borrowed || inv_tiny.borrowed || inv_heap.borrowed ||
+      mark + poly_gf2m_scratch_size(8, 10) > ws.size) {
+    err = "storage not taken from the arena";
+  }
+
+  /* (x + L)^-1 mod g for every L, through all three routes */
+  for (unsigned L = 0; L < 256 && !err; L++) {
+    poly_gf2m_zero(&a);
+    poly_gf2m_set_coeff(&a, 0, (uint16_t)L);
+    poly_gf2m_set_coeff(&a, 1, 1);
+
+    int r_heap = poly_gf2m_inv_mod(&inv_heap, &a, &g);
+    int r_ws = poly_gf2m_inv_mod_ws(&inv_ws, &a, &g, &ws);
+    int r_tiny = poly_gf2m_inv_mod_ws(&inv_tiny, &a, &g, &tiny);
+
+    if (r_heap != r_ws || r_heap != r_tiny || ws.used != mark || tiny.used != 0) {
+      err = "arena and heap paths disagree";
+    } else if (r_heap == 0 && poly_gf2m_eval(&g, (uint16_t)L) == 0) {
+      err = "inverse of a factor of g";
+    } else if (r_heap == 0) {
+      for (int i = 0; i < 4; i++) {
+        if (inv_heap.coeff[i] != inv_ws.coeff[i] || inv_heap.coeff[i] != inv_tiny.coeff[i]) {
+          err = "inverse differs";
+        }
+      }
+      /* (x + L) * inv mod g == 1 */
+      poly_gf2m_t prod, rem;
+      poly_gf2m_init_ws(&prod, &ctx, 6, &ws);
+      poly_gf2m_init_ws(&rem, &ctx, 6, &ws);
+      poly_gf2m_mul(&prod, &a, &inv_ws);
+      poly_gf2m_mod_ws(&rem, &prod, &g, &ws);
+      if (!err && (rem.deg != 0 || rem.coeff[0] != 1)) err = "not an inverse";
+      poly_gf2m_free(&prod);
+      poly_gf2m_free(&rem);
+      codectk_arena_release(&ws, mark);
+    }
+  }
+
+  /* gcd(g, g) = g without touching the arena's high-water mark */
+  if (!err) {
+    poly_gf2m_t d;
+    poly_gf2m_init_ws(&d, &ctx, 5, &ws);
+    poly_gf2m_gcd_ws(&d, &g, &g, &ws);
+    if (d.deg != 4 || ws.used != mark + codectk_arena_round(10)) err = "gcd mismatch";
+    poly_gf2m_free(&d);
+  }
+
+  poly_gf2m_free(&g);
+  poly_gf2m_free(&a);
+  poly_gf2m_free(&inv_heap);
+  poly_gf2m_free(&inv_ws);
+  poly_gf2m_free(&inv_tiny);
+  gf2m_ctx_free(&ctx);
+  if (err) {
+    FAIL(err);
+    return;
+  }
+  PASS();
+}
+
 int test_poly_suite(void) {
   test_count = 0;
   pass_count = 0;
 
   test_gf2_poly_add();
   test_gf2_poly_mul();
+  test_gf2_poly_large();
   test_gf2m_poly_eval();
   test_gf2m_poly_gcd();
+  test_gf2m_poly_arena();
 
   printf("  poly: %d/%d tests passed\n", pass_count, test_count);
   return test_count - pass_count;
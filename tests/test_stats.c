@@ -0,0 +1,171 @@
+/**
+ * test_stats.c - Tests for the decode counters (CODECTK_STATS builds; the
+ * default build only checks that the getters report ENOTSUP)
+ */
+
+#include "../include/stats.h"
+#include "../include/bch.h"
+#include "../include/hamming.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int test_count = 0;
+static int pass_count = 0;
+
+#define TEST(name) do { test_count++; printf("  [%d] %s: ", test_count, name); } while (0)
+#define PASS() do { pass_count++; printf("PASS\n"); } while (0)
+#define FAIL(msg) do { printf("FAIL - %s\n", msg); } while (0)
+
+static void flip(uint8_t *buf, size_t bit) {
+  buf[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+}
+
+static void test_stats_build(void) {
+  TEST("getters match the build");
+
+  codectk_stats s;
+  codectk_err want = codectk_stats_enabled() ? CODECTK_OK : CODECTK_ENOTSUP;
+  if (codectk_stats_thread(&s) != want || codectk_stats_total(&s) != want) {
+    FAIL("unexpected getter result");
+    return;
+  }
+  if (codectk_stats_enabled() && codectk_stats_total(NULL) != CODECTK_EINVAL) {
+    FAIL("NULL output accepted");
+    return;
+  }
+  if (strcmp(codectk_stats_codec_name(CODECTK_STATS_GOPPA), "goppa") != 0 ||
+      strcmp(codectk_stats_stage_name(CODECTK_STAGE_ROOTS), "roots") != 0) {
+    FAIL("wrong names");
+    return;
+  }
+  PASS();
+}
+
+/* One BCH(255) codeword per call with 0..6 errors: histogram and failures
+ * must match what the calls reported */
+static void test_stats_bch_histogram(void) {
+  TEST("BCH corrections histogram and failures");
+  if (!codectk_stats_enabled()) {
+    printf("skipped (CODECTK_STATS off) ");
+    PASS();
+    return;
+  }
+
+  const codectk_codec *codec = bch_codec();
+  bch_params params = {.m = 8, .t = 4};
+  uint8_t msg[32], cw[40], dec[40];
+  uint64_t want_hist[CODECTK_STATS_HIST] = {0}, want_fail = 0;
+  uint64_t seed = 7;
+  const char *err = NULL;
+
+  codectk_stats_reset();
+  for (int i = 0; i < 70 && !err; i++) {
+    for (size_t j = 0; j < sizeof(msg); j++) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      msg[j] = (uint8_t)(seed >> 56);
+    }
+    size_t cw_bits = sizeof(cw) * 8;
+    if (codec->encode(&params, msg, 255 - 32, cw, &cw_bits) != CODECTK_OK || cw_bits != 255) {
+      err = "encode failed";
+      break;
+    }
+    for (int e = 0; e < i % 7; e++) flip(cw, (size_t)(e * 37 + i) % 255);
+
+    size_t dec_bits = sizeof(dec) * 8, corrected = 0;
+    codectk_err r = codec->decode(&params, cw, cw_bits, dec, &dec_bits, &corrected);
+    if (r == CODECTK_OK) want_hist[corrected]++;
+    else if (r == CODECTK_EDECODE) want_fail++;
+    else err = "decode failed";
+  }
+
+  codectk_stats s;
+  if (!err && codectk_stats_thread(&s) != CODECTK_OK) err = "getter failed";
+  const codectk_codec_stats *b = &s.codec[CODECTK_STATS_BCH];
+  if (!err && (b->calls != 70 || b->codewords != 70 || b->failures != want_fail)) {
+    err = "wrong call, codeword or failure count";
+  }
+  for (int i = 0; i < CODECTK_STATS_HIST && !err; i++) {
+    if (b->corrections[i] != want_hist[i]) err = "wrong histogram";
+  }
+  if (!err && (want_hist[4] == 0 || want_fail == 0)) err = "test pattern too mild";
+  /* Without params.ctx every encode and decode builds a context */
+  if (!err && (b->spans[CODECTK_STAGE_SETUP] != 140 || !b->spans[CODECTK_STAGE_SYNDROME] ||
+               !b->spans[CODECTK_STAGE_KEY_EQUATION] || !b->spans[CODECTK_STAGE_ROOTS])) {
+    err = "stages not timed";
+  }
+  if (!err && !(s.ns_per_tick > 0)) err = "no tick calibration";
+
+  if (!err) {
+    FILE *f = tmpfile();
+    codectk_stats_print(f, &s);
+    if (!f || ftell(f) <= 0) err = "empty report";
+    if (f) fclose(f);
+  }
+
+  if (err) FAIL(err);
+  else PASS();
+}
+
+/* A Hamming stream long enough for the executor: the workers' counts only
+ * show up in the total */
+static void test_stats_threads(void) {
+  TEST("totals include executor workers");
+  if (!codectk_stats_enabled()) {
+    printf("skipped (CODECTK_STATS off) ");
+    PASS();
+    return;
+  }
+
+  enum { BLOCKS = 200000 };
+  const codectk_codec *codec = hamming_codec();
+  hamming_params params = {3};
+  size_t msg_bytes = BLOCKS * 4 / 8, cw_bytes = BLOCKS * 7 / 8 + 1;
+  uint8_t *msg = calloc(msg_bytes, 1), *cw = malloc(cw_bytes), *dec = malloc(msg_bytes + 8);
+  const char *err = NULL;
+
+  size_t cw_bits = cw_bytes * 8;
+  if (!msg || !cw || !dec ||
+      codec->encode(&params, msg, BLOCKS * 4, cw, &cw_bits) != CODECTK_OK) {
+    err = "encode failed";
+  }
+  size_t flips = 0;
+  for (size_t b = 0; !err && b < BLOCKS; b += 3) {
+    flip(cw, b * 7 + b % 7);
+    flips++;
+  }
+
+  codectk_stats_reset();
+  size_t dec_bits = (msg_bytes + 8) * 8, corrected = 0;
+  if (!err && (codec->decode(&params, cw, BLOCKS * 7, dec, &dec_bits, &corrected) !=
+                   CODECTK_OK || corrected != flips)) {
+    err = "decode failed";
+  }
+
+  codectk_stats s;
+  if (!err && codectk_stats_total(&s) != CODECTK_OK) err = "getter failed";
+  const codectk_codec_stats *h = &s.codec[CODECTK_STATS_HAMMING];
+  if (!err && (h->calls != 1 || h->codewords != BLOCKS || h->failures != 0 ||
+               h->corrections[1] != flips || h->corrections[0] != BLOCKS - flips)) {
+    err = "wrong totals";
+  }
+  if (!err && h->spans[CODECTK_STAGE_SYNDROME] < 2) err = "expected per-task spans";
+
+  free(msg);
+  free(cw);
+  free(dec);
+  if (err) FAIL(err);
+  else PASS();
+}
+
+int test_stats_suite(void) {
+  test_count = 0;
+  pass_count = 0;
+
+  test_stats_build();
+  test_stats_bch_histogram();
+  test_stats_threads();
+
+  printf("  stats: %d/%d tests passed\n", pass_count, test_count);
+  return test_count - pass_count;
+}
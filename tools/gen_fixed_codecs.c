@@ -0,0 +1,168 @@
+/**
+ * gen_fixed_codecs.c - Emit baked BCH contexts for fixed (m, t) sets
+ *
+ * Build-time helper for CODECTK_FIXED_CODECS. For each "bch-M-T" argument
+ * builds the context with bch_ctx_create() and writes its field, generator,
+ * LFSR, syndrome and Chien tables as static const arrays, plus a
+ * CODECTK_FIXED_BCH(X) list with one X(m, t, ctx) entry per set, where ctx
+ * is a bch_ctx initializer with designated fields. bch.c includes the
+ * header and specializes its encode and decode over each context.
+ *
+ * The Chien tables hold the 32-lane steps followed by the 16-lane ones;
+ * the contexts carry chien_lanes = BCH_CHIEN_CPU so that the width is
+ * picked on the machine that runs the code, not the one that built it.
+ *
+ * Usage: gen_fixed_codecs <output.h> bch-M-T...
+ */
+
+#include "../include/bch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SETS 32
+
+static void emit_u16(FILE *f, const char *name, const uint16_t *tab, size_t len) {
+  fprintf(f, "static const uint16_t %s[%zu] = {", name, len);
+  for (size_t i = 0; i < len; i++) {
+    fprintf(f, "%s%u,", (i % 16) ? " " : "\n  ", tab[i]);
+  }
+  fprintf(f, "\n};\n\n");
+}
+
+static void emit_u64(FILE *f, const char *name, const uint64_t *tab, size_t len) {
+  fprintf(f, "static const uint64_t %s[%zu] = {", name, len);
+  for (size_t i = 0; i < len; i++) {
+    fprintf(f, "%s0x%016llXull,", (i % 4) ? " " : "\n  ", (unsigned long long)tab[i]);
+  }
+  fprintf(f, "\n};\n\n");
+}
+
+static void emit_u8(FILE *f, const char *name, const uint8_t *tab, size_t len) {
+  fprintf(f, "static const uint8_t %s[%zu] = {", name, len);
+  for (size_t i = 0; i < len; i++) {
+    fprintf(f, "%s%u,", (i % 16) ? " " : "\n  ", tab[i]);
+  }
+  fprintf(f, "\n};\n\n");
+}
+
+static int emit_bch(FILE *f, unsigned m, unsigned t, const int *field_done) {
+  bch_ctx *c;
+  if (bch_ctx_create(m, t, &c) != CODECTK_OK) {
+    fprintf(stderr, "bch-%u-%u: no such code\n", m, t);
+    return -1;
+  }
+
+  char name[64];
+  size_t size = (size_t)1 << m;
+  if (!field_done[m]) {
+    snprintf(name, sizeof(name), "fixed_alog_%u", m);
+    emit_u16(f, name, c->field.alog, 2 * (size - 1));
+    snprintf(name, sizeof(name), "fixed_log_%u", m);
+    emit_u16(f, name, c->field.log, size);
+    snprintf(name, sizeof(name), "fixed_sqr_%u", m);
+    emit_u16(f, name, c->field.sqr, size);
+  }
+
+  snprintf(name, sizeof(name), "fixed_gen_%u_%u", m, t);
+  emit_u64(f, name, c->gen, c->words);
+  snprintf(name, sizeof(name), "fixed_tab_%u_%u", m, t);
+  emit_u64(f, name, c->tab, (size_t)c->slices * 256 * c->words);
+  if (c->synd_tab) {
+    snprintf(name, sizeof(name), "fixed_synd_%u_%u", m, t);
+    emit_u16(f, name, c->synd_tab, (size_t)t * 256);
+  }
+
+  unsigned nt = (t < BCH_CHIEN_SIMD_MAX_T) ? t : BCH_CHIEN_SIMD_MAX_T;
+  uint8_t *chien = (uint8_t*)calloc((size_t)nt * 256, 1);
+  if (!chien) {
+    bch_ctx_destroy(c);
+    return -1;
+  }
+  bch_chien_fill(c, 32, nt, chien);
+  bch_chien_fill(c, 16, nt, chien + (size_t)nt * 128);
+  snprintf(name, sizeof(name), "fixed_chien_%u_%u", m, t);
+  emit_u8(f, name, chien, (size_t)nt * 256);
+  free(chien);
+
+  /* Tables are never written through these pointers (owns_tables = 0) */
+  fprintf(f, "#define FIXED_CTX_%u_%u { \\\n", m, t);
+  fprintf(f, "  .m = %u, .t = %u, .n = %u, .r = %u, .k = %u, \\\n", m, t, c->n, c->r, c->k);
+  fprintf(f, "  .field = { .m = %u, .alog = (uint16_t*)fixed_alog_%u, \\\n", m, m);
+  fprintf(f, "    .log = (uint16_t*)fixed_log_%u, .sqr = (uint16_t*)fixed_sqr_%u, .mul = NULL, "
+             "\\\n", m, m);
+  fprintf(f, "    .flags = 0x%Xu, .prim = %u, .mod_poly = 0x%X, .owns_tables = 0 }, \\\n",
+          c->field.flags, c->field.prim, c->field.mod_poly);
+  fprintf(f, "  .words = %u, .gen = (uint64_t*)fixed_gen_%u_%u, \\\n", c->words, m, t);
+  fprintf(f, "  .slices = %u, .tab = (uint64_t*)fixed_tab_%u_%u, \\\n", c->slices, m, t);
+  if (c->synd_tab) fprintf(f, "  .synd_tab = (uint16_t*)fixed_synd_%u_%u, \\\n", m, t);
+  else fprintf(f, "  .synd_tab = NULL, \\\n");
+  fprintf(f, "  .chien_lanes = BCH_CHIEN_CPU, .chien_tab = (uint8_t*)fixed_chien_%u_%u }\n\n",
+          m, t);
+
+  bch_ctx_destroy(c);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s <output.h> bch-M-T...\n", argv[0]);
+    return 1;
+  }
+
+  unsigned sets[MAX_SETS][2];
+  int nsets = 0;
+  for (int i = 2; i < argc; i++) {
+    unsigned m, t;
+    char end;
+    if (sscanf(argv[i], "bch-%u-%u%c", &m, &t, &end) != 2 || m < 2 || m > 16) {
+      fprintf(stderr, "%s: expected bch-M-T with 2 <= M <= 16\n", argv[i]);
+      return 1;
+    }
+    for (int j = 0; j < nsets; j++) {
+      if (sets[j][0] == m && sets[j][1] == t) {
+        fprintf(stderr, "%s: listed twice\n", argv[i]);
+        return 1;
+      }
+    }
+    if (nsets == MAX_SETS) {
+      fprintf(stderr, "at most %d fixed codecs\n", MAX_SETS);
+      return 1;
+    }
+    sets[nsets][0] = m;
+    sets[nsets][1] = t;
+    nsets++;
+  }
+
+  FILE *f = fopen(argv[1], "w");
+  if (!f) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  fprintf(f, "/* Generated by gen_fixed_codecs; do not edit */\n\n");
+  fprintf(f, "#pragma once\n\n");
+
+  int field_done[17] = {0};
+  for (int i = 0; i < nsets; i++) {
+    if (emit_bch(f, sets[i][0], sets[i][1], field_done) != 0) {
+      fclose(f);
+      remove(argv[1]);
+      return 1;
+    }
+    field_done[sets[i][0]] = 1;
+  }
+
+  fprintf(f, "#define CODECTK_FIXED_BCH(X)");
+  for (int i = 0; i < nsets; i++) {
+    fprintf(f, " \\\n  X(%u, %u, FIXED_CTX_%u_%u)", sets[i][0], sets[i][1], sets[i][0],
+            sets[i][1]);
+  }
+  fprintf(f, "\n");
+
+  if (fclose(f) != 0) {
+    perror(argv[1]);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,74 @@
+/**
+ * gen_gf2m_tables.c - Emit static GF(2^m) tables for the default polynomials
+ *
+ * Build-time helper for CODECTK_STATIC_GF_TABLES. Writes a C file defining
+ * gf2m_static_ctx[17], indexed by m, whose entries for 2 <= m <= max_m hold
+ * the same antilog/log/squaring tables gf2m_ctx_init() would build for
+ * gf2m_default_poly(m). gf2m_ctx_get() hands these out directly.
+ *
+ * Usage: gen_gf2m_tables <max_m> <output.c>
+ */
+
+#include "../include/gf2m.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static void emit_table(FILE *f, const char *name, unsigned m,
+                       const uint16_t *tab, size_t len) {
+  fprintf(f, "static const uint16_t %s_%u[%zu] = {", name, m, len);
+  for (size_t i = 0; i < len; i++) {
+    fprintf(f, "%s%u,", (i % 16) ? " " : "\n  ", tab[i]);
+  }
+  fprintf(f, "\n};\n\n");
+}
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <max_m> <output.c>\n", argv[0]);
+    return 1;
+  }
+
+  unsigned max_m = (unsigned)strtoul(argv[1], NULL, 10);
+  if (max_m < 2 || max_m > 16) {
+    fprintf(stderr, "max_m must be in [2, 16]\n");
+    return 1;
+  }
+
+  FILE *f = fopen(argv[2], "w");
+  if (!f) {
+    perror(argv[2]);
+    return 1;
+  }
+
+  fprintf(f, "/* Generated by gen_gf2m_tables; do not edit */\n\n");
+  fprintf(f, "#include \"gf2m.h\"\n\n");
+
+  for (unsigned m = 2; m <= max_m; m++) {
+    gf2m_ctx ctx;
+    if (gf2m_ctx_init(&ctx, m, gf2m_default_poly(m)) != 0) {
+      fprintf(stderr, "failed to build GF(2^%u)\n", m);
+      fclose(f);
+      return 1;
+    }
+    size_t size = (size_t)1 << m;
+    emit_table(f, "alog", m, ctx.alog, 2 * (size - 1));
+    emit_table(f, "log", m, ctx.log, size);
+    emit_table(f, "sqr", m, ctx.sqr, size);
+    gf2m_ctx_free(&ctx);
+  }
+
+  /* Tables are never written through these pointers (owns_tables = 0) */
+  fprintf(f, "const gf2m_ctx gf2m_static_ctx[17] = {\n");
+  for (unsigned m = 2; m <= max_m; m++) {
+    fprintf(f, "  [%u] = { %u, (uint16_t*)alog_%u, (uint16_t*)log_%u, (uint16_t*)sqr_%u,"
+               " NULL, GF2M_TABLE_SQR, 2, 0x%X, 0 },\n",
+            m, m, m, m, m, gf2m_default_poly(m));
+  }
+  fprintf(f, "};\n");
+
+  if (fclose(f) != 0) {
+    perror(argv[2]);
+    return 1;
+  }
+  return 0;
+}
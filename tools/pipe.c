@@ -2,8 +2,29 @@
  * pipe.c - Command-line tool for codec demonstration
  *
  * Usage:
- *   pipe encode <codec> <input> <output>
- *   pipe decode <codec> <input> <output>
+ *   pipe [--stats] encode <chain> <input> <output> [chunk_kib]
+ *   pipe [--stats] decode <chain> <input> <output>
+ *
+ * A chain is one or more codecs joined by '+', applied left to right on
+ * encode and right to left on decode, each with optional parameters:
+ *   huffman+bch:m=8,t=4        compress, then protect
+ *   hamming:m=3
+ * The stages run as a codectk pipeline: tiles of each chunk alternate
+ * between small reusable buffers, with one thread per stage.
+ *
+ * Input and output may be "-" for stdin/stdout. The input is processed in
+ * chunks (default 1 MiB), so memory use does not depend on the file size:
+ * regular files are memory-mapped and released behind the cursor, pipes
+ * are read one chunk at a time.
+ *
+ * --stats prints the library's decode counters and stage timings at the
+ * end (to the progress stream); the library must be built with
+ * -DCODECTK_STATS=ON.
+ *
+ * Encoded files are a stream of independent frames:
+ *   "CTKS" | per chunk: LE32 raw bytes, LE64 coded bits, pipeline output
+ * Files without the magic are decoded the old way, as one codec call over
+ * the whole (mapped) input.
  *
  * Example:
  *   echo "Hello" > input.txt
@@ -12,84 +33,473 @@
  */
 
 #include "../include/codectk.h"
+#include "../include/bch.h"
+#include "../include/hamming.h"
+#include "../include/huffman.h"
+#include "../include/pipeline.h"
+#include "../include/stats.h"
+#include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define STREAM_MAGIC "CTKS"
+#define FRAME_HEADER 12                 /* LE32 raw bytes, LE64 coded bits */
+#define DEFAULT_CHUNK (1u << 20)
+#define MAX_CHUNK ((size_t)1 << 30)     /* largest frame accepted by decode */
+#define MAX_EXPANSION 64                /* coded bytes per raw byte of a frame, */
+#define EXPANSION_SLACK 10000           /* plus this for headers and tables */
+#define IO_ALIGN 4096
+
+/* Input: a read-only mapping of a regular file, or a read() buffer */
+typedef struct {
+  int fd;
+  const uint8_t *map;
+  size_t map_size;
+  size_t pos;                           /* bytes consumed */
+  size_t released;                      /* mapped bytes already dropped */
+  uint8_t *buf;
+  size_t cap;
+} source;
+
+static int source_open(source *s, const char *path) {
+  memset(s, 0, sizeof(*s));
+  s->fd = strcmp(path, "-") ? open(path, O_RDONLY) : STDIN_FILENO;
+  if (s->fd < 0) {
+    fprintf(stderr, "Error: cannot open input file '%s'\n", path);
+    return -1;
+  }
 
-#define MAX_FILE_SIZE (10 * 1024 * 1024) /* 10 MB limit */
+  struct stat st;
+  if (fstat(s->fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+      (uint64_t)st.st_size <= SIZE_MAX) {
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, s->fd, 0);
+    if (p != MAP_FAILED) {
+      s->map = (const uint8_t*)p;
+      s->map_size = (size_t)st.st_size;
+      madvise(p, s->map_size, MADV_SEQUENTIAL);
+    }
+    /* Otherwise (e.g. no address space for it) fall back to read() */
+  }
+  return 0;
+}
 
-static int read_file(const char *path, uint8_t **data, size_t *size) {
-  FILE *f = fopen(path, "rb");
-  if (!f) {
-    fprintf(stderr, "Error: cannot open input file '%s'\n", path);
+/**
+ * Next len bytes of input (fewer only at the end) in *data, valid until
+ * the next call. Returns the number of bytes, or -1 on error.
+ */
+static ssize_t source_read(source *s, size_t len, const uint8_t **data) {
+  if (s->map) {
+    size_t n = s->map_size - s->pos < len ? s->map_size - s->pos : len;
+    *data = s->map + s->pos;
+    s->pos += n;
+    return (ssize_t)n;
+  }
+
+  if (len > s->cap) {
+    uint8_t *b = (uint8_t*)realloc(s->buf, len);
+    if (!b) {
+      fprintf(stderr, "Error: out of memory\n");
+      return -1;
+    }
+    s->buf = b;
+    s->cap = len;
+  }
+
+  size_t n = 0;
+  while (n < len) {
+    ssize_t r = read(s->fd, s->buf + n, len - n);
+    if (r < 0 && errno == EINTR) continue;
+    if (r < 0) {
+      perror("Error: read");
+      return -1;
+    }
+    if (r == 0) break;
+    n += (size_t)r;
+  }
+  s->pos += n;
+  *data = s->buf;
+  return (ssize_t)n;
+}
+
+/* Drop the mapped pages behind the cursor so the resident size stays flat */
+static void source_release(source *s) {
+  if (!s->map) return;
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t end = s->pos / page * page;
+  if (end > s->released) {
+    madvise((void*)(uintptr_t)(s->map + s->released), end - s->released, MADV_DONTNEED);
+    s->released = end;
+  }
+}
+
+static void source_close(source *s) {
+  if (s->map) munmap((void*)(uintptr_t)s->map, s->map_size);
+  if (s->fd > STDIN_FILENO) close(s->fd);
+  free(s->buf);
+}
+
+/* Write all iovecs, resuming after short writes */
+static int write_all(int fd, struct iovec *iov, int n) {
+  while (n > 0) {
+    ssize_t w = writev(fd, iov, n);
+    if (w < 0 && errno == EINTR) continue;
+    if (w < 0) {
+      perror("Error: write");
+      return -1;
+    }
+    size_t left = (size_t)w;
+    while (n > 0 && left >= iov->iov_len) {
+      left -= iov->iov_len;
+      iov++;
+      n--;
+    }
+    if (n > 0) {
+      iov->iov_base = (uint8_t*)iov->iov_base + left;
+      iov->iov_len -= left;
+    }
+  }
+  return 0;
+}
+
+/* Grow an aligned buffer to at least size bytes; contents are not kept */
+static int reserve(uint8_t **buf, size_t *cap, size_t size) {
+  if (size <= *cap) return 0;
+  void *p = NULL;
+  if (posix_memalign(&p, IO_ALIGN, size) != 0) {
+    fprintf(stderr, "Error: out of memory\n");
     return -1;
   }
+  free(*buf);
+  *buf = (uint8_t*)p;
+  *cap = size;
+  return 0;
+}
 
-  fseek(f, 0, SEEK_END);
-  long fsize = ftell(f);
-  fseek(f, 0, SEEK_SET);
+static void put_le(uint8_t *p, uint64_t v, int bytes) {
+  for (int i = 0; i < bytes; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
 
-  if (fsize < 0 || fsize > MAX_FILE_SIZE) {
-    fprintf(stderr, "Error: file size invalid or too large\n");
-    fclose(f);
+static uint64_t get_le(const uint8_t *p, int bytes) {
+  uint64_t v = 0;
+  for (int i = 0; i < bytes; i++) v |= (uint64_t)p[i] << (8 * i);
+  return v;
+}
+
+/* Parsed chain: codecs, their parameters, and contexts built for them */
+typedef struct {
+  codectk_stage stage[CODECTK_PIPELINE_MAX_STAGES];
+  size_t n;
+  union {
+    hamming_params hamming;
+    bch_params bch;
+    huffman_params huffman;
+  } params[CODECTK_PIPELINE_MAX_STAGES];
+  bch_ctx *bch[CODECTK_PIPELINE_MAX_STAGES];
+} chain;
+
+static void chain_free(chain *c) {
+  for (size_t i = 0; i < c->n; i++) {
+    bch_ctx_destroy(c->bch[i]);
+  }
+}
+
+/* Parameter key=value of stage `name`; returns -1 with a message if unknown */
+static int set_param(chain *c, size_t i, const char *name, const char *key, unsigned long v) {
+  if (!strcmp(name, "hamming") && !strcmp(key, "m")) {
+    c->params[i].hamming.m = (unsigned)v;
+  } else if (!strcmp(name, "bch") && !strcmp(key, "m")) {
+    c->params[i].bch.m = (unsigned)v;
+  } else if (!strcmp(name, "bch") && !strcmp(key, "t")) {
+    c->params[i].bch.t = (unsigned)v;
+  } else if (!strcmp(name, "huffman") && !strcmp(key, "block")) {
+    c->params[i].huffman.block_size = (size_t)v * 1024;
+  } else if (!strcmp(name, "huffman") && !strcmp(key, "streams")) {
+    c->params[i].huffman.streams = (unsigned)v;
+  } else if (!strcmp(name, "huffman") && !strcmp(key, "threads")) {
+    c->params[i].huffman.threads = (unsigned)v;
+  } else {
+    fprintf(stderr, "Error: unknown parameter '%s' for %s\n", key, name);
     return -1;
   }
+  return 0;
+}
 
-  *data = (uint8_t*)malloc((size_t)fsize);
-  if (!*data) {
-    fprintf(stderr, "Error: out of memory\n");
-    fclose(f);
+static int chain_parse(chain *c, const char *spec) {
+  memset(c, 0, sizeof(*c));
+
+  char buf[256];
+  if (strlen(spec) >= sizeof(buf)) {
+    fprintf(stderr, "Error: chain description too long\n");
+    return -1;
+  }
+  strcpy(buf, spec);
+
+  char *save_stage = NULL;
+  for (char *st = strtok_r(buf, "+", &save_stage); st; st = strtok_r(NULL, "+", &save_stage)) {
+    if (c->n == CODECTK_PIPELINE_MAX_STAGES) {
+      fprintf(stderr, "Error: at most %d stages\n", CODECTK_PIPELINE_MAX_STAGES);
+      return -1;
+    }
+    size_t i = c->n++;
+
+    char *args = strchr(st, ':');
+    if (args) *args++ = '\0';
+    const codectk_codec *codec = codectk_get(st);
+    if (!codec) {
+      fprintf(stderr, "Error: unknown codec '%s'\n", st);
+      return -1;
+    }
+    if (!strcmp(st, "goppa")) {
+      fprintf(stderr, "Error: goppa needs a support set and Goppa polynomial; "
+                      "use the library API\n");
+      return -1;
+    }
+
+    char *save_arg = NULL;
+    for (char *kv = args ? strtok_r(args, ",", &save_arg) : NULL; kv;
+         kv = strtok_r(NULL, ",", &save_arg)) {
+      char *val = strchr(kv, '=');
+      if (!val) {
+        fprintf(stderr, "Error: expected key=value, got '%s'\n", kv);
+        return -1;
+      }
+      *val++ = '\0';
+      if (set_param(c, i, st, kv, strtoul(val, NULL, 10)) != 0) return -1;
+    }
+
+    c->stage[i].codec = codec;
+    c->stage[i].params = &c->params[i];
+    if (!strcmp(st, "huffman")) {
+      /* No parameters: plain HUF2 per tile */
+      huffman_params none = {0, 0, 0};
+      if (!memcmp(&c->params[i].huffman, &none, sizeof(none))) c->stage[i].params = NULL;
+    } else if (!strcmp(st, "hamming") && !c->params[i].hamming.m) {
+      c->params[i].hamming.m = 3;
+    } else if (!strcmp(st, "bch")) {
+      /* Build the tables once instead of once per tile */
+      bch_params *bp = &c->params[i].bch;
+      codectk_err err = bch_ctx_create(bp->m ? bp->m : 8, bp->t ? bp->t : 4, &c->bch[i]);
+      if (err != CODECTK_OK) {
+        fprintf(stderr, "Error: bch: %s\n", codectk_strerror(err));
+        return -1;
+      }
+      bp->ctx = c->bch[i];
+    }
+  }
+
+  if (c->n == 0) {
+    fprintf(stderr, "Error: empty chain\n");
     return -1;
   }
+  return 0;
+}
+
+typedef struct {
+  size_t in_bytes, out_bytes, corrected;
+} totals;
 
-  size_t nread = fread(*data, 1, (size_t)fsize, f);
-  fclose(f);
+static int encode_stream(codectk_pipeline *pl, source *src, int out_fd,
+                         size_t chunk, totals *t) {
+  size_t cap = 0;
+  uint8_t *out = NULL;
+  if (reserve(&out, &cap, 2 * chunk + 10000) != 0) return -1;
 
-  if (nread != (size_t)fsize) {
-    fprintf(stderr, "Error: failed to read entire file\n");
-    free(*data);
+  struct iovec magic = {STREAM_MAGIC, 4};
+  if (write_all(out_fd, &magic, 1) != 0) {
+    free(out);
     return -1;
   }
+  t->out_bytes += 4;
+
+  for (;;) {
+    const uint8_t *data;
+    ssize_t n = source_read(src, chunk, &data);
+    if (n <= 0) {
+      free(out);
+      return (int)n;
+    }
 
-  *size = (size_t)fsize;
+    /* Grow the output until the chain's expansion fits */
+    size_t out_bits = cap * 8;
+    codectk_err err;
+    size_t limit = MAX_EXPANSION * (size_t)n + EXPANSION_SLACK;
+    while ((err = codectk_pipeline_encode(pl, data, (size_t)n * 8, out, &out_bits)) ==
+               CODECTK_ENOMEM &&
+           cap < limit) {
+      if (reserve(&out, &cap, 2 * cap) != 0) {
+        free(out);
+        return -1;
+      }
+      out_bits = cap * 8;
+    }
+    /* Frames the decoder would reject as corrupt are not written */
+    if (err == CODECTK_OK && (out_bits + 7) / 8 > limit) err = CODECTK_ENOMEM;
+    if (err != CODECTK_OK) {
+      fprintf(stderr, "Error: encode failed: %s\n", codectk_strerror(err));
+      free(out);
+      return -1;
+    }
+
+    uint8_t hdr[FRAME_HEADER];
+    put_le(hdr, (uint64_t)n, 4);
+    put_le(hdr + 4, out_bits, 8);
+    struct iovec iov[2] = {{hdr, FRAME_HEADER}, {out, (out_bits + 7) / 8}};
+    if (write_all(out_fd, iov, 2) != 0) {
+      free(out);
+      return -1;
+    }
+
+    source_release(src);
+    t->in_bytes += (size_t)n;
+    t->out_bytes += FRAME_HEADER + (out_bits + 7) / 8;
+  }
+}
+
+static int decode_stream(codectk_pipeline *pl, source *src, int out_fd, totals *t) {
+  size_t cap = 0;
+  uint8_t *out = NULL;
+  t->in_bytes += 4;
+
+  for (;;) {
+    const uint8_t *hdr;
+    ssize_t n = source_read(src, FRAME_HEADER, &hdr);
+    if (n == 0) break;
+    if (n != FRAME_HEADER) {
+      if (n > 0) fprintf(stderr, "Error: truncated frame header\n");
+      free(out);
+      return -1;
+    }
+
+    size_t raw = (size_t)get_le(hdr, 4);
+    uint64_t coded_bits = get_le(hdr + 4, 8);
+    size_t coded = (size_t)((coded_bits + 7) / 8);
+    /* No more than the encoder writes, checked before the frame is read */
+    if (raw > MAX_CHUNK || coded_bits > 8 * (uint64_t)(MAX_EXPANSION * raw + EXPANSION_SLACK)) {
+      fprintf(stderr, "Error: corrupt frame header\n");
+      free(out);
+      return -1;
+    }
+
+    size_t need = raw + 64;
+    if (reserve(&out, &cap, need) != 0) {
+      free(out);
+      return -1;
+    }
+
+    const uint8_t *data;
+    if (source_read(src, coded, &data) != (ssize_t)coded) {
+      fprintf(stderr, "Error: truncated frame\n");
+      free(out);
+      return -1;
+    }
+
+    size_t out_bits = cap * 8;
+    size_t corrected = 0;
+    codectk_err err = codectk_pipeline_decode(pl, data, (size_t)coded_bits, out, &out_bits,
+                                              &corrected);
+    if (err == CODECTK_OK && out_bits != raw * 8) err = CODECTK_EDECODE;
+    if (err != CODECTK_OK) {
+      fprintf(stderr, "Error: decode failed: %s\n", codectk_strerror(err));
+      free(out);
+      return -1;
+    }
+
+    struct iovec iov = {out, raw};
+    if (write_all(out_fd, &iov, 1) != 0) {
+      free(out);
+      return -1;
+    }
+
+    source_release(src);
+    t->in_bytes += FRAME_HEADER + coded;
+    t->out_bytes += raw;
+    t->corrected += corrected;
+  }
+
+  free(out);
   return 0;
 }
 
-static int write_file(const char *path, const uint8_t *data, size_t size) {
-  FILE *f = fopen(path, "wb");
-  if (!f) {
-    fprintf(stderr, "Error: cannot open output file '%s'\n", path);
+/* Files written before the frame format: one codec call over everything */
+static int decode_legacy(const chain *c, source *src, int out_fd, totals *t) {
+  if (c->n != 1) {
+    fprintf(stderr, "Error: input is not a %s stream\n", STREAM_MAGIC);
+    return -1;
+  }
+  const codectk_codec *codec = c->stage[0].codec;
+  if (!src->map) {
+    fprintf(stderr, "Error: input is not a %s stream\n", STREAM_MAGIC);
     return -1;
   }
 
-  size_t nwritten = fwrite(data, 1, size, f);
-  fclose(f);
+  size_t cap = src->map_size * 10 + 10000;
+  uint8_t *out = (uint8_t*)malloc(cap);
+  if (!out) {
+    fprintf(stderr, "Error: out of memory\n");
+    return -1;
+  }
 
-  if (nwritten != size) {
-    fprintf(stderr, "Error: failed to write entire file\n");
+  size_t out_bits = cap * 8;
+  codectk_err err = codec->decode(c->stage[0].params, src->map, src->map_size * 8, out,
+                                  &out_bits, &t->corrected);
+  if (err != CODECTK_OK) {
+    fprintf(stderr, "Error: decode failed: %s\n", codectk_strerror(err));
+    free(out);
     return -1;
   }
 
-  return 0;
+  struct iovec iov = {out, (out_bits + 7) / 8};
+  int rc = write_all(out_fd, &iov, 1);
+  t->in_bytes = src->map_size;
+  t->out_bytes = iov.iov_len;
+  free(out);
+  return rc;
 }
 
 static void print_usage(const char *prog) {
   printf("Usage:\n");
-  printf("  %s encode <codec> <input> <output>\n", prog);
-  printf("  %s decode <codec> <input> <output>\n", prog);
+  printf("  %s [--stats] encode <chain> <input> <output> [chunk_kib]\n", prog);
+  printf("  %s [--stats] decode <chain> <input> <output>\n", prog);
+  printf("  (use - for stdin/stdout; --stats prints decode counters and timings)\n");
   printf("\n");
-  printf("Available codecs:\n");
-  printf("  huffman - Huffman source coding\n");
-  printf("  hamming - Hamming error-correcting code (requires m parameter)\n");
+  printf("A chain is codec[:key=value,...] stages joined by '+':\n");
+  printf("  huffman[:block=KiB,streams=N,threads=N] - Huffman source coding\n");
+  printf("  hamming[:m=3]       - Hamming error-correcting code\n");
+  printf("  bch[:m=8,t=4]       - BCH error-correcting code\n");
   printf("\n");
   printf("Examples:\n");
   printf("  %s encode huffman input.txt encoded.bin\n", prog);
   printf("  %s decode huffman encoded.bin output.txt\n", prog);
+  printf("  %s encode huffman+bch:m=8,t=4 input.txt protected.bin\n", prog);
+  printf("  cat big.log | %s encode huffman - - > big.ctk\n", prog);
+}
+
+/* Counters of every thread the run used, the pipeline's and the executor's */
+static void print_stats(FILE *msg) {
+  codectk_stats s;
+  if (codectk_stats_total(&s) != CODECTK_OK) {
+    fprintf(stderr, "Warning: stats not compiled in (build with -DCODECTK_STATS=ON)\n");
+    return;
+  }
+  fprintf(msg, "Decode stats:\n");
+  codectk_stats_print(msg, &s);
 }
 
 int main(int argc, char **argv) {
+  const char *prog = argv[0];
+  int stats = argc > 1 && !strcmp(argv[1], "--stats");
+  if (stats) {
+    argv++;
+    argc--;
+  }
   if (argc < 5) {
-    print_usage(argv[0]);
+    print_usage(prog);
     return 1;
   }
 
@@ -98,92 +508,100 @@ int main(int argc, char **argv) {
   const char *input_path = argv[3];
   const char *output_path = argv[4];
 
-  /* Get codec */
-  const codectk_codec *codec = codectk_get(codec_name);
-  if (!codec) {
-    fprintf(stderr, "Error: unknown codec '%s'\n", codec_name);
-    return 1;
+  size_t chunk = DEFAULT_CHUNK;
+  if (argc > 5) {
+    unsigned long kib = strtoul(argv[5], NULL, 10);
+    if (kib == 0 || kib > MAX_CHUNK / 1024) {
+      fprintf(stderr, "Error: chunk size must be 1..%zu KiB\n", MAX_CHUNK / 1024);
+      return 1;
+    }
+    chunk = (size_t)kib * 1024;
   }
 
-  /* Read input */
-  uint8_t *input_data = NULL;
-  size_t input_size = 0;
-  if (read_file(input_path, &input_data, &input_size) != 0) {
+  int encode = strcmp(operation, "encode") == 0;
+  if (!encode && strcmp(operation, "decode") != 0) {
+    fprintf(stderr, "Error: unknown operation '%s' (use 'encode' or 'decode')\n",
+            operation);
     return 1;
   }
 
-  /* Allocate output buffer (generous size) */
-  size_t output_capacity = input_size * 10 + 10000;
-  uint8_t *output_data = (uint8_t*)malloc(output_capacity);
-  if (!output_data) {
-    fprintf(stderr, "Error: out of memory\n");
-    free(input_data);
+  chain c;
+  if (chain_parse(&c, codec_name) != 0) {
+    chain_free(&c);
     return 1;
   }
 
-  size_t output_bits = output_capacity * 8;
-  codectk_err err;
-
-  if (strcmp(operation, "encode") == 0) {
-    printf("Encoding with %s...\n", codec_name);
-    err = codec->encode(NULL, input_data, input_size * 8, output_data, &output_bits);
-
-    if (err != CODECTK_OK) {
-      fprintf(stderr, "Error: encode failed: %s\n", codectk_strerror(err));
-      free(input_data);
-      free(output_data);
-      return 1;
-    }
+  codectk_pipeline *pl = NULL;
+  codectk_err perr = codectk_pipeline_create(c.stage, c.n, 0, CODECTK_PIPELINE_THREADED, &pl);
+  if (perr != CODECTK_OK) {
+    fprintf(stderr, "Error: %s\n", codectk_strerror(perr));
+    chain_free(&c);
+    return 1;
+  }
 
-    size_t output_bytes = (output_bits + 7) / 8;
-    printf("Encoded: %zu bytes -> %zu bytes (%.2f%% of original)\n",
-           input_size, output_bytes,
-           100.0 * output_bytes / input_size);
+  /* Progress goes to stderr when the data goes to stdout */
+  int to_stdout = strcmp(output_path, "-") == 0;
+  FILE *msg = to_stdout ? stderr : stdout;
 
-    if (write_file(output_path, output_data, output_bytes) != 0) {
-      free(input_data);
-      free(output_data);
-      return 1;
-    }
+  source src;
+  if (source_open(&src, input_path) != 0) {
+    codectk_pipeline_destroy(pl);
+    chain_free(&c);
+    return 1;
+  }
 
-  } else if (strcmp(operation, "decode") == 0) {
-    printf("Decoding with %s...\n", codec_name);
+  int out_fd = to_stdout ? STDOUT_FILENO : open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (out_fd < 0) {
+    fprintf(stderr, "Error: cannot open output file '%s'\n", output_path);
+    source_close(&src);
+    codectk_pipeline_destroy(pl);
+    chain_free(&c);
+    return 1;
+  }
 
-    size_t num_corrected = 0;
-    err = codec->decode(NULL, input_data, input_size * 8, output_data,
-                         &output_bits, &num_corrected);
+  totals t = {0, 0, 0};
+  int rc;
 
-    if (err != CODECTK_OK) {
-      fprintf(stderr, "Error: decode failed: %s\n", codectk_strerror(err));
-      free(input_data);
-      free(output_data);
-      return 1;
+  if (encode) {
+    fprintf(msg, "Encoding with %s...\n", codec_name);
+    rc = encode_stream(pl, &src, out_fd, chunk, &t);
+    if (rc == 0) {
+      fprintf(msg, "Encoded: %zu bytes -> %zu bytes (%.2f%% of original)\n",
+              t.in_bytes, t.out_bytes,
+              t.in_bytes ? 100.0 * (double)t.out_bytes / (double)t.in_bytes : 0.0);
     }
-
-    size_t output_bytes = (output_bits + 7) / 8;
-    printf("Decoded: %zu bytes -> %zu bytes\n", input_size, output_bytes);
-
-    if (num_corrected > 0) {
-      printf("Corrected %zu errors\n", num_corrected);
+  } else {
+    fprintf(msg, "Decoding with %s...\n", codec_name);
+    const uint8_t *magic;
+    ssize_t n = source_read(&src, 4, &magic);
+    if (n == 4 && memcmp(magic, STREAM_MAGIC, 4) == 0) {
+      rc = decode_stream(pl, &src, out_fd, &t);
+    } else if (n >= 0) {
+      src.pos = 0;
+      rc = decode_legacy(&c, &src, out_fd, &t);
+    } else {
+      rc = -1;
     }
-
-    if (write_file(output_path, output_data, output_bytes) != 0) {
-      free(input_data);
-      free(output_data);
-      return 1;
+    if (rc == 0) {
+      fprintf(msg, "Decoded: %zu bytes -> %zu bytes\n", t.in_bytes, t.out_bytes);
+      if (t.corrected > 0) {
+        fprintf(msg, "Corrected %zu errors\n", t.corrected);
+      }
     }
+  }
 
-  } else {
-    fprintf(stderr, "Error: unknown operation '%s' (use 'encode' or 'decode')\n",
-            operation);
-    free(input_data);
-    free(output_data);
+  source_close(&src);
+  codectk_pipeline_destroy(pl);
+  chain_free(&c);
+  if (stats) print_stats(msg);
+  if (!to_stdout && close(out_fd) != 0) {
+    perror("Error: close");
+    rc = -1;
+  }
+  if (rc != 0) {
     return 1;
   }
 
-  free(input_data);
-  free(output_data);
-
-  printf("Success!\n");
+  fprintf(msg, "Success!\n");
   return 0;
 }